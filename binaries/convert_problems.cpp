@@ -0,0 +1,138 @@
+/**
+ * Converts problems, subproblems, and solutions between the text protocol (see 
+ * SUBPROBLEM_PROTOCOL) and the binary exchange format (see BINARY_PROTOCOL).
+ */
+
+#include <iostream>
+#include <string>
+
+#include <sopnet/io/BinaryProblemsReader.h>
+#include <sopnet/io/BinaryProblemsWriter.h>
+#include <sopnet/io/BinarySolutionsReader.h>
+#include <sopnet/io/BinarySolutionsWriter.h>
+#include <sopnet/io/BinarySubproblemsReader.h>
+#include <sopnet/io/ProblemsReader.h>
+#include <sopnet/io/ProblemsWriter.h>
+#include <sopnet/io/SolutionsReader.h>
+#include <sopnet/io/SolutionsWriter.h>
+#include <sopnet/io/SubproblemsWriter.h>
+#include <util/ProgramOptions.h>
+#include <util/SignalHandler.h>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+
+util::ProgramOption optionConvertInput(
+		util::_long_name        = "in",
+		util::_short_name       = "i",
+		util::_description_text = "The file to convert.");
+
+util::ProgramOption optionConvertOutput(
+		util::_long_name        = "out",
+		util::_short_name       = "o",
+		util::_description_text = "The file to write the converted content to.");
+
+util::ProgramOption optionConvertContent(
+		util::_long_name        = "content",
+		util::_short_name       = "c",
+		util::_description_text = "The content of the input file: 'problems', 'solutions', or 'subproblems'.",
+		util::_default_value    = "problems");
+
+util::ProgramOption optionConvertToText(
+		util::_long_name        = "toText",
+		util::_short_name       = "t",
+		util::_description_text = "Convert from the binary format to text. The default is to convert from text to binary.");
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		/********
+		 * INIT *
+		 ********/
+
+		// init command line parser
+		util::ProgramOptions::init(optionc, optionv);
+
+		// init logger
+		logger::LogManager::init();
+
+		// init signal handler
+		util::SignalHandler::init();
+
+		std::string in      = optionConvertInput.as<std::string>();
+		std::string out     = optionConvertOutput.as<std::string>();
+		std::string content = optionConvertContent.as<std::string>();
+
+		if (content == "problems") {
+
+			if (optionConvertToText) {
+
+				pipeline::Process<BinaryProblemsReader> reader(in);
+				pipeline::Process<ProblemsWriter>       writer(out);
+
+				writer->setInput("problems", reader->getOutput());
+				writer->write();
+
+			} else {
+
+				pipeline::Process<ProblemsReader>       reader(in);
+				pipeline::Process<BinaryProblemsWriter> writer(out);
+
+				writer->setInput("problems", reader->getOutput());
+				writer->write();
+			}
+
+		} else if (content == "solutions") {
+
+			if (optionConvertToText) {
+
+				pipeline::Process<BinarySolutionsReader> reader(in);
+				pipeline::Process<SolutionsWriter>       writer(out);
+
+				writer->setInput("solutions", reader->getOutput("solutions"));
+				writer->setInput("problems", reader->getOutput("problems"));
+				writer->write();
+
+			} else {
+
+				pipeline::Process<SolutionsReader>       reader(in);
+				pipeline::Process<BinarySolutionsWriter> writer(out);
+
+				writer->setInput("solutions", reader->getOutput("solutions"));
+				writer->setInput("problems", reader->getOutput("problems"));
+				writer->write();
+			}
+
+		} else if (content == "subproblems") {
+
+			if (!optionConvertToText) {
+
+				LOG_ERROR(logger::out) << "subproblems can only be converted from binary to text" << std::endl;
+				return 1;
+			}
+
+			pipeline::Process<BinarySubproblemsReader> reader(in);
+			pipeline::Process<SubproblemsWriter>       writer(out);
+
+			writer->setInput(reader->getOutput());
+			writer->write();
+
+		} else {
+
+			LOG_ERROR(logger::out) << "unknown content '" << content << "'" << std::endl;
+			return 1;
+		}
+
+	} catch (boost::exception& e) {
+
+		if (boost::get_error_info<error_message>(e))
+			LOG_ERROR(logger::out) << *boost::get_error_info<error_message>(e);
+
+		LOG_ERROR(logger::out) << std::endl;
+
+		if (boost::get_error_info<stack_trace>(e))
+			LOG_ERROR(logger::out) << *boost::get_error_info<stack_trace>(e);
+
+		return 1;
+	}
+}
@@ -37,6 +37,10 @@ util::ProgramOption optionSaveErrors(
 		util::_long_name        = "saveErrors",
 		util::_description_text = "Create an image stack for every split and merge error. Be careful, this can result in a lot of data.");
 
+util::ProgramOption optionCountsOnly(
+		util::_long_name        = "countsOnly",
+		util::_description_text = "Only report the number of errors, don't create the corrected reconstruction and error location image stacks.");
+
 util::ProgramOption optionHeadless(
 		util::_long_name        = "headless",
 		util::_description_text = "Don't show the gui.");
@@ -100,6 +104,15 @@ int main(int optionc, char** optionv) {
 			rand->setInput("stack 2", reconstructionReader->getOutput());
 		}
 
+		if (optionCountsOnly) {
+
+			pipeline::Value<TolerantEditDistanceErrors> errors = editDistance->getOutput("errors");
+
+			LOG_USER(out) << "[main] " << errors->humanReadableErrorString() << std::endl;
+
+			return 0;
+		}
+
 		if (!optionHeadless) {
 
 			// start GUI
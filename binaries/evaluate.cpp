@@ -0,0 +1,108 @@
+/**
+ * evaluate main file. Computes a selection of error measures between a ground 
+ * truth and a reconstruction image stack in a single scan of the volumes and 
+ * appends them as a tab-separated line to a report file.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <imageprocessing/io/ImageStackDirectoryReader.h>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <sopnet/evaluation/StackErrorReport.h>
+#include <util/exceptions.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+
+util::ProgramOption optionGroundTruth(
+		util::_long_name        = "groundTruth",
+		util::_description_text = "The ground truth image stack.",
+		util::_default_value    = "groundtruth");
+
+util::ProgramOption optionReconstruction(
+		util::_long_name        = "reconstruction",
+		util::_description_text = "The reconstruction image stack.",
+		util::_default_value    = "reconstruction");
+
+util::ProgramOption optionTed(
+		util::_long_name        = "ted",
+		util::_description_text = "Compute the tolerant edit distance.");
+
+util::ProgramOption optionVoi(
+		util::_long_name        = "voi",
+		util::_description_text = "Compute the variation of information.");
+
+util::ProgramOption optionRand(
+		util::_long_name        = "rand",
+		util::_description_text = "Compute the Rand index.");
+
+util::ProgramOption optionReportFile(
+		util::_long_name        = "reportFile",
+		util::_description_text = "The file to append the error report to. A header line is written if the file does not exist yet.",
+		util::_default_value    = "errors.txt");
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		/********
+		 * INIT *
+		 ********/
+
+		// init command line parser
+		util::ProgramOptions::init(optionc, optionv);
+
+		// init logger
+		logger::LogManager::init();
+
+		LOG_USER(logger::out) << "[main] starting..." << std::endl;
+
+		bool reportTed  = optionTed;
+		bool reportRand = optionRand;
+		bool reportVoi  = optionVoi;
+
+		// compute all measures, if none was selected
+		if (!reportTed && !reportRand && !reportVoi)
+			reportTed = reportRand = reportVoi = true;
+
+		/*********
+		 * SETUP *
+		 *********/
+
+		pipeline::Process<ImageStackDirectoryReader> groundTruthReader(optionGroundTruth.as<std::string>());
+		pipeline::Process<ImageStackDirectoryReader> reconstructionReader(optionReconstruction.as<std::string>());
+
+		pipeline::Process<StackErrorReport> report(reportTed, reportRand, reportVoi);
+
+		report->setInput("ground truth", groundTruthReader->getOutput());
+		report->setInput("reconstruction", reconstructionReader->getOutput());
+
+		/*******
+		 * RUN *
+		 *******/
+
+		pipeline::Value<std::string> header = report->getOutput("error report header");
+		pipeline::Value<std::string> line   = report->getOutput("error report");
+		pipeline::Value<std::string> human  = report->getOutput("human readable error report");
+
+		LOG_USER(logger::out) << "[main] " << *human << std::endl;
+
+		std::string filename = optionReportFile.as<std::string>();
+		bool        newFile  = !boost::filesystem::exists(filename);
+
+		std::ofstream reportFile(filename.c_str(), std::ios::app);
+
+		if (newFile)
+			reportFile << "GROUND_TRUTH\tRECONSTRUCTION\t" << *header << std::endl;
+
+		reportFile
+				<< optionGroundTruth.as<std::string>() << "\t"
+				<< optionReconstruction.as<std::string>() << "\t"
+				<< *line << std::endl;
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <string>
 
+#include <sopnet/io/BinaryProblemsReader.h>
+#include <sopnet/io/BinarySolutionsWriter.h>
 #include <sopnet/io/ProblemsReader.h>
 #include <sopnet/io/SolutionsWriter.h>
 #include <sopnet/inference/ProblemsSolver.h>
@@ -26,6 +28,11 @@ util::ProgramOption optionSolutionOutput(
 		util::_description_text = "The problem description file or - to read from std::cin.",
 		util::_default_value    = "-");
 
+util::ProgramOption optionBinary(
+		util::_long_name        = "binary",
+		util::_short_name       = "b",
+		util::_description_text = "Read problems and write solutions in the binary format (see BINARY_PROTOCOL) instead of text. Requires files for input and output.");
+
 int main(int optionc, char** optionv) {
 
 	try {
@@ -43,22 +50,38 @@ int main(int optionc, char** optionv) {
 		// init signal handler
 		util::SignalHandler::init();
 
-		// create problem reader
-		pipeline::Process<ProblemsReader> problemsReader(optionProblemInput.as<std::string>());
-
 		// create problems solver
 		pipeline::Process<ProblemsSolver> problemsSolver;
 
-		// create solutions writer
-		pipeline::Process<SolutionsWriter> solutionsWriter(optionSolutionOutput.as<std::string>());
+		if (optionBinary) {
+
+			pipeline::Process<BinaryProblemsReader>  problemsReader(optionProblemInput.as<std::string>());
+			pipeline::Process<BinarySolutionsWriter> solutionsWriter(optionSolutionOutput.as<std::string>());
+
+			// create pipeline
+			problemsSolver->setInput("problems", problemsReader->getOutput());
+			solutionsWriter->setInput("solutions", problemsSolver->getOutput("solutions"));
+			solutionsWriter->setInput("problems", problemsReader->getOutput());
+
+			// write solution
+			solutionsWriter->write();
+
+		} else {
+
+			// create problem reader
+			pipeline::Process<ProblemsReader> problemsReader(optionProblemInput.as<std::string>());
+
+			// create solutions writer
+			pipeline::Process<SolutionsWriter> solutionsWriter(optionSolutionOutput.as<std::string>());
 
-		// create pipeline
-		problemsSolver->setInput("problems", problemsReader->getOutput());
-		solutionsWriter->setInput("solutions", problemsSolver->getOutput("solutions"));
-		solutionsWriter->setInput("problems", problemsReader->getOutput());
+			// create pipeline
+			problemsSolver->setInput("problems", problemsReader->getOutput());
+			solutionsWriter->setInput("solutions", problemsSolver->getOutput("solutions"));
+			solutionsWriter->setInput("problems", problemsReader->getOutput());
 
-		// write solution
-		solutionsWriter->write();
+			// write solution
+			solutionsWriter->write();
+		}
 
 	} catch (boost::exception& e) {
 
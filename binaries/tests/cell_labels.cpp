@@ -0,0 +1,323 @@
+/**
+ * Compares the cell labels found by the CellLabelOptimizer with the ones found 
+ * by an ILP of the same objective, solved with the LinearSolver, on random 
+ * cells. The number of splits and merges of the optimizer has to be at most 
+ * the reported gap above the one of the ILP.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <inference/LinearSolver.h>
+#include <sopnet/evaluation/CellLabelOptimizer.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+
+util::ProgramOption optionNumCells(
+		util::_long_name        = "numCells",
+		util::_description_text = "The number of cells of the random problems.",
+		util::_default_value    = 200);
+
+util::ProgramOption optionNumGroundTruthLabels(
+		util::_long_name        = "numGroundTruthLabels",
+		util::_description_text = "The number of ground-truth labels of the random problems.",
+		util::_default_value    = 40);
+
+util::ProgramOption optionNumReconstructionLabels(
+		util::_long_name        = "numReconstructionLabels",
+		util::_description_text = "The number of reconstruction labels of the random problems.",
+		util::_default_value    = 40);
+
+util::ProgramOption optionNumProblems(
+		util::_long_name        = "numProblems",
+		util::_description_text = "The number of random problems to compare.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed for the random problems.",
+		util::_default_value    = 42);
+
+typedef CellLabelOptimizer::cell_t cell_t;
+
+/**
+ * Create random cells. Every reconstruction label is the original label of at 
+ * least one cell, about half of the cells get up to three alternative labels.
+ */
+void createCells(
+		unsigned int numCells,
+		unsigned int numGtLabels,
+		unsigned int numRecLabels,
+		std::vector<cell_t>& cells,
+		std::set<float>& reconstructionLabels,
+		double& volumeSize) {
+
+	cells.clear();
+	cells.resize(std::max(numCells, numRecLabels));
+	reconstructionLabels.clear();
+	volumeSize = 0;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		cell_t& cell = cells[i];
+
+		float recLabel = (i < numRecLabels ? i : rand()%numRecLabels) + 1;
+
+		cell.setGroundTruthLabel(rand()%numGtLabels + 1);
+		cell.setReconstructionLabel(recLabel);
+		reconstructionLabels.insert(recLabel);
+
+		unsigned int size = 1 + rand()%100;
+		for (unsigned int x = 0; x < size; x++)
+			cell.add(cell_t::Location(x, i, 0));
+		volumeSize += size;
+
+		if (rand()%2 == 0)
+			continue;
+
+		unsigned int numAlternatives = 1 + rand()%3;
+		for (unsigned int j = 0; j < numAlternatives; j++) {
+
+			float alternative = rand()%numRecLabels + 1;
+
+			if (alternative != recLabel)
+				cell.addAlternativeLabel(alternative);
+		}
+	}
+}
+
+/**
+ * Get the label of a cell for the given choice: 0 for the reconstruction 
+ * label, i > 0 for the ith alternative label.
+ */
+float getLabel(const cell_t& cell, unsigned int choice) {
+
+	if (choice == 0)
+		return cell.getReconstructionLabel();
+
+	std::set<float>::const_iterator label = cell.getAlternativeLabels().begin();
+	std::advance(label, choice - 1);
+
+	return *label;
+}
+
+/**
+ * Get the number of splits and merges of a labeling of the cells, or -1 if a 
+ * reconstruction label disappeared.
+ */
+int getNumSplitsAndMerges(
+		const std::vector<cell_t>& cells,
+		const std::set<float>& reconstructionLabels,
+		const std::vector<unsigned int>& choices) {
+
+	std::set<std::pair<float, float> > matches;
+	std::set<float> gtLabels;
+	std::set<float> recLabels;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		float recLabel = getLabel(cells[i], choices[i]);
+
+		matches.insert(std::make_pair(cells[i].getGroundTruthLabel(), recLabel));
+		gtLabels.insert(cells[i].getGroundTruthLabel());
+		recLabels.insert(recLabel);
+	}
+
+	if (recLabels != reconstructionLabels)
+		return -1;
+
+	// every additional match of a ground-truth label is a split, every 
+	// additional match of a reconstruction label a merge
+	return 2*matches.size() - gtLabels.size() - recLabels.size();
+}
+
+/**
+ * Find the cell labels with an ILP that has the same optimum as the one 
+ * TolerantEditDistance solves if sopnet.evaluation.tedLinearSolver is set.
+ */
+void solveIlp(
+		const std::vector<cell_t>& cells,
+		const std::set<float>& reconstructionLabels,
+		double volumeSize,
+		std::vector<unsigned int>& choices) {
+
+	boost::shared_ptr<LinearConstraints> constraints = boost::make_shared<LinearConstraints>();
+
+	// one indicator for each cell and label
+
+	unsigned int var = 0;
+
+	std::vector<unsigned int> firstIndicators;
+	std::map<float, std::vector<unsigned int> > indicatorsByRec;
+	std::map<std::pair<float, float>, std::vector<unsigned int> > indicatorsByMatch;
+	std::vector<std::pair<unsigned int, double> > alternativeCosts;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		firstIndicators.push_back(var);
+
+		unsigned int numChoices = cells[i].getAlternativeLabels().size() + 1;
+
+		LinearConstraint oneLabel;
+
+		for (unsigned int choice = 0; choice < numChoices; choice++) {
+
+			float recLabel = getLabel(cells[i], choice);
+
+			indicatorsByRec[recLabel].push_back(var);
+			indicatorsByMatch[std::make_pair(cells[i].getGroundTruthLabel(), recLabel)].push_back(var);
+
+			if (choice > 0)
+				alternativeCosts.push_back(std::make_pair(var, cells[i].size()/(volumeSize + 1)));
+
+			oneLabel.setCoefficient(var++, 1.0);
+		}
+
+		// every cell needs to have a label
+		oneLabel.setRelation(Equal);
+		oneLabel.setValue(1);
+		constraints->add(oneLabel);
+	}
+
+	// labels can not disappear
+	foreach (float recLabel, reconstructionLabels) {
+
+		LinearConstraint constraint;
+		foreach (unsigned int v, indicatorsByRec[recLabel])
+			constraint.setCoefficient(v, 1.0);
+		constraint.setRelation(GreaterEqual);
+		constraint.setValue(1);
+		constraints->add(constraint);
+	}
+
+	// one indicator for each match, activated by the cell indicators
+
+	std::vector<unsigned int> matchVars;
+
+	std::map<std::pair<float, float>, std::vector<unsigned int> >::const_iterator match;
+	for (match = indicatorsByMatch.begin(); match != indicatorsByMatch.end(); match++) {
+
+		unsigned int matchVar = var++;
+		matchVars.push_back(matchVar);
+
+		foreach (unsigned int v, match->second) {
+
+			LinearConstraint constraint;
+			constraint.setCoefficient(matchVar, 1);
+			constraint.setCoefficient(v, -1);
+			constraint.setRelation(GreaterEqual);
+			constraint.setValue(0);
+			constraints->add(constraint);
+		}
+	}
+
+	// the number of splits and merges is twice the number of matches minus 
+	// the constant number of labels, prefer to relabel the least volume among 
+	// equally good solutions
+
+	boost::shared_ptr<LinearObjective> objective = boost::make_shared<LinearObjective>(var);
+
+	foreach (unsigned int matchVar, matchVars)
+		objective->setCoefficient(matchVar, 2);
+
+	unsigned int ind;
+	double cost;
+	foreach (boost::tie(ind, cost), alternativeCosts)
+		objective->setCoefficient(ind, cost);
+
+	objective->setSense(Minimize);
+
+	pipeline::Process<LinearSolver> solver;
+
+	solver->setInput("objective", objective);
+	solver->setInput("linear constraints", constraints);
+	solver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+
+	pipeline::Value<Solution> solution = solver->getOutput("solution");
+
+	choices.assign(cells.size(), 0);
+	for (unsigned int i = 0; i < cells.size(); i++)
+		for (unsigned int choice = 0; choice <= cells[i].getAlternativeLabels().size(); choice++)
+			if ((*solution)[firstIndicators[i] + choice] > 0.5)
+				choices[i] = choice;
+}
+
+int main(int argc, char** argv) {
+
+	try {
+
+		// init command line parser
+		util::ProgramOptions::init(argc, argv);
+
+		// init logger
+		logger::LogManager::init();
+
+		srand(optionSeed.as<unsigned int>());
+
+		unsigned int numProblems = optionNumProblems;
+		unsigned int numFailed   = 0;
+
+		for (unsigned int p = 0; p < numProblems; p++) {
+
+			std::vector<cell_t> cells;
+			std::set<float>     reconstructionLabels;
+			double              volumeSize;
+
+			createCells(
+					optionNumCells,
+					optionNumGroundTruthLabels,
+					optionNumReconstructionLabels,
+					cells,
+					reconstructionLabels,
+					volumeSize);
+
+			// solve with the optimizer
+			CellLabelOptimizer optimizer;
+			std::vector<unsigned int> optimizerChoices;
+			optimizer.optimize(cells, reconstructionLabels, volumeSize, optimizerChoices);
+
+			// solve with an ILP
+			std::vector<unsigned int> ilpChoices;
+			solveIlp(cells, reconstructionLabels, volumeSize, ilpChoices);
+
+			int optimizerErrors = getNumSplitsAndMerges(cells, reconstructionLabels, optimizerChoices);
+			int ilpErrors       = getNumSplitsAndMerges(cells, reconstructionLabels, ilpChoices);
+
+			std::cout
+					<< "problem " << p << ": optimizer " << optimizerErrors
+					<< " (gap " << optimizer.getGap() << ", "
+					<< optimizer.getNumOptimalComponents() << " of " << optimizer.getNumComponents()
+					<< " components optimal), ILP " << ilpErrors << std::endl;
+
+			if (optimizerErrors < 0) {
+
+				std::cerr << "problem " << p << ": optimizer lost a reconstruction label" << std::endl;
+				numFailed++;
+
+			} else if (optimizerErrors > ilpErrors + optimizer.getGap() + 1e-6) {
+
+				std::cerr << "problem " << p << ": optimizer is worse than the ILP by more than the reported gap" << std::endl;
+				numFailed++;
+			}
+		}
+
+		std::cout << numFailed << " of " << numProblems << " problems differ" << std::endl;
+
+		return (numFailed == 0 ? 0 : 1);
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+}
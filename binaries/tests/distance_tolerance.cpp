@@ -0,0 +1,290 @@
+/**
+ * Compares the cells and alternative labels found by the 
+ * DistanceToleranceFunction with a single thread to the ones found with 
+ * several threads, and the ones found in the whole volume to the ones found 
+ * chunk by chunk, on the same random label volumes. All have to be the same.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <imageprocessing/ImageStack.h>
+#include <sopnet/evaluation/DistanceToleranceFunction.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <vigra/multi_labeling.hxx>
+
+util::ProgramOption optionWidth(
+		util::_long_name        = "width",
+		util::_description_text = "The width of the random label volumes.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionHeight(
+		util::_long_name        = "height",
+		util::_description_text = "The height of the random label volumes.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionDepth(
+		util::_long_name        = "depth",
+		util::_description_text = "The depth of the random label volumes.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionNumRegions(
+		util::_long_name        = "numRegions",
+		util::_description_text = "The number of regions in each random label volume.",
+		util::_default_value    = 50);
+
+util::ProgramOption optionDistanceThreshold(
+		util::_long_name        = "distanceThreshold",
+		util::_description_text = "The distance threshold of the tolerance function in nm.",
+		util::_default_value    = 50);
+
+util::ProgramOption optionNumThreads(
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to compare against a single thread. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionExtractionChunkWidth(
+		util::_long_name        = "extractionChunkWidth",
+		util::_description_text = "The width of the chunks for the chunked extraction.",
+		util::_default_value    = 32);
+
+util::ProgramOption optionExtractionChunkHeight(
+		util::_long_name        = "extractionChunkHeight",
+		util::_description_text = "The height of the chunks for the chunked extraction.",
+		util::_default_value    = 32);
+
+util::ProgramOption optionExtractionChunkDepth(
+		util::_long_name        = "extractionChunkDepth",
+		util::_description_text = "The depth of the chunks for the chunked extraction.",
+		util::_default_value    = 4);
+
+util::ProgramOption optionNumVolumes(
+		util::_long_name        = "numVolumes",
+		util::_description_text = "The number of random label volumes to compare.",
+		util::_default_value    = 5);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed for the random label volumes.",
+		util::_default_value    = 42);
+
+typedef LocalToleranceFunction::cell_t cell_t;
+
+/**
+ * A summary of a cell, independent of the order in which cells and their 
+ * locations were found.
+ */
+struct CellSummary {
+
+	unsigned int    size;
+	float           gtLabel;
+	float           recLabel;
+	std::set<float> alternativeLabels;
+
+	bool operator==(const CellSummary& other) const {
+
+		return
+				size              == other.size &&
+				gtLabel           == other.gtLabel &&
+				recLabel          == other.recLabel &&
+				alternativeLabels == other.alternativeLabels;
+	}
+};
+
+typedef std::map<cell_t::Location, CellSummary> CellSummaries;
+
+/**
+ * Create a random label volume of Voronoi regions around random seed points.
+ */
+boost::shared_ptr<ImageStack> createLabels(unsigned int width, unsigned int height, unsigned int depth, unsigned int numRegions) {
+
+	std::vector<int> seedX(numRegions), seedY(numRegions), seedZ(numRegions);
+	for (unsigned int i = 0; i < numRegions; i++) {
+
+		seedX[i] = rand()%width;
+		seedY[i] = rand()%height;
+		seedZ[i] = rand()%depth;
+	}
+
+	boost::shared_ptr<ImageStack> labels = boost::make_shared<ImageStack>();
+
+	for (unsigned int z = 0; z < depth; z++) {
+
+		boost::shared_ptr<Image> section = boost::make_shared<Image>(width, height);
+
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++) {
+
+				// sections are ten times thicker than pixels are wide
+				int closest = 0;
+				int minDistance2 = -1;
+				for (unsigned int i = 0; i < numRegions; i++) {
+
+					int dx = seedX[i] - static_cast<int>(x);
+					int dy = seedY[i] - static_cast<int>(y);
+					int dz = 10*(seedZ[i] - static_cast<int>(z));
+
+					int distance2 = dx*dx + dy*dy + dz*dz;
+
+					if (minDistance2 < 0 || distance2 < minDistance2) {
+
+						minDistance2 = distance2;
+						closest = i;
+					}
+				}
+
+				(*section)(x, y) = closest + 1;
+			}
+
+		labels->add(section);
+	}
+
+	return labels;
+}
+
+/**
+ * Extract the cells of the whole volume the same way TolerantEditDistance 
+ * does.
+ */
+void extractCells(DistanceToleranceFunction& toleranceFunction, const ImageStack& recLabels, const ImageStack& gtLabels) {
+
+	unsigned int width  = gtLabels.width();
+	unsigned int height = gtLabels.height();
+	unsigned int depth  = gtLabels.size();
+
+	vigra::MultiArray<3, std::pair<float, float> > gtAndRec(vigra::Shape3(width, height, depth));
+	vigra::MultiArray<3, unsigned int>             cellIds(vigra::Shape3(width, height, depth));
+
+	for (unsigned int z = 0; z < depth; z++)
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++)
+				gtAndRec(x, y, z) = std::make_pair((*gtLabels[z])(x, y), (*recLabels[z])(x, y));
+
+	cellIds = 0;
+	unsigned int numCells = vigra::labelMultiArray(gtAndRec, cellIds);
+
+	toleranceFunction.clear();
+	toleranceFunction.extractCells(numCells, cellIds, recLabels, gtLabels);
+}
+
+/**
+ * Summarize the extracted cells by their first location in scan-line order.
+ */
+CellSummaries summarizeCells(LocalToleranceFunction& toleranceFunction) {
+
+	CellSummaries summaries;
+
+	foreach (const cell_t& cell, *toleranceFunction.getCells()) {
+
+		if (cell.size() == 0)
+			continue;
+
+		cell_t::Location first = *cell.begin();
+		foreach (const cell_t::Location& location, cell)
+			if (location < first)
+				first = location;
+
+		CellSummary summary;
+		summary.size              = cell.size();
+		summary.gtLabel           = cell.getGroundTruthLabel();
+		summary.recLabel          = cell.getReconstructionLabel();
+		summary.alternativeLabels = cell.getAlternativeLabels();
+
+		summaries.insert(std::make_pair(first, summary));
+	}
+
+	return summaries;
+}
+
+/**
+ * Count the cells that are not the same in both summaries.
+ */
+unsigned int getNumDifferent(const CellSummaries& a, const CellSummaries& b) {
+
+	unsigned int numDifferent = 0;
+
+	foreach (const CellSummaries::value_type& cell, a) {
+
+		CellSummaries::const_iterator i = b.find(cell.first);
+		if (i == b.end() || !(i->second == cell.second))
+			numDifferent++;
+	}
+
+	foreach (const CellSummaries::value_type& cell, b)
+		if (a.find(cell.first) == a.end())
+			numDifferent++;
+
+	return numDifferent;
+}
+
+int main(int argc, char** argv) {
+
+	try {
+
+		// init command line parser
+		util::ProgramOptions::init(argc, argv);
+
+		// init logger
+		logger::LogManager::init();
+
+		srand(optionSeed.as<unsigned int>());
+
+		unsigned int width      = optionWidth;
+		unsigned int height     = optionHeight;
+		unsigned int depth      = optionDepth;
+		unsigned int numRegions = optionNumRegions;
+		unsigned int numVolumes = optionNumVolumes;
+		unsigned int numFailed  = 0;
+
+		DistanceToleranceFunction singleThreaded(optionDistanceThreshold.as<float>(), false, 0.0, 1);
+		DistanceToleranceFunction multiThreaded(optionDistanceThreshold.as<float>(), false, 0.0, optionNumThreads.as<unsigned int>());
+		DistanceToleranceFunction chunked(optionDistanceThreshold.as<float>(), false, 0.0, optionNumThreads.as<unsigned int>());
+
+		for (unsigned int v = 0; v < numVolumes; v++) {
+
+			boost::shared_ptr<ImageStack> recLabels = createLabels(width, height, depth, numRegions);
+			boost::shared_ptr<ImageStack> gtLabels  = createLabels(width, height, depth, numRegions);
+
+			extractCells(singleThreaded, *recLabels, *gtLabels);
+			extractCells(multiThreaded, *recLabels, *gtLabels);
+
+			chunked.clear();
+			chunked.extractCells(
+					*recLabels,
+					*gtLabels,
+					optionExtractionChunkWidth.as<unsigned int>(),
+					optionExtractionChunkHeight.as<unsigned int>(),
+					optionExtractionChunkDepth.as<unsigned int>());
+
+			CellSummaries singleThreadedCells = summarizeCells(singleThreaded);
+			CellSummaries multiThreadedCells  = summarizeCells(multiThreaded);
+			CellSummaries chunkedCells        = summarizeCells(chunked);
+
+			unsigned int numDifferentThreaded = getNumDifferent(singleThreadedCells, multiThreadedCells);
+			unsigned int numDifferentChunked  = getNumDifferent(singleThreadedCells, chunkedCells);
+
+			std::cout
+					<< "volume " << v << ": " << singleThreadedCells.size()
+					<< " cells, " << numDifferentThreaded << " differ with several threads, "
+					<< numDifferentChunked << " differ in chunks" << std::endl;
+
+			if (numDifferentThreaded > 0 || numDifferentChunked > 0)
+				numFailed++;
+		}
+
+		std::cout << numFailed << " of " << numVolumes << " volumes differ" << std::endl;
+
+		return (numFailed == 0 ? 0 : 1);
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+}
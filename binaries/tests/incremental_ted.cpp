@@ -0,0 +1,318 @@
+/**
+ * Compares the errors found by the IncrementalTolerantEditDistance with the
+ * ones of a TolerantEditDistance computed from scratch, on a sequence of
+ * random reconstructions that differ by local relabelings and renumberings
+ * of all labels. The numbers of splits, merges, false positives, and false
+ * negatives have to be the same after each update.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <imageprocessing/ImageStack.h>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <sopnet/evaluation/IncrementalTolerantEditDistance.h>
+#include <sopnet/evaluation/TolerantEditDistance.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+
+util::ProgramOption optionWidth(
+		util::_long_name        = "width",
+		util::_description_text = "The width of the random label volumes.",
+		util::_default_value    = 64);
+
+util::ProgramOption optionHeight(
+		util::_long_name        = "height",
+		util::_description_text = "The height of the random label volumes.",
+		util::_default_value    = 64);
+
+util::ProgramOption optionDepth(
+		util::_long_name        = "depth",
+		util::_description_text = "The depth of the random label volumes.",
+		util::_default_value    = 8);
+
+util::ProgramOption optionNumRegions(
+		util::_long_name        = "numRegions",
+		util::_description_text = "The number of regions in the random ground truth and the first reconstruction.",
+		util::_default_value    = 20);
+
+util::ProgramOption optionUpdateChunkWidth(
+		util::_long_name        = "updateChunkWidth",
+		util::_description_text = "The width of the chunks of the incremental tolerant edit distance.",
+		util::_default_value    = 16);
+
+util::ProgramOption optionUpdateChunkHeight(
+		util::_long_name        = "updateChunkHeight",
+		util::_description_text = "The height of the chunks of the incremental tolerant edit distance.",
+		util::_default_value    = 16);
+
+util::ProgramOption optionUpdateChunkDepth(
+		util::_long_name        = "updateChunkDepth",
+		util::_description_text = "The depth of the chunks of the incremental tolerant edit distance.",
+		util::_default_value    = 4);
+
+util::ProgramOption optionMaxChangeSize(
+		util::_long_name        = "maxChangeSize",
+		util::_description_text = "The maximal width and height of the regions that are relabeled in each update.",
+		util::_default_value    = 12);
+
+util::ProgramOption optionNumUpdates(
+		util::_long_name        = "numUpdates",
+		util::_description_text = "The number of random updates to compare.",
+		util::_default_value    = 20);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed for the random label volumes and updates.",
+		util::_default_value    = 42);
+
+typedef IncrementalTolerantEditDistance::BoundingBox BoundingBox;
+
+/**
+ * Create a random label volume of Voronoi regions around random seed points.
+ */
+boost::shared_ptr<ImageStack> createLabels(unsigned int width, unsigned int height, unsigned int depth, unsigned int numRegions) {
+
+	std::vector<int> seedX(numRegions), seedY(numRegions), seedZ(numRegions);
+	for (unsigned int i = 0; i < numRegions; i++) {
+
+		seedX[i] = rand()%width;
+		seedY[i] = rand()%height;
+		seedZ[i] = rand()%depth;
+	}
+
+	boost::shared_ptr<ImageStack> labels = boost::make_shared<ImageStack>();
+
+	for (unsigned int z = 0; z < depth; z++) {
+
+		boost::shared_ptr<Image> section = boost::make_shared<Image>(width, height);
+
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++) {
+
+				// sections are ten times thicker than pixels are wide
+				int closest = 0;
+				int minDistance2 = -1;
+				for (unsigned int i = 0; i < numRegions; i++) {
+
+					int dx = seedX[i] - static_cast<int>(x);
+					int dy = seedY[i] - static_cast<int>(y);
+					int dz = 10*(seedZ[i] - static_cast<int>(z));
+
+					int distance2 = dx*dx + dy*dy + dz*dz;
+
+					if (minDistance2 < 0 || distance2 < minDistance2) {
+
+						minDistance2 = distance2;
+						closest = i;
+					}
+				}
+
+				(*section)(x, y) = closest + 1;
+			}
+
+		labels->add(section);
+	}
+
+	return labels;
+}
+
+/**
+ * Create a copy of a reconstruction in which a random box is set to one
+ * label, either one of the labels in the box or a new one. Afterwards, all
+ * labels are renumbered randomly. The region that contains all locations of
+ * the labels that changed is stored in changedRegion.
+ */
+boost::shared_ptr<ImageStack> changeLabels(const ImageStack& reconstruction, unsigned int maxChangeSize, BoundingBox& changedRegion) {
+
+	unsigned int width  = reconstruction.width();
+	unsigned int height = reconstruction.height();
+	unsigned int depth  = reconstruction.size();
+
+	// the box to relabel
+
+	unsigned int sizeX = 1 + rand()%std::min(maxChangeSize, width);
+	unsigned int sizeY = 1 + rand()%std::min(maxChangeSize, height);
+	unsigned int sizeZ = 1 + rand()%depth;
+
+	unsigned int x0 = rand()%(width  - sizeX + 1);
+	unsigned int y0 = rand()%(height - sizeY + 1);
+	unsigned int z0 = rand()%(depth  - sizeZ + 1);
+
+	// all current labels, and the ones in the box
+
+	std::set<float> labels;
+	std::set<float> changedLabels;
+	float           maxLabel = 0;
+
+	for (unsigned int z = 0; z < depth; z++)
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++) {
+
+				float label = (*reconstruction[z])(x, y);
+
+				labels.insert(label);
+				maxLabel = std::max(maxLabel, label);
+
+				if (x >= x0 && x < x0 + sizeX && y >= y0 && y < y0 + sizeY && z >= z0 && z < z0 + sizeZ)
+					changedLabels.insert(label);
+			}
+
+	// merge the box into one of its labels or split it off as a new one
+
+	float newLabel;
+	if (rand()%2) {
+
+		std::set<float>::const_iterator i = changedLabels.begin();
+		std::advance(i, rand()%changedLabels.size());
+		newLabel = *i;
+
+	} else {
+
+		newLabel = maxLabel + 1;
+		labels.insert(newLabel);
+	}
+
+	changedLabels.insert(newLabel);
+
+	// a random one-to-one renumbering of all labels
+
+	std::vector<float> numbers(labels.size());
+	for (unsigned int i = 0; i < numbers.size(); i++)
+		numbers[i] = i + 1;
+	std::random_shuffle(numbers.begin(), numbers.end());
+
+	std::map<float, float> renumbering;
+	unsigned int i = 0;
+	foreach (float label, labels)
+		renumbering[label] = numbers[i++];
+
+	boost::shared_ptr<ImageStack> changed = boost::make_shared<ImageStack>();
+
+	changedRegion = BoundingBox();
+
+	for (unsigned int z = 0; z < depth; z++) {
+
+		boost::shared_ptr<Image> section = boost::make_shared<Image>(width, height);
+
+		for (unsigned int y = 0; y < height; y++)
+			for (unsigned int x = 0; x < width; x++) {
+
+				float label = (*reconstruction[z])(x, y);
+
+				if (changedLabels.count(label))
+					changedRegion.add(x, y, z);
+
+				if (x >= x0 && x < x0 + sizeX && y >= y0 && y < y0 + sizeY && z >= z0 && z < z0 + sizeZ)
+					label = newLabel;
+
+				(*section)(x, y) = renumbering[label];
+			}
+
+		changed->add(section);
+	}
+
+	return changed;
+}
+
+/**
+ * Count the error numbers that are not the same.
+ */
+unsigned int getNumDifferent(TolerantEditDistanceErrors& a, TolerantEditDistanceErrors& b) {
+
+	return
+			(a.getNumSplits()         != b.getNumSplits()) +
+			(a.getNumMerges()         != b.getNumMerges()) +
+			(a.getNumFalsePositives() != b.getNumFalsePositives()) +
+			(a.getNumFalseNegatives() != b.getNumFalseNegatives());
+}
+
+int main(int argc, char** argv) {
+
+	try {
+
+		// init command line parser
+		util::ProgramOptions::init(argc, argv);
+
+		// init logger
+		logger::LogManager::init();
+
+		srand(optionSeed.as<unsigned int>());
+
+		unsigned int width      = optionWidth;
+		unsigned int height     = optionHeight;
+		unsigned int depth      = optionDepth;
+		unsigned int numRegions = optionNumRegions;
+		unsigned int numUpdates = optionNumUpdates;
+		unsigned int numFailed  = 0;
+
+		boost::shared_ptr<ImageStack> groundTruth    = createLabels(width, height, depth, numRegions);
+		boost::shared_ptr<ImageStack> reconstruction = createLabels(width, height, depth, numRegions);
+
+		IncrementalTolerantEditDistance incremental(
+				optionUpdateChunkWidth.as<unsigned int>(),
+				optionUpdateChunkHeight.as<unsigned int>(),
+				optionUpdateChunkDepth.as<unsigned int>());
+
+		incremental.initialize(*groundTruth, *reconstruction);
+
+		for (unsigned int u = 0; u <= numUpdates; u++) {
+
+			// the first comparison is the one after initialize()
+			bool withRegions = false;
+
+			if (u > 0) {
+
+				BoundingBox changedRegion;
+				reconstruction = changeLabels(*reconstruction, optionMaxChangeSize, changedRegion);
+
+				// alternate between updates with and without changed regions
+				withRegions = (u%2 == 0);
+
+				if (withRegions)
+					incremental.update(*reconstruction, std::vector<BoundingBox>(1, changedRegion));
+				else
+					incremental.update(*reconstruction);
+			}
+
+			pipeline::Process<TolerantEditDistance> ted;
+
+			ted->setInput("ground truth", groundTruth);
+			ted->setInput("reconstruction", reconstruction);
+
+			pipeline::Value<TolerantEditDistanceErrors> errors = ted->getOutput("errors");
+
+			TolerantEditDistanceErrors& incrementalErrors = *incremental.getErrors();
+
+			unsigned int numDifferent = getNumDifferent(*errors, incrementalErrors);
+
+			std::cout
+					<< "update " << u << (withRegions ? " with changed regions" : "") << ": "
+					<< incremental.getNumUpdatedCells() << " cells rebuilt, "
+					<< "splits " << errors->getNumSplits() << "/" << incrementalErrors.getNumSplits() << ", "
+					<< "merges " << errors->getNumMerges() << "/" << incrementalErrors.getNumMerges() << ", "
+					<< "FP " << errors->getNumFalsePositives() << "/" << incrementalErrors.getNumFalsePositives() << ", "
+					<< "FN " << errors->getNumFalseNegatives() << "/" << incrementalErrors.getNumFalseNegatives()
+					<< (numDifferent > 0 ? " (differ)" : "") << std::endl;
+
+			if (numDifferent > 0)
+				numFailed++;
+		}
+
+		std::cout << numFailed << " of " << (numUpdates + 1) << " updates differ" << std::endl;
+
+		return (numFailed == 0 ? 0 : 1);
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+}
@@ -0,0 +1,195 @@
+/**
+ * Compares the solution of a binary linear program solved directly with the 
+ * solution obtained via Presolver, LinearSolver, and Postsolver. Both have to 
+ * have the same objective value, and the postsolved solution has to satisfy 
+ * all original constraints.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <inference/LinearSolver.h>
+#include <inference/Postsolver.h>
+#include <inference/Presolver.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+
+util::ProgramOption optionNumVariables(
+		util::_long_name        = "numVariables",
+		util::_description_text = "The number of variables of the random problems.",
+		util::_default_value    = 200);
+
+util::ProgramOption optionNumProblems(
+		util::_long_name        = "numProblems",
+		util::_description_text = "The number of random problems to compare.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionSeed(
+		util::_long_name        = "seed",
+		util::_description_text = "The seed for the random problems.",
+		util::_default_value    = 42);
+
+double getValue(const LinearObjective& objective, const Solution& solution) {
+
+	double value = objective.getConstant();
+
+	for (unsigned int i = 0; i < objective.size(); i++)
+		value += objective.getCoefficients()[i]*solution[i];
+
+	return value;
+}
+
+unsigned int getNumViolated(const LinearConstraints& constraints, const Solution& solution) {
+
+	unsigned int numViolated = 0;
+
+	foreach (const LinearConstraint& constraint, constraints) {
+
+		double activity = 0;
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients())
+			activity += coef*solution[varNum];
+
+		if ((constraint.getRelation() == LessEqual    && activity > constraint.getValue() + 1e-6) ||
+		    (constraint.getRelation() == GreaterEqual && activity < constraint.getValue() - 1e-6) ||
+		    (constraint.getRelation() == Equal        && std::abs(activity - constraint.getValue()) > 1e-6))
+			numViolated++;
+	}
+
+	return numViolated;
+}
+
+/**
+ * Create a random problem that resembles the structure of sopnet problems: 
+ * conflict sets (at most one of a few variables) and consistency constraints 
+ * (two variables have to be picked together).
+ */
+void createProblem(unsigned int numVariables, LinearObjective& objective, LinearConstraints& constraints) {
+
+	objective = LinearObjective(numVariables);
+	constraints.clear();
+
+	for (unsigned int i = 0; i < numVariables; i++)
+		objective.setCoefficient(i, 2.0*rand()/RAND_MAX - 1.0);
+
+	for (unsigned int i = 0; i < numVariables/2; i++) {
+
+		LinearConstraint conflict;
+
+		unsigned int size = 2 + rand()%3;
+		for (unsigned int j = 0; j < size; j++)
+			conflict.setCoefficient(rand()%numVariables, 1.0);
+
+		conflict.setRelation(LessEqual);
+		conflict.setValue(1.0);
+
+		constraints.add(conflict);
+	}
+
+	for (unsigned int i = 0; i < numVariables/4; i++) {
+
+		unsigned int a = rand()%numVariables;
+		unsigned int b = rand()%numVariables;
+
+		if (a == b)
+			continue;
+
+		LinearConstraint consistency;
+
+		consistency.setCoefficient(a,  1.0);
+		consistency.setCoefficient(b, -1.0);
+		consistency.setRelation(Equal);
+		consistency.setValue(0.0);
+
+		constraints.add(consistency);
+	}
+
+	constraints.registerVariables(numVariables);
+}
+
+int main(int argc, char** argv) {
+
+	try {
+
+		// init command line parser
+		util::ProgramOptions::init(argc, argv);
+
+		// init logger
+		logger::LogManager::init();
+
+		srand(optionSeed.as<unsigned int>());
+
+		unsigned int numProblems = optionNumProblems;
+		unsigned int numFailed   = 0;
+
+		for (unsigned int p = 0; p < numProblems; p++) {
+
+			boost::shared_ptr<LinearObjective>   objective   = boost::make_shared<LinearObjective>();
+			boost::shared_ptr<LinearConstraints> constraints = boost::make_shared<LinearConstraints>();
+
+			createProblem(optionNumVariables, *objective, *constraints);
+
+			// solve directly
+			pipeline::Process<LinearSolver> solver;
+
+			solver->setInput("objective", objective);
+			solver->setInput("linear constraints", constraints);
+			solver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+
+			pipeline::Value<Solution> solution = solver->getOutput();
+
+			// solve via presolve
+			pipeline::Process<Presolver>    presolver;
+			pipeline::Process<LinearSolver> reducedSolver;
+			pipeline::Process<Postsolver>   postsolver;
+
+			presolver->setInput("objective", objective);
+			presolver->setInput("linear constraints", constraints);
+
+			reducedSolver->setInput("objective", presolver->getOutput("objective"));
+			reducedSolver->setInput("linear constraints", presolver->getOutput("linear constraints"));
+			reducedSolver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+
+			postsolver->setInput("solution", reducedSolver->getOutput("solution"));
+			postsolver->setInput("postsolve map", presolver->getOutput("postsolve map"));
+
+			pipeline::Value<Solution> postsolved = postsolver->getOutput("solution");
+
+			double directValue    = getValue(*objective, *solution);
+			double presolvedValue = getValue(*objective, *postsolved);
+
+			unsigned int violated = getNumViolated(*constraints, *postsolved);
+
+			std::cout
+					<< "problem " << p << ": direct " << directValue
+					<< ", presolved " << presolvedValue
+					<< ", violated constraints " << violated << std::endl;
+
+			if (postsolved->size() != solution->size()) {
+
+				std::cerr << "problem " << p << ": postsolved solution has " << postsolved->size() << " instead of " << solution->size() << " values" << std::endl;
+				numFailed++;
+
+			} else if (violated > 0 || std::abs(directValue - presolvedValue) > 1e-4*std::max(1.0, std::abs(directValue))) {
+
+				std::cerr << "problem " << p << ": presolved solution differs" << std::endl;
+				numFailed++;
+			}
+		}
+
+		std::cout << numFailed << " of " << numProblems << " problems differ" << std::endl;
+
+		return (numFailed == 0 ? 0 : 1);
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+		return 1;
+	}
+}
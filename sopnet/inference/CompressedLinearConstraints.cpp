@@ -0,0 +1,117 @@
+#include <util/foreach.h>
+#include "CompressedLinearConstraints.h"
+
+CompressedLinearConstraints::CompressedLinearConstraints(size_t numConstraints, size_t numCoefficients) {
+
+	reserve(numConstraints, numCoefficients);
+
+	_rowStarts.push_back(0);
+}
+
+CompressedLinearConstraints::CompressedLinearConstraints(const LinearConstraints& linearConstraints) {
+
+	_rowStarts.push_back(0);
+
+	addAll(linearConstraints);
+}
+
+void
+CompressedLinearConstraints::reserve(size_t numConstraints, size_t numCoefficients) {
+
+	_rowStarts.reserve(numConstraints + 1);
+	_relations.reserve(numConstraints);
+	_values.reserve(numConstraints);
+	_varNums.reserve(numCoefficients);
+	_coefs.reserve(numCoefficients);
+}
+
+void
+CompressedLinearConstraints::setCoefficient(unsigned int varNum, double coef) {
+
+	// constraints are short, a linear search in the current row is cheap
+	for (unsigned int i = _rowStarts.back(); i < _varNums.size(); i++) {
+
+		if (_varNums[i] != varNum)
+			continue;
+
+		if (coef == 0) {
+
+			_varNums.erase(_varNums.begin() + i);
+			_coefs.erase(_coefs.begin() + i);
+
+		} else {
+
+			_coefs[i] = coef;
+		}
+
+		return;
+	}
+
+	if (coef == 0)
+		return;
+
+	_varNums.push_back(varNum);
+	_coefs.push_back(coef);
+}
+
+void
+CompressedLinearConstraints::finishConstraint(Relation relation, double value) {
+
+	_relations.push_back(relation);
+	_values.push_back(value);
+	_rowStarts.push_back(_varNums.size());
+}
+
+void
+CompressedLinearConstraints::add(const LinearConstraint& linearConstraint) {
+
+	// coefficients of a LinearConstraint are unique and non-zero already
+	unsigned int varNum;
+	double coef;
+	foreach (boost::tie(varNum, coef), linearConstraint.getCoefficients()) {
+
+		_varNums.push_back(varNum);
+		_coefs.push_back(coef);
+	}
+
+	finishConstraint(linearConstraint.getRelation(), linearConstraint.getValue());
+}
+
+void
+CompressedLinearConstraints::addAll(const LinearConstraints& linearConstraints) {
+
+	size_t numCoefficients = 0;
+	foreach (const LinearConstraint& linearConstraint, linearConstraints)
+		numCoefficients += linearConstraint.getCoefficients().size();
+
+	reserve(size() + linearConstraints.size(), _varNums.size() + numCoefficients);
+
+	foreach (const LinearConstraint& linearConstraint, linearConstraints)
+		add(linearConstraint);
+}
+
+void
+CompressedLinearConstraints::clear() {
+
+	_rowStarts.clear();
+	_varNums.clear();
+	_coefs.clear();
+	_relations.clear();
+	_values.clear();
+
+	_rowStarts.push_back(0);
+}
+
+LinearConstraint
+CompressedLinearConstraints::getConstraint(unsigned int i) const {
+
+	LinearConstraint constraint;
+
+	for (unsigned int j = _rowStarts[i]; j < _rowStarts[i+1]; j++)
+		constraint.setCoefficient(_varNums[j], _coefs[j]);
+
+	constraint.setRelation(_relations[i]);
+	constraint.setValue(_values[i]);
+
+	return constraint;
+}
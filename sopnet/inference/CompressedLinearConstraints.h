@@ -0,0 +1,121 @@
+#ifndef INFERENCE_COMPRESSED_LINEAR_CONSTRAINTS_H__
+#define INFERENCE_COMPRESSED_LINEAR_CONSTRAINTS_H__
+
+#include <vector>
+
+#include <pipeline/all.h>
+#include "LinearConstraint.h"
+#include "LinearConstraints.h"
+#include "Relation.h"
+
+/**
+ * A set of linear constraints in compressed sparse row (CSR) format. The 
+ * coefficients of constraint i are stored at the positions 
+ * [getRowStarts()[i], getRowStarts()[i+1]) of getVariableIds() and 
+ * getCoefficients(). Relation and value of constraint i are 
+ * getRelations()[i] and getValues()[i].
+ *
+ * Constraints are created row by row with the builder interface:
+ *
+ *   constraints.setCoefficient(3,  1.0);
+ *   constraints.setCoefficient(7, -1.0);
+ *   constraints.finishConstraint(Equal, 0);
+ *
+ * This avoids the per-coefficient allocations of LinearConstraint and allows 
+ * backends to hand the arrays to the solver in one call.
+ */
+class CompressedLinearConstraints : public pipeline::Data {
+
+public:
+
+	/**
+	 * Create an empty set of compressed linear constraints and reserve memory 
+	 * for the given number of constraints and coefficients.
+	 */
+	CompressedLinearConstraints(size_t numConstraints = 0, size_t numCoefficients = 0);
+
+	/**
+	 * Create a compressed copy of the given linear constraints.
+	 */
+	explicit CompressedLinearConstraints(const LinearConstraints& linearConstraints);
+
+	/**
+	 * Reserve memory for the given number of constraints and coefficients.
+	 */
+	void reserve(size_t numConstraints, size_t numCoefficients);
+
+	/**
+	 * Set a coefficient of the constraint that is currently build. Setting a 
+	 * coefficient to zero removes it.
+	 */
+	void setCoefficient(unsigned int varNum, double coef);
+
+	/**
+	 * Finish the constraint that is currently build and start a new one.
+	 */
+	void finishConstraint(Relation relation, double value);
+
+	/**
+	 * Add a linear constraint.
+	 */
+	void add(const LinearConstraint& linearConstraint);
+
+	/**
+	 * Add a set of linear constraints.
+	 */
+	void addAll(const LinearConstraints& linearConstraints);
+
+	/**
+	 * Remove all constraints, including the one that is currently build.
+	 */
+	void clear();
+
+	/**
+	 * @return The number of finished constraints.
+	 */
+	unsigned int size() const { return _relations.size(); }
+
+	/**
+	 * @return The number of coefficients in all finished constraints.
+	 */
+	unsigned int getNumCoefficients() const { return _rowStarts.back(); }
+
+	/**
+	 * @return The number of coefficients of constraint i.
+	 */
+	unsigned int getNumCoefficients(unsigned int i) const { return _rowStarts[i+1] - _rowStarts[i]; }
+
+	/**
+	 * Get constraint i as a LinearConstraint.
+	 */
+	LinearConstraint getConstraint(unsigned int i) const;
+
+	/**
+	 * Get the offsets of the constraints in the coefficient arrays. Contains 
+	 * size() + 1 elements, the last one is the total number of coefficients.
+	 */
+	const std::vector<unsigned int>& getRowStarts() const { return _rowStarts; }
+
+	const std::vector<unsigned int>& getVariableIds() const { return _varNums; }
+
+	const std::vector<double>& getCoefficients() const { return _coefs; }
+
+	const std::vector<Relation>& getRelations() const { return _relations; }
+
+	const std::vector<double>& getValues() const { return _values; }
+
+private:
+
+	std::vector<unsigned int> _rowStarts;
+
+	std::vector<unsigned int> _varNums;
+
+	std::vector<double>       _coefs;
+
+	std::vector<Relation>     _relations;
+
+	std::vector<double>       _values;
+};
+
+#endif // INFERENCE_COMPRESSED_LINEAR_CONSTRAINTS_H__
+
@@ -1,4 +1,10 @@
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <util/ProgramOptions.h>
 #include "DefaultFactory.h"
+#include "PortfolioBackend.h"
 
 #include <config.h>
 
@@ -10,9 +16,39 @@
 #include "CplexBackend.h"
 #endif
 
+util::ProgramOption optionUsePortfolio(
+		util::_module           = "inference.portfolio",
+		util::_long_name        = "usePortfolio",
+		util::_description_text = "Solve linear programs with a portfolio of concurrently running solver configurations. The first one to find the optimal solution wins.");
+
+util::ProgramOption optionPortfolioMIPFocus(
+		util::_module           = "inference.portfolio",
+		util::_long_name        = "mipFocus",
+		util::_description_text = "Comma separated list of Gurobi MIP focus values. One solver is started for each value.",
+		util::_default_value    = "0,1,2,3");
+
+util::ProgramOption optionPortfolioNumThreads(
+		util::_module           = "inference.portfolio",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to be used by each solver in the portfolio.",
+		util::_default_value    = 1);
+
+util::ProgramOption optionPortfolioTimeLimit(
+		util::_module           = "inference.portfolio",
+		util::_long_name        = "timeLimit",
+		util::_description_text = "Time limit in seconds for the portfolio. If no solver found the optimal solution within this time, the best solution found so far is used. The default (0) means no limit.",
+		util::_default_value    = 0);
+
+#ifdef HAVE_GUROBI
+extern util::ProgramOption optionGurobiMIPGap;
+#endif
+
 LinearSolverBackend*
 DefaultFactory::createLinearSolverBackend() const {
 
+	if (optionUsePortfolio)
+		return createPortfolioBackend();
+
 // by default, create a gurobi backend
 #ifdef HAVE_GUROBI
 
@@ -32,6 +68,34 @@ DefaultFactory::createLinearSolverBackend() const {
 	BOOST_THROW_EXCEPTION(NoSolverException() << error_message("No linear solver available."));
 }
 
+LinearSolverBackend*
+DefaultFactory::createPortfolioBackend() const {
+
+#ifdef HAVE_GUROBI
+
+	PortfolioBackend* portfolio = new PortfolioBackend(optionPortfolioTimeLimit.as<double>());
+
+	double       mipGap     = optionGurobiMIPGap;
+	unsigned int numThreads = optionPortfolioNumThreads;
+
+	std::stringstream focusList(optionPortfolioMIPFocus.as<std::string>());
+	std::string focus;
+	while (std::getline(focusList, focus, ',')) {
+
+		unsigned int mipFocus = boost::lexical_cast<unsigned int>(focus);
+
+		portfolio->addBackend(
+				new GurobiBackend(mipGap, mipFocus, numThreads),
+				"gurobi (mipFocus " + focus + ")");
+	}
+
+	return portfolio;
+
+#endif
+
+	BOOST_THROW_EXCEPTION(NoSolverException() << error_message("No linear solver available for the portfolio."));
+}
+
 QuadraticSolverBackend*
 DefaultFactory::createQuadraticSolverBackend() const {
 
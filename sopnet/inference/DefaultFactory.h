@@ -16,6 +16,10 @@ public:
 	LinearSolverBackend* createLinearSolverBackend() const;
 
 	QuadraticSolverBackend* createQuadraticSolverBackend() const;
+
+private:
+
+	LinearSolverBackend* createPortfolioBackend() const;
 };
 
 #endif // INFERENCE_DEFAULT_FACTORY_H__
@@ -2,8 +2,12 @@
 
 #ifdef HAVE_GUROBI
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
+#include <boost/scoped_array.hpp>
+
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include "GurobiBackend.h"
@@ -33,7 +37,28 @@ util::ProgramOption optionGurobiNumThreads(
 
 GurobiBackend::GurobiBackend() :
 	_variables(0),
-	_model(_env) {
+	_model(_env),
+	_mipGap(optionGurobiMIPGap),
+	_mipFocus(optionGurobiMIPFocus),
+	_numThreads(optionGurobiNumThreads),
+	_timeLimit(0),
+	_sense(Minimize),
+	_observer(0),
+	_interrupted(false),
+	_callback(*this) {
+}
+
+GurobiBackend::GurobiBackend(double mipGap, unsigned int mipFocus, unsigned int numThreads) :
+	_variables(0),
+	_model(_env),
+	_mipGap(mipGap),
+	_mipFocus(mipFocus),
+	_numThreads(numThreads),
+	_timeLimit(0),
+	_sense(Minimize),
+	_observer(0),
+	_interrupted(false),
+	_callback(*this) {
 }
 
 GurobiBackend::~GurobiBackend() {
@@ -58,25 +83,14 @@ GurobiBackend::initialize(
 		VariableType                                defaultVariableType,
 		const std::map<unsigned int, VariableType>& specialVariableTypes) {
 
-	if (gurobilog.getLogLevel() >= Debug)
-		setVerbose(true);
-	else
-		setVerbose(false);
-
-	setMIPGap(optionGurobiMIPGap);
-
-	if (optionGurobiMIPFocus.as<unsigned int>() <= 3)
-		setMIPGap(optionGurobiMIPGap);
-	else
-		LOG_ERROR(gurobilog) << "Invalid value for MPI focus!" << std::endl;
-
-	setNumThreads(optionGurobiNumThreads);
+	setParameters();
 
 	_numVariables = numVariables;
 
 	// delete previous variables
 	if (_variables)
 		delete[] _variables;
+	_pinnedBounds.clear();
 
 	// add new variables to the model
 	if (defaultVariableType == Binary) {
@@ -125,6 +139,63 @@ GurobiBackend::initialize(
 	LOG_DEBUG(gurobilog) << "creating " << _numVariables << " ceofficients" << std::endl;
 }
 
+void
+GurobiBackend::initialize(
+		unsigned int                     numVariables,
+		const std::vector<VariableType>& variableTypes,
+		const std::vector<double>&       lowerBounds,
+		const std::vector<double>&       upperBounds) {
+
+	setParameters();
+
+	_numVariables = numVariables;
+
+	// delete previous variables
+	if (_variables)
+		delete[] _variables;
+	_pinnedBounds.clear();
+
+	LOG_DEBUG(gurobilog) << "creating " << _numVariables << " variables" << std::endl;
+
+	std::vector<char>   types(_numVariables);
+	std::vector<double> lbs(_numVariables);
+	std::vector<double> ubs(_numVariables);
+
+	for (unsigned int i = 0; i < _numVariables; i++) {
+
+		types[i] = (variableTypes[i] == Binary ? GRB_BINARY : (variableTypes[i] == Integer ? GRB_INTEGER : GRB_CONTINUOUS));
+		lbs[i]   = std::max(lowerBounds[i], -GRB_INFINITY);
+		ubs[i]   = std::min(upperBounds[i],  GRB_INFINITY);
+	}
+
+	if (_numVariables > 0)
+		_variables = _model.addVars(&lbs[0], &ubs[0], 0, &types[0], 0, _numVariables);
+	else
+		_variables = 0;
+
+	_model.update();
+}
+
+void
+GurobiBackend::setParameters() {
+
+	if (gurobilog.getLogLevel() >= Debug)
+		setVerbose(true);
+	else
+		setVerbose(false);
+
+	setMIPGap(_mipGap);
+
+	if (_mipFocus <= 3)
+		setMIPFocus(_mipFocus);
+	else
+		LOG_ERROR(gurobilog) << "Invalid value for MPI focus!" << std::endl;
+
+	setNumThreads(_numThreads);
+
+	_model.getEnv().set(GRB_DoubleParam_TimeLimit, _timeLimit > 0 ? _timeLimit : GRB_INFINITY);
+}
+
 void
 GurobiBackend::setObjective(const LinearObjective& objective) {
 
@@ -137,6 +208,7 @@ GurobiBackend::setObjective(const QuadraticObjective& objective) {
 	try {
 
 		// set sense of objective
+		_sense = objective.getSense();
 		if (objective.getSense() == Minimize)
 			_model.set(GRB_IntAttr_ModelSense, 1);
 		else
@@ -182,6 +254,12 @@ GurobiBackend::setObjective(const QuadraticObjective& objective) {
 void
 GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 
+	setConstraints(CompressedLinearConstraints(constraints));
+}
+
+void
+GurobiBackend::setConstraints(const CompressedLinearConstraints& constraints) {
+
 	// remove previous constraints
 	foreach (GRBConstr constraint, _constraints)
 		_model.remove(constraint);
@@ -189,40 +267,62 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 
 	_model.update();
 
-	// allocate memory for new constraints
-	_constraints.reserve(constraints.size());
+	addConstraints(constraints);
+}
+
+void
+GurobiBackend::addConstraints(const LinearConstraints& constraints) {
+
+	addConstraints(CompressedLinearConstraints(constraints));
+}
+
+void
+GurobiBackend::addConstraints(const CompressedLinearConstraints& constraints) {
 
 	try {
 
-		LOG_DEBUG(gurobilog) << "setting " << constraints.size() << " constraints" << std::endl;
+		unsigned int numConstraints = constraints.size();
+
+		LOG_DEBUG(gurobilog) << "adding " << numConstraints << " constraints" << std::endl;
+
+		if (numConstraints == 0)
+			return;
 
-		unsigned int j = 0;
-		foreach (const LinearConstraint& constraint, constraints) {
+		const std::vector<unsigned int>& rowStarts = constraints.getRowStarts();
+		const std::vector<unsigned int>& varNums   = constraints.getVariableIds();
+		const std::vector<double>&       coefs     = constraints.getCoefficients();
+		const std::vector<Relation>&     relations = constraints.getRelations();
+		const std::vector<double>&       values    = constraints.getValues();
 
-			if (j > 0)
-				if (j % 1000 == 0)
-					LOG_ALL(gurobilog) << "" << j << " constraints set so far" << std::endl;
+		// translate the CSR arrays into expressions, senses, and right hand 
+		// sides and add all constraints in one call
+		std::vector<GRBLinExpr> lhsExprs(numConstraints);
+		std::vector<char>       senses(numConstraints);
+		std::vector<GRBVar>     rowVariables;
 
-			// create the lhs expression
-			GRBLinExpr lhsExpr;
+		for (unsigned int j = 0; j < numConstraints; j++) {
 
-			// set the coefficients
-			typedef std::pair<unsigned int, double> pair_type;
-			foreach (const pair_type& pair, constraint.getCoefficients())
-				lhsExpr += pair.second*_variables[pair.first];
+			unsigned int begin = rowStarts[j];
+			unsigned int size  = rowStarts[j+1] - begin;
 
-			// add to the model
-			_constraints.push_back(
-					_model.addConstr(
-						lhsExpr,
-						(constraint.getRelation() == LessEqual ? GRB_LESS_EQUAL :
-								(constraint.getRelation() == GreaterEqual ? GRB_GREATER_EQUAL :
-										GRB_EQUAL)),
-						constraint.getValue()));
+			rowVariables.resize(size);
+			for (unsigned int i = 0; i < size; i++)
+				rowVariables[i] = _variables[varNums[begin + i]];
 
-			j++;
+			if (size > 0)
+				lhsExprs[j].addTerms(&coefs[begin], &rowVariables[0], size);
+
+			senses[j] =
+					(relations[j] == LessEqual ? GRB_LESS_EQUAL :
+							(relations[j] == GreaterEqual ? GRB_GREATER_EQUAL :
+									GRB_EQUAL));
 		}
 
+		boost::scoped_array<GRBConstr> added(
+				_model.addConstrs(&lhsExprs[0], &senses[0], &values[0], 0, numConstraints));
+
+		_constraints.insert(_constraints.end(), added.get(), added.get() + numConstraints);
+
 		_model.update();
 
 	} catch (GRBException e) {
@@ -231,9 +331,41 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 	}
 }
 
+void
+GurobiBackend::setObjectiveCoefficient(unsigned int varNum, double coef) {
+
+	_variables[varNum].set(GRB_DoubleAttr_Obj, coef);
+}
+
+void
+GurobiBackend::setInitialSolution(const Solution& solution) {
+
+	if (solution.size() != _numVariables) {
+
+		LOG_DEBUG(gurobilog) << "initial solution has wrong size, ignoring it" << std::endl;
+		return;
+	}
+
+	try {
+
+		_model.set(GRB_DoubleAttr_Start, _variables, &solution.getVector()[0], _numVariables);
+
+	} catch (GRBException e) {
+
+		LOG_ERROR(gurobilog) << "error: " << e.getMessage() << endl;
+	}
+}
+
 void
 GurobiBackend::pinVariable(unsigned int varNum, double value) {
 
+	// remember the bounds the variable had before it was pinned the first 
+	// time
+	if (_pinnedBounds.count(varNum) == 0)
+		_pinnedBounds[varNum] = std::make_pair(
+				_variables[varNum].get(GRB_DoubleAttr_LB),
+				_variables[varNum].get(GRB_DoubleAttr_UB));
+
 	_variables[varNum].set(GRB_DoubleAttr_LB, value);
 	_variables[varNum].set(GRB_DoubleAttr_UB, value);
 }
@@ -241,12 +373,17 @@ GurobiBackend::pinVariable(unsigned int varNum, double value) {
 bool
 GurobiBackend::unpinVariable(unsigned int varNum) {
 
-	bool pinned = (_variables[varNum].get(GRB_DoubleAttr_LB) > -GRB_INFINITY);
+	std::map<unsigned int, std::pair<double, double> >::iterator i = _pinnedBounds.find(varNum);
+
+	if (i == _pinnedBounds.end())
+		return false;
+
+	_variables[varNum].set(GRB_DoubleAttr_LB, i->second.first);
+	_variables[varNum].set(GRB_DoubleAttr_UB, i->second.second);
 
-	_variables[varNum].set(GRB_DoubleAttr_LB, -GRB_INFINITY);
-	_variables[varNum].set(GRB_DoubleAttr_UB,  GRB_INFINITY);
+	_pinnedBounds.erase(i);
 
-	return pinned;
+	return true;
 }
 
 bool
@@ -256,13 +393,55 @@ GurobiBackend::solve(Solution& x, double& value, std::string& msg) {
 
 		LOG_ALL(gurobilog) << "solving model " << _model.getObjective() << std::endl;
 
+		// an interrupt while the problem was set up
+		{
+			boost::mutex::scoped_lock lock(_interruptMutex);
+
+			if (_interrupted) {
+
+				_interrupted = false;
+				msg = "Solver interrupted";
+
+				return false;
+			}
+		}
+
+		// the callback is needed even without observer, to stop the solver on 
+		// interrupts that came in before the optimization started
+		_callback.reset();
+		_model.setCallback(&_callback);
+
 		_model.optimize();
 
+		{
+			boost::mutex::scoped_lock lock(_interruptMutex);
+			_interrupted = false;
+		}
+
 		int status = _model.get(GRB_IntAttr_Status);
 
 		if (status != GRB_OPTIMAL) {
-			msg = "Optimal solution *NOT* found";
+
+			if (status == GRB_TIME_LIMIT)
+				msg = "Time limit reached";
+			else if (status == GRB_INTERRUPTED)
+				msg = "Solver interrupted";
+			else
+				msg = "Optimal solution *NOT* found";
+
+			// if we were interrupted or hit a limit, the best solution found 
+			// so far is still of interest
+			if (_model.get(GRB_IntAttr_SolCount) > 0) {
+
+				x.resize(_numVariables);
+				for (unsigned int i = 0; i < _numVariables; i++)
+					x[i] = _variables[i].get(GRB_DoubleAttr_X);
+
+				value = _model.get(GRB_DoubleAttr_ObjVal);
+			}
+
 			return false;
+
 		} else
 			msg = "Optimal solution found";
 
@@ -287,6 +466,122 @@ GurobiBackend::solve(Solution& x, double& value, std::string& msg) {
 	return true;
 }
 
+void
+GurobiBackend::setTimeLimit(double seconds) {
+
+	_timeLimit = seconds;
+	_model.getEnv().set(GRB_DoubleParam_TimeLimit, _timeLimit > 0 ? _timeLimit : GRB_INFINITY);
+}
+
+void
+GurobiBackend::setOptimalityGap(double gap) {
+
+	_mipGap = gap;
+	setMIPGap(_mipGap);
+}
+
+void
+GurobiBackend::interrupt() {
+
+	boost::mutex::scoped_lock lock(_interruptMutex);
+
+	// terminate() has no effect if the optimization did not start yet, in 
+	// which case the flag stops it
+	_interrupted = true;
+	_model.terminate();
+}
+
+bool
+GurobiBackend::isInterrupted() {
+
+	boost::mutex::scoped_lock lock(_interruptMutex);
+
+	return _interrupted;
+}
+
+void
+GurobiBackend::setObserver(LinearSolverObserver* observer) {
+
+	_observer = observer;
+}
+
+void
+GurobiBackend::Callback::reset() {
+
+	_progress = SolverProgress();
+}
+
+void
+GurobiBackend::Callback::callback() {
+
+	try {
+
+		if (_backend.isInterrupted()) {
+
+			abort();
+			return;
+		}
+
+		if (!_backend._observer)
+			return;
+
+		if (where == GRB_CB_MIPSOL) {
+
+			double value = getDoubleInfo(GRB_CB_MIPSOL_OBJ);
+
+			if (_progress.hasIncumbent && !isBetter(value))
+				return;
+
+			_progress.runtime        = getDoubleInfo(GRB_CB_RUNTIME);
+			_progress.hasIncumbent   = true;
+			_progress.incumbentValue = value;
+			_progress.bound          = getDoubleInfo(GRB_CB_MIPSOL_OBJBND);
+			_progress.gap            = std::abs(value - _progress.bound)/std::max(std::abs(value), 1e-10);
+
+			double* values = getSolution(_backend._variables, _backend._numVariables);
+
+			Solution incumbent(_backend._numVariables);
+			std::copy(values, values + _backend._numVariables, incumbent.getVector().begin());
+			delete[] values;
+
+			LOG_DEBUG(gurobilog)
+					<< "new incumbent with value " << value
+					<< " after " << _progress.runtime << "s" << std::endl;
+
+			_backend._observer->onIncumbent(incumbent, _progress);
+
+		} else if (where == GRB_CB_MIP) {
+
+			double bound = getDoubleInfo(GRB_CB_MIP_OBJBND);
+
+			// report only changes of the bound
+			if (bound == _progress.bound)
+				return;
+
+			_progress.runtime = getDoubleInfo(GRB_CB_RUNTIME);
+			_progress.bound   = bound;
+
+			if (_progress.hasIncumbent)
+				_progress.gap = std::abs(_progress.incumbentValue - bound)/std::max(std::abs(_progress.incumbentValue), 1e-10);
+
+			_backend._observer->onProgress(_progress);
+		}
+
+	} catch (GRBException e) {
+
+		LOG_ERROR(gurobilog) << "error in callback: " << e.getMessage() << endl;
+	}
+}
+
+bool
+GurobiBackend::Callback::isBetter(double value) const {
+
+	if (_backend._sense == Minimize)
+		return value < _progress.incumbentValue;
+
+	return value > _progress.incumbentValue;
+}
+
 void
 GurobiBackend::setMIPGap(double gap) {
 
@@ -302,6 +597,7 @@ GurobiBackend::setMIPFocus(unsigned int focus) {
 void
 GurobiBackend::setNumThreads(unsigned int numThreads) {
 
+	_numThreads = numThreads;
 	_model.getEnv().set(GRB_IntParam_Threads, numThreads);
 }
 
@@ -3,11 +3,16 @@
 
 #ifdef HAVE_GUROBI
 
+#include <map>
 #include <string>
 
+#include <boost/thread/mutex.hpp>
+
 #include <gurobi_c++.h>
 
+#include "CompressedLinearConstraints.h"
 #include "LinearConstraints.h"
+#include "LinearSolverObserver.h"
 #include "LinearSolverParameters.h"
 #include "QuadraticObjective.h"
 #include "QuadraticSolverBackend.h"
@@ -33,8 +38,26 @@ class GurobiBackend : public QuadraticSolverBackend {
 
 public:
 
+	/**
+	 * Create a Gurobi backend with the settings given by the program options.
+	 */
 	GurobiBackend();
 
+	/**
+	 * Create a Gurobi backend with explicit settings.
+	 *
+	 * @param mipGap
+	 *              The relative optimality gap.
+	 *
+	 * @param mipFocus
+	 *              The MIP focus (0 = balanced, 1 = feasible solutions, 2 = 
+	 *              optimal solution, 3 = bound).
+	 *
+	 * @param numThreads
+	 *              The number of threads to use (0 = all available CPUs).
+	 */
+	GurobiBackend(double mipGap, unsigned int mipFocus, unsigned int numThreads);
+
 	virtual ~GurobiBackend();
 
 	///////////////////////////////////
@@ -50,12 +73,26 @@ public:
 			VariableType                                defaultVariableType,
 			const std::map<unsigned int, VariableType>& specialVariableTypes);
 
+	/**
+	 * Create all variables with their types and bounds in a single call.
+	 */
+	void initialize(
+			unsigned int                     numVariables,
+			const std::vector<VariableType>& variableTypes,
+			const std::vector<double>&       lowerBounds,
+			const std::vector<double>&       upperBounds);
+
 	void setObjective(const LinearObjective& objective);
 
 	void setObjective(const QuadraticObjective& objective);
 
 	void setConstraints(const LinearConstraints& constraints);
 
+	/**
+	 * Add all constraints to the model in a single call.
+	 */
+	void setConstraints(const CompressedLinearConstraints& constraints);
+
 	/**
 	 * Force the value of a variable to be a given value, i.e., pin the variable 
 	 * to a fixed value.
@@ -69,7 +106,8 @@ public:
 	void pinVariable(unsigned int varNum, double value);
 
 	/**
-	 * Remove a previous pin from a variable.
+	 * Remove a previous pin from a variable and restore the bounds it had 
+	 * before it was pinned.
 	 *
 	 * @param varNum
 	 *              The number of the variable to unpin.
@@ -78,26 +116,85 @@ public:
 	 */
 	bool unpinVariable(unsigned int varNum);
 
+	bool supportsIncrementalUpdates() const { return true; }
+
+	void setObjectiveCoefficient(unsigned int varNum, double coef);
+
+	void addConstraints(const LinearConstraints& constraints);
+
+	/**
+	 * Set the MIP start of the next solve.
+	 */
+	void setInitialSolution(const Solution& solution);
+
+	void setTimeLimit(double seconds);
+
+	void setOptimalityGap(double gap);
+
+	void setNumThreads(unsigned int numThreads);
+
+	/**
+	 * Terminate a running optimization, or the next one if none is running 
+	 * yet. Can be called from another thread.
+	 */
+	void interrupt();
+
+	/**
+	 * Report new incumbents and changes of the bound to the given observer.
+	 */
+	void setObserver(LinearSolverObserver* observer);
+
 	bool solve(Solution& solution, double& value, std::string& message);
 
 private:
 
+	// forwards the MIP callbacks of Gurobi to the observer
+	class Callback : public GRBCallback {
+
+	public:
+
+		Callback(GurobiBackend& backend) : _backend(backend) {}
+
+		// prepare for a new solve
+		void reset();
+
+	protected:
+
+		void callback();
+
+	private:
+
+		// is value a better objective value than the best so far?
+		bool isBetter(double value) const;
+
+		GurobiBackend& _backend;
+
+		SolverProgress _progress;
+	};
+
 	//////////////
 	// internal //
 	//////////////
 
+	// true, if interrupt() was called and the interrupt was not consumed by 
+	// a solve, yet
+	bool isInterrupted();
+
 	// dump the current problem to a file
 	void dumpProblem(std::string filename);
 
+	// set verbosity, gap, focus, threads, and time limit
+	void setParameters();
+
+	// add constraints to the model in a single call, keeping the existing ones
+	void addConstraints(const CompressedLinearConstraints& constraints);
+
 	// set the optimality gap
 	void setMIPGap(double gap);
 
 	// set the mpi focus
 	void setMIPFocus(unsigned int focus);
 
-	// set the number of threads to use
-	void setNumThreads(unsigned int numThreads);
-
 	/**
 	 * Enable solver output.
 	 */
@@ -118,6 +215,9 @@ private:
 	// the (binary) variables x
 	GRBVar* _variables;
 
+	// the original lower and upper bounds of currently pinned variables
+	std::map<unsigned int, std::pair<double, double> > _pinnedBounds;
+
 	// the objective
 	GRBQuadExpr _objective;
 
@@ -132,6 +232,24 @@ private:
 
 	// a value by which to scale the objective
 	double _scale;
+
+	// the solver settings
+	double       _mipGap;
+	unsigned int _mipFocus;
+	unsigned int _numThreads;
+	double       _timeLimit;
+
+	// the sense of the current objective
+	Sense _sense;
+
+	// the observer of the progress of solve(), if any
+	LinearSolverObserver* _observer;
+
+	// set by interrupt(), stops the current or next solve
+	bool         _interrupted;
+	boost::mutex _interruptMutex;
+
+	Callback _callback;
 };
 
 #endif // HAVE_GUROBI
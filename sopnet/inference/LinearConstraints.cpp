@@ -1,46 +1,173 @@
+#include <algorithm>
+
+#include <util/foreach.h>
 #include "LinearConstraints.h"
 
-LinearConstraints::LinearConstraints(size_t size) {
+LinearConstraints::LinearConstraints(size_t size) :
+	_numIndexed(0),
+	_numVariables(0),
+	_numVariablesDirty(false),
+	_numRegisteredVariables(0) {
 
 	_linearConstraints.resize(size);
 }
 
+LinearConstraints::LinearConstraints(const LinearConstraints& other) :
+	pipeline::Data(other),
+	_numIndexed(0),
+	_numVariables(0),
+	_numVariablesDirty(false),
+	_numRegisteredVariables(0) {
+
+	*this = other;
+}
+
+LinearConstraints&
+LinearConstraints::operator=(const LinearConstraints& other) {
+
+	if (&other == this)
+		return *this;
+
+	boost::mutex::scoped_lock lock(other._cacheMutex);
+
+	_linearConstraints      = other._linearConstraints;
+	_variableConstraints    = other._variableConstraints;
+	_numIndexed             = other._numIndexed;
+	_numVariables           = other._numVariables;
+	_numVariablesDirty      = other._numVariablesDirty;
+	_numRegisteredVariables = other._numRegisteredVariables;
+
+	return *this;
+}
+
+void
+LinearConstraints::clear() {
+
+	_linearConstraints.clear();
+	_numRegisteredVariables = 0;
+
+	invalidateCaches();
+}
+
 void
 LinearConstraints::add(const LinearConstraint& linearConstraint) {
 
 	_linearConstraints.push_back(linearConstraint);
+
+	// coefficients are sorted by variable number, the last one is the largest
+	if (!_numVariablesDirty && !linearConstraint.getCoefficients().empty())
+		_numVariables = std::max(_numVariables, linearConstraint.getCoefficients().rbegin()->first + 1);
 }
 
 void
 LinearConstraints::addAll(const LinearConstraints& linearConstraints) {
 
 	_linearConstraints.insert(_linearConstraints.end(), linearConstraints.begin(), linearConstraints.end());
+
+	if (!_numVariablesDirty)
+		_numVariables = std::max(_numVariables, linearConstraints.getNumVariables());
+}
+
+void
+LinearConstraints::registerVariables(unsigned int numVariables) {
+
+	_numRegisteredVariables = std::max(_numRegisteredVariables, numVariables);
+}
+
+unsigned int
+LinearConstraints::getNumVariables() const {
+
+	boost::mutex::scoped_lock lock(_cacheMutex);
+
+	if (_numVariablesDirty) {
+
+		_numVariables = 0;
+
+		foreach (const LinearConstraint& constraint, _linearConstraints)
+			if (!constraint.getCoefficients().empty())
+				_numVariables = std::max(_numVariables, constraint.getCoefficients().rbegin()->first + 1);
+
+		_numVariablesDirty = false;
+	}
+
+	return std::max(_numVariables, _numRegisteredVariables);
 }
 
 void
 LinearConstraints::removeLastConstraint() {
 
+	// the last constraint is indexed already, remove it from the index
+	if (_numIndexed == size()) {
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _linearConstraints.back().getCoefficients())
+			_variableConstraints[varNum].pop_back();
+
+		_numIndexed--;
+	}
+
 	_linearConstraints.pop_back();
+
+	// the removed constraint might have used the largest variable number
+	_numVariablesDirty = true;
 }
 
 std::vector<unsigned int>
-LinearConstraints::getConstraints(const std::vector<unsigned int>& variableIds) {
+LinearConstraints::getConstraints(const std::vector<unsigned int>& variableIds) const {
 
 	std::vector<unsigned int> indices;
 
-	for (unsigned int i = 0; i < size(); i++) {
+	{
+		boost::mutex::scoped_lock lock(_cacheMutex);
 
-		LinearConstraint& constraint = _linearConstraints[i];
+		updateIndex();
 
-		foreach (unsigned int v, variableIds) {
+		foreach (unsigned int v, variableIds)
+			collectConstraints(v, indices);
+	}
+
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
-			if (constraint.getCoefficients().count(v) != 0) {
+	return indices;
+}
 
-				indices.push_back(i);
-				break;
-			}
+std::vector<unsigned int>
+LinearConstraints::getConstraints(const std::set<unsigned int>& variableIds) const {
+
+	return getConstraints(std::vector<unsigned int>(variableIds.begin(), variableIds.end()));
+}
+
+void
+LinearConstraints::updateIndex() const {
+
+	// Constraints are only ever appended via add() and addAll(), such that we 
+	// only have to index the ones that came in since the last query. This also 
+	// keeps the per-variable lists sorted.
+	for (unsigned int i = _numIndexed; i < size(); i++) {
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _linearConstraints[i].getCoefficients()) {
+
+			if (varNum >= _variableConstraints.size())
+				_variableConstraints.resize(varNum + 1);
+
+			_variableConstraints[varNum].push_back(i);
 		}
 	}
 
-	return indices;
+	_numIndexed = size();
+}
+
+void
+LinearConstraints::collectConstraints(unsigned int varNum, std::vector<unsigned int>& indices) const {
+
+	if (varNum >= _variableConstraints.size())
+		return;
+
+	const std::vector<unsigned int>& constraints = _variableConstraints[varNum];
+
+	indices.insert(indices.end(), constraints.begin(), constraints.end());
 }
@@ -1,6 +1,11 @@
 #ifndef INFERENCE_LINEAR_CONSTRAINTS_H__
 #define INFERENCE_LINEAR_CONSTRAINTS_H__
 
+#include <set>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
 #include <pipeline/all.h>
 #include "LinearConstraint.h"
 
@@ -10,7 +15,9 @@ class LinearConstraints : public pipeline::Data {
 
 public:
 
-	typedef linear_constraints_type::iterator       iterator;
+	// constraints can only be changed through edit(), such that iterating 
+	// over them does not invalidate the variable index
+	typedef linear_constraints_type::const_iterator iterator;
 
 	typedef linear_constraints_type::const_iterator const_iterator;
 
@@ -24,10 +31,20 @@ public:
 	 */
 	LinearConstraints(size_t size = 0);
 
+	/**
+	 * Copy constructor.
+	 */
+	LinearConstraints(const LinearConstraints& other);
+
+	/**
+	 * Assignment operator.
+	 */
+	LinearConstraints& operator=(const LinearConstraints& other);
+
 	/**
 	 * Remove all constraints from this set of linear constraints.
 	 */
-	void clear() { _linearConstraints.clear(); }
+	void clear();
 
 	/**
 	 * Add a linear constraint.
@@ -55,25 +72,84 @@ public:
 
 	const const_iterator begin() const { return _linearConstraints.begin(); }
 
-	iterator begin() { return _linearConstraints.begin(); }
-
 	const const_iterator end() const { return _linearConstraints.end(); }
 
-	iterator end() { return _linearConstraints.end(); }
-
 	const LinearConstraint& operator[](size_t i) const { return _linearConstraints[i]; }
 
-	LinearConstraint& operator[](size_t i) { return _linearConstraints[i]; }
+	/**
+	 * Get write access to a constraint. Changing a constraint invalidates the 
+	 * variable index and the number of variables, which are recomputed on the 
+	 * next query.
+	 *
+	 * @param i The index of the constraint to change.
+	 */
+	LinearConstraint& edit(size_t i) { invalidateCaches(); return _linearConstraints[i]; }
+
+	/**
+	 * Register variables that are part of the problem, even if they do not 
+	 * appear in any constraint. After this call, getNumVariables() returns at 
+	 * least numVariables.
+	 *
+	 * @param numVariables The number of variables to register.
+	 */
+	void registerVariables(unsigned int numVariables);
+
+	/**
+	 * @return The number of variables used by this set of constraints, i.e., 
+	 *         the largest variable number plus one, or the number of 
+	 *         registered variables if that is larger.
+	 */
+	unsigned int getNumVariables() const;
+
+	/**
+	 * Get a list of indices of linear constraints that use the given 
+	 * variables. The indices are sorted in ascending order. Safe to be called 
+	 * concurrently, as long as the constraints are not changed.
+	 */
+	std::vector<unsigned int> getConstraints(const std::vector<unsigned int>& variableIds) const;
 
 	/**
-	 * Get a linst of indices of linear constraints that use the given 
-	 * variables.
+	 * Same as above, for a set of variables.
 	 */
-	std::vector<unsigned int> getConstraints(const std::vector<unsigned int>& variableIds);
+	std::vector<unsigned int> getConstraints(const std::set<unsigned int>& variableIds) const;
 
 private:
 
+	/**
+	 * Add all constraints that have not been seen so far to the inverted 
+	 * variable index. Has to be called with _cacheMutex locked.
+	 */
+	void updateIndex() const;
+
+	/**
+	 * Add the indices of all constraints involving the given variable to 
+	 * indices.
+	 */
+	void collectConstraints(unsigned int varNum, std::vector<unsigned int>& indices) const;
+
+	void invalidateCaches() { _variableConstraints.clear(); _numIndexed = 0; _numVariablesDirty = true; }
+
 	linear_constraints_type _linearConstraints;
+
+	// inverted index from variable numbers to the (ascending) indices of the 
+	// constraints they are used in
+	mutable std::vector<std::vector<unsigned int> > _variableConstraints;
+
+	// the number of constraints that have been added to the index so far
+	mutable unsigned int _numIndexed;
+
+	// the number of variables used by the constraints
+	mutable unsigned int _numVariables;
+
+	// true, if _numVariables has to be recomputed
+	mutable bool _numVariablesDirty;
+
+	// the number of explicitly registered variables
+	unsigned int _numRegisteredVariables;
+
+	// protects the lazily updated index and number of variables against 
+	// concurrent queries
+	mutable boost::mutex _cacheMutex;
 };
 
 #endif // INFERENCE_LINEAR_CONSTRAINTS_H__
@@ -1,20 +1,37 @@
+#include <algorithm>
+
 #include <boost/timer/timer.hpp>
 #include <util/Logger.h>
 #include <util/foreach.h>
 #include <util/helpers.hpp>
+#include <util/ProgramOptions.h>
 #include "LinearSolver.h"
 
 static logger::LogChannel linearsolverlog("linearsolverlog", "[LinearSolver] ");
 
+util::ProgramOption optionLinearSolverTimeBudget(
+		util::_module           = "inference",
+		util::_long_name        = "timeBudget",
+		util::_description_text = "The wall-clock time budget in seconds for each run of the linear solver, including the setup of the problem. If it is exhausted, the solver is stopped and the best solution found so far is used. The default (0) means no budget.",
+		util::_default_value    = 0);
+
 LinearSolver::LinearSolver(const LinearSolverBackendFactory& backendFactory) :
 	_solution(new Solution()),
 	_objectiveDirty(true),
 	_linearConstraintsDirty(true),
 	_parametersDirty(true),
-	_pinnedChanged(false) {
+	_pinnedChanged(false),
+	_numSentAddedConstraints(0),
+	_warmStart(true),
+	_haveSolution(false),
+	_optimal(false),
+	_haveInitialSolution(false),
+	_timeBudget(optionLinearSolverTimeBudget),
+	_budgetExhausted(false) {
 
 	registerInput(_objective, "objective");
 	registerInput(_linearConstraints, "linear constraints");
+	registerInput(_compressedLinearConstraints, "compressed linear constraints", pipeline::Optional);
 	registerInput(_parameters, "parameters");
 	registerOutput(_solution, "solution");
 
@@ -24,6 +41,7 @@ LinearSolver::LinearSolver(const LinearSolverBackendFactory& backendFactory) :
 	// register callbacks for input changes
 	_objective.registerCallback(&LinearSolver::onObjectiveModified, this);
 	_linearConstraints.registerCallback(&LinearSolver::onLinearConstraintsModified, this);
+	_compressedLinearConstraints.registerCallback(&LinearSolver::onLinearConstraintsModified, this);
 	_parameters.registerCallback(&LinearSolver::onParametersModified, this);
 }
 
@@ -60,6 +78,133 @@ LinearSolver::unpinVariable(unsigned int varNum) {
 	return false;
 }
 
+void
+LinearSolver::setObjectiveCoefficient(unsigned int varNum, double coef) {
+
+	// already set to that value?
+	if (_objectiveOverrides.count(varNum) && _objectiveOverrides[varNum] == coef)
+		return;
+
+	_objectiveOverrides[varNum] = coef;
+	_changedCoefficients.insert(varNum);
+	setDirty(_solution);
+}
+
+bool
+LinearSolver::resetObjectiveCoefficient(unsigned int varNum) {
+
+	if (_objectiveOverrides.erase(varNum) > 0) {
+
+		_changedCoefficients.insert(varNum);
+		setDirty(_solution);
+
+		return true;
+	}
+
+	return false;
+}
+
+void
+LinearSolver::addConstraint(const LinearConstraint& constraint) {
+
+	_addedConstraints.add(constraint);
+	setDirty(_solution);
+}
+
+void
+LinearSolver::clearAddedConstraints() {
+
+	if (_addedConstraints.size() == 0)
+		return;
+
+	_addedConstraints.clear();
+	_numSentAddedConstraints = 0;
+
+	// constraints can not be removed incrementally
+	_linearConstraintsDirty = true;
+	setDirty(_solution);
+}
+
+void
+LinearSolver::setInitialSolution(const Solution& solution) {
+
+	_initialSolution     = solution;
+	_haveInitialSolution = true;
+}
+
+void
+LinearSolver::interrupt() {
+
+	_solver->interrupt();
+}
+
+void
+LinearSolver::addObserver(LinearSolverObserver* observer) {
+
+	_observers.push_back(observer);
+}
+
+void
+LinearSolver::removeObserver(LinearSolverObserver* observer) {
+
+	_observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+}
+
+SolverProgress
+LinearSolver::getProgress() {
+
+	boost::mutex::scoped_lock lock(_progressMutex);
+
+	return _progress;
+}
+
+void
+LinearSolver::onIncumbent(const Solution& incumbent, const SolverProgress& progress) {
+
+	{
+		boost::mutex::scoped_lock lock(_progressMutex);
+		_progress = progress;
+	}
+
+	LOG_DEBUG(linearsolverlog)
+			<< "incumbent with value " << progress.incumbentValue
+			<< " (gap " << progress.gap << ") after " << progress.runtime << "s" << std::endl;
+
+	foreach (LinearSolverObserver* observer, _observers)
+		observer->onIncumbent(incumbent, progress);
+
+	checkTimeBudget();
+}
+
+void
+LinearSolver::onProgress(const SolverProgress& progress) {
+
+	{
+		boost::mutex::scoped_lock lock(_progressMutex);
+		_progress = progress;
+	}
+
+	foreach (LinearSolverObserver* observer, _observers)
+		observer->onProgress(progress);
+
+	checkTimeBudget();
+}
+
+void
+LinearSolver::checkTimeBudget() {
+
+	if (_timeBudget <= 0 || _budgetExhausted)
+		return;
+
+	if (_budgetTimer.elapsed().wall*1e-9 < _timeBudget)
+		return;
+
+	LOG_USER(linearsolverlog) << "time budget of " << _timeBudget << "s exhausted, stopping solver" << std::endl;
+
+	_budgetExhausted = true;
+	_solver->interrupt();
+}
+
 void
 LinearSolver::onObjectiveModified(const pipeline::Modified&) {
 
@@ -83,6 +228,9 @@ LinearSolver::updateOutputs() {
 
 	boost::timer::auto_cpu_timer timer("\tLinearSolver::updateOutputs()\t\t%ws\n");
 
+	_budgetTimer.start();
+	_budgetExhausted = false;
+
 	updateLinearProgram();
 
 	solve();
@@ -95,37 +243,97 @@ LinearSolver::updateLinearProgram() {
 
 		LOG_DEBUG(linearsolverlog) << "initializing solver" << std::endl;
 
-		if (_parameters.isSet())
+		unsigned int numVariables = getNumVariables();
+
+		if (_parameters.isSet()) {
+
+			std::vector<double> lowerBounds;
+			std::vector<double> upperBounds;
+			_parameters->getBounds(numVariables, lowerBounds, upperBounds);
+
 			_solver->initialize(
-					getNumVariables(),
-					_parameters->getDefaultVariableType(),
-					_parameters->getSpecialVariableTypes());
-		else
+					numVariables,
+					_parameters->getVariableTypes(numVariables),
+					lowerBounds,
+					upperBounds);
+
+			_solver->setTimeLimit(_parameters->getTimeLimit());
+
+			if (_parameters->getOptimalityGap() >= 0)
+				_solver->setOptimalityGap(_parameters->getOptimalityGap());
+
+			if (_parameters->getNumThreads() > 0)
+				_solver->setNumThreads(_parameters->getNumThreads());
+
+		} else {
+
 			_solver->initialize(
-					getNumVariables(),
+					numVariables,
 					Continuous);
+		}
+
+		// the backend created new variables, everything that refers to them 
+		// has to be set again
+		_objectiveDirty         = true;
+		_linearConstraintsDirty = true;
+		_pinnedChanged          = true;
 
 		_parametersDirty = false;
 	}
 
+	bool incremental = _solver->supportsIncrementalUpdates();
+
+	// without incremental updates, every change requires to set the whole 
+	// objective or all constraints again
+	if (!incremental && !_changedCoefficients.empty())
+		_objectiveDirty = true;
+	if (!incremental && _numSentAddedConstraints < _addedConstraints.size())
+		_linearConstraintsDirty = true;
+
 	if (_objectiveDirty) {
 
 		LOG_DEBUG(linearsolverlog) << "(re)setting objective" << std::endl;
 
-		_solver->setObjective(*_objective);
+		setObjective();
 
 		_objectiveDirty = false;
+
+	} else if (!_changedCoefficients.empty()) {
+
+		LOG_DEBUG(linearsolverlog) << "changing " << _changedCoefficients.size() << " objective coefficients" << std::endl;
+
+		foreach (unsigned int varNum, _changedCoefficients) {
+
+			if (_objectiveOverrides.count(varNum))
+				_solver->setObjectiveCoefficient(varNum, _objectiveOverrides[varNum]);
+			else
+				_solver->setObjectiveCoefficient(varNum, _objective->getCoefficients()[varNum]);
+		}
 	}
 
+	_changedCoefficients.clear();
+
 	if (_linearConstraintsDirty) {
 
 		LOG_DEBUG(linearsolverlog) << "(re)setting linear constraints" << std::endl;
 
-		_solver->setConstraints(*_linearConstraints);
+		setConstraints();
 
 		_linearConstraintsDirty = false;
+
+	} else if (_numSentAddedConstraints < _addedConstraints.size()) {
+
+		LOG_DEBUG(linearsolverlog) << "adding " << (_addedConstraints.size() - _numSentAddedConstraints) << " linear constraints" << std::endl;
+
+		LinearConstraints newConstraints;
+		for (unsigned int i = _numSentAddedConstraints; i < _addedConstraints.size(); i++)
+			newConstraints.add(_addedConstraints[i]);
+
+		_solver->addConstraints(newConstraints);
 	}
 
+	_numSentAddedConstraints = _addedConstraints.size();
+
 	if (_pinnedChanged) {
 
 		LOG_DEBUG(linearsolverlog) << "(un)pinning variables" << std::endl;
@@ -143,6 +351,45 @@ LinearSolver::updateLinearProgram() {
 	}
 }
 
+void
+LinearSolver::setObjective() {
+
+	if (_objectiveOverrides.empty()) {
+
+		_solver->setObjective(*_objective);
+		return;
+	}
+
+	LinearObjective objective = *_objective;
+
+	unsigned int varNum;
+	double       coef;
+	foreach (boost::tie(varNum, coef), _objectiveOverrides)
+		objective.setCoefficient(varNum, coef);
+
+	_solver->setObjective(objective);
+}
+
+void
+LinearSolver::setConstraints() {
+
+	if (_addedConstraints.size() == 0) {
+
+		// the compressed constraints can be handed to the backend without 
+		// conversion
+		if (_compressedLinearConstraints.isSet())
+			_solver->setConstraints(*_compressedLinearConstraints);
+		else
+			_solver->setConstraints(*_linearConstraints);
+		return;
+	}
+
+	LinearConstraints constraints = *_linearConstraints;
+	constraints.addAll(_addedConstraints);
+
+	_solver->setConstraints(constraints);
+}
+
 void
 LinearSolver::solve() {
 
@@ -150,10 +397,62 @@ LinearSolver::solve() {
 
 	std::string message;
 
-	if (_solver->solve(*_solution, value, message)) {
+	if (_haveInitialSolution) {
+
+		_solver->setInitialSolution(_initialSolution);
+		_haveInitialSolution = false;
+
+	} else if (_warmStart && _haveSolution) {
+
+		_solver->setInitialSolution(*_solution);
+	}
+
+	// spend at most the remaining time budget on the solve
+	if (_timeBudget > 0) {
+
+		double timeLimit = (_parameters.isSet() ? _parameters->getTimeLimit() : 0);
+		double remaining = std::max(_timeBudget - _budgetTimer.elapsed().wall*1e-9, 0.001);
+
+		_solver->setTimeLimit(timeLimit > 0 ? std::min(timeLimit, remaining) : remaining);
+	}
+
+	{
+		boost::mutex::scoped_lock lock(_progressMutex);
+		_progress = SolverProgress();
+	}
+
+	_solver->setObserver(_observers.empty() && _timeBudget <= 0 ? 0 : this);
+
+	_optimal = false;
+
+	// backends return the best solution found so far if they were stopped by 
+	// a time limit or interrupt
+	Solution solution;
+	bool     optimal = _solver->solve(solution, value, message);
+
+	// the backend's own time limit (set to the remaining budget) might have 
+	// stopped it before a progress callback noticed the exhausted budget
+	if (_timeBudget > 0 && _budgetTimer.elapsed().wall*1e-9 >= _timeBudget)
+		_budgetExhausted = true;
+
+	if (optimal) {
 
 		LOG_USER(linearsolverlog) << "optimal solution found" << std::endl;
 
+		*_solution    = solution;
+		_haveSolution = true;
+		_optimal      = true;
+
+	} else if (solution.size() > 0 && solution.size() == getNumVariables()) {
+
+		if (_budgetExhausted)
+			LOG_USER(linearsolverlog) << "using best solution found within the time budget" << std::endl;
+		else
+			LOG_USER(linearsolverlog) << message << ", using best solution found so far" << std::endl;
+
+		*_solution    = solution;
+		_haveSolution = true;
+
 	} else {
 
 		LOG_ERROR(linearsolverlog) << "error: " << message << std::endl;
@@ -170,14 +469,10 @@ LinearSolver::getNumVariables() {
 			<< _objective->getCoefficients().size()
 			<< " variables" << std::endl;
 
-	unsigned int numVars = _objective->getCoefficients().size();
-
-	// number of vars in the constraints
-	unsigned int varNum;
-	double coef;
-	foreach (const LinearConstraint& constraint, *_linearConstraints)
-		foreach (boost::tie(varNum, coef), constraint.getCoefficients())
-			numVars = std::max(numVars, varNum + 1);
+	// the constraints keep track of the variables they use
+	unsigned int numVars = std::max<unsigned int>(
+			_objective->getCoefficients().size(),
+			_linearConstraints->getNumVariables());
 
 	LOG_ALL(linearsolverlog)
 			<< "together with the constraints, "
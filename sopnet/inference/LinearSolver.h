@@ -2,15 +2,20 @@
 #define INFERENCE_LINEAR_SOLVER_H__
 
 #include <string>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/timer/timer.hpp>
 
 #include <pipeline/all.h>
 #include "DefaultFactory.h"
+#include "CompressedLinearConstraints.h"
 #include "LinearConstraints.h"
 #include "LinearObjective.h"
 #include "LinearSolverBackend.h"
 #include "LinearSolverBackendFactory.h"
+#include "LinearSolverObserver.h"
 #include "LinearSolverParameters.h"
 #include "Solution.h"
 
@@ -36,8 +41,13 @@
  * and provide the output
  *
  *   solution    : Solution.
+ *
+ * Observers can be added to follow the progress of a solve and to receive 
+ * intermediate solutions (e.g., to show previews). If the program option 
+ * timeBudget is set, the solve is stopped after the given wall-clock time and 
+ * the best solution found so far is the output.
  */
-class LinearSolver : public pipeline::SimpleProcessNode<> {
+class LinearSolver : public pipeline::SimpleProcessNode<>, private LinearSolverObserver {
 
 public:
 
@@ -67,8 +77,106 @@ public:
 	 */
 	bool unpinVariable(unsigned int varNum);
 
+	/**
+	 * Override a coefficient of the objective for subsequent solves. If the 
+	 * backend supports it, only this coefficient is changed in the current 
+	 * model.
+	 *
+	 * @param varNum
+	 *              The number of the variable to change the coefficient for.
+	 *
+	 * @param coef
+	 *              The new value of the coefficient.
+	 */
+	void setObjectiveCoefficient(unsigned int varNum, double coef);
+
+	/**
+	 * Remove a previous override of an objective coefficient.
+	 *
+	 * @param varNum
+	 *              The number of the variable to reset the coefficient for.
+	 *
+	 * @return True, if the coefficient was overridden before.
+	 */
+	bool resetObjectiveCoefficient(unsigned int varNum);
+
+	/**
+	 * Add a linear constraint to the constraints given as input for subsequent 
+	 * solves. If the backend supports it, the constraint is added to the 
+	 * current model without setting all constraints again.
+	 *
+	 * @param constraint
+	 *              The linear constraint to add.
+	 */
+	void addConstraint(const LinearConstraint& constraint);
+
+	/**
+	 * Remove all constraints that have been added via addConstraint().
+	 */
+	void clearAddedConstraints();
+
+	/**
+	 * Enable or disable warm starts from the previous solution (enabled by 
+	 * default).
+	 */
+	void setWarmStart(bool warmStart) { _warmStart = warmStart; }
+
+	/**
+	 * Set a start solution for the next solve. It takes precedence over the 
+	 * previous solution and is used only once.
+	 *
+	 * @param solution
+	 *              A (not necessarily feasible) assignment of all variables.
+	 */
+	void setInitialSolution(const Solution& solution);
+
+	/**
+	 * Ask a running solve to stop as soon as possible. The best solution found 
+	 * so far (if any) will be the output. If the problem is still being set 
+	 * up, the solve stops right after it started. Can be called from another 
+	 * thread.
+	 */
+	void interrupt();
+
+	/**
+	 * @return True, if the last solve found an optimal solution. False, if it 
+	 *         failed or the solution is only the best one found within the 
+	 *         time budget.
+	 */
+	bool isOptimal() const { return _optimal; }
+
+	/**
+	 * Add an observer to be informed about new incumbents, bounds, and gaps 
+	 * of subsequent solves. The observer is called from within 
+	 * updateOutputs(), possibly from another thread. Only backends that 
+	 * support it report their progress.
+	 *
+	 * @param observer
+	 *              The observer to add. Not owned by the solver.
+	 */
+	void addObserver(LinearSolverObserver* observer);
+
+	/**
+	 * Remove a previously added observer.
+	 */
+	void removeObserver(LinearSolverObserver* observer);
+
+	/**
+	 * Get the last reported state of the current or previous solve. Can be 
+	 * called from another thread.
+	 */
+	SolverProgress getProgress();
+
 private:
 
+	// LinearSolverObserver interface, called by the backend
+	void onIncumbent(const Solution& incumbent, const SolverProgress& progress);
+
+	void onProgress(const SolverProgress& progress);
+
+	// stop the solve if the time budget is exhausted
+	void checkTimeBudget();
+
 	void onObjectiveModified(const pipeline::Modified& signal);
 
 	void onLinearConstraintsModified(const pipeline::Modified& signal);
@@ -81,6 +189,7 @@ private:
 
 	pipeline::Input<LinearObjective>        _objective;
 	pipeline::Input<LinearConstraints>      _linearConstraints;
+	pipeline::Input<CompressedLinearConstraints> _compressedLinearConstraints;
 	pipeline::Input<LinearSolverParameters> _parameters;
 
 	pipeline::Output<Solution> _solution;
@@ -93,6 +202,10 @@ private:
 
 	void updateLinearProgram();
 
+	void setObjective();
+
+	void setConstraints();
+
 	void solve();
 
 	unsigned int getNumVariables();
@@ -112,6 +225,49 @@ private:
 	std::set<unsigned int> _unpinned;
 
 	bool _pinnedChanged;
+
+	// objective coefficients that override the objective input
+	std::map<unsigned int, double> _objectiveOverrides;
+
+	// variables whose objective coefficient changed since the last solve
+	std::set<unsigned int> _changedCoefficients;
+
+	// constraints added in addition to the linear constraints input
+	LinearConstraints _addedConstraints;
+
+	// the number of added constraints that are already known to the backend
+	unsigned int _numSentAddedConstraints;
+
+	// use the previous solution as a start for the next solve
+	bool _warmStart;
+
+	// true, if _solution contains the result of a previous solve
+	bool _haveSolution;
+
+	// true, if _solution is optimal
+	bool _optimal;
+
+	// a start solution for the next solve, given by the user
+	Solution _initialSolution;
+
+	bool _haveInitialSolution;
+
+	// observers of the progress of the solve
+	std::vector<LinearSolverObserver*> _observers;
+
+	// the last reported progress
+	SolverProgress _progress;
+	boost::mutex   _progressMutex;
+
+	// the wall-clock time budget for each call to updateOutputs() in seconds, 
+	// 0 for none
+	double _timeBudget;
+
+	// measures the time since the beginning of updateOutputs()
+	boost::timer::cpu_timer _budgetTimer;
+
+	// true, if the solve was interrupted because of the time budget
+	bool _budgetExhausted;
 };
 
 #endif // INFERENCE_LINEAR_SOLVER_H__
@@ -1,8 +1,14 @@
 #ifndef INFERENCE_LINEAR_SOLVER_BACKEND_H__
 #define INFERENCE_LINEAR_SOLVER_BACKEND_H__
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CompressedLinearConstraints.h"
 #include "LinearObjective.h"
 #include "LinearConstraints.h"
+#include "LinearSolverObserver.h"
 #include "Solution.h"
 #include "VariableType.h"
 
@@ -42,6 +48,43 @@ public:
 			VariableType                                defaultVariableType,
 			const std::map<unsigned int, VariableType>& specialVariableTypes) = 0;
 
+	/**
+	 * Initialise the linear solver with dense arrays of variable types and 
+	 * bounds. Backends that can create all variables with their bounds at 
+	 * once should override this method. The default implementation 
+	 * initializes the variables with their types and pins variables whose 
+	 * lower and upper bound coincide; other bounds are ignored.
+	 *
+	 * @param numVariables
+	 *             The number of variables in the problem.
+	 *
+	 * @param variableTypes
+	 *             The type of each variable.
+	 *
+	 * @param lowerBounds
+	 *             The lower bound of each variable.
+	 *
+	 * @param upperBounds
+	 *             The upper bound of each variable.
+	 */
+	virtual void initialize(
+			unsigned int                     numVariables,
+			const std::vector<VariableType>& variableTypes,
+			const std::vector<double>&       lowerBounds,
+			const std::vector<double>&       upperBounds) {
+
+		std::map<unsigned int, VariableType> specialVariableTypes;
+		for (unsigned int i = 0; i < numVariables; i++)
+			if (variableTypes[i] != Continuous)
+				specialVariableTypes[i] = variableTypes[i];
+
+		initialize(numVariables, Continuous, specialVariableTypes);
+
+		for (unsigned int i = 0; i < numVariables; i++)
+			if (lowerBounds[i] == upperBounds[i])
+				pinVariable(i, lowerBounds[i]);
+	}
+
 	/**
 	 * Set the objective.
 	 *
@@ -56,6 +99,23 @@ public:
 	 */
 	virtual void setConstraints(const LinearConstraints& constraints) = 0;
 
+	/**
+	 * Set the linear (in)equality constraints from a compressed sparse row 
+	 * representation. Backends that can add all constraints in one call 
+	 * should override this method. The default implementation converts the 
+	 * constraints and calls setConstraints(const LinearConstraints&).
+	 *
+	 * @param constraints A set of compressed linear constraints.
+	 */
+	virtual void setConstraints(const CompressedLinearConstraints& constraints) {
+
+		LinearConstraints linearConstraints;
+		for (unsigned int i = 0; i < constraints.size(); i++)
+			linearConstraints.add(constraints.getConstraint(i));
+
+		setConstraints(linearConstraints);
+	}
+
 	/**
 	 * Force the value of a variable to be a given value, i.e., pin the variable 
 	 * to a fixed value.
@@ -78,13 +138,101 @@ public:
 	 */
 	virtual bool unpinVariable(unsigned int varNum) = 0;
 
+	/**
+	 * @return True, if this backend can modify its current model in place via 
+	 *         setObjectiveCoefficient() and addConstraints(). If not, the 
+	 *         caller has to set the complete objective and constraints again 
+	 *         after each change.
+	 */
+	virtual bool supportsIncrementalUpdates() const { return false; }
+
+	/**
+	 * Change a single linear coefficient of the current objective. Only called 
+	 * if supportsIncrementalUpdates() returns true.
+	 *
+	 * @param varNum
+	 *              The number of the variable to change the coefficient for.
+	 *
+	 * @param coef
+	 *              The new value of the coefficient.
+	 */
+	virtual void setObjectiveCoefficient(unsigned int /*varNum*/, double /*coef*/) {}
+
+	/**
+	 * Add linear constraints to the current set of constraints. Only called if 
+	 * supportsIncrementalUpdates() returns true.
+	 *
+	 * @param constraints
+	 *              The constraints to add.
+	 */
+	virtual void addConstraints(const LinearConstraints& /*constraints*/) {}
+
+	/**
+	 * Provide a (possibly infeasible or partial) solution to start the next 
+	 * call to solve() from. Backends that don't support warm starts ignore 
+	 * this.
+	 *
+	 * @param solution
+	 *              The start solution.
+	 */
+	virtual void setInitialSolution(const Solution& /*solution*/) {}
+
+	/**
+	 * Limit the time of subsequent calls to solve(). Backends without time 
+	 * limits ignore this.
+	 *
+	 * @param seconds
+	 *              The maximal time in seconds, 0 for no limit.
+	 */
+	virtual void setTimeLimit(double /*seconds*/) {}
+
+	/**
+	 * Set the relative optimality gap at which subsequent calls to solve() 
+	 * stop. Backends that don't support this ignore it.
+	 *
+	 * @param gap
+	 *              The relative gap between the best bound and the 
+	 *              incumbent.
+	 */
+	virtual void setOptimalityGap(double /*gap*/) {}
+
+	/**
+	 * Set the number of threads subsequent calls to solve() can use. Backends 
+	 * that don't support this ignore it.
+	 *
+	 * @param numThreads
+	 *              The number of threads, 0 for the backend's default.
+	 */
+	virtual void setNumThreads(unsigned int /*numThreads*/) {}
+
+	/**
+	 * Request a running call to solve() to stop as soon as possible. If no 
+	 * solve is running yet (e.g., because the problem is still set up), the 
+	 * next call to solve() stops right away. Called from another thread than 
+	 * solve(). Backends that can't be interrupted ignore this.
+	 */
+	virtual void interrupt() {}
+
+	/**
+	 * Set an observer to be informed about new incumbents, bounds, and gaps
+	 * during subsequent calls to solve(). Backends that can't report progress
+	 * ignore this.
+	 *
+	 * @param observer
+	 *              The observer, or 0 to remove the current one. Not owned
+	 *              by the backend.
+	 */
+	virtual void setObserver(LinearSolverObserver* /*observer*/) {}
+
 	/**
 	 * Solve the problem.
 	 *
 	 * @param solution A solution object to write the solution to.
 	 * @param value The optimal value of the objective.
 	 * @param message A status message from the solver.
-	 * @return true, if the optimal value was found.
+	 * @return true, if the optimal value was found. If not, backends may 
+	 *         still provide the best solution they found in solution and 
+	 *         value.
 	 */
 	virtual bool solve(Solution& solution, double& value, std::string& message) = 0;
 };
@@ -0,0 +1,70 @@
+#ifndef INFERENCE_LINEAR_SOLVER_OBSERVER_H__
+#define INFERENCE_LINEAR_SOLVER_OBSERVER_H__
+
+#include <limits>
+
+#include "Solution.h"
+
+/**
+ * The state of a running solve.
+ */
+struct SolverProgress {
+
+	SolverProgress() :
+		runtime(0),
+		hasIncumbent(false),
+		incumbentValue(0),
+		bound(0),
+		gap(std::numeric_limits<double>::infinity()) {}
+
+	// the time since the solve started in seconds
+	double runtime;
+
+	// true, if a feasible solution was found already
+	bool hasIncumbent;
+
+	// the objective value of the best solution found so far
+	double incumbentValue;
+
+	// the best bound on the optimal objective value
+	double bound;
+
+	// the relative gap between incumbent and bound
+	double gap;
+};
+
+/**
+ * Interface for classes that want to follow the progress of a
+ * LinearSolverBackend. The methods are called from within
+ * LinearSolverBackend::solve(), possibly from another thread, and should
+ * return quickly.
+ */
+class LinearSolverObserver {
+
+public:
+
+	virtual ~LinearSolverObserver() {}
+
+	/**
+	 * Called whenever the solver found a new best solution.
+	 *
+	 * @param incumbent
+	 *              The new best solution.
+	 *
+	 * @param progress
+	 *              The state of the solve, including the value of the
+	 *              incumbent.
+	 */
+	virtual void onIncumbent(const Solution& /*incumbent*/, const SolverProgress& /*progress*/) {}
+
+	/**
+	 * Called periodically while the solver is running.
+	 *
+	 * @param progress
+	 *              The state of the solve.
+	 */
+	virtual void onProgress(const SolverProgress& /*progress*/) {}
+};
+
+#endif // INFERENCE_LINEAR_SOLVER_OBSERVER_H__
+
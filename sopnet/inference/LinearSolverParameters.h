@@ -1,7 +1,12 @@
 #ifndef INFERENCE_LINEAR_SOLVER_PARAMETERS_H__
 #define INFERENCE_LINEAR_SOLVER_PARAMETERS_H__
 
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include <pipeline/all.h>
+#include <util/foreach.h>
 
 #include "VariableType.h"
 
@@ -10,10 +15,16 @@ struct LinearSolverParameters : pipeline::Data {
 public:
 
 	LinearSolverParameters() :
-		_variableType(Continuous) {};
+		_variableType(Continuous),
+		_timeLimit(0),
+		_optimalityGap(-1),
+		_numThreads(0) {};
 
 	LinearSolverParameters(const VariableType& variableType) :
-		_variableType(variableType) {}
+		_variableType(variableType),
+		_timeLimit(0),
+		_optimalityGap(-1),
+		_numThreads(0) {}
 
 	/**
 	 * Set the default variable type for all variables.
@@ -46,6 +57,94 @@ public:
 		return _variableTypes;
 	}
 
+	/**
+	 * Set lower and upper bound of a variable. Without explicit bounds, binary 
+	 * variables are bounded by [0,1] and all other variables are unbounded.
+	 */
+	void setBounds(unsigned int var, double lowerBound, double upperBound) {
+
+		_bounds[var] = std::make_pair(lowerBound, upperBound);
+	}
+
+	const std::map<unsigned int, std::pair<double, double> >& getSpecialBounds() const {
+
+		return _bounds;
+	}
+
+	/**
+	 * Get the types of the first numVariables variables as a dense array.
+	 */
+	std::vector<VariableType> getVariableTypes(unsigned int numVariables) const {
+
+		std::vector<VariableType> types(numVariables, _variableType);
+
+		unsigned int var;
+		VariableType type;
+		foreach (boost::tie(var, type), _variableTypes)
+			if (var < numVariables)
+				types[var] = type;
+
+		return types;
+	}
+
+	/**
+	 * Get the lower and upper bounds of the first numVariables variables as 
+	 * dense arrays.
+	 */
+	void getBounds(
+			unsigned int         numVariables,
+			std::vector<double>& lowerBounds,
+			std::vector<double>& upperBounds) const {
+
+		const double inf = std::numeric_limits<double>::infinity();
+
+		std::vector<VariableType> types = getVariableTypes(numVariables);
+
+		lowerBounds.resize(numVariables);
+		upperBounds.resize(numVariables);
+
+		for (unsigned int i = 0; i < numVariables; i++) {
+
+			lowerBounds[i] = (types[i] == Binary ? 0 : -inf);
+			upperBounds[i] = (types[i] == Binary ? 1 :  inf);
+		}
+
+		unsigned int var;
+		std::pair<double, double> bounds;
+		foreach (boost::tie(var, bounds), _bounds) {
+
+			if (var >= numVariables)
+				continue;
+
+			lowerBounds[var] = bounds.first;
+			upperBounds[var] = bounds.second;
+		}
+	}
+
+	/**
+	 * Limit the time of each solve in seconds. The default (0) means no limit.
+	 */
+	void setTimeLimit(double seconds) { _timeLimit = seconds; }
+
+	double getTimeLimit() const { return _timeLimit; }
+
+	/**
+	 * Set the relative optimality gap at which to stop solving. A negative 
+	 * value (the default) keeps the gap configured for the backend.
+	 */
+	void setOptimalityGap(double gap) { _optimalityGap = gap; }
+
+	double getOptimalityGap() const { return _optimalityGap; }
+
+	/**
+	 * Set the number of threads the solver should use. The default (0) keeps 
+	 * the number configured for the backend. Set this when several solvers 
+	 * run concurrently.
+	 */
+	void setNumThreads(unsigned int numThreads) { _numThreads = numThreads; }
+
+	unsigned int getNumThreads() const { return _numThreads; }
+
 private:
 
 	// the default variable type
@@ -53,6 +152,14 @@ private:
 
 	// individual variable types
 	std::map<unsigned int, VariableType> _variableTypes;
+
+	// individual variable bounds
+	std::map<unsigned int, std::pair<double, double> > _bounds;
+
+	// limits for the solver
+	double _timeLimit;
+	double _optimalityGap;
+	unsigned int _numThreads;
 };
 
 #endif // INFERENCE_LINEAR_SOLVER_PARAMETERS_H__
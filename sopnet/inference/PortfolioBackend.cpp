@@ -0,0 +1,379 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "PortfolioBackend.h"
+
+static logger::LogChannel portfoliolog("portfoliolog", "[PortfolioBackend] ");
+
+PortfolioBackend::PortfolioBackend(double timeLimit) :
+	_portfolioTimeLimit(timeLimit),
+	_timeLimit(timeLimit),
+	_sense(Minimize),
+	_numFinished(0),
+	_firstOptimal(-1),
+	_interrupted(false),
+	_observer(0),
+	_backendObserver(*this) {}
+
+void
+PortfolioBackend::addBackend(LinearSolverBackend* backend, const std::string& name) {
+
+	_backends.push_back(boost::shared_ptr<LinearSolverBackend>(backend));
+	_names.push_back(name);
+
+	if (_timeLimit > 0)
+		backend->setTimeLimit(_timeLimit);
+
+	if (_observer)
+		backend->setObserver(&_backendObserver);
+}
+
+void
+PortfolioBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->initialize(numVariables, variableType);
+}
+
+void
+PortfolioBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->initialize(numVariables, defaultVariableType, specialVariableTypes);
+}
+
+void
+PortfolioBackend::initialize(
+		unsigned int                     numVariables,
+		const std::vector<VariableType>& variableTypes,
+		const std::vector<double>&       lowerBounds,
+		const std::vector<double>&       upperBounds) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->initialize(numVariables, variableTypes, lowerBounds, upperBounds);
+}
+
+void
+PortfolioBackend::setObjective(const LinearObjective& objective) {
+
+	_sense = objective.getSense();
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setObjective(objective);
+}
+
+void
+PortfolioBackend::setConstraints(const LinearConstraints& constraints) {
+
+	// convert only once for all backends
+	setConstraints(CompressedLinearConstraints(constraints));
+}
+
+void
+PortfolioBackend::setConstraints(const CompressedLinearConstraints& constraints) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setConstraints(constraints);
+}
+
+void
+PortfolioBackend::pinVariable(unsigned int varNum, double value) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->pinVariable(varNum, value);
+}
+
+bool
+PortfolioBackend::unpinVariable(unsigned int varNum) {
+
+	bool pinned = false;
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		pinned = backend->unpinVariable(varNum) || pinned;
+
+	return pinned;
+}
+
+bool
+PortfolioBackend::supportsIncrementalUpdates() const {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		if (!backend->supportsIncrementalUpdates())
+			return false;
+
+	return true;
+}
+
+void
+PortfolioBackend::setObjectiveCoefficient(unsigned int varNum, double coef) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setObjectiveCoefficient(varNum, coef);
+}
+
+void
+PortfolioBackend::addConstraints(const LinearConstraints& constraints) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->addConstraints(constraints);
+}
+
+void
+PortfolioBackend::setInitialSolution(const Solution& solution) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setInitialSolution(solution);
+}
+
+void
+PortfolioBackend::setTimeLimit(double seconds) {
+
+	// 0 means no limit for this solve, in which case the limit of the 
+	// portfolio stays in effect; otherwise, the smaller limit wins
+	if (seconds <= 0)
+		_timeLimit = _portfolioTimeLimit;
+	else if (_portfolioTimeLimit <= 0)
+		_timeLimit = seconds;
+	else
+		_timeLimit = std::min(seconds, _portfolioTimeLimit);
+
+	// the portfolio stops the race itself after this time, the backends get 
+	// the same limit (or none, if there is no limit)
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setTimeLimit(_timeLimit);
+}
+
+void
+PortfolioBackend::setOptimalityGap(double gap) {
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setOptimalityGap(gap);
+}
+
+void
+PortfolioBackend::setNumThreads(unsigned int numThreads) {
+
+	// the threads are shared by all backends of the portfolio
+	unsigned int threadsPerBackend = std::max<unsigned int>(1, numThreads/std::max<size_t>(1, _backends.size()));
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setNumThreads(threadsPerBackend);
+}
+
+void
+PortfolioBackend::interrupt() {
+
+	boost::mutex::scoped_lock lock(_resultsMutex);
+
+	// stops the next solve, if none is running
+	_interrupted = true;
+
+	interruptRunning();
+
+	_resultsChanged.notify_all();
+}
+
+void
+PortfolioBackend::interruptRunning() {
+
+	// interrupt only the ones that are still running
+	for (unsigned int i = 0; i < _backends.size(); i++)
+		if (i < _results.size() && !_results[i].finished)
+			_backends[i]->interrupt();
+}
+
+void
+PortfolioBackend::setObserver(LinearSolverObserver* observer) {
+
+	_observer = observer;
+
+	foreach (boost::shared_ptr<LinearSolverBackend> backend, _backends)
+		backend->setObserver(_observer ? &_backendObserver : 0);
+}
+
+bool
+PortfolioBackend::solve(Solution& solution, double& value, std::string& message) {
+
+	_winner = "";
+
+	if (_backends.empty()) {
+
+		message = "Portfolio does not contain any backends";
+		return false;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(_resultsMutex);
+
+		// an interrupt while the problem was set up
+		if (_interrupted) {
+
+			_interrupted = false;
+			message = "Solver interrupted";
+
+			return false;
+		}
+
+		_results.clear();
+		_results.resize(_backends.size());
+		_numFinished  = 0;
+		_firstOptimal = -1;
+	}
+
+	_backendObserver.reset();
+
+	LOG_DEBUG(portfoliolog) << "starting " << _backends.size() << " solvers" << std::endl;
+
+	boost::thread_group threads;
+	for (unsigned int i = 0; i < _backends.size(); i++)
+		threads.create_thread(boost::bind(&PortfolioBackend::solveWith, this, i));
+
+	// wait for the first optimal solution, all solvers to finish, or the time 
+	// limit
+	{
+		boost::mutex::scoped_lock lock(_resultsMutex);
+
+		boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(static_cast<long>(_timeLimit*1000));
+
+		while (!_interrupted && _firstOptimal < 0 && _numFinished < _backends.size()) {
+
+			if (_timeLimit > 0) {
+
+				if (!_resultsChanged.timed_wait(lock, deadline)) {
+
+					LOG_USER(portfoliolog) << "time limit reached" << std::endl;
+					break;
+				}
+
+			} else {
+
+				_resultsChanged.wait(lock);
+			}
+		}
+	}
+
+	// stop the ones still running
+	{
+		boost::mutex::scoped_lock lock(_resultsMutex);
+
+		interruptRunning();
+	}
+
+	threads.join_all();
+
+	{
+		boost::mutex::scoped_lock lock(_resultsMutex);
+
+		_interrupted = false;
+	}
+
+	// pick the winner
+	int winner = _firstOptimal;
+
+	if (winner < 0)
+		for (unsigned int i = 0; i < _results.size(); i++)
+			if (_results[i].solution.size() > 0)
+				if (winner < 0 || isBetter(_results[i].value, _results[winner].value))
+					winner = i;
+
+	if (winner < 0) {
+
+		message = "None of the solvers in the portfolio found a solution";
+		foreach (const Result& result, _results)
+			message += "; " + result.message;
+
+		return false;
+	}
+
+	_winner  = _names[winner];
+	solution = _results[winner].solution;
+	value    = _results[winner].value;
+	message  = _results[winner].message + " (by " + _winner + ")";
+
+	LOG_USER(portfoliolog) << "solution provided by " << _winner << std::endl;
+
+	return _results[winner].optimal;
+}
+
+void
+PortfolioBackend::solveWith(unsigned int i) {
+
+	Solution    solution;
+	double      value = 0;
+	std::string message;
+
+	boost::timer::cpu_timer timer;
+
+	bool optimal = _backends[i]->solve(solution, value, message);
+
+	LOG_DEBUG(portfoliolog)
+			<< _names[i] << " finished after " << timer.format(3, "%ws")
+			<< ": " << message << std::endl;
+
+	boost::mutex::scoped_lock lock(_resultsMutex);
+
+	Result& result  = _results[i];
+	result.finished = true;
+	result.optimal  = optimal;
+	result.solution = solution;
+	result.value    = value;
+	result.message  = message;
+
+	if (optimal && _firstOptimal < 0)
+		_firstOptimal = i;
+
+	_numFinished++;
+
+	_resultsChanged.notify_all();
+}
+
+bool
+PortfolioBackend::isBetter(double value, double best) const {
+
+	if (_sense == Minimize)
+		return value < best;
+
+	return value > best;
+}
+
+void
+PortfolioBackend::Observer::reset() {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	_haveIncumbent = false;
+}
+
+void
+PortfolioBackend::Observer::onIncumbent(const Solution& incumbent, const SolverProgress& progress) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_haveIncumbent && !_portfolio.isBetter(progress.incumbentValue, _bestValue))
+		return;
+
+	_haveIncumbent = true;
+	_bestValue     = progress.incumbentValue;
+
+	if (_portfolio._observer)
+		_portfolio._observer->onIncumbent(incumbent, progress);
+}
+
+void
+PortfolioBackend::Observer::onProgress(const SolverProgress& progress) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	if (_portfolio._observer)
+		_portfolio._observer->onProgress(progress);
+}
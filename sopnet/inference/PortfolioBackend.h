@@ -0,0 +1,191 @@
+#ifndef INFERENCE_PORTFOLIO_BACKEND_H__
+#define INFERENCE_PORTFOLIO_BACKEND_H__
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "LinearSolverBackend.h"
+#include "Sense.h"
+
+/**
+ * A linear solver backend that solves the same problem with several backends 
+ * (e.g., the same solver with different settings) concurrently. The first 
+ * backend that finds the optimal solution wins, all others are interrupted. 
+ * If a time limit is set and no backend proved optimality within it, the best 
+ * solution found so far by any backend is returned.
+ */
+class PortfolioBackend : public LinearSolverBackend {
+
+public:
+
+	/**
+	 * Create an empty portfolio. Add backends with addBackend().
+	 *
+	 * @param timeLimit
+	 *              Time limit in seconds for each solve, 0 for no limit. A 
+	 *              limit set later via setTimeLimit() can only shorten it.
+	 */
+	PortfolioBackend(double timeLimit = 0);
+
+	/**
+	 * Add a backend to the portfolio. The portfolio takes ownership of the 
+	 * backend.
+	 *
+	 * @param backend
+	 *              The backend to add.
+	 *
+	 * @param name
+	 *              A description of the configuration of this backend.
+	 */
+	void addBackend(LinearSolverBackend* backend, const std::string& name);
+
+	/**
+	 * @return The number of backends in this portfolio.
+	 */
+	unsigned int size() const { return _backends.size(); }
+
+	/**
+	 * @return The name of the configuration that provided the solution of the 
+	 *         last call to solve(), or an empty string if none did.
+	 */
+	const std::string& getWinner() const { return _winner; }
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void initialize(
+			unsigned int                     numVariables,
+			const std::vector<VariableType>& variableTypes,
+			const std::vector<double>&       lowerBounds,
+			const std::vector<double>&       upperBounds);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	void setConstraints(const CompressedLinearConstraints& constraints);
+
+	void pinVariable(unsigned int varNum, double value);
+
+	bool unpinVariable(unsigned int varNum);
+
+	bool supportsIncrementalUpdates() const;
+
+	void setObjectiveCoefficient(unsigned int varNum, double coef);
+
+	void addConstraints(const LinearConstraints& constraints);
+
+	void setInitialSolution(const Solution& solution);
+
+	void setTimeLimit(double seconds);
+
+	void setOptimalityGap(double gap);
+
+	void setNumThreads(unsigned int numThreads);
+
+	void interrupt();
+
+	/**
+	 * Report the progress of all backends to the given observer. Of the 
+	 * incumbents found by the backends, only the ones that improve on the 
+	 * best one of the portfolio are reported.
+	 */
+	void setObserver(LinearSolverObserver* observer);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	// the result of one backend in the portfolio
+	struct Result {
+
+		Result() : finished(false), optimal(false), value(0) {}
+
+		bool        finished;
+		bool        optimal;
+		Solution    solution;
+		double      value;
+		std::string message;
+	};
+
+	// serializes the calls of the concurrently running backends to the 
+	// observer of the portfolio
+	class Observer : public LinearSolverObserver {
+
+	public:
+
+		Observer(PortfolioBackend& portfolio) : _portfolio(portfolio), _haveIncumbent(false), _bestValue(0) {}
+
+		// prepare for a new solve
+		void reset();
+
+		void onIncumbent(const Solution& incumbent, const SolverProgress& progress);
+
+		void onProgress(const SolverProgress& progress);
+
+	private:
+
+		PortfolioBackend& _portfolio;
+
+		bool   _haveIncumbent;
+		double _bestValue;
+
+		boost::mutex _mutex;
+	};
+
+	// solve with backend i, to be run in its own thread
+	void solveWith(unsigned int i);
+
+	// interrupt the backends that did not finish, yet -- the caller has to 
+	// hold _resultsMutex
+	void interruptRunning();
+
+	// is value a better objective value than the one of the current best?
+	bool isBetter(double value, double best) const;
+
+	std::vector<boost::shared_ptr<LinearSolverBackend> > _backends;
+
+	std::vector<std::string> _names;
+
+	// the time limit given to the constructor
+	double _portfolioTimeLimit;
+
+	// the time limit of the next solve, the smaller of the one of the 
+	// portfolio and the one set via setTimeLimit()
+	double _timeLimit;
+
+	// the sense of the objective, needed to compare solutions
+	Sense _sense;
+
+	std::string _winner;
+
+	// results of the current call to solve() and synchronization
+	std::vector<Result>       _results;
+	unsigned int              _numFinished;
+	int                       _firstOptimal;
+	bool                      _interrupted;
+	boost::mutex              _resultsMutex;
+	boost::condition_variable _resultsChanged;
+
+	// the observer of the portfolio, if any
+	LinearSolverObserver* _observer;
+
+	// the observer given to the backends
+	Observer _backendObserver;
+};
+
+#endif // INFERENCE_PORTFOLIO_BACKEND_H__
+
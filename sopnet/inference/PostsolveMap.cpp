@@ -0,0 +1,47 @@
+#include "PostsolveMap.h"
+
+const unsigned int PostsolveMap::Fixed;
+
+PostsolveMap::PostsolveMap(unsigned int numVariables) {
+
+	clear(numVariables);
+}
+
+void
+PostsolveMap::clear(unsigned int numVariables) {
+
+	_reducedVariables.assign(numVariables, Fixed);
+	_fixedValues.assign(numVariables, 0);
+	_numReducedVariables = 0;
+}
+
+void
+PostsolveMap::fix(unsigned int varNum, double value) {
+
+	_reducedVariables[varNum] = Fixed;
+	_fixedValues[varNum] = value;
+}
+
+unsigned int
+PostsolveMap::keep(unsigned int varNum) {
+
+	_reducedVariables[varNum] = _numReducedVariables;
+
+	return _numReducedVariables++;
+}
+
+void
+PostsolveMap::postsolve(const Solution& reduced, Solution& original) const {
+
+	original.resize(getNumVariables());
+
+	for (unsigned int i = 0; i < getNumVariables(); i++) {
+
+		if (isFixed(i))
+			original[i] = _fixedValues[i];
+		else if (_reducedVariables[i] < reduced.size())
+			original[i] = reduced[_reducedVariables[i]];
+		else
+			original[i] = 0;
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef INFERENCE_POSTSOLVE_MAP_H__
+#define INFERENCE_POSTSOLVE_MAP_H__
+
+#include <vector>
+
+#include <pipeline/all.h>
+#include "Solution.h"
+
+/**
+ * Records how the variables of a problem relate to the variables of its
+ * presolved version: Each original variable is either fixed to a value or
+ * kept as a variable of the presolved problem.
+ */
+class PostsolveMap : public pipeline::Data {
+
+public:
+
+	PostsolveMap(unsigned int numVariables = 0);
+
+	/**
+	 * Reset the map to the given number of original variables, all of them
+	 * unassigned.
+	 */
+	void clear(unsigned int numVariables);
+
+	/**
+	 * Fix an original variable to a value.
+	 */
+	void fix(unsigned int varNum, double value);
+
+	/**
+	 * Keep an original variable as the next variable of the presolved
+	 * problem.
+	 *
+	 * @return The number of the variable in the presolved problem.
+	 */
+	unsigned int keep(unsigned int varNum);
+
+	/**
+	 * @return True, if the given original variable was fixed.
+	 */
+	bool isFixed(unsigned int varNum) const { return _reducedVariables[varNum] == Fixed; }
+
+	/**
+	 * @return The number of the given (not fixed) original variable in the
+	 *         presolved problem.
+	 */
+	unsigned int getReducedVariable(unsigned int varNum) const { return _reducedVariables[varNum]; }
+
+	unsigned int getNumVariables() const { return _reducedVariables.size(); }
+
+	unsigned int getNumReducedVariables() const { return _numReducedVariables; }
+
+	/**
+	 * Map a solution of the presolved problem to the original variables.
+	 */
+	void postsolve(const Solution& reduced, Solution& original) const;
+
+private:
+
+	static const unsigned int Fixed = static_cast<unsigned int>(-1);
+
+	// for each original variable, its number in the presolved problem or
+	// Fixed
+	std::vector<unsigned int> _reducedVariables;
+
+	// the values of the fixed variables
+	std::vector<double> _fixedValues;
+
+	unsigned int _numReducedVariables;
+};
+
+#endif // INFERENCE_POSTSOLVE_MAP_H__
+
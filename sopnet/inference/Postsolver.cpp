@@ -0,0 +1,16 @@
+#include "Postsolver.h"
+
+Postsolver::Postsolver() :
+	_solution(new Solution()) {
+
+	registerInput(_reducedSolution, "solution");
+	registerInput(_postsolveMap, "postsolve map");
+
+	registerOutput(_solution, "solution");
+}
+
+void
+Postsolver::updateOutputs() {
+
+	_postsolveMap->postsolve(*_reducedSolution, *_solution);
+}
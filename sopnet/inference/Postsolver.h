@@ -0,0 +1,38 @@
+#ifndef INFERENCE_POSTSOLVER_H__
+#define INFERENCE_POSTSOLVER_H__
+
+#include <pipeline/all.h>
+#include "PostsolveMap.h"
+#include "Solution.h"
+
+/**
+ * Maps the solution of a problem reduced by the Presolver back to the 
+ * variables of the original problem.
+ *
+ * Inputs:
+ *
+ *   "solution"      Solution       of the presolved problem
+ *   "postsolve map" PostsolveMap   as created by the Presolver
+ *
+ * Outputs:
+ *
+ *   "solution"      Solution       of the original problem
+ */
+class Postsolver : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	Postsolver();
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Input<Solution>     _reducedSolution;
+	pipeline::Input<PostsolveMap> _postsolveMap;
+
+	pipeline::Output<Solution> _solution;
+};
+
+#endif // INFERENCE_POSTSOLVER_H__
+
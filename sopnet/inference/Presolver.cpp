@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include <boost/timer/timer.hpp>
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "Presolver.h"
+
+static logger::LogChannel presolverlog("presolverlog", "[Presolver] ");
+
+// tolerance for comparisons of activities and right hand sides
+static const double Epsilon = 1e-6;
+
+static const double Infinity = std::numeric_limits<double>::infinity();
+
+Presolver::Presolver() :
+	_reducedObjective(new LinearObjective()),
+	_reducedLinearConstraints(new LinearConstraints()),
+	_postsolveMap(new PostsolveMap()) {
+
+	registerInput(_objective, "objective");
+	registerInput(_linearConstraints, "linear constraints");
+
+	registerOutput(_reducedObjective, "objective");
+	registerOutput(_reducedLinearConstraints, "linear constraints");
+	registerOutput(_postsolveMap, "postsolve map");
+}
+
+void
+Presolver::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer("\tPresolver::updateOutputs()\t\t%ws\n");
+
+	initialize();
+
+	unsigned int round = 0;
+	while (true) {
+
+		if (!propagate()) {
+
+			LOG_ERROR(presolverlog) << "problem is infeasible, passing it on unchanged" << std::endl;
+
+			createOriginalProblem();
+			return;
+		}
+
+		unsigned int numFixed = fixDual();
+		numFixed += fixDominated();
+
+		LOG_DEBUG(presolverlog) << "round " << round << ": fixed " << numFixed << " dominated variables" << std::endl;
+
+		if (numFixed == 0)
+			break;
+
+		round++;
+	}
+
+	mergeParallelConstraints();
+
+	createReducedProblem();
+}
+
+void
+Presolver::initialize() {
+
+	unsigned int numVariables = std::max(_objective->size(), _linearConstraints->getNumVariables());
+
+	_constraints.assign(_linearConstraints->begin(), _linearConstraints->end());
+	_removed.assign(_constraints.size(), false);
+	_queued.assign(_constraints.size(), false);
+	_queue.clear();
+
+	_values.assign(numVariables, -1);
+
+	_costs.assign(numVariables, 0);
+	double sense = (_objective->getSense() == Maximize ? -1 : 1);
+	for (unsigned int i = 0; i < _objective->size(); i++)
+		_costs[i] = sense*_objective->getCoefficients()[i];
+
+	_variableConstraints.assign(numVariables, std::vector<unsigned int>());
+	for (unsigned int c = 0; c < _constraints.size(); c++) {
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _constraints[c].getCoefficients())
+			_variableConstraints[varNum].push_back(c);
+
+		queue(c);
+	}
+}
+
+bool
+Presolver::propagate() {
+
+	while (!_queue.empty()) {
+
+		unsigned int c = _queue.front();
+		_queue.pop_front();
+		_queued[c] = false;
+
+		if (_removed[c])
+			continue;
+
+		double minActivity, maxActivity, rhs;
+		getActivity(c, minActivity, maxActivity, rhs);
+
+		Relation relation = _constraints[c].getRelation();
+		bool upper = (relation == LessEqual || relation == Equal);
+		bool lower = (relation == GreaterEqual || relation == Equal);
+
+		if ((upper && minActivity > rhs + Epsilon) || (lower && maxActivity < rhs - Epsilon)) {
+
+			LOG_DEBUG(presolverlog) << "constraint " << c << " can not be satisfied: " << _constraints[c] << std::endl;
+			return false;
+		}
+
+		// the constraint is satisfied for every assignment of the free
+		// variables
+		if ((!upper || maxActivity <= rhs + Epsilon) && (!lower || minActivity >= rhs - Epsilon)) {
+
+			_removed[c] = true;
+			continue;
+		}
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _constraints[c].getCoefficients()) {
+
+			if (_values[varNum] >= 0)
+				continue;
+
+			// the activity bounds of all other variables
+			double minOthers = minActivity - std::min(0.0, coef);
+			double maxOthers = maxActivity - std::max(0.0, coef);
+
+			int value = -1;
+
+			if ((upper && minOthers + coef > rhs + Epsilon) || (lower && maxOthers + coef < rhs - Epsilon))
+				value = 0;
+			else if ((upper && minOthers > rhs + Epsilon) || (lower && maxOthers < rhs - Epsilon))
+				value = 1;
+
+			if (value >= 0) {
+
+				fix(varNum, value);
+
+				// the activity bounds changed, look at this constraint again
+				queue(c);
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+unsigned int
+Presolver::fixDual() {
+
+	unsigned int numFixed = 0;
+
+	for (unsigned int i = 0; i < _values.size(); i++) {
+
+		if (_values[i] >= 0)
+			continue;
+
+		// count the constraints that could be violated by increasing or
+		// decreasing the variable
+		unsigned int upLocks   = 0;
+		unsigned int downLocks = 0;
+
+		foreach (unsigned int c, _variableConstraints[i]) {
+
+			if (_removed[c])
+				continue;
+
+			double coef = _constraints[c].getCoefficients().find(i)->second;
+			Relation relation = _constraints[c].getRelation();
+
+			if (relation == LessEqual || relation == Equal)
+				(coef > 0 ? upLocks : downLocks)++;
+			if (relation == GreaterEqual || relation == Equal)
+				(coef > 0 ? downLocks : upLocks)++;
+		}
+
+		if (_costs[i] >= 0 && downLocks == 0) {
+
+			fix(i, 0);
+			numFixed++;
+
+		} else if (_costs[i] <= 0 && upLocks == 0) {
+
+			fix(i, 1);
+			numFixed++;
+		}
+	}
+
+	return numFixed;
+}
+
+unsigned int
+Presolver::fixDominated() {
+
+	typedef std::vector<std::pair<unsigned int, double> > column_type;
+
+	// group the free variables by their constraint columns
+	std::map<column_type, std::vector<unsigned int> > columns;
+
+	for (unsigned int i = 0; i < _values.size(); i++) {
+
+		if (_values[i] >= 0)
+			continue;
+
+		column_type column;
+		foreach (unsigned int c, _variableConstraints[i])
+			if (!_removed[c])
+				column.push_back(std::make_pair(c, _constraints[c].getCoefficients().find(i)->second));
+
+		if (!column.empty())
+			columns[column].push_back(i);
+	}
+
+	unsigned int numFixed = 0;
+
+	typedef std::map<column_type, std::vector<unsigned int> >::value_type group_type;
+	foreach (const group_type& group, columns) {
+
+		const column_type&               column    = group.first;
+		const std::vector<unsigned int>& variables = group.second;
+
+		if (variables.size() < 2)
+			continue;
+
+		// Any two variables of the group can not be picked together, if one of
+		// the constraints of the column does not allow it. In this case, every
+		// solution that picks a variable of the group can pick the cheapest
+		// one instead.
+		bool exclusive = false;
+
+		unsigned int c;
+		double coef;
+		foreach (boost::tie(c, coef), column) {
+
+			double minActivity, maxActivity, rhs;
+			getActivity(c, minActivity, maxActivity, rhs);
+
+			Relation relation = _constraints[c].getRelation();
+
+			if ((relation == LessEqual || relation == Equal) && coef > 0 && minActivity + 2*coef > rhs + Epsilon)
+				exclusive = true;
+			if ((relation == GreaterEqual || relation == Equal) && coef < 0 && maxActivity + 2*coef < rhs - Epsilon)
+				exclusive = true;
+
+			if (exclusive)
+				break;
+		}
+
+		if (!exclusive)
+			continue;
+
+		unsigned int cheapest = variables[0];
+		foreach (unsigned int i, variables)
+			if (_costs[i] < _costs[cheapest])
+				cheapest = i;
+
+		foreach (unsigned int i, variables)
+			if (i != cheapest) {
+
+				fix(i, 0);
+				numFixed++;
+			}
+	}
+
+	return numFixed;
+}
+
+void
+Presolver::mergeParallelConstraints() {
+
+	// for each set of normalized coefficients, the index of the first
+	// constraint with these coefficients and the merged bounds
+	std::map<std::map<unsigned int, double>, unsigned int>         first;
+	std::map<unsigned int, std::pair<double, double> >             bounds;
+
+	unsigned int numMerged = 0;
+
+	for (unsigned int c = 0; c < _constraints.size(); c++) {
+
+		if (_removed[c])
+			continue;
+
+		double lower, upper;
+		getBounds(c, lower, upper);
+
+		// normalize the free coefficients by the absolute value of the first
+		// one
+		std::map<unsigned int, double> coefficients;
+		double scale = 0;
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _constraints[c].getCoefficients()) {
+
+			if (_values[varNum] >= 0)
+				continue;
+
+			if (scale == 0)
+				scale = std::abs(coef);
+
+			coefficients[varNum] = coef/scale;
+		}
+
+		lower /= scale;
+		upper /= scale;
+
+		std::map<std::map<unsigned int, double>, unsigned int>::iterator i = first.find(coefficients);
+
+		if (i == first.end()) {
+
+			first[coefficients] = c;
+			bounds[c] = std::make_pair(lower, upper);
+
+			continue;
+		}
+
+		std::pair<double, double>& merged = bounds[i->second];
+		merged.first  = std::max(merged.first, lower);
+		merged.second = std::min(merged.second, upper);
+
+		_removed[c] = true;
+		numMerged++;
+	}
+
+	// replace the first constraint of each set by the merged one
+	typedef std::map<std::map<unsigned int, double>, unsigned int>::value_type first_type;
+	foreach (const first_type& f, first) {
+
+		const std::pair<double, double>& merged = bounds[f.second];
+
+		LinearConstraint constraint;
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), f.first)
+			constraint.setCoefficient(varNum, coef);
+
+		if (merged.first == merged.second) {
+
+			constraint.setRelation(Equal);
+			constraint.setValue(merged.first);
+
+		} else if (merged.first == -Infinity) {
+
+			constraint.setRelation(LessEqual);
+			constraint.setValue(merged.second);
+
+		} else if (merged.second == Infinity) {
+
+			constraint.setRelation(GreaterEqual);
+			constraint.setValue(merged.first);
+
+		} else {
+
+			// a ranged constraint, keep the upper bound as a separate
+			// constraint
+			LinearConstraint upper = constraint;
+			upper.setRelation(LessEqual);
+			upper.setValue(merged.second);
+
+			_constraints.push_back(upper);
+			_removed.push_back(false);
+
+			constraint.setRelation(GreaterEqual);
+			constraint.setValue(merged.first);
+		}
+
+		_constraints[f.second] = constraint;
+	}
+
+	LOG_DEBUG(presolverlog) << "merged " << numMerged << " parallel constraints" << std::endl;
+}
+
+void
+Presolver::createReducedProblem() {
+
+	unsigned int numVariables = _values.size();
+
+	_postsolveMap->clear(numVariables);
+
+	double constant = _objective->getConstant();
+
+	for (unsigned int i = 0; i < numVariables; i++) {
+
+		if (_values[i] >= 0) {
+
+			_postsolveMap->fix(i, _values[i]);
+
+			if (i < _objective->size())
+				constant += _values[i]*_objective->getCoefficients()[i];
+
+		} else {
+
+			_postsolveMap->keep(i);
+		}
+	}
+
+	unsigned int numReducedVariables = _postsolveMap->getNumReducedVariables();
+
+	_reducedObjective->resize(numReducedVariables);
+	_reducedObjective->setSense(_objective->getSense());
+	_reducedObjective->setConstant(constant);
+
+	for (unsigned int i = 0; i < numVariables && i < _objective->size(); i++)
+		if (!_postsolveMap->isFixed(i))
+			_reducedObjective->setCoefficient(_postsolveMap->getReducedVariable(i), _objective->getCoefficients()[i]);
+
+	_reducedLinearConstraints->clear();
+
+	for (unsigned int c = 0; c < _constraints.size(); c++) {
+
+		if (_removed[c])
+			continue;
+
+		LinearConstraint constraint;
+
+		double lower, upper;
+		getBounds(c, lower, upper);
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), _constraints[c].getCoefficients())
+			if (_values[varNum] < 0)
+				constraint.setCoefficient(_postsolveMap->getReducedVariable(varNum), coef);
+
+		constraint.setRelation(_constraints[c].getRelation());
+		constraint.setValue(_constraints[c].getRelation() == GreaterEqual ? lower : upper);
+
+		_reducedLinearConstraints->add(constraint);
+	}
+
+	_reducedLinearConstraints->registerVariables(numReducedVariables);
+
+	LOG_USER(presolverlog)
+			<< "reduced problem from " << numVariables << " variables and "
+			<< _linearConstraints->size() << " constraints to "
+			<< numReducedVariables << " variables and "
+			<< _reducedLinearConstraints->size() << " constraints" << std::endl;
+}
+
+void
+Presolver::createOriginalProblem() {
+
+	unsigned int numVariables = _values.size();
+
+	_postsolveMap->clear(numVariables);
+	for (unsigned int i = 0; i < numVariables; i++)
+		_postsolveMap->keep(i);
+
+	*_reducedObjective = *_objective;
+	*_reducedLinearConstraints = *_linearConstraints;
+}
+
+void
+Presolver::fix(unsigned int varNum, int value) {
+
+	LOG_ALL(presolverlog) << "fixing variable " << varNum << " to " << value << std::endl;
+
+	_values[varNum] = value;
+
+	foreach (unsigned int c, _variableConstraints[varNum])
+		queue(c);
+}
+
+void
+Presolver::getActivity(unsigned int constraint, double& minActivity, double& maxActivity, double& rhs) {
+
+	minActivity = 0;
+	maxActivity = 0;
+	rhs         = _constraints[constraint].getValue();
+
+	unsigned int varNum;
+	double coef;
+	foreach (boost::tie(varNum, coef), _constraints[constraint].getCoefficients()) {
+
+		if (_values[varNum] >= 0) {
+
+			rhs -= coef*_values[varNum];
+
+		} else {
+
+			minActivity += std::min(0.0, coef);
+			maxActivity += std::max(0.0, coef);
+		}
+	}
+}
+
+void
+Presolver::getBounds(unsigned int constraint, double& lower, double& upper) {
+
+	double minActivity, maxActivity, rhs;
+	getActivity(constraint, minActivity, maxActivity, rhs);
+
+	Relation relation = _constraints[constraint].getRelation();
+
+	lower = (relation == LessEqual    ? -Infinity : rhs);
+	upper = (relation == GreaterEqual ?  Infinity : rhs);
+}
+
+void
+Presolver::queue(unsigned int constraint) {
+
+	if (_queued[constraint] || _removed[constraint])
+		return;
+
+	_queue.push_back(constraint);
+	_queued[constraint] = true;
+}
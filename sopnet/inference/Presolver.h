@@ -0,0 +1,122 @@
+#ifndef INFERENCE_PRESOLVER_H__
+#define INFERENCE_PRESOLVER_H__
+
+#include <deque>
+#include <vector>
+
+#include <pipeline/all.h>
+#include "LinearConstraints.h"
+#include "LinearObjective.h"
+#include "PostsolveMap.h"
+
+/**
+ * Reduces a binary linear program before it is handed to a solver. Applies
+ * the following reductions until none of them changes the problem anymore:
+ *
+ *   constraint propagation  Fixes variables that can assume only one value
+ *                           given the bounds of the other variables in a
+ *                           constraint (this includes singleton constraints
+ *                           and conflict sets with a variable fixed to one)
+ *                           and removes constraints that can not be violated
+ *                           anymore.
+ *
+ *   dual fixing             Fixes variables to the value preferred by the
+ *                           objective, if no constraint prevents them from
+ *                           moving there.
+ *
+ *   dominated variables     Of variables with identical constraint columns
+ *                           that can not be picked together, fixes all but
+ *                           the cheapest one to zero.
+ *
+ * Finally, parallel constraints are merged into a single one.
+ *
+ * Inputs:
+ *
+ *   "objective"          LinearObjective
+ *   "linear constraints" LinearConstraints
+ *
+ * Outputs:
+ *
+ *   "objective"          LinearObjective     the presolved objective
+ *   "linear constraints" LinearConstraints   the presolved constraints
+ *   "postsolve map"      PostsolveMap        to map solutions of the presolved
+ *                                            problem to the original variables
+ *                                            (see Postsolver)
+ *
+ * If the problem is found to be infeasible, it is passed on unchanged.
+ */
+class Presolver : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	Presolver();
+
+private:
+
+	void updateOutputs();
+
+	// (re-)initialize the working copy of the problem
+	void initialize();
+
+	// propagate the bounds of all queued constraints, returns false if the
+	// problem is infeasible
+	bool propagate();
+
+	// fix variables whose constraints do not prevent the value preferred by
+	// the objective, returns the number of fixed variables
+	unsigned int fixDual();
+
+	// fix dominated variables with identical columns, returns the number of
+	// fixed variables
+	unsigned int fixDominated();
+
+	// merge constraints with identical coefficients
+	void mergeParallelConstraints();
+
+	// create the outputs from the working copy
+	void createReducedProblem();
+
+	// pass the input problem on unchanged
+	void createOriginalProblem();
+
+	void fix(unsigned int varNum, int value);
+
+	// the minimal and maximal activity of the free variables and the right
+	// hand side corrected for the fixed variables of a constraint
+	void getActivity(unsigned int constraint, double& minActivity, double& maxActivity, double& rhs);
+
+	// the left and right hand side bounds of a constraint, substituting fixed
+	// variables
+	void getBounds(unsigned int constraint, double& lower, double& upper);
+
+	void queue(unsigned int constraint);
+
+	pipeline::Input<LinearObjective>   _objective;
+	pipeline::Input<LinearConstraints> _linearConstraints;
+
+	pipeline::Output<LinearObjective>   _reducedObjective;
+	pipeline::Output<LinearConstraints> _reducedLinearConstraints;
+	pipeline::Output<PostsolveMap>      _postsolveMap;
+
+	// the working copy of the constraints
+	std::vector<LinearConstraint> _constraints;
+
+	// constraints that are redundant or have been merged
+	std::vector<bool> _removed;
+
+	// the constraints each variable is involved in
+	std::vector<std::vector<unsigned int> > _variableConstraints;
+
+	// the value of each variable, -1 for free variables
+	std::vector<int> _values;
+
+	// the coefficients of the objective in minimization sense
+	std::vector<double> _costs;
+
+	// constraints to propagate
+	std::deque<unsigned int> _queue;
+	std::vector<bool>        _queued;
+};
+
+#endif // INFERENCE_PRESOLVER_H__
+
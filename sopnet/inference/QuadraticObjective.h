@@ -90,7 +90,7 @@ public:
 	 *
 	 * @return The number of variables in this objective.
 	 */
-	unsigned int size() { return _coefs.size(); }
+	unsigned int size() const { return _coefs.size(); }
 
 private:
 
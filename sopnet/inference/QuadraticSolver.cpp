@@ -76,10 +76,7 @@ QuadraticSolver::getNumVariables() {
 		numVars = std::max(numVars, std::max(pair.first.first + 1, pair.first.second + 1));
 
 	// number of vars in the constraints
-	typedef std::pair<unsigned int, double> lin_coef_type;
-	foreach (const LinearConstraint& constraint, *_linearConstraints)
-		foreach (const lin_coef_type& pair, constraint.getCoefficients())
-			numVars = std::max(numVars, pair.first + 1);
+	numVars = std::max(numVars, _linearConstraints->getNumVariables());
 
 	return numVars;
 }
@@ -19,6 +19,8 @@ public:
 
 	std::vector<double>& getVector() { return _solution; }
 
+	const std::vector<double>& getVector() const { return _solution; }
+
 private:
 
 	std::vector<double> _solution;
@@ -4,6 +4,8 @@
 #include <imageprocessing/ImageStack.h>
 #include <inference/io/RandomForestHdf5Reader.h>
 #include <inference/LinearSolver.h>
+#include <inference/Postsolver.h>
+#include <inference/Presolver.h>
 #include <pipeline/Process.h>
 #include <util/foreach.h>
 #include <util/ProgramOptions.h>
@@ -14,6 +16,7 @@
 #include <sopnet/inference/ProblemAssembler.h>
 #include <sopnet/inference/SubproblemsExtractor.h>
 #include <sopnet/inference/SubproblemsSolver.h>
+#include <sopnet/inference/DualDecompositionSolver.h>
 #include <sopnet/inference/LinearCostFunction.h>
 #include <sopnet/inference/io/LinearCostFunctionParametersReader.h>
 #include <sopnet/inference/RandomForestCostFunction.h>
@@ -69,7 +72,19 @@ util::ProgramOption optionLinearCostFunctionParametersFile(
 util::ProgramOption optionDecomposeProblem(
 		util::_module           = "sopnet.inference",
 		util::_long_name        = "decomposeProblem",
-		util::_description_text = "Decompose the problem into overlapping subproblems and solve them using SCALAR.",
+		util::_description_text = "Decompose the problem into overlapping subproblems and solve them independently.",
+		util::_default_value    = false);
+
+util::ProgramOption optionDualDecomposition(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "dualDecomposition",
+		util::_description_text = "If the problem is decomposed, enforce agreement between overlapping subproblems using dual decomposition.",
+		util::_default_value    = false);
+
+util::ProgramOption optionPresolve(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "presolve",
+		util::_description_text = "Reduce the problem (fix forced and dominated segments, merge parallel constraints) before it is solved. Only used if the problem is not decomposed.",
 		util::_default_value    = false);
 
 util::ProgramOption optionReadGoldStandardFromFile(
@@ -392,13 +407,18 @@ Sopnet::createInferencePipeline() {
 		if (optionDecomposeProblem) {
 
 			pipeline::Process<SubproblemsExtractor> subproblemsExtractor;
-			pipeline::Process<SubproblemsSolver>    subproblemsSolver;
+			boost::shared_ptr<ProcessNode>          subproblemsSolver;
+
+			if (optionDualDecomposition)
+				subproblemsSolver = boost::make_shared<DualDecompositionSolver>();
+			else
+				subproblemsSolver = boost::make_shared<SubproblemsSolver>();
 
 			subproblemsExtractor->setInput("objective", _objectiveGenerator->getOutput());
 			subproblemsExtractor->setInput("linear constraints", _problemAssembler->getOutput("linear constraints"));
 			subproblemsExtractor->setInput("problem configuration", _problemAssembler->getOutput("problem configuration"));
 
-			subproblemsSolver->setInput(subproblemsExtractor->getOutput());
+			subproblemsSolver->setInput("subproblems", subproblemsExtractor->getOutput());
 
 			// feed solution and segments to reconstructor
 			_reconstructor->setInput("solution", subproblemsSolver->getOutput("solution"));
@@ -406,14 +426,37 @@ Sopnet::createInferencePipeline() {
 
 		} else {
 
-			// feed objective and linear constraints to ilp creator
-			_linearSolver->setInput("objective", _objectiveGenerator->getOutput());
-			_linearSolver->setInput("linear constraints", _problemAssembler->getOutput("linear constraints"));
-			_linearSolver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+			if (optionPresolve) {
 
-			// feed solution and segments to reconstructor
-			_reconstructor->setInput("solution", _linearSolver->getOutput("solution"));
-			_reconstructor->setInput("segments", _problemAssembler->getOutput("segments"));
+				pipeline::Process<Presolver>  presolver;
+				pipeline::Process<Postsolver> postsolver;
+
+				presolver->setInput("objective", _objectiveGenerator->getOutput());
+				presolver->setInput("linear constraints", _problemAssembler->getOutput("linear constraints"));
+
+				// feed presolved objective and linear constraints to ilp creator
+				_linearSolver->setInput("objective", presolver->getOutput("objective"));
+				_linearSolver->setInput("linear constraints", presolver->getOutput("linear constraints"));
+				_linearSolver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+
+				postsolver->setInput("solution", _linearSolver->getOutput("solution"));
+				postsolver->setInput("postsolve map", presolver->getOutput("postsolve map"));
+
+				// feed solution and segments to reconstructor
+				_reconstructor->setInput("solution", postsolver->getOutput("solution"));
+				_reconstructor->setInput("segments", _problemAssembler->getOutput("segments"));
+
+			} else {
+
+				// feed objective and linear constraints to ilp creator
+				_linearSolver->setInput("objective", _objectiveGenerator->getOutput());
+				_linearSolver->setInput("linear constraints", _problemAssembler->getOutput("linear constraints"));
+				_linearSolver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+
+				// feed solution and segments to reconstructor
+				_reconstructor->setInput("solution", _linearSolver->getOutput("solution"));
+				_reconstructor->setInput("segments", _problemAssembler->getOutput("segments"));
+			}
 		}
 	}
 
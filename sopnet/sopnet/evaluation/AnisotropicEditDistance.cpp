@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/helpers.hpp>
@@ -10,10 +12,17 @@ util::ProgramOption optionEvaluatinMinOverlap(
 		util::_long_name        = "minOverlap",
 		util::_description_text = "The minimal normalized overlap between a result and ground-truth slice to consider them as a match.");
 
+util::ProgramOption optionAedMaxMappings(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "aedMaxMappings",
+		util::_description_text = "The maximal number of mappings of a section to enumerate for the anisotropic edit distance. Sections with more possible mappings use the mapping to all partners, which is optimal as well.",
+		util::_default_value    = 1024);
+
 AnisotropicEditDistance::AnisotropicEditDistance(double minOverlap) :
 	_errors(new AnisotropicEditDistanceErrors()),
 	_overlap(true /* normalize */, false /* don't align */),
-	_minOverlap(optionEvaluatinMinOverlap ? optionEvaluatinMinOverlap : minOverlap) {
+	_minOverlap(optionEvaluatinMinOverlap ? optionEvaluatinMinOverlap : minOverlap),
+	_maxMappings(optionAedMaxMappings) {
 
 	registerInput(_result, "result");
 	registerInput(_groundTruth, "ground truth");
@@ -205,10 +214,40 @@ AnisotropicEditDistance::getAllMappings(unsigned int section) {
 		}
 	}
 
-	// Recursively get all possible mappings.
 	Mappings mappings;
 	Mapping  currentMapping;
 
+	// Mapping a result slice to more of its partners never introduces errors: 
+	// It can only cover more ground-truth slices (less false negatives) and 
+	// explain more links (less false splits and merges), for any mapping of 
+	// the neighboring sections. Hence, the mapping to all partners is among 
+	// the optimal ones. Enumerating all mappings is exponential in the number 
+	// of partners -- if there are too many, take the mapping to all partners 
+	// right away.
+
+	double numMappings = 1;
+	int resultId;
+	std::vector<int> partners;
+	foreach (boost::tie(resultId, partners), resultPartners)
+		numMappings *= std::pow(2.0, static_cast<double>(partners.size())) - 1;
+
+	if (numMappings > _maxMappings) {
+
+		LOG_DEBUG(resultevaluatorlog)
+				<< "section " << section << " has " << numMappings
+				<< " possible mappings, using mapping to all partners" << std::endl;
+
+		foreach (boost::tie(resultId, partners), resultPartners)
+			foreach (int partner, partners)
+				currentMapping.push_back(std::make_pair(resultId, partner));
+
+		mappings.push_back(currentMapping);
+
+		return mappings;
+	}
+
+	// Recursively get all possible mappings.
+
 	createMappings(mappings, currentMapping, resultPartners, resultSlices, (unsigned int)0);
 
 	LOG_ALL(resultevaluatorlog) << mappings.size() << " mappings found" << std::endl;
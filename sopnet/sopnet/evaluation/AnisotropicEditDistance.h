@@ -78,6 +78,9 @@ private:
 
 	double _minOverlap;
 
+	// the maximal number of mappings to enumerate per section
+	double _maxMappings;
+
 	// all slices sorted by sections
 	std::vector<std::vector<boost::shared_ptr<Slice> > > _resultSlices;
 	std::vector<std::vector<boost::shared_ptr<Slice> > > _groundTruthSlices;
@@ -1,7 +1,11 @@
 #ifndef SOPNET_EVALUATION_CELL_H__
 #define SOPNET_EVALUATION_CELL_H__
 
+#include <algorithm>
 #include <set>
+#include <vector>
+
+#include <boost/iterator/iterator_facade.hpp>
 
 /**
  * A cell is a set of connected locations build by intersecting a connected 
@@ -11,6 +15,10 @@
  * Cells are annotated with their original reconstruction label, as well as 
  * possible alternative reconstruction labels according to an external tolerance 
  * criterion.
+ *
+ * The locations are stored as runs of consecutive locations in x. Adding the 
+ * locations in scan-line order (x fastest, then y, then z) results in the 
+ * most compact representation.
  */
 template <typename LabelType>
 class Cell {
@@ -47,6 +55,62 @@ public:
 		}
 	};
 
+	/**
+	 * A run of consecutive locations in x, starting at (x, y, z).
+	 */
+	struct Run {
+
+		Run(int x_, int y_, int z_, unsigned int length_) :
+			x(x_), y(y_), z(z_), length(length_) {}
+
+		int x, y, z;
+
+		unsigned int length;
+	};
+
+	/**
+	 * Iterator over the locations of a cell.
+	 */
+	class const_iterator : public boost::iterator_facade<const_iterator, const Location, boost::forward_traversal_tag, Location> {
+
+	public:
+
+		const_iterator() : _offset(0) {}
+
+		const_iterator(typename std::vector<Run>::const_iterator run) : _run(run), _offset(0) {}
+
+	private:
+
+		friend class boost::iterator_core_access;
+
+		void increment() {
+
+			if (++_offset == _run->length) {
+
+				++_run;
+				_offset = 0;
+			}
+		}
+
+		bool equal(const const_iterator& other) const {
+
+			return _run == other._run && _offset == other._offset;
+		}
+
+		Location dereference() const {
+
+			return Location(_run->x + _offset, _run->y, _run->z);
+		}
+
+		typename std::vector<Run>::const_iterator _run;
+
+		unsigned int _offset;
+	};
+
+	typedef const_iterator iterator;
+
+	Cell() : _size(0) {}
+
 	/**
 	 * Set the original reconstruction label of this cell.
 	 */
@@ -96,11 +160,35 @@ public:
 	}
 
 	/**
-	 * Add a location to this cell.
+	 * Add a location to this cell. If the location directly follows the last 
+	 * added one in x, the last run is extended.
 	 */
 	void add(const Location& l) {
 
-		_content.push_back(l);
+		if (!_runs.empty()) {
+
+			Run& last = _runs.back();
+
+			if (last.z == l.z && last.y == l.y && last.x + static_cast<int>(last.length) == l.x) {
+
+				last.length++;
+				_size++;
+				return;
+			}
+		}
+
+		_runs.push_back(Run(l.x, l.y, l.z, 1));
+		_size++;
+	}
+
+	/**
+	 * Add all locations of another cell to this cell.
+	 */
+	void merge(const Cell<LabelType>& other) {
+
+		_runs.insert(_runs.end(), other._runs.begin(), other._runs.end());
+		_boundary.insert(_boundary.end(), other._boundary.begin(), other._boundary.end());
+		_size += other._size;
 	}
 
 	/**
@@ -112,56 +200,53 @@ public:
 	}
 
 	/**
-	 * Remove a location from this cell. Returns false, if the location was not 
-	 * part of this cell.
+	 * Get the number of locations in this cell.
 	 */
-	bool remove(const Location& l) {
-
-		iterator i = _content.find(l);
-
-		if (i != _content.end())
-			_content.erase(i);
-		else
-			return false;
+	unsigned int size() const {
 
-		return true;
+		return _size;
 	}
 
-	bool removeBoundary(const Location& l) {
+	const std::vector<Location>& getBoundary() const {
 
-		iterator i = _boundary.find(l);
+		return _boundary;
+	}
 
-		if (i != _boundary.end())
-			_boundary.erase(i);
-		else
-			return false;
+	/**
+	 * Get the runs of locations that constitute this cell.
+	 */
+	const std::vector<Run>& getRuns() const {
 
-		return true;
+		return _runs;
 	}
 
 	/**
-	 * Get the number of locations in this cell.
+	 * Free memory that was reserved for additional runs.
 	 */
-	unsigned int size() const {
+	void shrink() {
 
-		return _content.size();
+		std::vector<Run>(_runs).swap(_runs);
 	}
 
-	const std::vector<Location>& getBoundary() const {
-
-		return _boundary;
+	/**
+	 * Exchange the content of this cell with another one, without copying the 
+	 * locations.
+	 */
+	void swap(Cell<LabelType>& other) {
+
+		std::swap(_label, other._label);
+		std::swap(_groundTruthLabel, other._groundTruthLabel);
+		std::swap(_size, other._size);
+		_alternativeLabels.swap(other._alternativeLabels);
+		_runs.swap(other._runs);
+		_boundary.swap(other._boundary);
 	}
 
 	/**
 	 * Iterator access to the locations of the cell.
 	 */
-	typedef typename std::vector<Location>::iterator       iterator;
-	typedef typename std::vector<Location>::const_iterator const_iterator;
-
-	iterator begin() { return _content.begin(); }
-	iterator end() { return _content.end(); }
-	const_iterator begin() const { return _content.begin(); }
-	const_iterator end() const { return _content.end(); }
+	const_iterator begin() const { return const_iterator(_runs.begin()); }
+	const_iterator end() const { return const_iterator(_runs.end()); }
 
 private:
 
@@ -175,8 +260,11 @@ private:
 	// criterion
 	std::set<LabelType> _alternativeLabels;
 
-	// the volume locations that constitute this cell
-	std::vector<Location> _content;
+	// the volume locations that constitute this cell, as runs in x
+	std::vector<Run> _runs;
+
+	// the number of locations in this cell
+	unsigned int _size;
 
 	// the locations that are forming the boundary
 	std::vector<Location> _boundary;
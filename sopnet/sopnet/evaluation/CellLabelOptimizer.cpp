@@ -0,0 +1,559 @@
+#include <algorithm>
+#include <limits>
+
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include "CellLabelOptimizer.h"
+
+logger::LogChannel celllabeloptimizerlog("celllabeloptimizerlog", "[CellLabelOptimizer] ");
+
+namespace {
+
+// a choice for cells that have not been assigned a label yet
+const unsigned int Unassigned = std::numeric_limits<unsigned int>::max();
+
+// tolerance for comparing costs
+const double Epsilon = 1e-12;
+
+unsigned int
+getId(std::map<float, unsigned int>& ids, float label) {
+
+	std::map<float, unsigned int>::iterator i = ids.find(label);
+
+	if (i != ids.end())
+		return i->second;
+
+	unsigned int id = ids.size();
+	ids[label] = id;
+
+	return id;
+}
+
+} // anonymous namespace
+
+CellLabelOptimizer::CellLabelOptimizer(unsigned int maxExactCells, unsigned int maxExactNodes) :
+	_maxExactCells(maxExactCells),
+	_maxExactNodes(maxExactNodes),
+	_numComponents(0),
+	_numOptimalComponents(0),
+	_gap(0) {}
+
+void
+CellLabelOptimizer::optimize(
+		const std::vector<cell_t>& cells,
+		const std::set<float>& reconstructionLabels,
+		double volumeSize,
+		std::vector<unsigned int>& choices) {
+
+	choices.assign(cells.size(), 0);
+
+	std::vector<unsigned int> all(cells.size());
+	for (unsigned int i = 0; i < cells.size(); i++)
+		all[i] = i;
+
+	solve(cells, all, reconstructionLabels, volumeSize, choices);
+}
+
+void
+CellLabelOptimizer::reoptimize(
+		const std::vector<cell_t>& cells,
+		const std::vector<unsigned int>& subset,
+		const std::set<float>& reconstructionLabels,
+		double volumeSize,
+		std::vector<unsigned int>& choices) {
+
+	choices.resize(cells.size(), 0);
+
+	solve(cells, subset, reconstructionLabels, volumeSize, choices);
+}
+
+void
+CellLabelOptimizer::solve(
+		const std::vector<cell_t>& cells,
+		const std::vector<unsigned int>& subset,
+		const std::set<float>& reconstructionLabels,
+		double volumeSize,
+		std::vector<unsigned int>& choices) {
+
+	_numComponents        = 0;
+	_numOptimalComponents = 0;
+	_gap                  = 0;
+
+	// get dense label ids and the options of each cell of the subset, all 
+	// following indices are positions in the subset
+
+	std::map<float, unsigned int> gtIds;
+	std::map<float, unsigned int> recIds;
+
+	unsigned int numCells = subset.size();
+
+	_cellIndices = subset;
+	_gtIds.resize(numCells);
+	_options.clear();
+	_options.resize(numCells);
+
+	for (unsigned int i = 0; i < numCells; i++) {
+
+		const cell_t& cell = cells[subset[i]];
+
+		_gtIds[i] = getId(gtIds, cell.getGroundTruthLabel());
+
+		// keeping the label is for free
+		_options[i].push_back(Option(getId(recIds, cell.getReconstructionLabel()), 0));
+
+		// changing it costs a fraction of a split or merge, proportional to 
+		// the size of the cell
+		foreach (float label, cell.getAlternativeLabels())
+			_options[i].push_back(Option(getId(recIds, label), cell.size()/(volumeSize + 1)));
+	}
+
+	foreach (float label, reconstructionLabels)
+		getId(recIds, label);
+
+	unsigned int numGtLabels  = gtIds.size();
+	unsigned int numRecLabels = recIds.size();
+
+	// cells without alternatives determine pairs of labels and cover 
+	// reconstruction labels already
+
+	std::vector<bool> covered(numRecLabels, false);
+
+	_fixedPairs.clear();
+	for (unsigned int i = 0; i < numCells; i++)
+		if (_options[i].size() == 1) {
+
+			_fixedPairs.insert(std::make_pair(_gtIds[i], _options[i][0].rec));
+			covered[_options[i][0].rec] = true;
+			choices[subset[i]] = 0;
+		}
+
+	// group the remaining cells into components that share labels
+
+	_parents.resize(numGtLabels + numRecLabels);
+	for (unsigned int i = 0; i < _parents.size(); i++)
+		_parents[i] = i;
+
+	std::vector<bool> isOption(numRecLabels, false);
+
+	for (unsigned int i = 0; i < numCells; i++) {
+
+		if (_options[i].size() == 1)
+			continue;
+
+		foreach (const Option& option, _options[i]) {
+
+			_parents[findRoot(_gtIds[i])] = findRoot(numGtLabels + option.rec);
+			isOption[option.rec] = true;
+		}
+	}
+
+	std::map<unsigned int, std::vector<unsigned int> > components;
+	for (unsigned int i = 0; i < numCells; i++)
+		if (_options[i].size() > 1)
+			components[findRoot(_gtIds[i])].push_back(i);
+
+	// reconstruction labels that are not covered yet have to be chosen by one 
+	// of the remaining cells
+
+	_needed.assign(numRecLabels, false);
+
+	foreach (float label, reconstructionLabels) {
+
+		unsigned int rec = recIds[label];
+
+		if (covered[rec])
+			continue;
+
+		if (!isOption[rec]) {
+
+			LOG_ERROR(celllabeloptimizerlog) << "reconstruction label " << label << " can not be assigned to any cell" << std::endl;
+			continue;
+		}
+
+		_needed[rec] = true;
+	}
+
+	LOG_DEBUG(celllabeloptimizerlog) << "solving " << components.size() << " components" << std::endl;
+
+	unsigned int root;
+	std::vector<unsigned int> component;
+	foreach (boost::tie(root, component), components) {
+
+		solveComponent(component, choices);
+		_numComponents++;
+	}
+
+	LOG_DEBUG(celllabeloptimizerlog)
+			<< "solved " << _numOptimalComponents << " of " << _numComponents
+			<< " components to optimality, gap is at most " << _gap << std::endl;
+}
+
+void
+CellLabelOptimizer::solveComponent(const std::vector<unsigned int>& cells, std::vector<unsigned int>& choices) {
+
+	// start with all cells keeping their label
+	Assignment assignment(*this, cells);
+	for (unsigned int i = 0; i < cells.size(); i++)
+		assignment.set(i, 0);
+
+	repair(assignment);
+	localSearch(assignment);
+
+	bool optimal = false;
+
+	if (cells.size() <= _maxExactCells) {
+
+		std::vector<unsigned int> bestChoices = assignment.getChoices();
+		double bestCost = (assignment.isFeasible() ? assignment.getCost() : std::numeric_limits<double>::infinity());
+
+		Assignment partial(*this, cells);
+		unsigned int numNodes = 0;
+
+		optimal = branchAndBound(partial, bestChoices, bestCost, 0, numNodes);
+
+		for (unsigned int i = 0; i < cells.size(); i++)
+			assignment.set(i, bestChoices[i]);
+	}
+
+	if (optimal)
+		_numOptimalComponents++;
+	else
+		_gap += std::max(0.0, assignment.getCost() - lowerBound(cells));
+
+	for (unsigned int i = 0; i < cells.size(); i++)
+		choices[_cellIndices[cells[i]]] = assignment.get(i);
+}
+
+void
+CellLabelOptimizer::repair(Assignment& assignment) {
+
+	if (assignment.isFeasible())
+		return;
+
+	// Every needed label has to be chosen by a different cell. Find a 
+	// matching of needed labels to cells that have them as an option, with 
+	// augmenting paths.
+
+	unsigned int numCells = assignment.getChoices().size();
+
+	// the cells and their choices that can provide each needed label
+	std::map<unsigned int, std::vector<std::pair<unsigned int, unsigned int> > > providers;
+
+	for (unsigned int i = 0; i < numCells; i++) {
+
+		const std::vector<Option>& options = _options[assignment.getCell(i)];
+
+		for (unsigned int choice = 0; choice < options.size(); choice++)
+			if (_needed[options[choice].rec])
+				providers[options[choice].rec].push_back(std::make_pair(i, choice));
+	}
+
+	// the label each cell is matched to
+	std::vector<unsigned int> matchedLabels(numCells, Unassigned);
+	std::vector<unsigned int> matchedChoices(numCells, Unassigned);
+
+	unsigned int label;
+	std::vector<std::pair<unsigned int, unsigned int> > cells;
+	foreach (boost::tie(label, cells), providers) {
+
+		std::vector<bool> visited(numCells, false);
+
+		if (!augment(label, providers, matchedLabels, matchedChoices, visited)) {
+
+			LOG_ERROR(celllabeloptimizerlog) << "not all reconstruction labels of a component can be assigned to a cell" << std::endl;
+			return;
+		}
+	}
+
+	for (unsigned int i = 0; i < numCells; i++)
+		if (matchedLabels[i] != Unassigned)
+			assignment.set(i, matchedChoices[i]);
+}
+
+bool
+CellLabelOptimizer::augment(
+		unsigned int label,
+		const std::map<unsigned int, std::vector<std::pair<unsigned int, unsigned int> > >& providers,
+		std::vector<unsigned int>& matchedLabels,
+		std::vector<unsigned int>& matchedChoices,
+		std::vector<bool>& visited) {
+
+	unsigned int i, choice;
+	foreach (boost::tie(i, choice), providers.find(label)->second) {
+
+		if (visited[i])
+			continue;
+
+		visited[i] = true;
+
+		if (matchedLabels[i] == Unassigned || augment(matchedLabels[i], providers, matchedLabels, matchedChoices, visited)) {
+
+			matchedLabels[i]  = label;
+			matchedChoices[i] = choice;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+CellLabelOptimizer::localSearch(Assignment& assignment) {
+
+	const unsigned int maxPasses = 100;
+
+	typedef std::pair<unsigned int, unsigned int> pair_t;
+
+	bool improved = true;
+	for (unsigned int pass = 0; improved && pass < maxPasses; pass++) {
+
+		improved = false;
+
+		// move single cells
+
+		for (unsigned int i = 0; i < assignment.getChoices().size(); i++) {
+
+			unsigned int current = assignment.get(i);
+
+			for (unsigned int choice = 0; choice < _options[assignment.getCell(i)].size(); choice++) {
+
+				if (choice == current)
+					continue;
+
+				bool   wasFeasible = assignment.isFeasible();
+				double cost        = assignment.getCost();
+
+				assignment.set(i, choice);
+
+				if (assignment.isFeasible() && (!wasFeasible || assignment.getCost() < cost - Epsilon)) {
+
+					current  = choice;
+					improved = true;
+
+				} else {
+
+					assignment.set(i, current);
+				}
+			}
+		}
+
+		// move all cells of a pair of labels to another reconstruction label, 
+		// this can remove a pair without adding a new one
+
+		std::map<pair_t, std::vector<unsigned int> > pairs;
+		for (unsigned int i = 0; i < assignment.getChoices().size(); i++) {
+
+			unsigned int cell = assignment.getCell(i);
+			pairs[std::make_pair(_gtIds[cell], _options[cell][assignment.get(i)].rec)].push_back(i);
+		}
+
+		pair_t pair;
+		std::vector<unsigned int> members;
+		foreach (boost::tie(pair, members), pairs) {
+
+			// all reconstruction labels the members can be moved to
+			std::set<unsigned int> targets;
+			foreach (unsigned int i, members)
+				foreach (const Option& option, _options[assignment.getCell(i)])
+					if (option.rec != pair.second)
+						targets.insert(option.rec);
+
+			foreach (unsigned int target, targets) {
+
+				// the members might have been moved by a previous target
+				if (_options[assignment.getCell(members[0])][assignment.get(members[0])].rec != pair.second)
+					break;
+
+				bool   wasFeasible = assignment.isFeasible();
+				double cost        = assignment.getCost();
+
+				std::vector<std::pair<unsigned int, unsigned int> > moved;
+
+				foreach (unsigned int i, members) {
+
+					const std::vector<Option>& options = _options[assignment.getCell(i)];
+
+					for (unsigned int choice = 0; choice < options.size(); choice++)
+						if (options[choice].rec == target) {
+
+							moved.push_back(std::make_pair(i, assignment.get(i)));
+							assignment.set(i, choice);
+							break;
+						}
+				}
+
+				if (assignment.isFeasible() && (!wasFeasible || assignment.getCost() < cost - Epsilon)) {
+
+					improved = true;
+
+				} else {
+
+					for (unsigned int j = 0; j < moved.size(); j++)
+						assignment.set(moved[j].first, moved[j].second);
+				}
+			}
+		}
+	}
+}
+
+bool
+CellLabelOptimizer::branchAndBound(
+		Assignment& assignment,
+		std::vector<unsigned int>& bestChoices,
+		double& bestCost,
+		unsigned int i,
+		unsigned int& numNodes) {
+
+	if (numNodes >= _maxExactNodes)
+		return false;
+
+	numNodes++;
+
+	// costs can only increase with more assigned cells
+	if (assignment.getCost() >= bestCost - Epsilon)
+		return true;
+
+	if (i == assignment.getChoices().size()) {
+
+		if (assignment.isFeasible()) {
+
+			bestChoices = assignment.getChoices();
+			bestCost    = assignment.getCost();
+		}
+
+		return true;
+	}
+
+	unsigned int numOptions = _options[assignment.getCell(i)].size();
+
+	// try the choice of the best assignment first
+	unsigned int first = bestChoices[i];
+
+	for (unsigned int k = 0; k < numOptions; k++) {
+
+		unsigned int choice = (k == 0 ? first : (k <= first ? k - 1 : k));
+
+		assignment.set(i, choice);
+
+		if (!branchAndBound(assignment, bestChoices, bestCost, i + 1, numNodes)) {
+
+			assignment.set(i, Unassigned);
+			return false;
+		}
+	}
+
+	assignment.set(i, Unassigned);
+
+	return true;
+}
+
+double
+CellLabelOptimizer::lowerBound(const std::vector<unsigned int>& cells) {
+
+	// every ground-truth label with a cell that can not be assigned to a 
+	// fixed pair needs at least one additional pair
+	std::set<unsigned int> unfixedGtLabels;
+
+	foreach (unsigned int cell, cells) {
+
+		bool canBeFixed = false;
+		foreach (const Option& option, _options[cell])
+			if (isFixedPair(_gtIds[cell], option.rec))
+				canBeFixed = true;
+
+		if (!canBeFixed)
+			unfixedGtLabels.insert(_gtIds[cell]);
+	}
+
+	return 2.0*unfixedGtLabels.size();
+}
+
+unsigned int
+CellLabelOptimizer::findRoot(unsigned int node) {
+
+	unsigned int root = node;
+	while (_parents[root] != root)
+		root = _parents[root];
+
+	// compress the path
+	while (_parents[node] != root) {
+
+		unsigned int next = _parents[node];
+		_parents[node] = root;
+		node = next;
+	}
+
+	return root;
+}
+
+CellLabelOptimizer::Assignment::Assignment(CellLabelOptimizer& optimizer, const std::vector<unsigned int>& cells) :
+	_optimizer(optimizer),
+	_cells(cells),
+	_choices(cells.size(), Unassigned),
+	_numMissing(0),
+	_cost(0) {
+
+	// count the needed labels this component can provide
+	std::set<unsigned int> needed;
+	foreach (unsigned int cell, cells)
+		foreach (const Option& option, _optimizer._options[cell])
+			if (_optimizer._needed[option.rec])
+				needed.insert(option.rec);
+
+	_numMissing = needed.size();
+}
+
+void
+CellLabelOptimizer::Assignment::set(unsigned int i, unsigned int choice) {
+
+	if (_choices[i] != Unassigned)
+		remove(i);
+
+	_choices[i] = choice;
+
+	if (_choices[i] != Unassigned)
+		add(i);
+}
+
+void
+CellLabelOptimizer::Assignment::add(unsigned int i) {
+
+	unsigned int  cell   = _cells[i];
+	const Option& option = _optimizer._options[cell][_choices[i]];
+	unsigned int  gt     = _optimizer._gtIds[cell];
+
+	// each new pair of labels is one split and one merge
+	if (++_pairCounts[std::make_pair(gt, option.rec)] == 1 && !_optimizer.isFixedPair(gt, option.rec))
+		_cost += 2;
+
+	_cost += option.cost;
+
+	if (_optimizer._needed[option.rec])
+		if (++_recCounts[option.rec] == 1)
+			_numMissing--;
+}
+
+void
+CellLabelOptimizer::Assignment::remove(unsigned int i) {
+
+	unsigned int  cell   = _cells[i];
+	const Option& option = _optimizer._options[cell][_choices[i]];
+	unsigned int  gt     = _optimizer._gtIds[cell];
+
+	std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator count = _pairCounts.find(std::make_pair(gt, option.rec));
+
+	if (--count->second == 0) {
+
+		_pairCounts.erase(count);
+
+		if (!_optimizer.isFixedPair(gt, option.rec))
+			_cost -= 2;
+	}
+
+	_cost -= option.cost;
+
+	if (_optimizer._needed[option.rec])
+		if (--_recCounts[option.rec] == 0)
+			_numMissing++;
+}
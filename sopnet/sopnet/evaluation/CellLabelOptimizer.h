@@ -0,0 +1,243 @@
+#ifndef SOPNET_EVALUATION_CELL_LABEL_OPTIMIZER_H__
+#define SOPNET_EVALUATION_CELL_LABEL_OPTIMIZER_H__
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Cell.h"
+
+/**
+ * Finds the labels of cells that minimize the number of splits and merges of 
+ * the tolerant edit distance. Among equally good labelings, the one that 
+ * relabels the least volume is preferred. This is the same objective as the 
+ * one of the ILP in TolerantEditDistance, but solved without a general 
+ * purpose solver:
+ *
+ * Cells without alternative labels keep their label. The remaining cells are 
+ * grouped into independent components, i.e., sets of cells that are connected 
+ * via shared ground-truth or reconstruction labels. Each component is solved 
+ * with a greedy assignment improved by local search and, if it has at most 
+ * maxExactCells cells, with a branch and bound search to optimality.
+ */
+class CellLabelOptimizer {
+
+public:
+
+	typedef Cell<float> cell_t;
+
+	/**
+	 * Create a new optimizer.
+	 *
+	 * @param maxExactCells 
+	 *             The maximal number of cells with alternative labels in a 
+	 *             component to solve it to optimality.
+	 * @param maxExactNodes 
+	 *             The maximal number of nodes to visit in the branch and bound 
+	 *             search for each component.
+	 */
+	CellLabelOptimizer(unsigned int maxExactCells = 20, unsigned int maxExactNodes = 1000000);
+
+	/**
+	 * Find the best labels for the given cells.
+	 *
+	 * @param cells 
+	 *             The cells with their alternative labels.
+	 * @param reconstructionLabels 
+	 *             The reconstruction labels that have to be assigned to at 
+	 *             least one cell.
+	 * @param volumeSize 
+	 *             The number of locations in the volume, used to weigh the 
+	 *             relabeled volume against splits and merges.
+	 * @param choices [out] 
+	 *             The label of each cell: 0 for the reconstruction label, i > 0 
+	 *             for the ith alternative label.
+	 */
+	void optimize(
+			const std::vector<cell_t>& cells,
+			const std::set<float>& reconstructionLabels,
+			double volumeSize,
+			std::vector<unsigned int>& choices);
+
+	/**
+	 * Find the best labels for a subset of the cells after some of them 
+	 * changed. The subset has to contain all cells with alternative labels of 
+	 * the components that have to be solved again, and all cells without 
+	 * alternative labels that share a label with them. The labels of all other 
+	 * cells are kept, such that the time spent is proportional to the size of 
+	 * the subset. Used to update the labels incrementally (see 
+	 * IncrementalTolerantEditDistance).
+	 *
+	 * @param cells 
+	 *             All cells with their alternative labels.
+	 * @param subset 
+	 *             The indices of the cells to find the labels for.
+	 * @param reconstructionLabels 
+	 *             The reconstruction labels of the cells in the subset.
+	 * @param volumeSize 
+	 *             The number of locations in the volume.
+	 * @param choices [in/out] 
+	 *             The label of each cell. Only the ones of the cells in the 
+	 *             subset are changed.
+	 */
+	void reoptimize(
+			const std::vector<cell_t>& cells,
+			const std::vector<unsigned int>& subset,
+			const std::set<float>& reconstructionLabels,
+			double volumeSize,
+			std::vector<unsigned int>& choices);
+
+	/**
+	 * Get the number of components that have been solved in the last call to 
+	 * optimize() or reoptimize().
+	 */
+	unsigned int getNumComponents() const { return _numComponents; }
+
+	/**
+	 * Get the number of components that have been solved to optimality.
+	 */
+	unsigned int getNumOptimalComponents() const { return _numOptimalComponents; }
+
+	/**
+	 * Get an upper bound on the number of splits and merges the found labeling 
+	 * has more than the optimal one. 0 if all components have been solved to 
+	 * optimality.
+	 */
+	double getGap() const { return _gap; }
+
+private:
+
+	// one possible label of a cell
+	struct Option {
+
+		Option(unsigned int rec_, double cost_) : rec(rec_), cost(cost_) {}
+
+		// the dense id of the reconstruction label
+		unsigned int rec;
+
+		// the cost of relabeling the cell to this label
+		double cost;
+	};
+
+	// the labels of the cells of a component and the resulting costs
+	class Assignment {
+
+	public:
+
+		Assignment(CellLabelOptimizer& optimizer, const std::vector<unsigned int>& cells);
+
+		// change the label of the ith cell of the component
+		void set(unsigned int i, unsigned int choice);
+
+		unsigned int get(unsigned int i) const { return _choices[i]; }
+
+		// get the index of the ith cell of the component
+		unsigned int getCell(unsigned int i) const { return _cells[i]; }
+
+		double getCost() const { return _cost; }
+
+		// is every reconstruction label that needs a cell assigned to one?
+		bool isFeasible() const { return _numMissing == 0; }
+
+		unsigned int getNumMissing() const { return _numMissing; }
+
+		const std::vector<unsigned int>& getChoices() const { return _choices; }
+
+	private:
+
+		void add(unsigned int i);
+
+		void remove(unsigned int i);
+
+		CellLabelOptimizer& _optimizer;
+
+		const std::vector<unsigned int>& _cells;
+
+		std::vector<unsigned int> _choices;
+
+		// the number of cells assigned to each pair of (gt, rec) label
+		std::map<std::pair<unsigned int, unsigned int>, unsigned int> _pairCounts;
+
+		// the number of cells assigned to each reconstruction label
+		std::map<unsigned int, unsigned int> _recCounts;
+
+		// the number of reconstruction labels that need a cell but don't have 
+		// one
+		unsigned int _numMissing;
+
+		double _cost;
+	};
+
+	// find the best labels for all components of the given subset of cells
+	void solve(
+			const std::vector<cell_t>& cells,
+			const std::vector<unsigned int>& subset,
+			const std::set<float>& reconstructionLabels,
+			double volumeSize,
+			std::vector<unsigned int>& choices);
+
+	void solveComponent(const std::vector<unsigned int>& cells, std::vector<unsigned int>& choices);
+
+	// assign cells to reconstruction labels that don't have one yet
+	void repair(Assignment& assignment);
+
+	// find an augmenting path for the given label in the matching of needed 
+	// labels to cells
+	bool augment(
+			unsigned int label,
+			const std::map<unsigned int, std::vector<std::pair<unsigned int, unsigned int> > >& providers,
+			std::vector<unsigned int>& matchedLabels,
+			std::vector<unsigned int>& matchedChoices,
+			std::vector<bool>& visited);
+
+	// improve the assignment by moving single cells or all cells of a pair of 
+	// labels at once, until no move improves
+	void localSearch(Assignment& assignment);
+
+	// search for an assignment of the cells from i on that is better than the 
+	// best one, returns false if the search was aborted
+	bool branchAndBound(
+			Assignment& assignment,
+			std::vector<unsigned int>& bestChoices,
+			double& bestCost,
+			unsigned int i,
+			unsigned int& numNodes);
+
+	// a lower bound on the cost of any feasible assignment of the cells
+	double lowerBound(const std::vector<unsigned int>& cells);
+
+	// does the given pair of labels have to be counted for cells without 
+	// alternatives already?
+	bool isFixedPair(unsigned int gt, unsigned int rec) const { return _fixedPairs.count(std::make_pair(gt, rec)) > 0; }
+
+	// find the root of node in the union-find forest _parents
+	unsigned int findRoot(unsigned int node);
+
+	unsigned int _maxExactCells;
+	unsigned int _maxExactNodes;
+
+	// the index of each cell of the current subset in the list of all cells
+	std::vector<unsigned int> _cellIndices;
+
+	// dense ground-truth label id for each cell of the subset
+	std::vector<unsigned int> _gtIds;
+
+	// the possible labels for each cell of the subset, the first is the 
+	// reconstruction label
+	std::vector<std::vector<Option> > _options;
+
+	// pairs of (gt, rec) label that are used by cells without alternatives
+	std::set<std::pair<unsigned int, unsigned int> > _fixedPairs;
+
+	// reconstruction labels that need a cell with alternatives assigned to 
+	// them
+	std::vector<bool> _needed;
+
+	std::vector<unsigned int> _parents;
+
+	unsigned int _numComponents;
+	unsigned int _numOptimalComponents;
+	double       _gap;
+};
+
+#endif // SOPNET_EVALUATION_CELL_LABEL_OPTIMIZER_H__
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <sopnet/parallel.h>
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "ContingencyTable.h"
+
+logger::LogChannel contingencytablelog("contingencytablelog", "[ContingencyTable] ");
+
+util::ProgramOption optionContingencyThreads(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "contingencyThreads",
+		util::_description_text = "The number of threads to use to count label co-occurrences for the RAND and VOI. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+ContingencyTable::ContingencyTable(unsigned int numThreads) :
+	_numThreads(numThreads),
+	_numLocations(0) {
+
+	if (_numThreads == 0)
+		_numThreads = optionContingencyThreads;
+	_numThreads = getNumWorkerThreads(_numThreads, std::numeric_limits<unsigned int>::max());
+}
+
+void
+ContingencyTable::count(const ImageStack& stack1, const ImageStack& stack2, bool ignoreBackground) {
+
+	if (stack1.size() != stack2.size())
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("image stacks have different size") << STACK_TRACE);
+
+	for (unsigned int z = 0; z < stack1.size(); z++)
+		if (stack1[z]->size() != stack2[z]->size())
+			BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("images have different size") << STACK_TRACE);
+
+	unsigned int depth      = stack1.size();
+	unsigned int numThreads = getNumWorkerThreads(_numThreads, depth);
+
+	// one table per block of sections, merged afterwards
+	std::vector<Counts> counts(numThreads);
+	std::vector<size_t> numLocations(numThreads, 0);
+
+	parallelFor(
+			numThreads,
+			numThreads,
+			boost::bind(
+					&ContingencyTable::countSections,
+					this,
+					boost::cref(stack1),
+					boost::cref(stack2),
+					ignoreBackground,
+					_1,
+					numThreads,
+					boost::ref(counts),
+					boost::ref(numLocations)));
+
+	_numLocations = numLocations[0];
+	for (unsigned int i = 1; i < numThreads; i++) {
+
+		counts[0].merge(counts[i]);
+		counts[i] = Counts();
+		_numLocations += numLocations[i];
+	}
+
+	collect(counts[0]);
+
+	LOG_DEBUG(contingencytablelog)
+			<< "counted " << _numLocations << " locations with " << _pairCounts.size()
+			<< " label pairs of " << _counts1.size() << " and " << _counts2.size()
+			<< " labels" << std::endl;
+}
+
+void
+ContingencyTable::count(const std::vector<Cell<float> >& cells, bool ignoreBackground) {
+
+	Counts pairs;
+
+	_numLocations = 0;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		Label gtLabel  = cells[i].getGroundTruthLabel();
+		Label recLabel = cells[i].getReconstructionLabel();
+
+		if (ignoreBackground && (gtLabel == 0 || recLabel == 0))
+			continue;
+
+		pairs.add(toKey(gtLabel, recLabel), cells[i].size());
+		_numLocations += cells[i].size();
+	}
+
+	collect(pairs);
+}
+
+ContingencyTable
+ContingencyTable::getWithoutBackground() const {
+
+	ContingencyTable table(_numThreads);
+
+	Counts pairs;
+
+	foreach (const PairCount& pairCount, _pairCounts) {
+
+		if (pairCount.first.first == 0 || pairCount.first.second == 0)
+			continue;
+
+		pairs.add(toKey(pairCount.first.first, pairCount.first.second), pairCount.second);
+		table._numLocations += pairCount.second;
+	}
+
+	table.collect(pairs);
+
+	return table;
+}
+
+void
+ContingencyTable::collect(const Counts& pairs) {
+
+	Counts counts1;
+	Counts counts2;
+
+	_pairCounts.clear();
+	_pairCounts.reserve(pairs.size());
+
+	for (unsigned int i = 0; i < pairs.capacity(); i++) {
+
+		if (!pairs.used(i))
+			continue;
+
+		boost::uint32_t bits1 = static_cast<boost::uint32_t>(pairs.key(i) >> 32);
+		boost::uint32_t bits2 = static_cast<boost::uint32_t>(pairs.key(i));
+		size_t          n     = pairs.count(i);
+
+		_pairCounts.push_back(PairCount(LabelPair(toLabel(bits1), toLabel(bits2)), n));
+
+		counts1.add(bits1, n);
+		counts2.add(bits2, n);
+	}
+
+	_counts1.clear();
+	_counts1.reserve(counts1.size());
+	for (unsigned int i = 0; i < counts1.capacity(); i++)
+		if (counts1.used(i))
+			_counts1.push_back(LabelCount(toLabel(counts1.key(i)), counts1.count(i)));
+
+	_counts2.clear();
+	_counts2.reserve(counts2.size());
+	for (unsigned int i = 0; i < counts2.capacity(); i++)
+		if (counts2.used(i))
+			_counts2.push_back(LabelCount(toLabel(counts2.key(i)), counts2.count(i)));
+}
+
+void
+ContingencyTable::countSections(
+		const ImageStack&    stack1,
+		const ImageStack&    stack2,
+		bool                 ignoreBackground,
+		unsigned int         block,
+		unsigned int         numBlocks,
+		std::vector<Counts>& blockCounts,
+		std::vector<size_t>& blockNumLocations) {
+
+	Counts& counts       = blockCounts[block];
+	size_t& numLocations = blockNumLocations[block];
+
+	// sections have the same size, equal blocks balance the work
+	unsigned int begin = static_cast<size_t>(stack1.size())*block/numBlocks;
+	unsigned int end   = static_cast<size_t>(stack1.size())*(block + 1)/numBlocks;
+
+	for (unsigned int z = begin; z < end; z++) {
+
+		Image& image1 = *stack1[z];
+		Image& image2 = *stack2[z];
+
+		Image::iterator i1 = image1.begin();
+		Image::iterator i2 = image2.begin();
+
+		// count runs of equal label pairs at once, labels are mostly constant 
+		// along lines
+		bool   haveRun   = false;
+		Key    runKey    = 0;
+		size_t runLength = 0;
+
+		for (; i1 != image1.end(); i1++, i2++) {
+
+			if (ignoreBackground && (*i1 == 0 || *i2 == 0))
+				continue;
+
+			numLocations++;
+
+			Key key = toKey(*i1, *i2);
+
+			if (haveRun && key == runKey) {
+
+				runLength++;
+				continue;
+			}
+
+			if (haveRun)
+				counts.add(runKey, runLength);
+
+			haveRun   = true;
+			runKey    = key;
+			runLength = 1;
+		}
+
+		if (haveRun)
+			counts.add(runKey, runLength);
+	}
+}
+
+ContingencyTable::Key
+ContingencyTable::toKey(Label label1, Label label2) {
+
+	// map -0 to 0, they are the same label
+	label1 += 0.0f;
+	label2 += 0.0f;
+
+	boost::uint32_t bits1;
+	boost::uint32_t bits2;
+	std::memcpy(&bits1, &label1, sizeof(Label));
+	std::memcpy(&bits2, &label2, sizeof(Label));
+
+	return (static_cast<Key>(bits1) << 32) | bits2;
+}
+
+ContingencyTable::Label
+ContingencyTable::toLabel(boost::uint32_t bits) {
+
+	Label label;
+	std::memcpy(&label, &bits, sizeof(Label));
+
+	return label;
+}
+
+ContingencyTable::Counts::Counts() :
+	_keys(64),
+	_counts(64, 0),
+	_used(64, 0),
+	_size(0),
+	_shift(64 - 6) {}
+
+void
+ContingencyTable::Counts::add(Key key, size_t n) {
+
+	unsigned int mask = _keys.size() - 1;
+	unsigned int slot = static_cast<unsigned int>((key*0x9e3779b97f4a7c15ULL) >> _shift);
+
+	while (_used[slot]) {
+
+		if (_keys[slot] == key) {
+
+			_counts[slot] += n;
+			return;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	_keys[slot]   = key;
+	_counts[slot] = n;
+	_used[slot]   = 1;
+	_size++;
+
+	// keep the load factor below 1/2
+	if (2*_size > _keys.size())
+		grow();
+}
+
+void
+ContingencyTable::Counts::merge(const Counts& other) {
+
+	for (unsigned int i = 0; i < other.capacity(); i++)
+		if (other.used(i))
+			add(other.key(i), other.count(i));
+}
+
+void
+ContingencyTable::Counts::grow() {
+
+	std::vector<Key>    keys;
+	std::vector<size_t> counts;
+	std::vector<char>   used;
+
+	keys.swap(_keys);
+	counts.swap(_counts);
+	used.swap(_used);
+
+	_keys.resize(2*keys.size());
+	_counts.resize(2*keys.size(), 0);
+	_used.resize(2*keys.size(), 0);
+	_size = 0;
+	_shift--;
+
+	for (unsigned int i = 0; i < keys.size(); i++)
+		if (used[i])
+			add(keys[i], counts[i]);
+}
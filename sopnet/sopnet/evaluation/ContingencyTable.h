@@ -0,0 +1,161 @@
+#ifndef SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+#define SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <imageprocessing/ImageStack.h>
+#include "Cell.h"
+
+/**
+ * Counts the co-occurrences of labels in two image stacks, i.e., the number of 
+ * locations for each pair of labels and for each label of either stack. Used 
+ * by the RandIndex and the VariationOfInformation.
+ *
+ * Blocks of sections are counted in parallel into separate hash tables with 
+ * open addressing, which are merged at the end.
+ */
+class ContingencyTable {
+
+public:
+
+	typedef float                        Label;
+	typedef std::pair<Label, Label>      LabelPair;
+	typedef std::pair<LabelPair, size_t> PairCount;
+	typedef std::pair<Label, size_t>     LabelCount;
+
+	/**
+	 * Create a new contingency table.
+	 *
+	 * @param numThreads 
+	 *             The number of threads to use, 0 for one per CPU.
+	 */
+	ContingencyTable(unsigned int numThreads = 0);
+
+	/**
+	 * Count the label pairs of the given stacks.
+	 *
+	 * @param stack1 
+	 *             The first image stack.
+	 *
+	 * @param stack2 
+	 *             The second image stack, with the same size as stack1.
+	 *
+	 * @param ignoreBackground 
+	 *             If set, locations that are 0 in either stack are not 
+	 *             counted.
+	 */
+	void count(const ImageStack& stack1, const ImageStack& stack2, bool ignoreBackground = false);
+
+	/**
+	 * Count the label pairs of the given cells, with the ground truth label as 
+	 * the first and the reconstruction label as the second label. Since cells 
+	 * partition the volume, this gives the same table as counting the ground 
+	 * truth and reconstruction stacks the cells were extracted from.
+	 *
+	 * @param cells 
+	 *             The cells partitioning the volume.
+	 *
+	 * @param ignoreBackground 
+	 *             If set, cells with label 0 in either stack are not counted.
+	 */
+	void count(const std::vector<Cell<float> >& cells, bool ignoreBackground = false);
+
+	/**
+	 * Get a copy of this table without the locations that have the label 0 in 
+	 * either stack.
+	 */
+	ContingencyTable getWithoutBackground() const;
+
+	/**
+	 * Get the number of counted locations.
+	 */
+	size_t getNumLocations() const { return _numLocations; }
+
+	/**
+	 * Get the number of locations for each pair of labels that co-occurs.
+	 */
+	const std::vector<PairCount>& getPairCounts() const { return _pairCounts; }
+
+	/**
+	 * Get the number of locations for each label of the first stack.
+	 */
+	const std::vector<LabelCount>& getCounts1() const { return _counts1; }
+
+	/**
+	 * Get the number of locations for each label of the second stack.
+	 */
+	const std::vector<LabelCount>& getCounts2() const { return _counts2; }
+
+private:
+
+	typedef boost::uint64_t Key;
+
+	// a hash map from keys to counts with open addressing and linear probing
+	class Counts {
+
+	public:
+
+		Counts();
+
+		// add n to the count of key
+		void add(Key key, size_t n);
+
+		// add all counts of other
+		void merge(const Counts& other);
+
+		unsigned int size() const { return _size; }
+
+		unsigned int capacity() const { return _keys.size(); }
+
+		bool used(unsigned int i) const { return _used[i]; }
+
+		Key key(unsigned int i) const { return _keys[i]; }
+
+		size_t count(unsigned int i) const { return _counts[i]; }
+
+	private:
+
+		void grow();
+
+		std::vector<Key>    _keys;
+		std::vector<size_t> _counts;
+		std::vector<char>   _used;
+
+		unsigned int _size;
+
+		// the number of bits to shift the hashed key to get a slot
+		unsigned int _shift;
+	};
+
+	// count the sections of the given block of the stacks into the counts and 
+	// number of locations of this block
+	void countSections(
+			const ImageStack&    stack1,
+			const ImageStack&    stack2,
+			bool                 ignoreBackground,
+			unsigned int         block,
+			unsigned int         numBlocks,
+			std::vector<Counts>& blockCounts,
+			std::vector<size_t>& blockNumLocations);
+
+	// set the pair counts and sum them up to the label counts
+	void collect(const Counts& pairs);
+
+	static Key toKey(Label label1, Label label2);
+
+	static Label toLabel(boost::uint32_t bits);
+
+	// the number of threads to use
+	unsigned int _numThreads;
+
+	size_t _numLocations;
+
+	std::vector<PairCount>  _pairCounts;
+	std::vector<LabelCount> _counts1;
+	std::vector<LabelCount> _counts2;
+};
+
+#endif // SOPNET_EVALUATION_CONTINGENCY_TABLE_H__
+
@@ -1,21 +1,62 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+#include <sopnet/parallel.h>
+
 #include "DistanceToleranceFunction.h"
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include <vigra/multi_distance.hxx>
+#include <vigra/multi_labeling.hxx>
 //#include <vigra/multi_impex.hxx>
 
 logger::LogChannel distancetolerancelog("distancetolerancelog", "[DistanceToleranceFunction] ");
 
+util::ProgramOption optionToleranceThreads(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "toleranceThreads",
+		util::_description_text = "The number of threads to use to find alternative cell labels. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionResolutionX(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "resolutionX",
+		util::_description_text = "The size of a voxel in x in nm.",
+		util::_default_value    = 4.0);
+
+util::ProgramOption optionResolutionY(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "resolutionY",
+		util::_description_text = "The size of a voxel in y in nm.",
+		util::_default_value    = 4.0);
+
+util::ProgramOption optionResolutionZ(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "resolutionZ",
+		util::_description_text = "The size of a voxel in z in nm.",
+		util::_default_value    = 40.0);
+
 DistanceToleranceFunction::DistanceToleranceFunction(
 		float distanceThreshold,
 		bool haveBackgroundLabel,
-		float backgroundLabel) :
+		float backgroundLabel,
+		unsigned int numThreads) :
 	_haveBackgroundLabel(haveBackgroundLabel),
 	_backgroundLabel(backgroundLabel),
+	_numThreads(numThreads),
 	_maxDistanceThreshold(distanceThreshold) {
 
-	_resolutionX = 4.0;
-	_resolutionY = 4.0;
-	_resolutionZ = 40.0;
+	if (_numThreads == 0)
+		_numThreads = optionToleranceThreads;
+	_numThreads = getNumWorkerThreads(_numThreads, std::numeric_limits<unsigned int>::max());
+
+	_resolutionX = optionResolutionX;
+	_resolutionY = optionResolutionY;
+	_resolutionZ = optionResolutionZ;
 }
 
 void
@@ -29,6 +70,7 @@ DistanceToleranceFunction::extractCells(
 	_width  = gtLabels.width();
 	_height = gtLabels.height();
 
+	setRegion(0, 0, 0, _width, _height, _depth);
 	createBoundaryMap(recLabels);
 	createBoundaryDistanceMap();
 
@@ -42,14 +84,16 @@ DistanceToleranceFunction::extractCells(
 	// the maximum boundary distance of any location for each cell
 	std::vector<float> maxBoundaryDistances(numCells, 0);
 
-	std::set<unsigned int> foundCells;
+	std::vector<bool> foundCells(numCells, false);
 	for (unsigned int z = 0; z < _depth; z++) {
 
 		boost::shared_ptr<const Image> gt  = gtLabels[z];
 		boost::shared_ptr<const Image> rec = recLabels[z];
 
-		for (unsigned int x = 0; x < _width; x++)
-			for (unsigned int y = 0; y < _height; y++) {
+		// visit locations in scan-line order, such that cells can store them as 
+		// runs in x
+		for (unsigned int y = 0; y < _height; y++)
+			for (unsigned int x = 0; x < _width; x++) {
 
 				float gtLabel  = (*gt)(x, y);
 				float recLabel = (*rec)(x, y);
@@ -63,19 +107,457 @@ DistanceToleranceFunction::extractCells(
 
 				maxBoundaryDistances[cellIndex] = std::max(maxBoundaryDistances[cellIndex], _boundaryDistance2(x, y, z));
 
-				if (foundCells.count(cellIndex) == 0) {
+				if (!foundCells[cellIndex]) {
 
 					registerPossibleMatch(gtLabel, recLabel);
-					foundCells.insert(cellIndex);
+					foundCells[cellIndex] = true;
 				}
 			}
 	}
 
+	foreach (cell_t& cell, *_cells)
+		cell.shrink();
+
 	findRelabelCandidates(maxBoundaryDistances);
 
 	enumerateCellLabels(recLabels);
 }
 
+void
+DistanceToleranceFunction::extractCells(
+		const ImageStack& recLabels,
+		const ImageStack& gtLabels,
+		unsigned int chunkWidth,
+		unsigned int chunkHeight,
+		unsigned int chunkDepth) {
+
+	_depth  = gtLabels.size();
+	_width  = gtLabels.width();
+	_height = gtLabels.height();
+
+	if (chunkWidth == 0 || chunkWidth > _width)
+		chunkWidth = _width;
+	if (chunkHeight == 0 || chunkHeight > _height)
+		chunkHeight = _height;
+	if (chunkDepth == 0 || chunkDepth > _depth)
+		chunkDepth = _depth;
+
+	// the cell fragments of all chunks
+	std::vector<cell_t> fragments;
+
+	// the maximum boundary distance of any location for each fragment
+	std::vector<float> fragmentDistances;
+
+	// union-find forest of fragments that belong to the same cell
+	std::vector<unsigned int> parents;
+
+	// the fragments at the upper faces of the previous chunks in x, y, and z
+	std::vector<unsigned int> xFace(_height*chunkDepth);
+	std::vector<unsigned int> yFace(_width*chunkDepth);
+	std::vector<unsigned int> zFace(_width*_height);
+
+	std::vector<Chunk> chunks;
+
+	for (unsigned int z = 0; z < _depth; z += chunkDepth)
+		for (unsigned int y = 0; y < _height; y += chunkHeight)
+			for (unsigned int x = 0; x < _width; x += chunkWidth) {
+
+				Chunk chunk;
+				chunk.x0 = x;
+				chunk.y0 = y;
+				chunk.z0 = z;
+				chunk.x1 = std::min(x + chunkWidth,  _width);
+				chunk.y1 = std::min(y + chunkHeight, _height);
+				chunk.z1 = std::min(z + chunkDepth,  _depth);
+
+				extractFragments(chunk, recLabels, gtLabels, fragments, fragmentDistances, parents, xFace, yFace, zFace);
+
+				chunks.push_back(chunk);
+			}
+
+	// create one cell for each set of connected fragments
+
+	std::vector<unsigned int> cellIndices(fragments.size());
+	std::vector<unsigned int> rootIndices(fragments.size(), fragments.size());
+
+	unsigned int numCells = 0;
+	for (unsigned int f = 0; f < fragments.size(); f++) {
+
+		unsigned int root = findRoot(f, parents);
+
+		if (rootIndices[root] == fragments.size())
+			rootIndices[root] = numCells++;
+
+		cellIndices[f] = rootIndices[root];
+	}
+
+	LOG_DEBUG(distancetolerancelog) << "merged " << fragments.size() << " fragments in " << chunks.size() << " chunks into " << numCells << " cells" << std::endl;
+
+	_cells->resize(numCells);
+
+	std::vector<float> maxBoundaryDistances(numCells, 0);
+	std::vector<bool>  foundCells(numCells, false);
+
+	for (unsigned int f = 0; f < fragments.size(); f++) {
+
+		unsigned int cellIndex = cellIndices[f];
+		cell_t&      cell      = (*_cells)[cellIndex];
+
+		maxBoundaryDistances[cellIndex] = std::max(maxBoundaryDistances[cellIndex], fragmentDistances[f]);
+
+		if (!foundCells[cellIndex]) {
+
+			cell.setGroundTruthLabel(fragments[f].getGroundTruthLabel());
+			cell.setReconstructionLabel(fragments[f].getReconstructionLabel());
+			registerPossibleMatch(cell.getGroundTruthLabel(), cell.getReconstructionLabel());
+			foundCells[cellIndex] = true;
+		}
+	}
+
+	findRelabelCandidates(maxBoundaryDistances);
+
+	LOG_DEBUG(distancetolerancelog) << "there are " << _relabelCandidates.size() << " cells that can be relabeled" << std::endl;
+
+	// the alternative labels of each relabel candidate are the ones that all 
+	// its fragments agree on
+
+	std::vector<int> candidateIndices(numCells, -1);
+	for (unsigned int i = 0; i < _relabelCandidates.size(); i++)
+		candidateIndices[_relabelCandidates[i]] = i;
+
+	std::vector<std::vector<float> > alternativeLabels(_relabelCandidates.size());
+	std::vector<bool>                haveAlternativeLabels(_relabelCandidates.size(), false);
+
+	std::vector<NeighborhoodRow> neighborhood = createNeighborhood();
+
+	foreach (const Chunk& chunk, chunks) {
+
+		// the fragments of candidates that can still be relabeled
+		std::vector<const cell_t*> candidateFragments;
+		std::vector<unsigned int>  candidates;
+
+		for (unsigned int f = chunk.firstFragment; f < chunk.firstFragment + chunk.numFragments; f++) {
+
+			int i = candidateIndices[cellIndices[f]];
+
+			if (i < 0 || (haveAlternativeLabels[i] && alternativeLabels[i].empty()))
+				continue;
+
+			candidateFragments.push_back(&fragments[f]);
+			candidates.push_back(i);
+		}
+
+		if (candidateFragments.empty())
+			continue;
+
+		setRegion(
+				chunk.x0 - _maxDistanceThresholdX - 1, chunk.y0 - _maxDistanceThresholdY - 1, chunk.z0 - _maxDistanceThresholdZ - 1,
+				chunk.x1 + _maxDistanceThresholdX + 1, chunk.y1 + _maxDistanceThresholdY + 1, chunk.z1 + _maxDistanceThresholdZ + 1);
+		createBoundaryMap(recLabels);
+
+		std::vector<std::vector<float> > fragmentLabels(candidateFragments.size());
+
+		parallelFor(
+				_numThreads,
+				candidateFragments.size(),
+				boost::bind(
+						&DistanceToleranceFunction::findAlternativeLabels,
+						this,
+						_1,
+						boost::cref(candidateFragments),
+						boost::cref(neighborhood),
+						boost::cref(recLabels),
+						boost::ref(fragmentLabels)));
+
+		for (unsigned int j = 0; j < candidates.size(); j++) {
+
+			unsigned int i = candidates[j];
+
+			if (!haveAlternativeLabels[i]) {
+
+				alternativeLabels[i] = fragmentLabels[j];
+				haveAlternativeLabels[i] = true;
+				continue;
+			}
+
+			std::vector<float> intersection;
+			std::set_intersection(
+					alternativeLabels[i].begin(), alternativeLabels[i].end(),
+					fragmentLabels[j].begin(), fragmentLabels[j].end(),
+					std::back_inserter(intersection));
+			alternativeLabels[i].swap(intersection);
+		}
+	}
+
+	registerAlternativeLabels(alternativeLabels);
+
+	// collect the locations of the fragments in their cells
+
+	for (unsigned int f = 0; f < fragments.size(); f++) {
+
+		(*_cells)[cellIndices[f]].merge(fragments[f]);
+		fragments[f] = cell_t();
+	}
+
+	foreach (cell_t& cell, *_cells)
+		cell.shrink();
+}
+
+void
+DistanceToleranceFunction::extractFragments(
+		Chunk& chunk,
+		const ImageStack& recLabels,
+		const ImageStack& gtLabels,
+		std::vector<cell_t>& fragments,
+		std::vector<float>& maxBoundaryDistances,
+		std::vector<unsigned int>& parents,
+		std::vector<unsigned int>& xFace,
+		std::vector<unsigned int>& yFace,
+		std::vector<unsigned int>& zFace) {
+
+	vigra::MultiArray<3, unsigned int> cellIds;
+
+	chunk.firstFragment = fragments.size();
+	chunk.numFragments  = labelFragments(chunk, recLabels, gtLabels, cellIds);
+
+	fragments.resize(chunk.firstFragment + chunk.numFragments);
+	maxBoundaryDistances.resize(chunk.firstFragment + chunk.numFragments, 0);
+	for (unsigned int f = chunk.firstFragment; f < fragments.size(); f++)
+		parents.push_back(f);
+
+	// compute the boundary distances of the chunk, considering all boundaries 
+	// within threshold distance
+
+	setRegion(
+			chunk.x0 - getHaloX(), chunk.y0 - getHaloY(), chunk.z0 - getHaloZ(),
+			chunk.x1 + getHaloX(), chunk.y1 + getHaloY(), chunk.z1 + getHaloZ());
+	createBoundaryMap(recLabels);
+	createBoundaryDistanceMap();
+
+	// collect the locations of each fragment and connect it to fragments of 
+	// previous chunks with the same labels
+
+	for (int z = chunk.z0; z < chunk.z1; z++) {
+
+		const Image& gt  = *gtLabels[z];
+		const Image& rec = *recLabels[z];
+
+		for (int y = chunk.y0; y < chunk.y1; y++)
+			for (int x = chunk.x0; x < chunk.x1; x++) {
+
+				float gtLabel  = gt(x, y);
+				float recLabel = rec(x, y);
+
+				// argh, vigra starts counting at 1!
+				unsigned int fragment = chunk.firstFragment + cellIds(x - chunk.x0, y - chunk.y0, z - chunk.z0) - 1;
+
+				fragments[fragment].add(cell_t::Location(x, y, z));
+				fragments[fragment].setReconstructionLabel(recLabel);
+				fragments[fragment].setGroundTruthLabel(gtLabel);
+
+				maxBoundaryDistances[fragment] = std::max(
+						maxBoundaryDistances[fragment],
+						_boundaryDistance2(x - _regionX, y - _regionY, z - _regionZ));
+
+				unsigned int& xNeighbor = xFace[(z - chunk.z0)*_height + y];
+				unsigned int& yNeighbor = yFace[(z - chunk.z0)*_width + x];
+				unsigned int& zNeighbor = zFace[y*_width + x];
+
+				if (x == chunk.x0 && x > 0 && gt(x - 1, y) == gtLabel && rec(x - 1, y) == recLabel)
+					parents[findRoot(fragment, parents)] = findRoot(xNeighbor, parents);
+				if (y == chunk.y0 && y > 0 && gt(x, y - 1) == gtLabel && rec(x, y - 1) == recLabel)
+					parents[findRoot(fragment, parents)] = findRoot(yNeighbor, parents);
+				if (z == chunk.z0 && z > 0 && (*gtLabels[z - 1])(x, y) == gtLabel && (*recLabels[z - 1])(x, y) == recLabel)
+					parents[findRoot(fragment, parents)] = findRoot(zNeighbor, parents);
+
+				if (x == chunk.x1 - 1)
+					xNeighbor = fragment;
+				if (y == chunk.y1 - 1)
+					yNeighbor = fragment;
+				if (z == chunk.z1 - 1)
+					zNeighbor = fragment;
+			}
+	}
+}
+
+void
+DistanceToleranceFunction::extractCellFragments(
+		const ImageStack& recLabels,
+		const ImageStack& gtLabels,
+		int x0, int y0, int z0,
+		int x1, int y1, int z1,
+		std::vector<cell_t>& fragments,
+		vigra::MultiArray<3, unsigned int>& fragmentIds) {
+
+	_depth  = gtLabels.size();
+	_width  = gtLabels.width();
+	_height = gtLabels.height();
+
+	Chunk chunk;
+	chunk.x0 = x0;
+	chunk.y0 = y0;
+	chunk.z0 = z0;
+	chunk.x1 = x1;
+	chunk.y1 = y1;
+	chunk.z1 = z1;
+
+	unsigned int numFragments = labelFragments(chunk, recLabels, gtLabels, fragmentIds);
+
+	fragments.clear();
+	fragments.resize(numFragments);
+
+	std::vector<float> maxBoundaryDistances(numFragments, 0);
+
+	setRegion(
+			chunk.x0 - getHaloX(), chunk.y0 - getHaloY(), chunk.z0 - getHaloZ(),
+			chunk.x1 + getHaloX(), chunk.y1 + getHaloY(), chunk.z1 + getHaloZ());
+	createBoundaryMap(recLabels);
+	createBoundaryDistanceMap();
+
+	for (int z = chunk.z0; z < chunk.z1; z++) {
+
+		const Image& gt  = *gtLabels[z];
+		const Image& rec = *recLabels[z];
+
+		for (int y = chunk.y0; y < chunk.y1; y++)
+			for (int x = chunk.x0; x < chunk.x1; x++) {
+
+				// argh, vigra starts counting at 1!
+				unsigned int& fragment = fragmentIds(x - chunk.x0, y - chunk.y0, z - chunk.z0);
+				fragment--;
+
+				fragments[fragment].add(cell_t::Location(x, y, z));
+				fragments[fragment].setReconstructionLabel(rec(x, y));
+				fragments[fragment].setGroundTruthLabel(gt(x, y));
+
+				maxBoundaryDistances[fragment] = std::max(
+						maxBoundaryDistances[fragment],
+						_boundaryDistance2(x - _regionX, y - _regionY, z - _regionZ));
+			}
+	}
+
+	foreach (cell_t& fragment, fragments)
+		fragment.shrink();
+
+	// only fragments that are within threshold distance to a boundary 
+	// everywhere can be part of a relabel candidate
+
+	std::vector<const cell_t*> candidates;
+	std::vector<unsigned int>  candidateIndices;
+
+	for (unsigned int f = 0; f < numFragments; f++)
+		if (maxBoundaryDistances[f] <= _maxDistanceThreshold*_maxDistanceThreshold) {
+
+			candidates.push_back(&fragments[f]);
+			candidateIndices.push_back(f);
+		}
+
+	if (candidates.empty())
+		return;
+
+	std::vector<NeighborhoodRow> neighborhood = createNeighborhood();
+
+	setRegion(
+			chunk.x0 - _maxDistanceThresholdX - 1, chunk.y0 - _maxDistanceThresholdY - 1, chunk.z0 - _maxDistanceThresholdZ - 1,
+			chunk.x1 + _maxDistanceThresholdX + 1, chunk.y1 + _maxDistanceThresholdY + 1, chunk.z1 + _maxDistanceThresholdZ + 1);
+	createBoundaryMap(recLabels);
+
+	std::vector<std::vector<float> > alternativeLabels(candidates.size());
+
+	parallelFor(
+			_numThreads,
+			candidates.size(),
+			boost::bind(
+					&DistanceToleranceFunction::findAlternativeLabels,
+					this,
+					_1,
+					boost::cref(candidates),
+					boost::cref(neighborhood),
+					boost::cref(recLabels),
+					boost::ref(alternativeLabels)));
+
+	for (unsigned int i = 0; i < candidates.size(); i++)
+		foreach (float label, alternativeLabels[i])
+			fragments[candidateIndices[i]].addAlternativeLabel(label);
+}
+
+int
+DistanceToleranceFunction::getHaloX() const {
+
+	return static_cast<int>(std::ceil(_maxDistanceThreshold/_resolutionX)) + 1;
+}
+
+int
+DistanceToleranceFunction::getHaloY() const {
+
+	return static_cast<int>(std::ceil(_maxDistanceThreshold/_resolutionY)) + 1;
+}
+
+int
+DistanceToleranceFunction::getHaloZ() const {
+
+	return static_cast<int>(std::ceil(_maxDistanceThreshold/_resolutionZ)) + 1;
+}
+
+unsigned int
+DistanceToleranceFunction::labelFragments(
+		const Chunk& chunk,
+		const ImageStack& recLabels,
+		const ImageStack& gtLabels,
+		vigra::MultiArray<3, unsigned int>& fragmentIds) {
+
+	vigra::Shape3 shape(chunk.x1 - chunk.x0, chunk.y1 - chunk.y0, chunk.z1 - chunk.z0);
+
+	// find connected components of gt and rec labels in the chunk
+
+	vigra::MultiArray<3, std::pair<float, float> > gtAndRec(shape);
+
+	for (int z = chunk.z0; z < chunk.z1; z++) {
+
+		const Image& gt  = *gtLabels[z];
+		const Image& rec = *recLabels[z];
+
+		for (int y = chunk.y0; y < chunk.y1; y++)
+			for (int x = chunk.x0; x < chunk.x1; x++)
+				gtAndRec(x - chunk.x0, y - chunk.y0, z - chunk.z0) = std::make_pair(gt(x, y), rec(x, y));
+	}
+
+	fragmentIds.reshape(shape);
+	fragmentIds = 0;
+
+	return vigra::labelMultiArray(gtAndRec, fragmentIds);
+}
+
+unsigned int
+DistanceToleranceFunction::findRoot(unsigned int fragment, std::vector<unsigned int>& parents) {
+
+	unsigned int root = fragment;
+	while (parents[root] != root)
+		root = parents[root];
+
+	// compress the path
+	while (parents[fragment] != root) {
+
+		unsigned int next = parents[fragment];
+		parents[fragment] = root;
+		fragment = next;
+	}
+
+	return root;
+}
+
+void
+DistanceToleranceFunction::setRegion(int x0, int y0, int z0, int x1, int y1, int z1) {
+
+	_regionX = std::max(x0, 0);
+	_regionY = std::max(y0, 0);
+	_regionZ = std::max(z0, 0);
+
+	_regionWidth  = std::min(x1, (int)_width)  - _regionX;
+	_regionHeight = std::min(y1, (int)_height) - _regionY;
+	_regionDepth  = std::min(z1, (int)_depth)  - _regionZ;
+}
+
 void
 DistanceToleranceFunction::findRelabelCandidates(const std::vector<float>& maxBoundaryDistances) {
 
@@ -88,46 +570,90 @@ DistanceToleranceFunction::findRelabelCandidates(const std::vector<float>& maxBo
 void
 DistanceToleranceFunction::createBoundaryMap(const ImageStack& recLabels) {
 
-	vigra::Shape3 shape(_width, _height, _depth);
+	vigra::Shape3 shape(_regionWidth, _regionHeight, _regionDepth);
 	_boundaryMap.reshape(shape);
 
 	// create boundary map
 	LOG_DEBUG(distancetolerancelog) << "creating boundary map of size " << shape << std::endl;
-	_boundaryMap = 0.0f;
-	for (unsigned int x = 0; x < _width; x++)
-		for (unsigned int y = 0; y < _height; y++)
-			for (unsigned int z = 0; z < _depth; z++)
-				if (isBoundaryVoxel(x, y, z, recLabels))
-					_boundaryMap(x, y, z) = 1.0f;
+	parallelFor(
+			_numThreads,
+			_regionDepth,
+			boost::bind(&DistanceToleranceFunction::createBoundaryMapSection, this, _1, boost::cref(recLabels)));
+}
+
+void
+DistanceToleranceFunction::createBoundaryMapSection(unsigned int z, const ImageStack& recLabels) {
+
+	unsigned int sectionNum = _regionZ + z;
+
+	const Image& section  = *recLabels[sectionNum];
+	const Image* previous = (sectionNum > 0          ? recLabels[sectionNum - 1].get() : 0);
+	const Image* next     = (sectionNum < _depth - 1 ? recLabels[sectionNum + 1].get() : 0);
+
+	for (unsigned int y = 0; y < _regionHeight; y++)
+		for (unsigned int x = 0; x < _regionWidth; x++)
+			_boundaryMap(x, y, z) = isBoundaryVoxel(_regionX + x, _regionY + y, sectionNum, section, previous, next);
 }
 
 void
 DistanceToleranceFunction::createBoundaryDistanceMap() {
 
-	vigra::Shape3 shape(_width, _height, _depth);
+	vigra::Shape3 shape(_regionWidth, _regionHeight, _regionDepth);
 	_boundaryDistance2.reshape(shape);
 
+	// Distances are only compared to the threshold, therefore each slab of 
+	// sections needs to see the boundaries up to the threshold distance in z 
+	// only.
+	unsigned int padding   = static_cast<unsigned int>(std::ceil(_maxDistanceThreshold/_resolutionZ)) + 1;
+	unsigned int slabDepth = std::max(padding, (_regionDepth + _numThreads - 1)/_numThreads);
+	unsigned int numSlabs  = (_regionDepth + slabDepth - 1)/slabDepth;
+
+	// compute l2 distance for each pixel to boundary
+	LOG_DEBUG(distancetolerancelog) << "computing boundary distances in " << numSlabs << " slabs" << std::endl;
+	parallelFor(
+			_numThreads,
+			numSlabs,
+			boost::bind(&DistanceToleranceFunction::createBoundaryDistanceMapSlab, this, _1, slabDepth, padding));
+}
+
+void
+DistanceToleranceFunction::createBoundaryDistanceMapSlab(unsigned int slab, unsigned int slabDepth, unsigned int padding) {
+
+	unsigned int zBegin = slab*slabDepth;
+	unsigned int zEnd   = std::min(zBegin + slabDepth, _regionDepth);
+
+	unsigned int paddedBegin = (zBegin > padding ? zBegin - padding : 0);
+	unsigned int paddedEnd   = std::min(zEnd + padding, _regionDepth);
+
+	vigra::MultiArrayView<3, bool> boundaries =
+			_boundaryMap.subarray(
+					vigra::Shape3(0, 0, paddedBegin),
+					vigra::Shape3(_regionWidth, _regionHeight, paddedEnd));
+
+	vigra::MultiArray<3, float> distances2(boundaries.shape());
+
 	float pitch[3];
 	pitch[0] = _resolutionX;
 	pitch[1] = _resolutionY;
 	pitch[2] = _resolutionZ;
 
-	// compute l2 distance for each pixel to boundary
-	LOG_DEBUG(distancetolerancelog) << "computing boundary distances" << std::endl;
 	vigra::separableMultiDistSquared(
-			_boundaryMap,
-			_boundaryDistance2,
+			boundaries,
+			distances2,
 			true /* background */,
 			pitch);
+
+	_boundaryDistance2.subarray(
+			vigra::Shape3(0, 0, zBegin),
+			vigra::Shape3(_regionWidth, _regionHeight, zEnd)) =
+					distances2.subarray(
+							vigra::Shape3(0, 0, zBegin - paddedBegin),
+							vigra::Shape3(_regionWidth, _regionHeight, zEnd - paddedBegin));
 }
 
 void
 DistanceToleranceFunction::enumerateCellLabels(const ImageStack& recLabels) {
 
-	_maxDistanceThresholdX = std::min((float)_width,  _maxDistanceThreshold/_resolutionX);
-	_maxDistanceThresholdY = std::min((float)_height, _maxDistanceThreshold/_resolutionY);
-	_maxDistanceThresholdZ = std::min((float)_depth,  _maxDistanceThreshold/_resolutionZ);
-
 	LOG_DEBUG(distancetolerancelog) << "there are " << _relabelCandidates.size() << " cells that can be relabeled" << std::endl;
 
 	if (_relabelCandidates.size() == 0)
@@ -135,24 +661,46 @@ DistanceToleranceFunction::enumerateCellLabels(const ImageStack& recLabels) {
 
 	LOG_DEBUG(distancetolerancelog) << "creating distance threshold neighborhood" << std::endl;
 
-	// list of all location offsets within threshold distance
-	std::vector<cell_t::Location> neighborhood = createNeighborhood();
+	// rows of all location offsets within threshold distance
+	std::vector<NeighborhoodRow> neighborhood = createNeighborhood();
 
-	LOG_DEBUG(distancetolerancelog) << "there are " << neighborhood.size() << " pixels in the neighborhood for a threshold of " << _maxDistanceThreshold << std::endl;
+	LOG_DEBUG(distancetolerancelog) << "there are " << neighborhood.size() << " rows in the neighborhood for a threshold of " << _maxDistanceThreshold << std::endl;
 
-	// for each cell
-	foreach (unsigned int index, _relabelCandidates) {
+	// the alternative labels for each relabel candidate
+	std::vector<const cell_t*>       candidates;
+	std::vector<std::vector<float> > alternativeLabels(_relabelCandidates.size());
+
+	foreach (unsigned int index, _relabelCandidates)
+		candidates.push_back(&(*_cells)[index]);
+
+	parallelFor(
+			_numThreads,
+			candidates.size(),
+			boost::bind(
+					&DistanceToleranceFunction::findAlternativeLabels,
+					this,
+					_1,
+					boost::cref(candidates),
+					boost::cref(neighborhood),
+					boost::cref(recLabels),
+					boost::ref(alternativeLabels)));
+
+	registerAlternativeLabels(alternativeLabels);
+}
 
-		cell_t& cell = (*_cells)[index];
+void
+DistanceToleranceFunction::registerAlternativeLabels(const std::vector<std::vector<float> >& alternativeLabels) {
 
-		LOG_ALL(distancetolerancelog) << "processing cell " << index << " (label " << cell.getReconstructionLabel() << ")" << std::flush;
+	// for each cell
+	for (unsigned int i = 0; i < _relabelCandidates.size(); i++) {
 
-		std::set<float> alternativeLabels = getAlternativeLabels(cell, neighborhood, recLabels);
+		unsigned int index = _relabelCandidates[i];
+		cell_t&      cell  = (*_cells)[index];
 
-		LOG_ALL(distancetolerancelog) << "; can map to ";
+		LOG_ALL(distancetolerancelog) << "processing cell " << index << " (label " << cell.getReconstructionLabel() << "); can map to ";
 
 		// for each alternative label
-		foreach (float recLabel, alternativeLabels) {
+		foreach (float recLabel, alternativeLabels[i]) {
 
 			LOG_ALL(distancetolerancelog) << recLabel << " ";
 
@@ -161,14 +709,22 @@ DistanceToleranceFunction::enumerateCellLabels(const ImageStack& recLabels) {
 			registerPossibleMatch(cell.getGroundTruthLabel(), recLabel);
 		}
 		LOG_ALL(distancetolerancelog) << std::endl;
-
-		// DEBUG
-		index++;
 	}
 }
 
+void
+DistanceToleranceFunction::findAlternativeLabels(
+		unsigned int i,
+		const std::vector<const cell_t*>& cells,
+		const std::vector<NeighborhoodRow>& neighborhood,
+		const ImageStack& recLabels,
+		std::vector<std::vector<float> >& alternativeLabels) const {
+
+	alternativeLabels[i] = getAlternativeLabels(*cells[i], neighborhood, recLabels);
+}
+
 bool
-DistanceToleranceFunction::isBoundaryVoxel(int x, int y, int z, const ImageStack& stack) {
+DistanceToleranceFunction::isBoundaryVoxel(int x, int y, int z, const Image& section, const Image* previous, const Image* next) const {
 
 	// voxels at the volume borders are always boundary voxels
 	if (x == 0 || x == (int)_width - 1)
@@ -179,161 +735,196 @@ DistanceToleranceFunction::isBoundaryVoxel(int x, int y, int z, const ImageStack
 	if (_depth > 1 && (z == 0 || z == (int)_depth - 1))
 		return true;
 
-	float center = (*stack[z])(x, y);
-
-	if (x > 0)
-		if ((*stack[z])(x - 1, y) != center)
-			return true;
-	if (x < (int)_width - 1)
-		if ((*stack[z])(x + 1, y) != center)
-			return true;
-	if (y > 0)
-		if ((*stack[z])(x, y - 1) != center)
-			return true;
-	if (y < (int)_height - 1)
-		if ((*stack[z])(x, y + 1) != center)
-			return true;
-	if (z > 0)
-		if ((*stack[z - 1])(x, y) != center)
-			return true;
-	if (z < (int)_depth - 1)
-		if ((*stack[z + 1])(x, y) != center)
-			return true;
+	float center = section(x, y);
+
+	if (section(x - 1, y) != center)
+		return true;
+	if (section(x + 1, y) != center)
+		return true;
+	if (section(x, y - 1) != center)
+		return true;
+	if (section(x, y + 1) != center)
+		return true;
+	if (previous && (*previous)(x, y) != center)
+		return true;
+	if (next && (*next)(x, y) != center)
+		return true;
 
 	return false;
 }
 
-std::vector<DistanceToleranceFunction::cell_t::Location>
+std::vector<DistanceToleranceFunction::NeighborhoodRow>
 DistanceToleranceFunction::createNeighborhood() {
 
-	std::vector<cell_t::Location> thresholdOffsets;
-
-	// quick check first: test on all three axes -- if they contain all covering
-	// labels already, we can abort iterating earlier in getAlternativeLabels()
-
-	for (int z = 1; z <= _maxDistanceThresholdZ; z++) {
-
-		thresholdOffsets.push_back(cell_t::Location(0, 0,  z));
-		thresholdOffsets.push_back(cell_t::Location(0, 0, -z));
-	}
-	for (int y = 1; y <= _maxDistanceThresholdY; y++) {
-
-		thresholdOffsets.push_back(cell_t::Location(0,  y, 0));
-		thresholdOffsets.push_back(cell_t::Location(0, -y, 0));
-	}
-	for (int x = 1; x <= _maxDistanceThresholdX; x++) {
+	_maxDistanceThresholdX = std::min((float)_width,  _maxDistanceThreshold/_resolutionX);
+	_maxDistanceThresholdY = std::min((float)_height, _maxDistanceThreshold/_resolutionY);
+	_maxDistanceThresholdZ = std::min((float)_depth,  _maxDistanceThreshold/_resolutionZ);
 
-		thresholdOffsets.push_back(cell_t::Location( x, 0, 0));
-		thresholdOffsets.push_back(cell_t::Location(-x, 0, 0));
-	}
+	std::vector<NeighborhoodRow> rows;
 
 	for (int z = -_maxDistanceThresholdZ; z <= _maxDistanceThresholdZ; z++)
-		for (int y = -_maxDistanceThresholdY; y <= _maxDistanceThresholdY; y++)
-			for (int x = -_maxDistanceThresholdX; x <= _maxDistanceThresholdX; x++) {
+		for (int y = -_maxDistanceThresholdY; y <= _maxDistanceThresholdY; y++) {
+
+			// find the largest x, such that (x, y, z) is within threshold 
+			// distance (locations on the axes always are)
+			int radius = -1;
+			for (int x = 0; x <= _maxDistanceThresholdX; x++) {
 
-				// axis locations have been added already, center is not needed
-				if ((x == 0 && y == 0) || (x == 0 && z == 0) || (y == 0 && z == 0))
-					continue;
+				bool onAxis = (x == 0 && y == 0) || (x == 0 && z == 0) || (y == 0 && z == 0);
 
-				// is it within threshold distance?
-				if (
+				if (!onAxis &&
 						x*_resolutionX*x*_resolutionX +
 						y*_resolutionY*y*_resolutionY +
-						z*_resolutionZ*z*_resolutionZ <= _maxDistanceThreshold*_maxDistanceThreshold)
+						z*_resolutionZ*z*_resolutionZ > _maxDistanceThreshold*_maxDistanceThreshold)
+					break;
 
-					thresholdOffsets.push_back(cell_t::Location(x, y, z));
+				radius = x;
 			}
 
-	return thresholdOffsets;
+			if (radius >= 0)
+				rows.push_back(NeighborhoodRow(y, z, radius));
+		}
+
+	return rows;
 }
 
-std::set<float>
+std::vector<float>
 DistanceToleranceFunction::getAlternativeLabels(
 		const cell_t& cell,
-		const std::vector<cell_t::Location>& neighborhood,
-		const ImageStack& recLabels) {
+		const std::vector<NeighborhoodRow>& neighborhood,
+		const ImageStack& recLabels) const {
+
+	typedef std::pair<const NeighborhoodRow*, const Image*> row_t;
 
 	float cellLabel = cell.getReconstructionLabel();
 
-	// counts for each neighbor label, how often it was found while iterating 
-	// over the cells locations
-	std::map<float, unsigned int> counts;
+	// the labels that have been seen in the neighborhood of every location 
+	// visited so far
+	std::vector<float> alternativeLabels;
 
-	// the number of cell locations visited so far
-	unsigned int numVisited = 0;
+	// the labels of the boundary locations in the neighborhood of the current 
+	// location
+	LabelCounts counts;
 
-	// the maximal number of alternative labels, starts with number of labels 
-	// found at first location and decreases whenever one label was not found
-	unsigned int maxAlternativeLabels = 0;
+	// the neighborhood rows that are inside the volume for the current run, 
+	// together with their section
+	std::vector<row_t> rows;
 
-	// for each location i in that cell
-	foreach (const cell_t::Location& i, cell) {
+	bool first = true;
 
-		// all the labels in the neighborhood of i
-		std::set<float> neighborhoodLabels;
+	// For each run of the cell, slide the neighborhood along the run: Moving 
+	// to the next location, only one location per row leaves and one enters 
+	// the neighborhood.
+	foreach (const cell_t::Run& run, cell.getRuns()) {
 
-		numVisited++;
+		rows.clear();
+		foreach (const NeighborhoodRow& row, neighborhood) {
 
-		// the number of complete neighbor labels that have been seen at the 
-		// current location
-		unsigned int numComplete = 0;
+			int y = run.y + row.y;
+			int z = run.z + row.z;
 
-		// for all locations within the neighborhood, get alternative labels
-		foreach (const cell_t::Location& n, neighborhood) {
+			if (y < _regionY || y >= _regionY + (int)_regionHeight || z < _regionZ || z >= _regionZ + (int)_regionDepth)
+				continue;
 
-			cell_t::Location j(i.x + n.x, i.y + n.y, i.z + n.z);
+			rows.push_back(std::make_pair(&row, recLabels[z].get()));
+		}
 
-			// are we leaving the image?
-			if (j.x < 0 || j.x >= (int)_width || j.y < 0 || j.y >= (int)_height || j.z < 0 || j.z >= (int)_depth)
-				continue;
+		counts.clear();
 
-			// is this a boundary?
-			if (!_boundaryMap(j.x, j.y, j.z))
-				continue;
+		for (unsigned int i = 0; i < run.length; i++) {
+
+			int x = run.x + i;
+
+			foreach (const row_t& r, rows) {
+
+				const NeighborhoodRow& row     = *r.first;
+				const Image&           section = *r.second;
+
+				// the position of the row in the region
+				int y = run.y + row.y - _regionY;
+				int z = run.z + row.z - _regionZ;
+
+				// the locations that enter the neighborhood
+				int begin = (i == 0 ? x - row.radius : x + row.radius) - _regionX;
+				int end   = x + row.radius + 1 - _regionX;
+
+				// the location that leaves the neighborhood
+				int leaving = x - row.radius - 1 - _regionX;
+
+				if (i > 0 && leaving >= 0 && _boundaryMap(leaving, y, z))
+					counts.remove(section(_regionX + leaving, _regionY + y));
+
+				for (int j = std::max(begin, 0); j < std::min(end, (int)_regionWidth); j++)
+					if (_boundaryMap(j, y, z))
+						counts.add(section(_regionX + j, _regionY + y));
+			}
+
+			counts.intersect(alternativeLabels, cellLabel, first);
+			first = false;
+
+			// none of the neighbor labels covers the cell
+			if (alternativeLabels.empty())
+				return alternativeLabels;
+		}
+	}
+
+	return alternativeLabels;
+}
+
+void
+DistanceToleranceFunction::LabelCounts::add(float label) {
+
+	for (unsigned int i = 0; i < _counts.size(); i++)
+		if (_counts[i].first == label) {
 
-			// now we have found a boundary pixel within our neighborhood
-			float label = (*(recLabels)[j.z])(j.x, j.y);
+			_counts[i].second++;
+			return;
+		}
 
-			// count how often we see a neighbor label the first time
-			if (label != cellLabel) {
+	_counts.push_back(std::make_pair(label, 1u));
+}
 
-				bool firstTime = neighborhoodLabels.insert(label).second;
+void
+DistanceToleranceFunction::LabelCounts::remove(float label) {
 
-				// seen the first time for the current location i
-				if (firstTime)
-					// is a potential alternative label (covers all visited 
-					// locations so far)
-					if (++counts[label] == numVisited) {
+	for (unsigned int i = 0; i < _counts.size(); i++)
+		if (_counts[i].first == label) {
 
-						numComplete++;
+			if (--_counts[i].second == 0) {
 
-						// if we have seen all the possible complete labels 
-						// already, there is no need to search further for the 
-						// current location i
-						if (numComplete == maxAlternativeLabels)
-							break;
-					}
+				_counts[i] = _counts.back();
+				_counts.pop_back();
 			}
+
+			return;
 		}
+}
+
+void
+DistanceToleranceFunction::LabelCounts::intersect(std::vector<float>& candidates, float exclude, bool first) const {
+
+	if (first) {
 
-		// the number of labels that we have seen for each location visited so 
-		// far is the maximal possible number of alternative labels
-		maxAlternativeLabels = numComplete;
+		candidates.clear();
+		for (unsigned int i = 0; i < _counts.size(); i++)
+			if (_counts[i].first != exclude)
+				candidates.push_back(_counts[i].first);
 
-		// none of the neighbor labels covers the cell
-		if (maxAlternativeLabels == 0)
-			break;
+		std::sort(candidates.begin(), candidates.end());
+
+		return;
 	}
 
-	std::set<float> alternativeLabels;
+	// keep the candidates that are still in the neighborhood
+	std::vector<float>::iterator kept = candidates.begin();
+	for (std::vector<float>::iterator candidate = candidates.begin(); candidate != candidates.end(); candidate++)
+		for (unsigned int i = 0; i < _counts.size(); i++)
+			if (_counts[i].first == *candidate) {
 
-	// collect all neighbor labels that we have seen for every location of the 
-	// cell
-	float label;
-	unsigned int count;
-	foreach (boost::tie(label, count), counts)
-		if (count == cell.size())
-			alternativeLabels.insert(label);
+				*kept = *candidate;
+				kept++;
+				break;
+			}
 
-	return alternativeLabels;
+	candidates.erase(kept, candidates.end());
 }
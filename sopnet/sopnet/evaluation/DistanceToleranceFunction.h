@@ -3,14 +3,36 @@
 
 #include "LocalToleranceFunction.h"
 
+/**
+ * A local tolerance function that allows cells to change their reconstruction 
+ * label to any label of a reconstruction boundary that is within a distance 
+ * threshold to every location of the cell.
+ *
+ * Boundary and distance maps are computed section-wise and the alternative 
+ * labels cell-wise, both in parallel. For large volumes, cells can be extracted 
+ * chunk by chunk to bound the memory needed for these maps.
+ */
 class DistanceToleranceFunction : public LocalToleranceFunction {
 
 public:
 
+	/**
+	 * Create a new distance tolerance function.
+	 *
+	 * @param distanceThreshold
+	 *             The maximal distance in nm a boundary is allowed to shift.
+	 * @param haveBackgroundLabel
+	 *             Whether there is a background label.
+	 * @param backgroundLabel
+	 *             The reconstruction background label.
+	 * @param numThreads
+	 *             The number of threads to use, 0 for one per CPU.
+	 */
 	DistanceToleranceFunction(
 			float distanceThreshold,
 			bool haveBackgroundLabel,
-			float backgroundLabel = 0.0);
+			float backgroundLabel = 0.0,
+			unsigned int numThreads = 0);
 
 	void extractCells(
 			unsigned int numCells,
@@ -18,6 +40,67 @@ public:
 			const ImageStack& recLabels,
 			const ImageStack& gtLabels);
 
+	/**
+	 * Extract cells chunk by chunk and find all alternative labels for them. 
+	 * Each chunk is processed with a halo large enough to see all boundaries 
+	 * within the distance threshold, and cells that cross chunk borders are 
+	 * merged afterwards. The result is the same as for extractCells() on the 
+	 * whole volume, up to the order of the cells.
+	 *
+	 * @param recLabels
+	 *             The reconstruction labels.
+	 * @param gtLabels
+	 *             The ground-truth labels.
+	 * @param chunkWidth, chunkHeight, chunkDepth
+	 *             The size of the chunks, 0 to not split the volume along an 
+	 *             axis.
+	 */
+	void extractCells(
+			const ImageStack& recLabels,
+			const ImageStack& gtLabels,
+			unsigned int chunkWidth,
+			unsigned int chunkHeight,
+			unsigned int chunkDepth);
+
+	/**
+	 * Extract the fragments of cells in a part of the volume, i.e., the 
+	 * connected components of equal ground-truth and reconstruction labels 
+	 * within this part, and find the alternative labels of each fragment. A 
+	 * cell made of several fragments can be relabeled to the labels all its 
+	 * fragments agree on. Fragments with a location further away from a 
+	 * boundary than the distance threshold get no alternative labels.
+	 *
+	 * The fragments of a part only depend on the labels within the halo 
+	 * around the part (see getHaloX()), which allows updating them 
+	 * incrementally (see IncrementalTolerantEditDistance).
+	 *
+	 * @param recLabels 
+	 *             The reconstruction labels.
+	 * @param gtLabels 
+	 *             The ground-truth labels.
+	 * @param x0, y0, z0, x1, y1, z1 
+	 *             The bounding box of the part, excluding the upper bounds.
+	 * @param fragments [out] 
+	 *             The fragments found in the part.
+	 * @param fragmentIds [out] 
+	 *             The index of the fragment for each location of the part.
+	 */
+	void extractCellFragments(
+			const ImageStack& recLabels,
+			const ImageStack& gtLabels,
+			int x0, int y0, int z0,
+			int x1, int y1, int z1,
+			std::vector<cell_t>& fragments,
+			vigra::MultiArray<3, unsigned int>& fragmentIds);
+
+	/**
+	 * Get the number of locations in x, y, and z around a location that can 
+	 * influence the cell fragments at this location.
+	 */
+	int getHaloX() const;
+	int getHaloY() const;
+	int getHaloZ() const;
+
 protected:
 
 	virtual void findRelabelCandidates(const std::vector<float>& maxBoundaryDistances);
@@ -29,33 +112,127 @@ protected:
 
 private:
 
+	// a row of the neighborhood, i.e., all offsets (x, y, z) with |x| <= 
+	// radius
+	struct NeighborhoodRow {
+
+		NeighborhoodRow(int y_, int z_, int radius_) :
+			y(y_), z(z_), radius(radius_) {}
+
+		int y, z;
+
+		int radius;
+	};
+
+	// the number of boundary locations per label in a neighborhood
+	class LabelCounts {
+
+	public:
+
+		void clear() { _counts.clear(); }
+
+		void add(float label);
+
+		void remove(float label);
+
+		// keep only the labels in candidates that have a count, or initialize 
+		// candidates with all labels but exclude if first is true
+		void intersect(std::vector<float>& candidates, float exclude, bool first) const;
+
+	private:
+
+		// there are only a few labels in each neighborhood, a vector is 
+		// faster than a map
+		std::vector<std::pair<float, unsigned int> > _counts;
+	};
+
+	// a chunk of the volume and the cell fragments found in it
+	struct Chunk {
+
+		int x0, y0, z0;
+		int x1, y1, z1;
+
+		unsigned int firstFragment;
+		unsigned int numFragments;
+	};
+
+	// set the part of the volume the boundary and distance maps are computed 
+	// for
+	void setRegion(int x0, int y0, int z0, int x1, int y1, int z1);
+
+	// find the connected components of equal labels in a chunk, returns the 
+	// number of components
+	unsigned int labelFragments(
+			const Chunk& chunk,
+			const ImageStack& recLabels,
+			const ImageStack& gtLabels,
+			vigra::MultiArray<3, unsigned int>& fragmentIds);
+
+	// extract the cell fragments of one chunk, connect them to the fragments 
+	// of previous chunks
+	void extractFragments(
+			Chunk& chunk,
+			const ImageStack& recLabels,
+			const ImageStack& gtLabels,
+			std::vector<cell_t>& fragments,
+			std::vector<float>& maxBoundaryDistances,
+			std::vector<unsigned int>& parents,
+			std::vector<unsigned int>& xFace,
+			std::vector<unsigned int>& yFace,
+			std::vector<unsigned int>& zFace);
+
+	// find the root of a fragment in the union-find forest parents
+	unsigned int findRoot(unsigned int fragment, std::vector<unsigned int>& parents);
+
 	// find alternative cell labels
 	void enumerateCellLabels(const ImageStack& recLabels);
 
+	// add alternative labels for each relabel candidate
+	void registerAlternativeLabels(const std::vector<std::vector<float> >& alternativeLabels);
+
 	// create a b/w image of reconstruction label changes
 	void createBoundaryMap(const ImageStack& recLabels);
 
+	// create the boundary map for one section
+	void createBoundaryMapSection(unsigned int z, const ImageStack& recLabels);
+
 	// create a distance2 image of boundary distances
 	void createBoundaryDistanceMap();
 
-	// find all offset locations for the given distance threshold
-	std::vector<cell_t::Location> createNeighborhood();
+	// create the distance2 image for the given slab of sections, considering 
+	// only boundaries up to padding sections away from the slab
+	void createBoundaryDistanceMapSlab(unsigned int slab, unsigned int slabDepth, unsigned int padding);
+
+	// find the rows of offset locations for the given distance threshold, 
+	// sets the distance thresholds in pixels
+	std::vector<NeighborhoodRow> createNeighborhood();
+
+	// find the alternative labels of the ith of the given cells
+	void findAlternativeLabels(
+			unsigned int i,
+			const std::vector<const cell_t*>& cells,
+			const std::vector<NeighborhoodRow>& neighborhood,
+			const ImageStack& recLabels,
+			std::vector<std::vector<float> >& alternativeLabels) const;
 
 	// search for all relabeling alternatives for the given cell and 
-	// neighborhood
-	std::set<float> getAlternativeLabels(
+	// neighborhood, returns a sorted list of labels
+	std::vector<float> getAlternativeLabels(
 			const cell_t& cell,
-			const std::vector<cell_t::Location>& neighborhood,
-			const ImageStack& recLabels);
+			const std::vector<NeighborhoodRow>& neighborhood,
+			const ImageStack& recLabels) const;
 
 	// test, whether a voxel is surrounded by at least one other voxel with a 
 	// different label
-	bool isBoundaryVoxel(int x, int y, int z, const ImageStack& stack);
+	bool isBoundaryVoxel(int x, int y, int z, const Image& section, const Image* previous, const Image* next) const;
+
+	// the number of threads to use
+	unsigned int _numThreads;
 
 	// the distance threshold in nm
 	float _maxDistanceThreshold;
 
-	// the size of one voxel
+	// the size of one voxel in nm
 	float _resolutionX;
 	float _resolutionY;
 	float _resolutionZ;
@@ -68,7 +245,15 @@ private:
 	// the extends of the ground truth and reconstruction
 	unsigned int _width, _height, _depth;
 
+	// the part of the volume covered by the boundary and distance maps
+	int _regionX, _regionY, _regionZ;
+	unsigned int _regionWidth, _regionHeight, _regionDepth;
+
+	// the boundary map of the region
 	vigra::MultiArray<3, bool>  _boundaryMap;
+
+	// the squared distance to the next boundary in the region, exact up to the 
+	// distance threshold
 	vigra::MultiArray<3, float> _boundaryDistance2;
 };
 
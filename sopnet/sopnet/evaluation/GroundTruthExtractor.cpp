@@ -1,9 +1,23 @@
+#include <functional>
+#include <iomanip>
+#include <queue>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/ref.hpp>
+
 #include <pipeline/Value.h>
 #include <pipeline/Process.h>
-#include <imageprocessing/ImageExtractor.h>
+#include <imageprocessing/ConnectedComponent.h>
+#include <sopnet/io/BinaryFormat.h>
+#include <sopnet/parallel.h>
+#include <sopnet/slices/ComponentTreeConverter.h>
 #include <sopnet/slices/SliceExtractor.h>
 #include "GroundTruthExtractor.h"
 
+extern util::ProgramOption optionMaxSliceMerges;
+
 util::ProgramOption optionGroundTruthFromSkeletons(
 		util::_module           = "sopnet.evaluation",
 		util::_long_name        = "groundTruthFromSkeletons",
@@ -14,12 +28,50 @@ util::ProgramOption optionGroundTruthAddIntensityBoundaries(
 		util::_long_name        = "groundTruthAddIntensityBoundaries",
 		util::_description_text = "Separate ground truth regions of different intensities with a black boundary, such that components of same intensity end up to be exactly one slice.");
 
+util::ProgramOption optionGroundTruthThreads(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "groundTruthThreads",
+		util::_description_text = "The number of threads to extract the ground-truth slices with. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionGroundTruthCacheDirectory(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "groundTruthCacheDirectory",
+		util::_description_text = "A directory to keep the extracted ground-truth segments between runs. Segments of a ground truth that "
+		                          "was extracted before with the same options are read from there instead of being extracted again.");
+
+// bump this whenever the content of the ground-truth cache files changes
+static const boost::uint32_t GroundTruthCacheVersion = 1;
+
+namespace {
+
+// add bytes to a 64 bit FNV-1a hash
+void hashBytes(boost::uint64_t& hash, const void* data, std::size_t size) {
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	for (std::size_t i = 0; i < size; i++) {
+
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+template <typename T>
+void hashValue(boost::uint64_t& hash, const T& value) {
+
+	hashBytes(hash, &value, sizeof(T));
+}
+
+} // anonymous namespace
+
 logger::LogChannel groundtruthextractorlog("groundtruthextractorlog", "[GroundTruthExtractor] ");
 
 GroundTruthExtractor::GroundTruthExtractor(bool endSegmentsOnly) :
 	_groundTruthSegments(new Segments()),
 	_addIntensityBoundaries(optionGroundTruthAddIntensityBoundaries && !optionGroundTruthFromSkeletons),
-	_endSegmentsOnly(endSegmentsOnly) {
+	_endSegmentsOnly(endSegmentsOnly),
+	_numThreads(optionGroundTruthThreads) {
 
 	registerInput(_groundTruthSections, "ground truth sections");
 	registerOutput(_groundTruthSegments, "ground truth segments");
@@ -36,9 +88,32 @@ GroundTruthExtractor::updateOutputs() {
 			<< firstSection << " - " << lastSection
 			<< std::endl;
 
+	std::string cacheFilename = getCacheFilename();
+
+	if (!cacheFilename.empty() && readCache(cacheFilename, *_groundTruthSegments))
+		return;
+
 	std::vector<Slices> slices = extractSlices(firstSection, lastSection);
 
 	*_groundTruthSegments = findMinimalTrees(slices);
+
+	if (cacheFilename.empty())
+		return;
+
+	// the cache is only an optimization, failing to write it is not an error 
+	// of the extraction
+	try {
+
+		writeCache(cacheFilename, slices, *_groundTruthSegments);
+
+	} catch (IOError&) {
+
+		LOG_ERROR(groundtruthextractorlog) << "could not write cache file " << cacheFilename << std::endl;
+
+	} catch (boost::filesystem::filesystem_error& e) {
+
+		LOG_ERROR(groundtruthextractorlog) << "could not write cache file " << cacheFilename << ": " << e.what() << std::endl;
+	}
 }
 
 std::vector<Slices>
@@ -66,36 +141,93 @@ GroundTruthExtractor::extractSlices(int firstSection, int lastSection) {
 	cteParameters->minIntensity = 0;
 	cteParameters->maxIntensity = maxIntensity;
 
-	// create a section extractor to access the sections in the stack
-	pipeline::Process<ImageExtractor> sectionExtractor;
-	sectionExtractor->setInput(_groundTruthSections);
-
 	// list of all slices for each section
-	std::vector<Slices> slices;
+	std::vector<Slices> slices(lastSection - firstSection + 1);
+
+	unsigned int numThreads = getNumWorkerThreads(_numThreads, slices.size());
+
+	LOG_DEBUG(groundtruthextractorlog)
+			<< "extracting slices of " << slices.size() << " sections with "
+			<< numThreads << " threads" << std::endl;
+
+	parallelFor(
+			numThreads,
+			slices.size(),
+			boost::bind(
+					&GroundTruthExtractor::extractSectionSlices,
+					this,
+					_1,
+					firstSection,
+					boost::cref(*cteParameters),
+					boost::ref(slices)));
+
+	renumberSlices(slices);
+
+	return slices;
+}
+
+void
+GroundTruthExtractor::extractSectionSlices(
+		unsigned int                            i,
+		int                                     firstSection,
+		const ComponentTreeExtractorParameters& parameters,
+		std::vector<Slices>&                    slices) {
 
 	float resX = _groundTruthSections->getResolutionX();
 	float resY = _groundTruthSections->getResolutionY();
 	float resZ = _groundTruthSections->getResolutionZ();
 
-	for (int section = firstSection; section <= lastSection; section++) {
+	int section = firstSection + i;
 
-		LOG_DEBUG(groundtruthextractorlog) << "extracting slices in section " << section << std::endl;
+	LOG_DEBUG(groundtruthextractorlog) << "extracting slices in section " << section << std::endl;
 
-		// create a SliceExtractor
-		pipeline::Process<SliceExtractor<unsigned short> > sliceExtractor(section, resX, resY, resZ, false /* don't downsample */);
+	// each section gets its own pipeline, nothing is shared between the 
+	// threads
+	boost::shared_ptr<ComponentTreeExtractorParameters> sectionParameters =
+			boost::make_shared<ComponentTreeExtractorParameters>(parameters);
 
-		// give it the section it has to process and our parameters
-		sliceExtractor->setInput("membrane", sectionExtractor->getOutput(section));
-		sliceExtractor->setInput("parameters", cteParameters);
+	// create a SliceExtractor
+	pipeline::Process<SliceExtractor<unsigned short> > sliceExtractor(section, resX, resY, resZ, false /* don't downsample */);
 
-		// get the slices in the current section
-		pipeline::Value<Slices> sectionSlices = sliceExtractor->getOutput("slices");
-		slices.push_back(*sectionSlices);
+	// give it the section it has to process and our parameters
+	sliceExtractor->setInput("membrane", (*_groundTruthSections)[section]);
+	sliceExtractor->setInput("parameters", sectionParameters);
 
-		LOG_ALL(groundtruthextractorlog) << "found " << sectionSlices->size() << " slices" << std::endl;
-	}
+	// get the slices in the current section
+	pipeline::Value<Slices> sectionSlices = sliceExtractor->getOutput("slices");
+	slices[i] = *sectionSlices;
 
-	return slices;
+	LOG_ALL(groundtruthextractorlog) << "found " << sectionSlices->size() << " slices" << std::endl;
+}
+
+void
+GroundTruthExtractor::renumberSlices(std::vector<Slices>& slices) {
+
+	float resX = _groundTruthSections->getResolutionX();
+	float resY = _groundTruthSections->getResolutionY();
+	float resZ = _groundTruthSections->getResolutionZ();
+
+	// The slices of a section are ordered by their hashes, which do not 
+	// depend on the ids. Conflicts between slices are not used for the ground 
+	// truth and not carried over.
+	for (unsigned int i = 0; i < slices.size(); i++) {
+
+		Slices renumbered;
+
+		foreach (boost::shared_ptr<Slice> slice, slices[i]) {
+
+			boost::shared_ptr<Slice> copy =
+					boost::make_shared<Slice>(
+							ComponentTreeConverter::getNextSliceId(),
+							slice->getSection(),
+							slice->getComponent());
+			copy->setResolution(resX, resY, resZ);
+
+			renumbered.add(copy);
+		}
+
+		slices[i] = renumbered;
+	}
 }
 
 Segments
@@ -160,41 +292,79 @@ GroundTruthExtractor::findLabelTree(
 
 	LOG_ALL(groundtruthextractorlog) << "processing neuron label " << label << std::endl;
 
+	if (continuations.empty())
+		return;
+
+	// sort continuations by overlap, computing overlap and displacement only 
+	// once per continuation
+	Overlap overlap(false, false);
+
+	std::vector<ContinuationKey> keys(continuations.size());
+
+	for (unsigned int i = 0; i < continuations.size(); i++) {
+
+		const ContinuationSegment& continuation = continuations[i];
+
+		util::point<double> diff =
+				continuation.getTargetSlice()->getComponent()->getCenter() -
+				continuation.getSourceSlice()->getComponent()->getCenter();
+
+		keys[i].overlap  = overlap(*continuation.getSourceSlice(), *continuation.getTargetSlice());
+		keys[i].distance = diff.x*diff.x + diff.y*diff.y;
+		keys[i].index    = i;
+	}
+
+	std::sort(keys.begin(), keys.end());
+
+	// The rank of a continuation in this order is its cost. The tree is grown 
+	// as in Prim's algorithm, with the continuations of all connected slices 
+	// in a priority queue.
+	std::map<unsigned int, std::vector<unsigned int> > adjacentContinuations;
+
+	for (unsigned int rank = 0; rank < keys.size(); rank++) {
+
+		const ContinuationSegment& continuation = continuations[keys[rank].index];
+
+		adjacentContinuations[continuation.getSourceSlice()->getId()].push_back(rank);
+		adjacentContinuations[continuation.getTargetSlice()->getId()].push_back(rank);
+	}
+
 	// all currently connected slices
 	std::set<unsigned int> connectedSlices;
 
-	// sort continuations by overlap
-	std::sort(continuations.begin(), continuations.end(), ContinuationComparator());
+	// the ranks of the continuations of connected slices, cheapest first
+	std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int> > openContinuations;
 
-	// pick initial slice, put into connected slices
-	unsigned int initialSlice = continuations.begin()->getSourceSlice()->getId();
-	connectedSlices.insert(initialSlice);
+	// continuations before this rank have no disconnected slices
+	unsigned int nextDisconnected = 0;
 
-	LOG_ALL(groundtruthextractorlog) << "initial slice is " << initialSlice << std::endl;
+	// pick initial slice
+	unsigned int newSlice = continuations[keys[0].index].getSourceSlice()->getId();
+
+	LOG_ALL(groundtruthextractorlog) << "initial slice is " << newSlice << std::endl;
 
 	// iterate
-	bool allConnected = false;
-	while (!allConnected) {
+	while (true) {
+
+		// put new slice into connected slices
+		connectedSlices.insert(newSlice);
+		foreach (unsigned int rank, adjacentContinuations[newSlice])
+			openContinuations.push(rank);
 
 		bool foundOpenEdge = false;
-		bool foundDisconnectedSlices = false;
 
 		// find cheapest continuation for any connected slice to any not 
 		// connected slice
-		for (std::vector<ContinuationSegment>::const_iterator i = continuations.begin(); i != continuations.end(); i++) {
-
-			unsigned int source = i->getSourceSlice()->getId();
-			unsigned int target = i->getTargetSlice()->getId();
+		while (!openContinuations.empty()) {
 
-			int sourceTargetCount = connectedSlices.count(source) + connectedSlices.count(target);
+			const ContinuationSegment& continuation = continuations[keys[openContinuations.top()].index];
+			openContinuations.pop();
 
-			if (sourceTargetCount != 1) {
-
-				if (sourceTargetCount == 0)
-					foundDisconnectedSlices = true;
+			unsigned int source = continuation.getSourceSlice()->getId();
+			unsigned int target = continuation.getTargetSlice()->getId();
 
+			if (connectedSlices.count(source) && connectedSlices.count(target))
 				continue;
-			}
 
 			LOG_ALL(groundtruthextractorlog)
 					<< "next best continuation from connected to not-connected slice is "
@@ -204,10 +374,10 @@ GroundTruthExtractor::findLabelTree(
 			foundOpenEdge = true;
 
 			// put continuation in segments
-			segments.add(boost::make_shared<ContinuationSegment>(*i));
+			segments.add(boost::make_shared<ContinuationSegment>(continuation));
 
 			// count number of usages of involved slices
-			if (i->getDirection() == Right) {
+			if (continuation.getDirection() == Right) {
 
 				linksLeft[target]++;
 				linksRight[source]++;
@@ -218,39 +388,41 @@ GroundTruthExtractor::findLabelTree(
 				linksLeft[source]++;
 			}
 
-			// put new slice into connected slices
-			connectedSlices.insert(target);
-			connectedSlices.insert(source);
+			newSlice = (connectedSlices.count(source) ? target : source);
 
 			break;
 		}
 
-		if (!foundOpenEdge && foundDisconnectedSlices) {
-
-			LOG_USER(groundtruthextractorlog) << "Warning: ground-truth contains disconnected neuron with same label: " << label << std::endl;
+		if (foundOpenEdge)
+			continue;
 
-			// add a new disconnected slice to the set of connected slices 
-			// to continue growing the tree
-			for (std::vector<ContinuationSegment>::const_iterator i = continuations.begin(); i != continuations.end(); i++) {
+		// the tree is complete, look for a disconnected slice of the same 
+		// label to continue growing the tree
+		bool foundDisconnectedSlice = false;
 
-				if (connectedSlices.count(i->getSourceSlice()->getId()) == 0) {
+		for (; nextDisconnected < keys.size(); nextDisconnected++) {
 
-					connectedSlices.insert(i->getSourceSlice()->getId());
-					break;
-				}
+			const ContinuationSegment& continuation = continuations[keys[nextDisconnected].index];
 
-				if (connectedSlices.count(i->getTargetSlice()->getId()) == 0) {
+			if (connectedSlices.count(continuation.getSourceSlice()->getId()) == 0) {
 
-					connectedSlices.insert(i->getTargetSlice()->getId());
-					break;
-				}
+				newSlice = continuation.getSourceSlice()->getId();
+				foundDisconnectedSlice = true;
+				break;
 			}
 
-			continue;
+			if (connectedSlices.count(continuation.getTargetSlice()->getId()) == 0) {
+
+				newSlice = continuation.getTargetSlice()->getId();
+				foundDisconnectedSlice = true;
+				break;
+			}
 		}
 
-		if (!foundOpenEdge)
-			allConnected = true;
+		if (!foundDisconnectedSlice)
+			break;
+
+		LOG_USER(groundtruthextractorlog) << "Warning: ground-truth contains disconnected neuron with same label: " << label << std::endl;
 	}
 }
 
@@ -263,28 +435,267 @@ GroundTruthExtractor::extractContinuations(const std::vector<Slices>& slices) {
 
 		LOG_ALL(groundtruthextractorlog) << "extracting potential continuations between " << i << " and " << (i+1) << std::endl;
 
+		// the slices of the right section by label
+		std::map<float, std::vector<boost::shared_ptr<Slice> > > rightSlices;
+		foreach (boost::shared_ptr<Slice> rightSlice, slices[i+1])
+			rightSlices[rightSlice->getComponent()->getValue()].push_back(rightSlice);
+
 		foreach (boost::shared_ptr<Slice> leftSlice, slices[i]) {
 
 			float leftValue = leftSlice->getComponent()->getValue();
 
-			foreach (boost::shared_ptr<Slice> rightSlice, slices[i+1]) {
+			std::map<float, std::vector<boost::shared_ptr<Slice> > >::const_iterator sameValue = rightSlices.find(leftValue);
 
-				float rightValue = rightSlice->getComponent()->getValue();
+			if (sameValue == rightSlices.end())
+				continue;
 
-				if (leftValue == rightValue) {
+			foreach (boost::shared_ptr<Slice> rightSlice, sameValue->second) {
 
-					LOG_ALL(groundtruthextractorlog) << "found a potential continuation" << std::endl;
+				LOG_ALL(groundtruthextractorlog) << "found a potential continuation" << std::endl;
 
-					continuations[leftValue].push_back(
-							ContinuationSegment(
-									Segment::getNextSegmentId(),
-									Right,
-									leftSlice,
-									rightSlice));
-				}
+				continuations[leftValue].push_back(
+						ContinuationSegment(
+								Segment::getNextSegmentId(),
+								Right,
+								leftSlice,
+								rightSlice));
 			}
 		}
 	}
 
 	return continuations;
 }
+
+std::string
+GroundTruthExtractor::getCacheFilename() {
+
+	if (!optionGroundTruthCacheDirectory)
+		return "";
+
+	std::string directory = optionGroundTruthCacheDirectory.as<std::string>();
+
+	try {
+
+		if (!boost::filesystem::exists(directory))
+			boost::filesystem::create_directories(directory);
+
+	} catch (boost::filesystem::filesystem_error& e) {
+
+		LOG_ERROR(groundtruthextractorlog) << "could not create cache directory " << directory << ", not using a cache: " << e.what() << std::endl;
+		return "";
+	}
+
+	std::stringstream filename;
+	filename
+			<< directory << "/ground_truth_"
+			<< std::hex << std::setw(16) << std::setfill('0') << hashGroundTruth()
+			<< ".bin";
+
+	return filename.str();
+}
+
+boost::uint64_t
+GroundTruthExtractor::hashGroundTruth() {
+
+	boost::uint64_t hash = 14695981039346656037ULL;
+
+	hashValue(hash, GroundTruthCacheVersion);
+
+	// the options that change the extracted slices and segments
+	hashValue(hash, static_cast<bool>(optionGroundTruthFromSkeletons));
+	hashValue(hash, _addIntensityBoundaries);
+	hashValue(hash, _endSegmentsOnly);
+	hashValue(hash, optionMaxSliceMerges.as<int>());
+
+	hashValue(hash, _groundTruthSections->getResolutionX());
+	hashValue(hash, _groundTruthSections->getResolutionY());
+	hashValue(hash, _groundTruthSections->getResolutionZ());
+	hashValue(hash, _groundTruthSections->size());
+
+	foreach (boost::shared_ptr<Image> image, *_groundTruthSections) {
+
+		hashValue(hash, image->width());
+		hashValue(hash, image->height());
+
+		for (Image::iterator i = image->begin(); i != image->end(); i++)
+			hashValue(hash, *i);
+	}
+
+	return hash;
+}
+
+bool
+GroundTruthExtractor::readCache(const std::string& filename, Segments& segments) {
+
+	if (!boost::filesystem::exists(filename)) {
+
+		LOG_DEBUG(groundtruthextractorlog) << "no cache file " << filename << " found" << std::endl;
+		return false;
+	}
+
+	std::vector<boost::uint32_t> sliceSections;
+	std::vector<double>          sliceValues;
+	std::vector<boost::uint64_t> pixelStarts;
+	std::vector<boost::uint32_t> pixels;
+	std::vector<boost::uint32_t> continuations;
+	std::vector<boost::uint32_t> ends;
+
+	try {
+
+		BinaryReader reader(filename, BinaryGroundTruth);
+
+		reader.readArray(sliceSections);
+		reader.readArray(sliceValues);
+		reader.readArray(pixelStarts);
+		reader.readArray(pixels);
+		reader.readArray(continuations);
+		reader.readArray(ends);
+
+	} catch (IOError&) {
+
+		LOG_ERROR(groundtruthextractorlog) << "could not read cache file " << filename << ", extracting the ground truth again" << std::endl;
+		return false;
+	}
+
+	unsigned int numSlices = sliceSections.size();
+
+	bool valid =
+			sliceValues.size() == numSlices &&
+			pixelStarts.size() == numSlices + 1 &&
+			pixelStarts.back() == pixels.size()/2 &&
+			continuations.size() % 3 == 0 &&
+			ends.size() % 2 == 0;
+
+	for (unsigned int i = 0; valid && i < numSlices; i++)
+		valid = sliceSections[i] < _groundTruthSections->size() && pixelStarts[i] <= pixelStarts[i+1];
+	for (unsigned int i = 0; valid && i < numSlices; i++) {
+
+		const Image& section = *(*_groundTruthSections)[sliceSections[i]];
+
+		for (boost::uint64_t j = pixelStarts[i]; valid && j < pixelStarts[i+1]; j++)
+			valid = pixels[2*j] < section.width() && pixels[2*j+1] < section.height();
+	}
+	for (unsigned int i = 0; valid && i < continuations.size(); i += 3)
+		valid = continuations[i] < numSlices && continuations[i+1] < numSlices;
+	for (unsigned int i = 0; valid && i < ends.size(); i += 2)
+		valid = ends[i] < numSlices;
+
+	if (!valid) {
+
+		LOG_ERROR(groundtruthextractorlog) << "cache file " << filename << " is corrupt, extracting the ground truth again" << std::endl;
+		return false;
+	}
+
+	float resX = _groundTruthSections->getResolutionX();
+	float resY = _groundTruthSections->getResolutionY();
+	float resZ = _groundTruthSections->getResolutionZ();
+
+	std::vector<boost::shared_ptr<Slice> > slices(numSlices);
+
+	for (unsigned int i = 0; i < numSlices; i++) {
+
+		boost::shared_ptr<ConnectedComponent::pixel_list_type> pixelList =
+				boost::make_shared<ConnectedComponent::pixel_list_type>(pixelStarts[i+1] - pixelStarts[i]);
+
+		for (boost::uint64_t j = pixelStarts[i]; j < pixelStarts[i+1]; j++)
+			pixelList->add(util::point<unsigned int>(pixels[2*j], pixels[2*j+1]));
+
+		boost::shared_ptr<ConnectedComponent> component =
+				boost::make_shared<ConnectedComponent>(
+						(*_groundTruthSections)[sliceSections[i]],
+						sliceValues[i],
+						pixelList,
+						pixelList->begin(),
+						pixelList->end());
+
+		slices[i] = boost::make_shared<Slice>(ComponentTreeConverter::getNextSliceId(), sliceSections[i], component);
+		slices[i]->setResolution(resX, resY, resZ);
+	}
+
+	Segments cached;
+	cached.setResolution(resX, resY, resZ);
+
+	for (unsigned int i = 0; i < continuations.size(); i += 3)
+		cached.add(
+				boost::make_shared<ContinuationSegment>(
+						Segment::getNextSegmentId(),
+						static_cast<Direction>(continuations[i+2]),
+						slices[continuations[i]],
+						slices[continuations[i+1]]));
+
+	for (unsigned int i = 0; i < ends.size(); i += 2)
+		cached.add(
+				boost::make_shared<EndSegment>(
+						Segment::getNextSegmentId(),
+						static_cast<Direction>(ends[i+1]),
+						slices[ends[i]]));
+
+	segments = cached;
+
+	LOG_USER(groundtruthextractorlog)
+			<< "read " << numSlices << " ground-truth slices and "
+			<< (continuations.size()/3 + ends.size()/2) << " segments from "
+			<< filename << std::endl;
+
+	return true;
+}
+
+void
+GroundTruthExtractor::writeCache(const std::string& filename, const std::vector<Slices>& slices, const Segments& segments) {
+
+	// the position of each slice in the cache file
+	std::map<unsigned int, boost::uint32_t> sliceIndices;
+
+	std::vector<boost::uint32_t> sliceSections;
+	std::vector<double>          sliceValues;
+	std::vector<boost::uint64_t> pixelStarts;
+	std::vector<boost::uint32_t> pixels;
+
+	for (unsigned int i = 0; i < slices.size(); i++)
+		foreach (boost::shared_ptr<Slice> slice, slices[i]) {
+
+			sliceIndices[slice->getId()] = sliceSections.size();
+
+			sliceSections.push_back(slice->getSection());
+			sliceValues.push_back(slice->getComponent()->getValue());
+			pixelStarts.push_back(pixels.size()/2);
+
+			foreach (const util::point<unsigned int>& pixel, slice->getComponent()->getPixels()) {
+
+				pixels.push_back(pixel.x);
+				pixels.push_back(pixel.y);
+			}
+		}
+
+	pixelStarts.push_back(pixels.size()/2);
+
+	// source, target, and direction of each continuation
+	std::vector<boost::uint32_t> continuations;
+	foreach (boost::shared_ptr<ContinuationSegment> continuation, segments.getContinuations()) {
+
+		continuations.push_back(sliceIndices[continuation->getSourceSlice()->getId()]);
+		continuations.push_back(sliceIndices[continuation->getTargetSlice()->getId()]);
+		continuations.push_back(continuation->getDirection());
+	}
+
+	// slice and direction of each end
+	std::vector<boost::uint32_t> ends;
+	foreach (boost::shared_ptr<EndSegment> end, segments.getEnds()) {
+
+		ends.push_back(sliceIndices[end->getSlice()->getId()]);
+		ends.push_back(end->getDirection());
+	}
+
+	BinaryWriter writer(BinaryGroundTruth);
+
+	writer.writeArray(sliceSections);
+	writer.writeArray(sliceValues);
+	writer.writeArray(pixelStarts);
+	writer.writeArray(pixels);
+	writer.writeArray(continuations);
+	writer.writeArray(ends);
+
+	writer.write(filename);
+
+	LOG_DEBUG(groundtruthextractorlog) << "wrote ground-truth segments to " << filename << std::endl;
+}
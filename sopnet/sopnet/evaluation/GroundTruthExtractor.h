@@ -1,9 +1,14 @@
 #ifndef SOPNET_GROUND_TRUTH_EXTRACTOR_H__
 #define SOPNET_GROUND_TRUTH_EXTRACTOR_H__
 
+#include <map>
+#include <string>
 #include <vector>
 
+#include <boost/cstdint.hpp>
+
 #include <pipeline/SimpleProcessNode.h>
+#include <imageprocessing/ComponentTreeExtractor.h>
 #include <imageprocessing/ImageStack.h>
 #include <sopnet/slices/Slices.h>
 #include <sopnet/segments/Segments.h>
@@ -27,33 +32,27 @@ public:
 private:
 
 	/**
-	 * Sorts continuations by source-target overlap descending.
+	 * The sort key of a continuation: continuations with larger source-target 
+	 * overlap come first, then the ones with smaller displacement. Remaining 
+	 * ties are broken by the position of the continuation, such that the 
+	 * order is deterministic.
 	 */
-	struct ContinuationComparator {
-
-		ContinuationComparator() :
-			overlap(false, false) {}
-
-		bool operator()(const ContinuationSegment& a, const ContinuationSegment& b) {
+	struct ContinuationKey {
 
-			double overlapA = overlap(*a.getSourceSlice(), *a.getTargetSlice());
-			double overlapB = overlap(*b.getSourceSlice(), *b.getTargetSlice());
+		bool operator<(const ContinuationKey& other) const {
 
-			// larger overlap goes to front
-			if (overlapA != overlapB)
-				return overlapA > overlapB;
+			if (overlap != other.overlap)
+				return overlap > other.overlap;
 
-			util::point<double> diffA = a.getTargetSlice()->getComponent()->getCenter() - a.getSourceSlice()->getComponent()->getCenter();
-			util::point<double> diffB = b.getTargetSlice()->getComponent()->getCenter() - b.getSourceSlice()->getComponent()->getCenter();
+			if (distance != other.distance)
+				return distance < other.distance;
 
-			double distanceA = diffA.x*diffA.x + diffA.y*diffA.y;
-			double distanceB = diffB.x*diffB.x + diffB.y*diffB.y;
-
-			// smaller displacement goes to front
-			return distanceA < distanceB;
+			return index < other.index;
 		}
 
-		Overlap overlap;
+		double       overlap;
+		double       distance;
+		unsigned int index;
 	};
 
 	void updateOutputs();
@@ -61,6 +60,18 @@ private:
 	// extract all slices of each ground-truth section
 	std::vector<Slices> extractSlices(int firstSection, int lastSection);
 
+	// extract the slices of the ith section after firstSection, called by 
+	// the worker threads
+	void extractSectionSlices(
+			unsigned int                            i,
+			int                                     firstSection,
+			const ComponentTreeExtractorParameters& parameters,
+			std::vector<Slices>&                    slices);
+
+	// replace the slices by copies with ids assigned in the order of the 
+	// sections, independent of the order in which the sections were processed
+	void renumberSlices(std::vector<Slices>& slices);
+
 	std::map<float, std::vector<ContinuationSegment> > extractContinuations(const std::vector<Slices>& slices);
 
 	// find a minimal spanning segment tree for each set of slices with the same 
@@ -75,6 +86,21 @@ private:
 			std::map<unsigned int, unsigned int>& linksRight,
 			Segments& segments);
 
+	// get the name of the cache file for the current ground truth, empty if 
+	// no cache directory is set
+	std::string getCacheFilename();
+
+	// hash the ground truth and all options that change the extracted 
+	// segments
+	boost::uint64_t hashGroundTruth();
+
+	// read the segments from a cache file, returns false if there is no valid 
+	// cache file
+	bool readCache(const std::string& filename, Segments& segments);
+
+	// write the slices and segments to a cache file
+	void writeCache(const std::string& filename, const std::vector<Slices>& slices, const Segments& segments);
+
 	// the ground truth images
 	pipeline::Input<ImageStack> _groundTruthSections;
 
@@ -84,6 +110,9 @@ private:
 	bool _addIntensityBoundaries;
 
 	bool _endSegmentsOnly;
+
+	// the number of threads to extract slices with
+	unsigned int _numThreads;
 };
 
 #endif // SOPNET_GROUND_TRUTH_EXTRACTOR_H__
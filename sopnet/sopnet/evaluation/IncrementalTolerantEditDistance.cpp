@@ -0,0 +1,879 @@
+#include <algorithm>
+#include <limits>
+
+#include <boost/make_shared.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <sopnet/evaluation/GroundTruthExtractor.h>
+#include "IncrementalTolerantEditDistance.h"
+
+extern util::ProgramOption optionToleranceDistanceThreshold;
+extern util::ProgramOption optionHaveBackgroundLabel;
+extern util::ProgramOption optionGroundTruthBackgroundLabel;
+extern util::ProgramOption optionReconstructionBackgroundLabel;
+extern util::ProgramOption optionChunkWidth;
+extern util::ProgramOption optionChunkHeight;
+extern util::ProgramOption optionChunkDepth;
+extern util::ProgramOption optionTedMaxExactCells;
+
+logger::LogChannel incrementaltedlog("incrementaltedlog", "[IncrementalTolerantEditDistance] ");
+
+namespace {
+
+// the default chunk sizes, if neither given nor set for the tolerant edit 
+// distance
+const unsigned int DefaultChunkWidth  = 256;
+const unsigned int DefaultChunkHeight = 256;
+const unsigned int DefaultChunkDepth  = 16;
+
+unsigned int
+getChunkSize(unsigned int size, const util::ProgramOption& option, unsigned int defaultSize) {
+
+	if (size > 0)
+		return size;
+
+	if (option.as<unsigned int>() > 0)
+		return option.as<unsigned int>();
+
+	return defaultSize;
+}
+
+} // anonymous namespace
+
+IncrementalTolerantEditDistance::IncrementalTolerantEditDistance(
+		unsigned int chunkWidth,
+		unsigned int chunkHeight,
+		unsigned int chunkDepth) :
+	_haveBackgroundLabel(optionHaveBackgroundLabel),
+	_gtBackgroundLabel(optionGroundTruthBackgroundLabel),
+	_recBackgroundLabel(optionReconstructionBackgroundLabel),
+	_toleranceFunction(optionToleranceDistanceThreshold.as<float>(), _haveBackgroundLabel, _recBackgroundLabel),
+	_optimizer(optionTedMaxExactCells.as<unsigned int>()),
+	_chunkWidth(getChunkSize(chunkWidth, optionChunkWidth, DefaultChunkWidth)),
+	_chunkHeight(getChunkSize(chunkHeight, optionChunkHeight, DefaultChunkHeight)),
+	_chunkDepth(getChunkSize(chunkDepth, optionChunkDepth, DefaultChunkDepth)),
+	_numUpdatedChunks(0),
+	_numUpdatedCells(0) {
+
+	if (optionGroundTruthFromSkeletons)
+		BOOST_THROW_EXCEPTION(
+				UsageError()
+				<< error_message("the incremental tolerant edit distance does not support ground truth from skeletons")
+				<< STACK_TRACE);
+}
+
+void
+IncrementalTolerantEditDistance::initialize(const ImageStack& groundTruth, const ImageStack& reconstruction) {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tIncrementalTolerantEditDistance::initialize():\t%ws\n");
+
+	if (groundTruth.size() != reconstruction.size())
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("ground truth and reconstruction have different size") << STACK_TRACE);
+
+	if (groundTruth.height() != reconstruction.height() || groundTruth.width() != reconstruction.width())
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("ground truth and reconstruction have different size") << STACK_TRACE);
+
+	_depth  = groundTruth.size();
+	_width  = groundTruth.width();
+	_height = groundTruth.height();
+
+	// keep the ground truth and a copy of the reconstruction that can be 
+	// changed in place
+
+	_groundTruth.clear();
+	_reconstruction.clear();
+
+	_maxLabel = 0;
+
+	for (unsigned int z = 0; z < _depth; z++) {
+
+		const Image& section = *reconstruction[z];
+		boost::shared_ptr<Image> copy = boost::make_shared<Image>(_width, _height, 0.0);
+
+		for (unsigned int y = 0; y < _height; y++)
+			for (unsigned int x = 0; x < _width; x++) {
+
+				(*copy)(x, y) = section(x, y);
+				_maxLabel = std::max(_maxLabel, section(x, y));
+			}
+
+		_groundTruth.add(groundTruth[z]);
+		_reconstruction.add(copy);
+	}
+
+	// divide the volume into chunks
+
+	_chunkWidth  = std::max(1u, std::min(_chunkWidth,  _width));
+	_chunkHeight = std::max(1u, std::min(_chunkHeight, _height));
+	_chunkDepth  = std::max(1u, std::min(_chunkDepth,  _depth));
+
+	_numChunksX = (_width  + _chunkWidth  - 1)/_chunkWidth;
+	_numChunksY = (_height + _chunkHeight - 1)/_chunkHeight;
+	_numChunksZ = (_depth  + _chunkDepth  - 1)/_chunkDepth;
+
+	_chunks.clear();
+	_chunks.resize(_numChunksX*_numChunksY*_numChunksZ);
+
+	std::vector<unsigned int> chunks;
+
+	for (unsigned int cz = 0; cz < _numChunksZ; cz++)
+		for (unsigned int cy = 0; cy < _numChunksY; cy++)
+			for (unsigned int cx = 0; cx < _numChunksX; cx++) {
+
+				unsigned int index = (cz*_numChunksY + cy)*_numChunksX + cx;
+				Chunk&       chunk = _chunks[index];
+
+				chunk.x0 = cx*_chunkWidth;
+				chunk.y0 = cy*_chunkHeight;
+				chunk.z0 = cz*_chunkDepth;
+				chunk.x1 = std::min((cx + 1)*_chunkWidth,  _width);
+				chunk.y1 = std::min((cy + 1)*_chunkHeight, _height);
+				chunk.z1 = std::min((cz + 1)*_chunkDepth,  _depth);
+
+				chunks.push_back(index);
+			}
+
+	_cells = boost::make_shared<std::vector<cell_t> >();
+	_cellFragments.clear();
+	_choices.clear();
+	_freeCells.clear();
+	_cellsByGtLabel.clear();
+	_cellsByRecLabel.clear();
+
+	// the errors are updated with each change of a cell label from now on
+	if (_haveBackgroundLabel)
+		_errors = boost::make_shared<TolerantEditDistanceErrors>(_gtBackgroundLabel, _recBackgroundLabel);
+	else
+		_errors = boost::make_shared<TolerantEditDistanceErrors>();
+
+	_errors->setCells(_cells);
+
+	updateChunks(chunks);
+}
+
+void
+IncrementalTolerantEditDistance::update(const ImageStack& reconstruction) {
+
+	BoundingBox volume;
+	volume.add(0, 0, 0);
+	volume.add(_width - 1, _height - 1, _depth - 1);
+
+	update(reconstruction, std::vector<BoundingBox>(1, volume));
+}
+
+void
+IncrementalTolerantEditDistance::update(const ImageStack& reconstruction, const std::vector<BoundingBox>& changedRegions) {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tIncrementalTolerantEditDistance::update():\t%ws\n");
+
+	if (!_errors)
+		BOOST_THROW_EXCEPTION(UsageError() << error_message("initialize() has to be called before update()") << STACK_TRACE);
+
+	if (reconstruction.size() != _depth || reconstruction.width() != _width || reconstruction.height() != _height)
+		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("ground truth and reconstruction have different size") << STACK_TRACE);
+
+	// clip the regions to the volume
+
+	std::vector<BoundingBox> regions;
+
+	foreach (const BoundingBox& region, changedRegions) {
+
+		BoundingBox clipped;
+		clipped.x0 = std::max(0, region.x0);
+		clipped.y0 = std::max(0, region.y0);
+		clipped.z0 = std::max(0, region.z0);
+		clipped.x1 = std::min(static_cast<int>(_width),  region.x1);
+		clipped.y1 = std::min(static_cast<int>(_height), region.y1);
+		clipped.z1 = std::min(static_cast<int>(_depth),  region.z1);
+
+		if (clipped.x0 < clipped.x1 && clipped.y0 < clipped.y1 && clipped.z0 < clipped.z1)
+			regions.push_back(clipped);
+	}
+
+	// the bounding box of the changed locations in each chunk
+	std::vector<BoundingBox> changes(_chunks.size());
+
+	if (!copyReconstruction(reconstruction, regions, changes)) {
+
+		LOG_DEBUG(incrementaltedlog) << "reconstruction did not change" << std::endl;
+
+		_numUpdatedChunks = 0;
+		_numUpdatedCells  = 0;
+
+		return;
+	}
+
+	// fragments and alternative labels can change everywhere within the halo 
+	// of a changed location
+
+	std::set<unsigned int> chunks;
+
+	foreach (const BoundingBox& change, changes) {
+
+		if (change.isEmpty())
+			continue;
+
+		int x0 = std::max(0, change.x0 - _toleranceFunction.getHaloX());
+		int y0 = std::max(0, change.y0 - _toleranceFunction.getHaloY());
+		int z0 = std::max(0, change.z0 - _toleranceFunction.getHaloZ());
+		int x1 = std::min(static_cast<int>(_width),  change.x1 + _toleranceFunction.getHaloX());
+		int y1 = std::min(static_cast<int>(_height), change.y1 + _toleranceFunction.getHaloY());
+		int z1 = std::min(static_cast<int>(_depth),  change.z1 + _toleranceFunction.getHaloZ());
+
+		for (unsigned int cz = z0/_chunkDepth; cz <= (z1 - 1)/_chunkDepth; cz++)
+			for (unsigned int cy = y0/_chunkHeight; cy <= (y1 - 1)/_chunkHeight; cy++)
+				for (unsigned int cx = x0/_chunkWidth; cx <= (x1 - 1)/_chunkWidth; cx++)
+					chunks.insert((cz*_numChunksY + cy)*_numChunksX + cx);
+	}
+
+	updateChunks(std::vector<unsigned int>(chunks.begin(), chunks.end()));
+}
+
+bool
+IncrementalTolerantEditDistance::copyReconstruction(
+		const ImageStack& reconstruction,
+		const std::vector<BoundingBox>& regions,
+		std::vector<BoundingBox>& changes) {
+
+	std::map<float, float> labelMap = matchLabels(reconstruction, regions);
+
+	bool changed = false;
+
+	foreach (const BoundingBox& region, regions)
+		for (int z = region.z0; z < region.z1; z++) {
+
+			const Image& section = *reconstruction[z];
+			Image&       current = *_reconstruction[z];
+
+			// labels are mostly constant along lines, remember the last match
+			float label   = section(region.x0, region.y0);
+			float matched = labelMap[label];
+
+			for (int y = region.y0; y < region.y1; y++)
+				for (int x = region.x0; x < region.x1; x++) {
+
+					if (section(x, y) != label) {
+
+						label   = section(x, y);
+						matched = labelMap[label];
+					}
+
+					if (current(x, y) == matched)
+						continue;
+
+					current(x, y) = matched;
+
+					unsigned int chunk = ((z/_chunkDepth)*_numChunksY + y/_chunkHeight)*_numChunksX + x/_chunkWidth;
+					changes[chunk].add(x, y, z);
+					changed = true;
+				}
+		}
+
+	return changed;
+}
+
+std::map<float, float>
+IncrementalTolerantEditDistance::matchLabels(
+		const ImageStack& reconstruction,
+		const std::vector<BoundingBox>& regions) {
+
+	// count the overlaps of current and new labels in the regions
+
+	typedef std::pair<float, float> LabelPair;
+
+	std::map<LabelPair, size_t> pairCounts;
+
+	foreach (const BoundingBox& region, regions)
+		for (int z = region.z0; z < region.z1; z++) {
+
+			const Image& section = *reconstruction[z];
+			const Image& current = *_reconstruction[z];
+
+			for (int y = region.y0; y < region.y1; y++) {
+
+				// count runs of equal label pairs at once
+				LabelPair run(current(region.x0, y), section(region.x0, y));
+				size_t    runLength = 0;
+
+				for (int x = region.x0; x < region.x1; x++) {
+
+					LabelPair pair(current(x, y), section(x, y));
+
+					if (pair == run) {
+
+						runLength++;
+						continue;
+					}
+
+					pairCounts[run] += runLength;
+					run       = pair;
+					runLength = 1;
+				}
+
+				pairCounts[run] += runLength;
+			}
+		}
+
+	// visit the pairs of current and new labels by decreasing overlap
+
+	std::vector<std::pair<size_t, LabelPair> > overlaps;
+	std::set<float> newLabels;
+
+	std::map<LabelPair, size_t>::const_iterator pairCount;
+	for (pairCount = pairCounts.begin(); pairCount != pairCounts.end(); pairCount++) {
+
+		overlaps.push_back(std::make_pair(pairCount->second, pairCount->first));
+		newLabels.insert(pairCount->first.second);
+	}
+
+	std::sort(overlaps.rbegin(), overlaps.rend());
+
+	// from new to current labels
+	std::map<float, float> labelMap;
+
+	// current labels that have been matched already
+	std::set<float> matched;
+
+	// the background keeps its label
+	if (_haveBackgroundLabel) {
+
+		labelMap[_recBackgroundLabel] = _recBackgroundLabel;
+		matched.insert(_recBackgroundLabel);
+	}
+
+	for (unsigned int i = 0; i < overlaps.size(); i++) {
+
+		float current = overlaps[i].second.first;
+		float label   = overlaps[i].second.second;
+
+		if (labelMap.count(label) || matched.count(current))
+			continue;
+
+		labelMap[label] = current;
+		matched.insert(current);
+	}
+
+	// new labels without a match get labels that have never been used, 
+	// neither inside nor outside of the regions
+
+	unsigned int numNewLabels = 0;
+	foreach (float label, newLabels)
+		if (!labelMap.count(label)) {
+
+			labelMap[label] = ++_maxLabel;
+			numNewLabels++;
+		}
+
+	LOG_DEBUG(incrementaltedlog)
+			<< "matched " << (labelMap.size() - numNewLabels) << " labels, "
+			<< numNewLabels << " labels are new" << std::endl;
+
+	return labelMap;
+}
+
+void
+IncrementalTolerantEditDistance::updateChunks(const std::vector<unsigned int>& chunks) {
+
+	std::vector<bool> isUpdated(_chunks.size(), false);
+	foreach (unsigned int c, chunks)
+		isUpdated[c] = true;
+
+	// remove all cells with a fragment in an updated chunk, their labels are 
+	// the ones that changed
+
+	std::set<float> changedGtLabels;
+	std::set<float> changedRecLabels;
+
+	std::set<unsigned int> removedCells;
+
+	foreach (unsigned int c, chunks)
+		removedCells.insert(_chunks[c].cells.begin(), _chunks[c].cells.end());
+
+	// the fragments of the removed cells outside of the updated chunks have 
+	// to be connected again, together with the fragments of the updated 
+	// chunks
+
+	std::vector<FragmentId> fragments;
+
+	foreach (unsigned int cell, removedCells) {
+
+		addChangedLabels((*_cells)[cell], changedGtLabels, changedRecLabels);
+
+		foreach (const FragmentId& fragment, _cellFragments[cell])
+			if (!isUpdated[fragment.first])
+				fragments.push_back(fragment);
+
+		removeCell(cell);
+	}
+
+	foreach (unsigned int c, chunks) {
+
+		Chunk& chunk = _chunks[c];
+
+		_toleranceFunction.extractCellFragments(
+				_reconstruction,
+				_groundTruth,
+				chunk.x0, chunk.y0, chunk.z0,
+				chunk.x1, chunk.y1, chunk.z1,
+				chunk.fragments,
+				chunk.fragmentIds);
+
+		chunk.cells.assign(chunk.fragments.size(), 0);
+
+		for (unsigned int f = 0; f < chunk.fragments.size(); f++)
+			fragments.push_back(FragmentId(c, f));
+	}
+
+	// the links of the updated chunks and their upper neighbors changed
+
+	std::set<unsigned int> linkChunks;
+	foreach (unsigned int c, chunks) {
+
+		linkChunks.insert(c);
+
+		int neighbors[3] = { getNeighbor(c, 1, 0, 0), getNeighbor(c, 0, 1, 0), getNeighbor(c, 0, 0, 1) };
+		for (int i = 0; i < 3; i++)
+			if (neighbors[i] >= 0)
+				linkChunks.insert(neighbors[i]);
+	}
+
+	foreach (unsigned int c, linkChunks)
+		findLinks(c);
+
+	// create the new cells
+
+	std::vector<cell_t>                   newCells;
+	std::vector<std::vector<FragmentId> > newCellFragments;
+
+	createCells(fragments, newCells, newCellFragments);
+
+	// put the new cells into the slots of the removed ones
+
+	std::vector<unsigned int> addedCells;
+
+	for (unsigned int cell = 0; cell < newCells.size(); cell++) {
+
+		addChangedLabels(newCells[cell], changedGtLabels, changedRecLabels);
+		addedCells.push_back(addCell(newCells[cell], newCellFragments[cell]));
+	}
+
+	_numUpdatedChunks = chunks.size();
+	_numUpdatedCells  = newCells.size();
+
+	LOG_DEBUG(incrementaltedlog)
+			<< "updated " << _numUpdatedChunks << " of " << _chunks.size() << " chunks, rebuilt "
+			<< _numUpdatedCells << " of " << (_cells->size() - _freeCells.size()) << " cells" << std::endl;
+
+	findErrors(changedGtLabels, changedRecLabels, addedCells);
+}
+
+unsigned int
+IncrementalTolerantEditDistance::addCell(cell_t& cell, std::vector<FragmentId>& fragments) {
+
+	unsigned int index;
+
+	if (_freeCells.empty()) {
+
+		index = _cells->size();
+
+		_cells->push_back(cell_t());
+		_cellFragments.push_back(std::vector<FragmentId>());
+		_choices.push_back(0);
+
+	} else {
+
+		index = _freeCells.back();
+		_freeCells.pop_back();
+	}
+
+	(*_cells)[index].swap(cell);
+	_cellFragments[index].swap(fragments);
+	_choices[index] = 0;
+
+	foreach (const FragmentId& fragment, _cellFragments[index])
+		_chunks[fragment.first].cells[fragment.second] = index;
+
+	indexCell(index, true);
+
+	return index;
+}
+
+void
+IncrementalTolerantEditDistance::removeCell(unsigned int index) {
+
+	_errors->removeMapping(index, getLabel(index));
+
+	indexCell(index, false);
+
+	// leave an empty slot for the next new cell
+	cell_t().swap((*_cells)[index]);
+	std::vector<FragmentId>().swap(_cellFragments[index]);
+	_choices[index] = 0;
+
+	_freeCells.push_back(index);
+}
+
+void
+IncrementalTolerantEditDistance::indexCell(unsigned int index, bool add) {
+
+	const cell_t& cell = (*_cells)[index];
+
+	std::vector<std::pair<cell_index_t*, float> > entries;
+
+	entries.push_back(std::make_pair(&_cellsByGtLabel, cell.getGroundTruthLabel()));
+	entries.push_back(std::make_pair(&_cellsByRecLabel, cell.getReconstructionLabel()));
+	foreach (float label, cell.getAlternativeLabels())
+		entries.push_back(std::make_pair(&_cellsByRecLabel, label));
+
+	for (unsigned int i = 0; i < entries.size(); i++) {
+
+		cell_index_t& cellIndex = *entries[i].first;
+		float         label     = entries[i].second;
+
+		if (add) {
+
+			cellIndex[label].insert(index);
+
+		} else {
+
+			cell_index_t::iterator cells = cellIndex.find(label);
+			cells->second.erase(index);
+
+			if (cells->second.empty())
+				cellIndex.erase(cells);
+		}
+	}
+}
+
+float
+IncrementalTolerantEditDistance::getLabel(unsigned int index) const {
+
+	const cell_t& cell = (*_cells)[index];
+
+	if (_choices[index] == 0)
+		return cell.getReconstructionLabel();
+
+	std::set<float>::const_iterator label = cell.getAlternativeLabels().begin();
+	std::advance(label, _choices[index] - 1);
+
+	return *label;
+}
+
+void
+IncrementalTolerantEditDistance::findLinks(unsigned int c) {
+
+	Chunk& chunk = _chunks[c];
+
+	chunk.links.clear();
+
+	const int offsets[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+	for (int d = 0; d < 3; d++) {
+
+		int dx = offsets[d][0];
+		int dy = offsets[d][1];
+		int dz = offsets[d][2];
+
+		int n = getNeighbor(c, -dx, -dy, -dz);
+
+		if (n < 0)
+			continue;
+
+		const Chunk& neighbor = _chunks[n];
+
+		// the locations at the lower face of the chunk in direction d
+		int x1 = (dx ? chunk.x0 + 1 : chunk.x1);
+		int y1 = (dy ? chunk.y0 + 1 : chunk.y1);
+		int z1 = (dz ? chunk.z0 + 1 : chunk.z1);
+
+		for (int z = chunk.z0; z < z1; z++) {
+
+			const Image& gt          = *_groundTruth[z];
+			const Image& rec         = *_reconstruction[z];
+			const Image& neighborGt  = *_groundTruth[z - dz];
+			const Image& neighborRec = *_reconstruction[z - dz];
+
+			for (int y = chunk.y0; y < y1; y++)
+				for (int x = chunk.x0; x < x1; x++) {
+
+					if (gt(x, y) != neighborGt(x - dx, y - dy) || rec(x, y) != neighborRec(x - dx, y - dy))
+						continue;
+
+					chunk.links.push_back(
+							Link(
+									chunk.fragmentIds(x - chunk.x0, y - chunk.y0, z - chunk.z0),
+									n,
+									neighbor.fragmentIds(x - dx - neighbor.x0, y - dy - neighbor.y0, z - dz - neighbor.z0)));
+				}
+		}
+	}
+
+	std::sort(chunk.links.begin(), chunk.links.end());
+	chunk.links.erase(std::unique(chunk.links.begin(), chunk.links.end()), chunk.links.end());
+}
+
+int
+IncrementalTolerantEditDistance::getNeighbor(unsigned int chunk, int dx, int dy, int dz) const {
+
+	int cx = chunk%_numChunksX + dx;
+	int cy = (chunk/_numChunksX)%_numChunksY + dy;
+	int cz = chunk/(_numChunksX*_numChunksY) + dz;
+
+	if (cx < 0 || cx >= (int)_numChunksX || cy < 0 || cy >= (int)_numChunksY || cz < 0 || cz >= (int)_numChunksZ)
+		return -1;
+
+	return (cz*_numChunksY + cy)*_numChunksX + cx;
+}
+
+void
+IncrementalTolerantEditDistance::createCells(
+		const std::vector<FragmentId>& fragments,
+		std::vector<cell_t>& newCells,
+		std::vector<std::vector<FragmentId> >& newCellFragments) {
+
+	// union-find forest of the given fragments
+
+	std::map<FragmentId, unsigned int> indices;
+	std::set<unsigned int>             fragmentChunks;
+
+	for (unsigned int i = 0; i < fragments.size(); i++) {
+
+		indices[fragments[i]] = i;
+		fragmentChunks.insert(fragments[i].first);
+	}
+
+	std::vector<unsigned int> parents(fragments.size());
+	for (unsigned int i = 0; i < parents.size(); i++)
+		parents[i] = i;
+
+	// links are stored with the upper of the two chunks, so all links between 
+	// the given fragments are found in their chunks
+	foreach (unsigned int c, fragmentChunks)
+		foreach (const Link& link, _chunks[c].links) {
+
+			std::map<FragmentId, unsigned int>::const_iterator i = indices.find(FragmentId(c, link.fragment));
+			std::map<FragmentId, unsigned int>::const_iterator j = indices.find(FragmentId(link.neighborChunk, link.neighborFragment));
+
+			if (i == indices.end() || j == indices.end())
+				continue;
+
+			parents[findRoot(i->second, parents)] = findRoot(j->second, parents);
+		}
+
+	// create one cell for each set of connected fragments
+
+	std::vector<unsigned int> cellIndices(fragments.size());
+	std::vector<unsigned int> rootIndices(fragments.size(), fragments.size());
+
+	unsigned int numCells = 0;
+	for (unsigned int i = 0; i < fragments.size(); i++) {
+
+		unsigned int root = findRoot(i, parents);
+
+		if (rootIndices[root] == fragments.size())
+			rootIndices[root] = numCells++;
+
+		cellIndices[i] = rootIndices[root];
+	}
+
+	newCells.resize(numCells);
+	newCellFragments.resize(numCells);
+
+	// the alternative labels of each cell are the ones that all its fragments 
+	// agree on
+	std::vector<std::vector<float> > alternativeLabels(numCells);
+	std::vector<bool>                foundCells(numCells, false);
+
+	for (unsigned int i = 0; i < fragments.size(); i++) {
+
+		unsigned int  cellIndex = cellIndices[i];
+		cell_t&       cell      = newCells[cellIndex];
+		const cell_t& fragment  = _chunks[fragments[i].first].fragments[fragments[i].second];
+
+		if (!foundCells[cellIndex]) {
+
+			cell.setGroundTruthLabel(fragment.getGroundTruthLabel());
+			cell.setReconstructionLabel(fragment.getReconstructionLabel());
+			alternativeLabels[cellIndex].assign(fragment.getAlternativeLabels().begin(), fragment.getAlternativeLabels().end());
+			foundCells[cellIndex] = true;
+
+		} else {
+
+			std::vector<float> intersection;
+			std::set_intersection(
+					alternativeLabels[cellIndex].begin(), alternativeLabels[cellIndex].end(),
+					fragment.getAlternativeLabels().begin(), fragment.getAlternativeLabels().end(),
+					std::back_inserter(intersection));
+			alternativeLabels[cellIndex].swap(intersection);
+		}
+
+		cell.merge(fragment);
+		newCellFragments[cellIndex].push_back(fragments[i]);
+	}
+
+	for (unsigned int cellIndex = 0; cellIndex < numCells; cellIndex++) {
+
+		foreach (float label, alternativeLabels[cellIndex])
+			newCells[cellIndex].addAlternativeLabel(label);
+
+		newCells[cellIndex].shrink();
+	}
+}
+
+void
+IncrementalTolerantEditDistance::findErrors(
+		const std::set<float>& changedGtLabels,
+		const std::set<float>& changedRecLabels,
+		const std::vector<unsigned int>& addedCells) {
+
+	// Find the components of the cell labeling problem that contain a changed 
+	// label: starting from the changed labels, visit all cells with one of the 
+	// visited labels. Cells with alternative labels connect all their labels, 
+	// cells without alternatives are visited only to know which pairs of 
+	// labels are fixed.
+
+	std::set<unsigned int> subset;
+
+	std::set<float>    gtLabels(changedGtLabels);
+	std::set<float>    recLabels(changedRecLabels);
+	std::vector<float> gtQueue(gtLabels.begin(), gtLabels.end());
+	std::vector<float> recQueue(recLabels.begin(), recLabels.end());
+
+	while (!gtQueue.empty() || !recQueue.empty()) {
+
+		cell_index_t::const_iterator cells;
+
+		if (!gtQueue.empty()) {
+
+			cells = _cellsByGtLabel.find(gtQueue.back());
+			gtQueue.pop_back();
+
+			if (cells == _cellsByGtLabel.end())
+				continue;
+
+		} else {
+
+			cells = _cellsByRecLabel.find(recQueue.back());
+			recQueue.pop_back();
+
+			if (cells == _cellsByRecLabel.end())
+				continue;
+		}
+
+		foreach (unsigned int index, cells->second) {
+
+			if (!subset.insert(index).second)
+				continue;
+
+			const cell_t& cell = (*_cells)[index];
+
+			if (cell.getAlternativeLabels().empty())
+				continue;
+
+			if (gtLabels.insert(cell.getGroundTruthLabel()).second)
+				gtQueue.push_back(cell.getGroundTruthLabel());
+
+			if (recLabels.insert(cell.getReconstructionLabel()).second)
+				recQueue.push_back(cell.getReconstructionLabel());
+
+			foreach (float label, cell.getAlternativeLabels())
+				if (recLabels.insert(label).second)
+					recQueue.push_back(label);
+		}
+	}
+
+	// solve the visited components again and update the mappings of the 
+	// cells whose label changed
+
+	std::vector<unsigned int> cells(subset.begin(), subset.end());
+	std::set<unsigned int>    added(addedCells.begin(), addedCells.end());
+	std::vector<float>        previousLabels(cells.size());
+	std::set<float>           reconstructionLabels;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		previousLabels[i] = getLabel(cells[i]);
+		reconstructionLabels.insert((*_cells)[cells[i]].getReconstructionLabel());
+	}
+
+	_optimizer.reoptimize(
+			*_cells,
+			cells,
+			reconstructionLabels,
+			_width*_height*_depth,
+			_choices);
+
+	LOG_DEBUG(incrementaltedlog)
+			<< "solved " << _optimizer.getNumComponents() << " components with "
+			<< cells.size() << " cells, " << _optimizer.getNumOptimalComponents()
+			<< " of them to optimality" << std::endl;
+
+	for (unsigned int i = 0; i < cells.size(); i++) {
+
+		float label = getLabel(cells[i]);
+
+		if (added.count(cells[i])) {
+
+			_errors->addMapping(cells[i], label);
+
+		} else if (label != previousLabels[i]) {
+
+			_errors->removeMapping(cells[i], previousLabels[i]);
+			_errors->addMapping(cells[i], label);
+		}
+	}
+}
+
+void
+IncrementalTolerantEditDistance::addChangedLabels(
+		const cell_t& cell,
+		std::set<float>& changedGtLabels,
+		std::set<float>& changedRecLabels) {
+
+	changedGtLabels.insert(cell.getGroundTruthLabel());
+	changedRecLabels.insert(cell.getReconstructionLabel());
+	changedRecLabels.insert(cell.getAlternativeLabels().begin(), cell.getAlternativeLabels().end());
+}
+
+unsigned int
+IncrementalTolerantEditDistance::findRoot(unsigned int node, std::vector<unsigned int>& parents) {
+
+	unsigned int root = node;
+	while (parents[root] != root)
+		root = parents[root];
+
+	// compress the path
+	while (parents[node] != root) {
+
+		unsigned int next = parents[node];
+		parents[node] = root;
+		node = next;
+	}
+
+	return root;
+}
+
+bool
+IncrementalTolerantEditDistance::Link::operator<(const Link& other) const {
+
+	if (fragment != other.fragment)
+		return fragment < other.fragment;
+
+	if (neighborChunk != other.neighborChunk)
+		return neighborChunk < other.neighborChunk;
+
+	return neighborFragment < other.neighborFragment;
+}
+
+bool
+IncrementalTolerantEditDistance::Link::operator==(const Link& other) const {
+
+	return
+			fragment         == other.fragment &&
+			neighborChunk    == other.neighborChunk &&
+			neighborFragment == other.neighborFragment;
+}
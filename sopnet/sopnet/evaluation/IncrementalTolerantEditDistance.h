@@ -0,0 +1,308 @@
+#ifndef SOPNET_EVALUATION_INCREMENTAL_TOLERANT_EDIT_DISTANCE_H__
+#define SOPNET_EVALUATION_INCREMENTAL_TOLERANT_EDIT_DISTANCE_H__
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <vigra/multi_array.hxx>
+
+#include <imageprocessing/ImageStack.h>
+#include "CellLabelOptimizer.h"
+#include "DistanceToleranceFunction.h"
+#include "TolerantEditDistanceErrors.h"
+
+/**
+ * Computes the tolerant edit distance of a sequence of reconstructions that 
+ * differ only locally, like the reconstructions obtained by flipping single 
+ * segments. The engine keeps the cells, their alternative labels, and the 
+ * best cell labels of the previous reconstruction, and updates only what is 
+ * affected by a change:
+ *
+ * The volume is divided into chunks, and the cell fragments of each chunk 
+ * are kept together with the links to the fragments of neighboring chunks. 
+ * For a new reconstruction, only the chunks within the halo of the changed 
+ * locations of each chunk are extracted again (see 
+ * DistanceToleranceFunction::extractCellFragments()), only the cells with a 
+ * fragment in these chunks are rebuilt, and only the independent components 
+ * of the cell labeling problem that contain a changed label are solved again 
+ * (see CellLabelOptimizer::reoptimize()). The components are found from the 
+ * changed labels via an index of the cells of each label. Rebuilt cells take 
+ * the slots of the removed ones, and the errors are updated only for the cells 
+ * whose label changed. Apart from reading the reconstruction, an update costs 
+ * time proportional to the size of the change and of the components it 
+ * touches.
+ *
+ * The reconstruction labels are matched to the labels of the previous 
+ * reconstruction before the changed locations are found, such that 
+ * renumbered labels (as produced by the IdMapCreator) do not count as 
+ * changes. The reported errors refer to these matched labels. If the regions 
+ * that changed are known, only these are read and matched.
+ *
+ * Ground truth from skeletons is not supported.
+ */
+class IncrementalTolerantEditDistance {
+
+public:
+
+	typedef LocalToleranceFunction::cell_t  cell_t;
+	typedef LocalToleranceFunction::cells_t cells_t;
+
+	/**
+	 * The bounding box of a set of locations, excluding the upper bounds.
+	 */
+	struct BoundingBox {
+
+		BoundingBox() :
+			x0(std::numeric_limits<int>::max()),
+			y0(std::numeric_limits<int>::max()),
+			z0(std::numeric_limits<int>::max()),
+			x1(0), y1(0), z1(0) {}
+
+		void add(int x, int y, int z) {
+
+			x0 = std::min(x0, x);
+			y0 = std::min(y0, y);
+			z0 = std::min(z0, z);
+			x1 = std::max(x1, x + 1);
+			y1 = std::max(y1, y + 1);
+			z1 = std::max(z1, z + 1);
+		}
+
+		bool isEmpty() const { return x1 <= x0; }
+
+		int x0, y0, z0;
+		int x1, y1, z1;
+	};
+
+	/**
+	 * Create a new incremental tolerant edit distance.
+	 *
+	 * @param chunkWidth, chunkHeight, chunkDepth 
+	 *             The size of the chunks that are updated at once. 0 uses the 
+	 *             chunk sizes of the tolerant edit distance, or a default size 
+	 *             if these are not set either.
+	 */
+	IncrementalTolerantEditDistance(
+			unsigned int chunkWidth  = 0,
+			unsigned int chunkHeight = 0,
+			unsigned int chunkDepth  = 0);
+
+	/**
+	 * Compute the tolerant edit distance of a reconstruction from scratch.
+	 *
+	 * @param groundTruth 
+	 *             The ground truth to compare against. It is kept for later 
+	 *             updates and must not be changed.
+	 * @param reconstruction 
+	 *             The first reconstruction.
+	 */
+	void initialize(const ImageStack& groundTruth, const ImageStack& reconstruction);
+
+	/**
+	 * Compute the tolerant edit distance of a new reconstruction, reusing 
+	 * everything that is not affected by the differences to the previous one.
+	 *
+	 * @param reconstruction 
+	 *             The new reconstruction, of the same size as the ground 
+	 *             truth.
+	 */
+	void update(const ImageStack& reconstruction);
+
+	/**
+	 * Compute the tolerant edit distance of a new reconstruction that differs 
+	 * from the previous one only in the given regions. Only these regions of 
+	 * the reconstruction are read, such that the update costs time 
+	 * proportional to the size of the change.
+	 *
+	 * @param reconstruction 
+	 *             The new reconstruction, of the same size as the ground 
+	 *             truth.
+	 * @param changedRegions 
+	 *             Non-overlapping regions that contain all locations of the 
+	 *             labels that changed, in the previous and in the new 
+	 *             reconstruction. Outside of them, the new reconstruction has 
+	 *             to be the same as the previous one, up to a one-to-one 
+	 *             renumbering of the labels (as done by the IdMapCreator).
+	 */
+	void update(const ImageStack& reconstruction, const std::vector<BoundingBox>& changedRegions);
+
+	/**
+	 * Get the errors of the last reconstruction. The errors share the cells 
+	 * with this engine and are changed in place by the next update. Slots of 
+	 * removed cells are empty cells without a mapping.
+	 */
+	boost::shared_ptr<TolerantEditDistanceErrors> getErrors() { return _errors; }
+
+	/**
+	 * Get the number of chunks that have been extracted again in the last 
+	 * update.
+	 */
+	unsigned int getNumUpdatedChunks() const { return _numUpdatedChunks; }
+
+	/**
+	 * Get the number of cells that have been rebuilt in the last update.
+	 */
+	unsigned int getNumUpdatedCells() const { return _numUpdatedCells; }
+
+private:
+
+	// a fragment, identified by its chunk and its index in the chunk
+	typedef std::pair<unsigned int, unsigned int> FragmentId;
+
+	// the indices of the cells of each label
+	typedef std::map<float, std::set<unsigned int> > cell_index_t;
+
+	// a connection between a fragment of a chunk and a fragment of a lower 
+	// neighbor, such that both belong to the same cell
+	struct Link {
+
+		Link(unsigned int fragment_, unsigned int neighborChunk_, unsigned int neighborFragment_) :
+			fragment(fragment_), neighborChunk(neighborChunk_), neighborFragment(neighborFragment_) {}
+
+		bool operator<(const Link& other) const;
+
+		bool operator==(const Link& other) const;
+
+		unsigned int fragment;
+		unsigned int neighborChunk;
+		unsigned int neighborFragment;
+	};
+
+	struct Chunk {
+
+		int x0, y0, z0;
+		int x1, y1, z1;
+
+		// the cell fragments in this chunk
+		std::vector<cell_t> fragments;
+
+		// the index of the fragment at each location of this chunk
+		vigra::MultiArray<3, unsigned int> fragmentIds;
+
+		// the cell each fragment belongs to
+		std::vector<unsigned int> cells;
+
+		// the links to the fragments of the lower neighbors in x, y, and z
+		std::vector<Link> links;
+	};
+
+	// copy the given regions of the new reconstruction with labels matched to 
+	// the current one, find the bounding box of the changed locations in each 
+	// chunk, returns false if nothing changed
+	bool copyReconstruction(
+			const ImageStack& reconstruction,
+			const std::vector<BoundingBox>& regions,
+			std::vector<BoundingBox>& changes);
+
+	// find a one-to-one mapping from the labels of the new reconstruction in 
+	// the given regions to the labels of the current one with the largest 
+	// overlaps
+	std::map<float, float> matchLabels(
+			const ImageStack& reconstruction,
+			const std::vector<BoundingBox>& regions);
+
+	// extract the given chunks, rebuild the affected cells, and find the best 
+	// cell labels
+	void updateChunks(const std::vector<unsigned int>& chunks);
+
+	// find the links of a chunk to its lower neighbors
+	void findLinks(unsigned int chunk);
+
+	// get the index of the neighbor of a chunk, -1 if there is none
+	int getNeighbor(unsigned int chunk, int dx, int dy, int dz) const;
+
+	// create the cells of the given fragments, connected by the links between 
+	// them
+	void createCells(
+			const std::vector<FragmentId>& fragments,
+			std::vector<cell_t>& newCells,
+			std::vector<std::vector<FragmentId> >& newCellFragments);
+
+	// put a new cell into a free slot, returns its index
+	unsigned int addCell(cell_t& cell, std::vector<FragmentId>& fragments);
+
+	// remove a cell and its mapping, and free its slot
+	void removeCell(unsigned int index);
+
+	// add a cell to or remove it from the cells of its labels
+	void indexCell(unsigned int index, bool add);
+
+	// get the label a cell is mapped to
+	float getLabel(unsigned int index) const;
+
+	// find the best labels for the cells of the components with changed 
+	// labels, and update the errors of the cells whose label changed or that 
+	// have been added
+	void findErrors(
+			const std::set<float>& changedGtLabels,
+			const std::set<float>& changedRecLabels,
+			const std::vector<unsigned int>& addedCells);
+
+	// add the labels of a cell to the changed labels
+	void addChangedLabels(const cell_t& cell, std::set<float>& changedGtLabels, std::set<float>& changedRecLabels);
+
+	// find the root of node in the union-find forest parents
+	unsigned int findRoot(unsigned int node, std::vector<unsigned int>& parents);
+
+	// is there a background label?
+	bool _haveBackgroundLabel;
+
+	// the optional background labels of the ground truth and reconstruction
+	float _gtBackgroundLabel;
+	float _recBackgroundLabel;
+
+	DistanceToleranceFunction _toleranceFunction;
+
+	CellLabelOptimizer _optimizer;
+
+	// the size of the chunks
+	unsigned int _chunkWidth, _chunkHeight, _chunkDepth;
+
+	// the number of chunks in x, y, and z
+	unsigned int _numChunksX, _numChunksY, _numChunksZ;
+
+	// the extends of the ground truth and reconstruction
+	unsigned int _width, _height, _depth;
+
+	ImageStack _groundTruth;
+
+	// a copy of the current reconstruction, with matched labels
+	ImageStack _reconstruction;
+
+	// the largest label that has been used in the reconstruction so far
+	float _maxLabel;
+
+	std::vector<Chunk> _chunks;
+
+	// all current cells, and empty cells in free slots
+	cells_t _cells;
+
+	// the free slots in _cells
+	std::vector<unsigned int> _freeCells;
+
+	// the cells of each ground-truth label
+	cell_index_t _cellsByGtLabel;
+
+	// the cells of each reconstruction label, as their own or as an 
+	// alternative label
+	cell_index_t _cellsByRecLabel;
+
+	// the fragments of each cell
+	std::vector<std::vector<FragmentId> > _cellFragments;
+
+	// the label of each cell: 0 for the reconstruction label, i > 0 for the 
+	// ith alternative label
+	std::vector<unsigned int> _choices;
+
+	boost::shared_ptr<TolerantEditDistanceErrors> _errors;
+
+	unsigned int _numUpdatedChunks;
+	unsigned int _numUpdatedCells;
+};
+
+#endif // SOPNET_EVALUATION_INCREMENTAL_TOLERANT_EDIT_DISTANCE_H__
+
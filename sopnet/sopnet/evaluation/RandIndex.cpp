@@ -27,94 +27,60 @@ RandIndex::updateOutputs() {
 	if (!_errors)
 		_errors = new RandIndexErrors();
 
-	unsigned int depth = _stack1->size();
+	ContingencyTable table;
+	table.count(*_stack1, *_stack2, _ignoreBackground);
 
-	if (depth == 0) {
-
-		// rand index of 1 for empty images
-		_errors->setNumPairs(1);
-		_errors->setNumAggreeingPairs(1);
-		return;
-	}
+	computeErrors(table, *_errors);
+}
 
-	unsigned int width  = (*_stack1)[0]->width();
-	unsigned int height = (*_stack1)[0]->height();
+void
+RandIndex::computeErrors(const ContingencyTable& table, RandIndexErrors& errors) {
 
-	size_t numLocations = depth*width*height;
+	size_t numLocations = table.getNumLocations();
 
 	if (numLocations == 0) {
 
 		// rand index of 1 for empty images
-		_errors->setNumPairs(1);
-		_errors->setNumAggreeingPairs(1);
+		errors.setNumPairs(1);
+		errors.setNumAggreeingPairs(1);
 		return;
 	}
 
-	double numAgree = getNumAgreeingPairs(*_stack1, *_stack2, numLocations);
+	double numAgree = getNumAgreeingPairs(table);
 	double numPairs = (static_cast<double>(numLocations)/2)*(static_cast<double>(numLocations) - 1);
 
 	LOG_DEBUG(randindexlog) << "number of pairs is          " << numPairs << std::endl;;
 	LOG_DEBUG(randindexlog) << "number of agreeing pairs is " << numAgree << std::endl;;
 
-	_errors->setNumPairs(numPairs);
-	_errors->setNumAggreeingPairs(numAgree);
+	errors.setNumPairs(numPairs);
+	errors.setNumAggreeingPairs(numAgree);
 }
 
 size_t
-RandIndex::getNumAgreeingPairs(const ImageStack& stack1, const ImageStack& stack2, size_t& numLocations) {
+RandIndex::getNumAgreeingPairs(const ContingencyTable& table) {
 
 	// Implementation following algorith by Bjoern Andres:
 	//
 	// https://github.com/bjoern-andres/partition-comparison/blob/master/include/andres/partition-comparison.hxx
 
-	typedef float                       Label;
-	typedef std::pair<Label,    Label>  LabelPair;
-	typedef std::map<LabelPair, size_t> ContingencyMatrix;
-	typedef std::map<Label,     size_t> SumVector;
-
-	ContingencyMatrix c;
-	SumVector         a;
-	SumVector         b;
-
-	ImageStack::const_iterator image1 = stack1.begin();
-	ImageStack::const_iterator image2 = stack2.begin();
-
-	// for each image in the stacks
-	for(; image1 != stack1.end(); image1++, image2++) {
-
-		Image::iterator i1 = (*image1)->begin();
-		Image::iterator i2 = (*image2)->begin();
-
-		for (; i1 != (*image1)->end(); i1++, i2++) {
-
-			if (_ignoreBackground && (*i1 == 0 || *i2 == 0)) {
-
-				numLocations--;
-				continue;
-			}
-
-			c[std::make_pair(*i1, *i2)]++;
-			a[*i1]++;
-			b[*i2]++;
-		}
-	}
+	size_t numLocations = table.getNumLocations();
 
-	LabelPair labelPair;
-	Label     label;
-	size_t    n;
+	ContingencyTable::LabelPair labelPair;
+	ContingencyTable::Label     label;
+	size_t                      n;
 
 	size_t A = 0;
 	size_t B = numLocations*numLocations;
 
-	foreach (boost::tie(labelPair, n), c) {
+	foreach (boost::tie(labelPair, n), table.getPairCounts()) {
 
 		A += n*(n-1);
 		B += n*n;
 	}
 
-	foreach (boost::tie(label, n), a)
+	foreach (boost::tie(label, n), table.getCounts1())
 		B -= n*n;
-	foreach (boost::tie(label, n), b)
+	foreach (boost::tie(label, n), table.getCounts2())
 		B -= n*n;
 
 	return (A+B)/2;
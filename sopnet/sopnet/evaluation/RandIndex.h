@@ -3,6 +3,7 @@
 
 #include <pipeline/all.h>
 #include <imageprocessing/ImageStack.h>
+#include "ContingencyTable.h"
 #include "RandIndexErrors.h"
 
 class RandIndex : public pipeline::SimpleProcessNode<> {
@@ -11,11 +12,16 @@ public:
 
 	RandIndex();
 
+	/**
+	 * Compute the RAND index from the label co-occurrences of two stacks.
+	 */
+	static void computeErrors(const ContingencyTable& table, RandIndexErrors& errors);
+
 private:
 
 	void updateOutputs();
 
-	size_t getNumAgreeingPairs(const ImageStack& stack1, const ImageStack& stack2, size_t& numLocations);
+	static size_t getNumAgreeingPairs(const ContingencyTable& table);
 
 	// input image stacks
 	pipeline::Input<ImageStack> _stack1;
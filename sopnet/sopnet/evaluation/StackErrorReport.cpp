@@ -0,0 +1,114 @@
+#include <boost/timer/timer.hpp>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include "ContingencyTable.h"
+#include "StackErrorReport.h"
+
+extern util::ProgramOption optionRandIgnoreBackground;
+extern util::ProgramOption optionVoiIgnoreBackground;
+
+logger::LogChannel stackerrorreportlog("stackerrorreportlog", "[StackErrorReport] ");
+
+StackErrorReport::StackErrorReport(bool reportTed, bool reportRand, bool reportVoi) :
+	_randErrors(new RandIndexErrors()),
+	_voiErrors(new VariationOfInformationErrors()),
+	_reportHeader(new std::string()),
+	_report(new std::string()),
+	_humanReadableReport(new std::string()),
+	_reportTed(reportTed),
+	_reportRand(reportRand),
+	_reportVoi(reportVoi),
+	_randIgnoreBackground(optionRandIgnoreBackground),
+	_voiIgnoreBackground(optionVoiIgnoreBackground),
+	_pipelineSetup(false) {
+
+	registerInput(_groundTruth, "ground truth");
+	registerInput(_reconstruction, "reconstruction");
+
+	if (_reportTed)
+		registerOutput(_ted->getOutput("errors"), "ted errors");
+	if (_reportRand)
+		registerOutput(_randErrors, "rand errors");
+	if (_reportVoi)
+		registerOutput(_voiErrors, "voi errors");
+
+	registerOutput(_reportHeader, "error report header");
+	registerOutput(_report, "error report");
+	registerOutput(_humanReadableReport, "human readable error report");
+}
+
+void
+StackErrorReport::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tStackErrorReport::updateOutputs():\t%ws\n");
+
+	_reportHeader->clear();
+	_report->clear();
+	_humanReadableReport->clear();
+
+	ContingencyTable table;
+
+	if (_reportTed) {
+
+		if (!_pipelineSetup) {
+
+			_ted->setInput("ground truth", _groundTruth);
+			_ted->setInput("reconstruction", _reconstruction);
+
+			_pipelineSetup = true;
+		}
+
+		pipeline::Value<TolerantEditDistanceErrors> tedErrors = _ted->getOutput("errors");
+
+		addToReport(*tedErrors);
+
+		// the cells partition the volume, no need for another scan
+		if (_reportRand || _reportVoi)
+			table.count(*tedErrors->getCells());
+
+	} else if (_reportRand || _reportVoi) {
+
+		table.count(*_groundTruth, *_reconstruction);
+	}
+
+	LOG_DEBUG(stackerrorreportlog)
+			<< "contingency table has " << table.getPairCounts().size()
+			<< " label pairs" << std::endl;
+
+	if (_reportRand) {
+
+		if (_randIgnoreBackground)
+			RandIndex::computeErrors(table.getWithoutBackground(), *_randErrors);
+		else
+			RandIndex::computeErrors(table, *_randErrors);
+
+		addToReport(*_randErrors);
+	}
+
+	if (_reportVoi) {
+
+		if (_voiIgnoreBackground)
+			VariationOfInformation::computeErrors(table.getWithoutBackground(), *_voiErrors);
+		else
+			VariationOfInformation::computeErrors(table, *_voiErrors);
+
+		addToReport(*_voiErrors);
+	}
+}
+
+void
+StackErrorReport::addToReport(Errors& errors) {
+
+	if (!_reportHeader->empty())
+		(*_reportHeader) += "\t";
+
+	if (!_report->empty())
+		(*_report) += "\t";
+
+	if (!_humanReadableReport->empty())
+		(*_humanReadableReport) += "; ";
+
+	(*_reportHeader)        += errors.errorHeader();
+	(*_report)              += errors.errorString();
+	(*_humanReadableReport) += errors.humanReadableErrorString();
+}
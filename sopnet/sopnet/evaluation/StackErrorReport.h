@@ -0,0 +1,61 @@
+#ifndef SOPNET_EVALUATION_STACK_ERROR_REPORT_H__
+#define SOPNET_EVALUATION_STACK_ERROR_REPORT_H__
+
+#include <string>
+#include <pipeline/SimpleProcessNode.h>
+#include <pipeline/Process.h>
+#include <imageprocessing/ImageStack.h>
+#include "RandIndex.h"
+#include "TolerantEditDistance.h"
+#include "VariationOfInformation.h"
+
+/**
+ * Computes a selection of error measures between a ground truth and a 
+ * reconstruction label stack, sharing the scan of the volumes between them: 
+ * RAND and VOI are computed from one contingency table of the label pairs. If 
+ * the tolerant edit distance is requested as well, the contingency table is 
+ * obtained from the cells found by the TED, such that the volumes are scanned 
+ * only once.
+ *
+ * The anisotropic edit distance is not part of this report, since it works on 
+ * segments instead of label stacks (see ErrorReport).
+ */
+class StackErrorReport : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	/**
+	 * Create a new report for the given error measures.
+	 */
+	StackErrorReport(bool reportTed = true, bool reportRand = true, bool reportVoi = true);
+
+private:
+
+	void updateOutputs();
+
+	// append the errors to the report
+	void addToReport(Errors& errors);
+
+	pipeline::Input<ImageStack> _groundTruth;
+	pipeline::Input<ImageStack> _reconstruction;
+
+	pipeline::Process<TolerantEditDistance> _ted;
+
+	pipeline::Output<RandIndexErrors>              _randErrors;
+	pipeline::Output<VariationOfInformationErrors> _voiErrors;
+	pipeline::Output<std::string>                  _reportHeader;
+	pipeline::Output<std::string>                  _report;
+	pipeline::Output<std::string>                  _humanReadableReport;
+
+	bool _reportTed;
+	bool _reportRand;
+	bool _reportVoi;
+
+	bool _randIgnoreBackground;
+	bool _voiIgnoreBackground;
+
+	bool _pipelineSetup;
+};
+
+#endif // SOPNET_EVALUATION_STACK_ERROR_REPORT_H__
+
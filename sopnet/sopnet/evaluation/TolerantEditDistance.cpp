@@ -13,6 +13,7 @@
 #include <util/exceptions.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
+#include "CellLabelOptimizer.h"
 #include "TolerantEditDistance.h"
 #include "DistanceToleranceFunction.h"
 #include "SkeletonToleranceFunction.h"
@@ -43,15 +44,40 @@ util::ProgramOption optionReconstructionBackgroundLabel(
 		util::_description_text = "The value of the reconstruction background label.",
 		util::_default_value    = 0.0);
 
+util::ProgramOption optionChunkWidth(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "chunkWidth",
+		util::_description_text = "Extract cells in chunks of this width to bound the memory usage. The default (0) does not split the volume in x.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionChunkHeight(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "chunkHeight",
+		util::_description_text = "Extract cells in chunks of this height to bound the memory usage. The default (0) does not split the volume in y.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionChunkDepth(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "chunkDepth",
+		util::_description_text = "Extract cells in chunks of this many sections to bound the memory usage. The default (0) does not split the volume in z.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionTedLinearSolver(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "tedLinearSolver",
+		util::_description_text = "Find the best cell labels for the tolerant edit distance with an ILP instead of the dedicated optimizer.",
+		util::_default_value    = false);
+
+util::ProgramOption optionTedMaxExactCells(
+		util::_module           = "sopnet.evaluation",
+		util::_long_name        = "tedMaxExactCells",
+		util::_description_text = "The maximal number of cells with alternative labels in an independent component to find the best cell labels for by exhaustive search.",
+		util::_default_value    = 20);
+
 TolerantEditDistance::TolerantEditDistance() :
 	_haveBackgroundLabel(optionHaveBackgroundLabel || optionGroundTruthFromSkeletons),
 	_gtBackgroundLabel(optionGroundTruthBackgroundLabel),
 	_recBackgroundLabel(optionReconstructionBackgroundLabel),
-	_correctedReconstruction(new ImageStack()),
-	_splitLocations(new ImageStack()),
-	_mergeLocations(new ImageStack()),
-	_fpLocations(new ImageStack()),
-	_fnLocations(new ImageStack()),
 	_errors(_haveBackgroundLabel ? new TolerantEditDistanceErrors(_gtBackgroundLabel, _recBackgroundLabel) : new TolerantEditDistanceErrors()) {
 
 	if (optionHaveBackgroundLabel) {
@@ -63,17 +89,26 @@ TolerantEditDistance::TolerantEditDistance() :
 	registerInput(_groundTruth, "ground truth");
 	registerInput(_reconstruction, "reconstruction");
 
-	registerOutput(_correctedReconstruction, "corrected reconstruction");
-	registerOutput(_splitLocations, "splits");
-	registerOutput(_mergeLocations, "merges");
-	registerOutput(_fpLocations, "false positives");
-	registerOutput(_fnLocations, "false negatives");
 	registerOutput(_errors, "errors");
 
+	// the corrected reconstruction and error location stacks are only created 
+	// if someone asks for them
+	_correction->setInput("errors", _errors);
+	_errorLocations->setInput("errors", _errors);
+
+	registerOutput(_correction->getOutput("corrected reconstruction"), "corrected reconstruction");
+
+	registerOutput(_errorLocations->getOutput("splits"), "splits");
+	registerOutput(_errorLocations->getOutput("merges"), "merges");
+	registerOutput(_errorLocations->getOutput("false positives"), "false positives");
+	registerOutput(_errorLocations->getOutput("false negatives"), "false negatives");
+
 	if (optionGroundTruthFromSkeletons)
 		_toleranceFunction = new SkeletonToleranceFunction(optionToleranceDistanceThreshold.as<float>(), _recBackgroundLabel);
 	else
 		_toleranceFunction = new DistanceToleranceFunction(optionToleranceDistanceThreshold.as<float>(), _haveBackgroundLabel, _recBackgroundLabel);
+
+	_groundTruth.registerCallback(&TolerantEditDistance::onInputSet, this);
 }
 
 TolerantEditDistance::~TolerantEditDistance() {
@@ -81,6 +116,14 @@ TolerantEditDistance::~TolerantEditDistance() {
 	delete _toleranceFunction;
 }
 
+void
+TolerantEditDistance::onInputSet(const pipeline::InputSetBase&) {
+
+	// the rendered stacks have the size of the ground truth
+	_correction->setInput("reference", _groundTruth.getAssignedOutput());
+	_errorLocations->setInput("reference", _groundTruth.getAssignedOutput());
+}
+
 void
 TolerantEditDistance::updateOutputs() {
 
@@ -90,8 +133,6 @@ TolerantEditDistance::updateOutputs() {
 
 	findBestCellLabels();
 
-	correctReconstruction();
-
 	findErrors();
 }
 
@@ -105,11 +146,6 @@ TolerantEditDistance::clear() {
 	_labelingByVar.clear();
 	_alternativeIndicators.clear();
 	_errors->clear();
-	_correctedReconstruction->clear();
-	_splitLocations->clear();
-	_mergeLocations->clear();
-	_fpLocations->clear();
-	_fnLocations->clear();
 }
 
 void
@@ -127,6 +163,12 @@ TolerantEditDistance::extractCells() {
 	_width  = _groundTruth->width();
 	_height = _groundTruth->height();
 
+	if (optionChunkWidth || optionChunkHeight || optionChunkDepth) {
+
+		extractCellsChunked();
+		return;
+	}
+
 	LOG_ALL(tedlog) << "extracting cells in " << _width << "x" << _height << "x" << _depth << " volume" << std::endl;
 
 	vigra::MultiArray<3, std::pair<float, float> > gtAndRec(vigra::Shape3(_width, _height, _depth));
@@ -172,24 +214,36 @@ TolerantEditDistance::extractCells() {
 }
 
 void
-TolerantEditDistance::findBestCellLabels() {
+TolerantEditDistance::extractCellsChunked() {
 
-	boost::timer::auto_cpu_timer timer(std::cout, "\tfindBestCellLabels():\t\t\t%ws\n");
+	LOG_ALL(tedlog) << "extracting cells in " << _width << "x" << _height << "x" << _depth << " volume in chunks" << std::endl;
 
-	pipeline::Value<LinearConstraints>      constraints;
-	pipeline::Value<LinearSolverParameters> parameters;
+	_toleranceFunction->extractCells(
+			*_reconstruction,
+			*_groundTruth,
+			optionChunkWidth.as<unsigned int>(),
+			optionChunkHeight.as<unsigned int>(),
+			optionChunkDepth.as<unsigned int>());
 
-	// the default are binary variables
-	parameters->setVariableType(Binary);
+	_numCells = _toleranceFunction->getCells()->size();
+
+	LOG_DEBUG(tedlog) << "found " << _numCells << " cells" << std::endl;
+}
+
+void
+TolerantEditDistance::findBestCellLabels() {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tfindBestCellLabels():\t\t\t%ws\n");
 
 	// introduce indicators for each cell and each possible label of that cell
 	unsigned int var = 0;
+	_firstIndicators.clear();
 	for (unsigned int cellIndex = 0; cellIndex < _toleranceFunction->getCells()->size(); cellIndex++) {
 
 		cell_t& cell = (*_toleranceFunction->getCells())[cellIndex];
 
 		// first indicator variable for this cell
-		unsigned int begin = var;
+		_firstIndicators.push_back(var);
 
 		// one variable for the default label
 		assignIndicatorVariable(var++, cellIndex, cell.getGroundTruthLabel(), cell.getReconstructionLabel());
@@ -201,19 +255,62 @@ TolerantEditDistance::findBestCellLabels() {
 			_alternativeIndicators.push_back(std::make_pair(ind, cell.size()));
 			assignIndicatorVariable(ind, cellIndex, cell.getGroundTruthLabel(), l);
 		}
+	}
+	_numIndicatorVars = var;
+	_firstIndicators.push_back(var);
 
-		// last +1 indicator variable for this cell
-		unsigned int end = var;
+	if (optionTedLinearSolver)
+		findBestCellLabelsIlp();
+	else
+		findBestCellLabelsCombinatorial();
+}
+
+void
+TolerantEditDistance::findBestCellLabelsCombinatorial() {
+
+	CellLabelOptimizer optimizer(optionTedMaxExactCells.as<unsigned int>());
+
+	std::vector<unsigned int> choices;
+	optimizer.optimize(
+			*_toleranceFunction->getCells(),
+			_toleranceFunction->getReconstructionLabels(),
+			_width*_height*_depth,
+			choices);
+
+	LOG_USER(tedlog)
+			<< "solved " << optimizer.getNumOptimalComponents() << " of " << optimizer.getNumComponents()
+			<< " components to optimality, the number of splits and merges is at most "
+			<< optimizer.getGap() << " above the optimum" << std::endl;
+
+	// set the indicators of the chosen labels
+	_solution = pipeline::Value<Solution>(_numIndicatorVars);
+	for (unsigned int i = 0; i < _numIndicatorVars; i++)
+		(*_solution)[i] = 0;
+	for (unsigned int cellIndex = 0; cellIndex < choices.size(); cellIndex++)
+		(*_solution)[_firstIndicators[cellIndex] + choices[cellIndex]] = 1;
+}
+
+void
+TolerantEditDistance::findBestCellLabelsIlp() {
+
+	pipeline::Value<LinearConstraints>      constraints;
+	pipeline::Value<LinearSolverParameters> parameters;
+
+	// the default are binary variables
+	parameters->setVariableType(Binary);
+
+	unsigned int var = _numIndicatorVars;
+
+	// every cell needs to have a label
+	for (unsigned int cellIndex = 0; cellIndex + 1 < _firstIndicators.size(); cellIndex++) {
 
-		// every cell needs to have a label
 		LinearConstraint constraint;
-		for (unsigned int i = begin; i < end; i++)
+		for (unsigned int i = _firstIndicators[cellIndex]; i < _firstIndicators[cellIndex + 1]; i++)
 			constraint.setCoefficient(i, 1.0);
 		constraint.setRelation(Equal);
 		constraint.setValue(1);
 		constraints->add(constraint);
 	}
-	_numIndicatorVars = var;
 
 	// labels can not disappear
 	foreach (float recLabel, _toleranceFunction->getReconstructionLabels()) {
@@ -376,17 +473,6 @@ TolerantEditDistance::findErrors() {
 
 	boost::timer::auto_cpu_timer timer(std::cout, "\tfindErrors():\t\t\t\t%ws\n");
 
-	// prepare error location image stack
-
-	for (unsigned int i = 0; i < _depth; i++) {
-
-		// initialize with gray (no cell label)
-		_splitLocations->add(boost::make_shared<Image>(_width, _height, 0.33));
-		_mergeLocations->add(boost::make_shared<Image>(_width, _height, 0.33));
-		_fpLocations->add(boost::make_shared<Image>(_width, _height, 0.33));
-		_fnLocations->add(boost::make_shared<Image>(_width, _height, 0.33));
-	}
-
 	// prepare error data structure
 
 	_errors->setCells(_toleranceFunction->getCells());
@@ -403,80 +489,6 @@ TolerantEditDistance::findErrors() {
 			_errors->addMapping(cellIndex, recLabel);
 		}
 	}
-
-	//LOG_USER(tedlog) << "error counts from Errors data structure:" << std::endl;
-	//LOG_USER(tedlog) << "num splits: " << _errors->getNumSplits() << std::endl;
-	//LOG_USER(tedlog) << "num merges: " << _errors->getNumMerges() << std::endl;
-	//LOG_USER(tedlog) << "num false positives: " << _errors->getNumFalsePositives() << std::endl;
-	//LOG_USER(tedlog) << "num false negatives: " << _errors->getNumFalseNegatives() << std::endl;
-
-	// fill error location image stack
-
-	// all cells that changed label within tolerance
-
-	// all cells that split the ground truth
-	float gtLabel;
-	typedef TolerantEditDistanceErrors::cell_map_t::mapped_type::value_type mapping_t;
-	foreach (gtLabel, _errors->getSplitLabels())
-		foreach (const mapping_t& cells, _errors->getSplitCells(gtLabel))
-			foreach (unsigned int cellIndex, cells.second)
-				foreach (const cell_t::Location& l, (*_toleranceFunction->getCells())[cellIndex])
-					(*(*_splitLocations)[l.z])(l.x, l.y) = cells.first;
-
-	// all cells that split the reconstruction
-	float recLabel;
-	foreach (recLabel, _errors->getMergeLabels())
-		foreach (const mapping_t& cells, _errors->getMergeCells(recLabel))
-			foreach (unsigned int cellIndex, cells.second)
-				foreach (const cell_t::Location& l, (*_toleranceFunction->getCells())[cellIndex])
-					(*(*_mergeLocations)[l.z])(l.x, l.y) = cells.first;
-
-	if (_haveBackgroundLabel) {
-
-		// all cells that are false positives
-		foreach (const mapping_t& cells, _errors->getFalsePositiveCells())
-			if (cells.first != _recBackgroundLabel) {
-				foreach (unsigned int cellIndex, cells.second)
-					foreach (const cell_t::Location& l, (*_toleranceFunction->getCells())[cellIndex])
-						(*(*_fpLocations)[l.z])(l.x, l.y) = cells.first;
-			}
-
-		// all cells that are false negatives
-		foreach (const mapping_t& cells, _errors->getFalseNegativeCells())
-			if (cells.first != _gtBackgroundLabel) {
-				foreach (unsigned int cellIndex, cells.second)
-					foreach (const cell_t::Location& l, (*_toleranceFunction->getCells())[cellIndex])
-						(*(*_fnLocations)[l.z])(l.x, l.y) = cells.first;
-			}
-	}
-}
-
-void
-TolerantEditDistance::correctReconstruction() {
-
-	boost::timer::auto_cpu_timer timer(std::cout, "\tcorrectReconstruction():\t\t%ws\n");
-
-	// prepare output image
-
-	for (unsigned int i = 0; i < _depth; i++) {
-
-		_correctedReconstruction->add(boost::make_shared<Image>(_width, _height, 0.0));
-	}
-
-	// read solution
-
-	for (unsigned int i = 0; i < _numIndicatorVars; i++) {
-
-		if ((*_solution)[i]) {
-
-			unsigned int cellIndex = _labelingByVar[i].first;
-			float        recLabel  = _labelingByVar[i].second;
-			cell_t&      cell      = (*_toleranceFunction->getCells())[cellIndex];
-
-			foreach (const cell_t::Location& l, cell)
-				(*(*_correctedReconstruction)[l.z])(l.x, l.y) = recLabel;
-		}
-	}
 }
 
 void
@@ -2,11 +2,14 @@
 #define SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_H__
 
 #include <imageprocessing/ImageStack.h>
+#include <pipeline/Process.h>
 #include <pipeline/SimpleProcessNode.h>
 #include <pipeline/Value.h>
 #include <inference/Solution.h>
-#include "LocalToleranceFunction.h"
+#include "DistanceToleranceFunction.h"
 #include "TolerantEditDistanceErrors.h"
+#include "TolerantEditDistanceCorrectedReconstruction.h"
+#include "TolerantEditDistanceErrorLocations.h"
 #include "Cell.h"
 
 class TolerantEditDistance : public pipeline::SimpleProcessNode<> {
@@ -21,17 +24,23 @@ private:
 
 	typedef LocalToleranceFunction::cell_t cell_t;
 
+	void onInputSet(const pipeline::InputSetBase& signal);
+
 	void updateOutputs();
 
 	void clear();
 
 	void extractCells();
 
+	void extractCellsChunked();
+
 	void findBestCellLabels();
 
-	void findErrors();
+	void findBestCellLabelsCombinatorial();
+
+	void findBestCellLabelsIlp();
 
-	void correctReconstruction();
+	void findErrors();
 
 	void assignIndicatorVariable(unsigned int var, unsigned int cellIndex, float gtLabel, float recLabel);
 
@@ -53,15 +62,16 @@ private:
 	pipeline::Input<ImageStack> _groundTruth;
 	pipeline::Input<ImageStack> _reconstruction;
 
-	pipeline::Output<ImageStack> _correctedReconstruction;
-	pipeline::Output<ImageStack> _splitLocations;
-	pipeline::Output<ImageStack> _mergeLocations;
-	pipeline::Output<ImageStack> _fpLocations;
-	pipeline::Output<ImageStack> _fnLocations;
 	pipeline::Output<TolerantEditDistanceErrors> _errors;
 
+	// renders the corrected reconstruction only if it is requested
+	pipeline::Process<TolerantEditDistanceCorrectedReconstruction> _correction;
+
+	// renders the error locations only if they are requested
+	pipeline::Process<TolerantEditDistanceErrorLocations> _errorLocations;
+
 	// the local tolerance function to use
-	LocalToleranceFunction* _toleranceFunction;
+	DistanceToleranceFunction* _toleranceFunction;
 
 	// the extends of the ground truth and reconstruction
 	unsigned int _width, _height, _depth;
@@ -85,6 +95,10 @@ private:
 	// the number of indicator variables in the ILP
 	unsigned int _numIndicatorVars;
 
+	// the first indicator variable of each cell, and the number of indicator 
+	// variables as last element
+	std::vector<unsigned int> _firstIndicators;
+
 	// indicators for alternative cell labels, and the corresponding cell size
 	std::vector<std::pair<unsigned int, size_t> > _alternativeIndicators;
 
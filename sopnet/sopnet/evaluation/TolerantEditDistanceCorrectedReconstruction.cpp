@@ -0,0 +1,39 @@
+#include <iostream>
+#include <boost/timer/timer.hpp>
+#include <util/foreach.h>
+#include "TolerantEditDistanceCorrectedReconstruction.h"
+
+TolerantEditDistanceCorrectedReconstruction::TolerantEditDistanceCorrectedReconstruction() :
+	_correctedReconstruction(new ImageStack()) {
+
+	registerInput(_errors, "errors");
+	registerInput(_reference, "reference");
+
+	registerOutput(_correctedReconstruction, "corrected reconstruction");
+}
+
+void
+TolerantEditDistanceCorrectedReconstruction::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tTolerantEditDistanceCorrectedReconstruction::updateOutputs():\t%ws\n");
+
+	_correctedReconstruction->clear();
+
+	for (unsigned int i = 0; i < _reference->size(); i++)
+		_correctedReconstruction->add(boost::make_shared<Image>(_reference->width(), _reference->height(), 0.0));
+
+	const std::vector<cell_t>& cells = *_errors->getCells();
+
+	typedef cell_map_t::value_type              rec_mapping_t;
+	typedef cell_map_t::mapped_type::value_type gt_mapping_t;
+	foreach (const rec_mapping_t& recMapping, _errors->getCellsByReconstructionLabel())
+		foreach (const gt_mapping_t& gtMapping, recMapping.second)
+			foreach (unsigned int cellIndex, gtMapping.second)
+				foreach (const cell_t::Run& run, cells[cellIndex].getRuns()) {
+
+					Image& section = *(*_correctedReconstruction)[run.z];
+
+					for (unsigned int i = 0; i < run.length; i++)
+						section(run.x + i, run.y) = recMapping.first;
+				}
+}
@@ -0,0 +1,35 @@
+#ifndef SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_CORRECTED_RECONSTRUCTION_H__
+#define SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_CORRECTED_RECONSTRUCTION_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <imageprocessing/ImageStack.h>
+#include "TolerantEditDistanceErrors.h"
+
+/**
+ * Renders the reconstruction as corrected by the TED, i.e., every cell with 
+ * the reconstruction label it was mapped to. Only needed for visualization -- 
+ * the error counts are available from the TolerantEditDistanceErrors 
+ * directly.
+ */
+class TolerantEditDistanceCorrectedReconstruction : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	TolerantEditDistanceCorrectedReconstruction();
+
+private:
+
+	typedef TolerantEditDistanceErrors::cell_t     cell_t;
+	typedef TolerantEditDistanceErrors::cell_map_t cell_map_t;
+
+	void updateOutputs();
+
+	pipeline::Input<TolerantEditDistanceErrors> _errors;
+
+	// a stack of the size of the volume the errors were found in
+	pipeline::Input<ImageStack> _reference;
+
+	pipeline::Output<ImageStack> _correctedReconstruction;
+};
+
+#endif // SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_CORRECTED_RECONSTRUCTION_H__
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <boost/timer/timer.hpp>
+#include <util/foreach.h>
+#include "TolerantEditDistanceErrorLocations.h"
+
+TolerantEditDistanceErrorLocations::TolerantEditDistanceErrorLocations() :
+	_splitLocations(new ImageStack()),
+	_mergeLocations(new ImageStack()),
+	_fpLocations(new ImageStack()),
+	_fnLocations(new ImageStack()) {
+
+	registerInput(_errors, "errors");
+	registerInput(_reference, "reference");
+
+	registerOutput(_splitLocations, "splits");
+	registerOutput(_mergeLocations, "merges");
+	registerOutput(_fpLocations, "false positives");
+	registerOutput(_fnLocations, "false negatives");
+}
+
+void
+TolerantEditDistanceErrorLocations::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer(std::cout, "\tTolerantEditDistanceErrorLocations::updateOutputs():\t%ws\n");
+
+	initialize(*_splitLocations);
+	initialize(*_mergeLocations);
+	initialize(*_fpLocations);
+	initialize(*_fnLocations);
+
+	// all cells that split the ground truth
+	foreach (float gtLabel, _errors->getSplitLabels())
+		drawCells(_errors->getSplitCells(gtLabel), *_splitLocations);
+
+	// all cells that split the reconstruction
+	foreach (float recLabel, _errors->getMergeLabels())
+		drawCells(_errors->getMergeCells(recLabel), *_mergeLocations);
+
+	if (_errors->haveBackgroundLabel()) {
+
+		drawCells(_errors->getFalsePositiveCells(), *_fpLocations, true, _errors->getReconstructionBackgroundLabel());
+		drawCells(_errors->getFalseNegativeCells(), *_fnLocations, true, _errors->getGroundTruthBackgroundLabel());
+	}
+}
+
+void
+TolerantEditDistanceErrorLocations::initialize(ImageStack& stack) {
+
+	stack.clear();
+
+	// initialize with gray (no cell label)
+	for (unsigned int i = 0; i < _reference->size(); i++)
+		stack.add(boost::make_shared<Image>(_reference->width(), _reference->height(), 0.33));
+}
+
+void
+TolerantEditDistanceErrorLocations::drawCells(
+		const partner_map_t& partners,
+		ImageStack&          stack,
+		bool                 skipBackground,
+		float                backgroundLabel) {
+
+	const std::vector<cell_t>& cells = *_errors->getCells();
+
+	typedef partner_map_t::value_type mapping_t;
+	foreach (const mapping_t& partner, partners) {
+
+		if (skipBackground && partner.first == backgroundLabel)
+			continue;
+
+		foreach (unsigned int cellIndex, partner.second)
+			foreach (const cell_t::Run& run, cells[cellIndex].getRuns()) {
+
+				Image& section = *stack[run.z];
+
+				for (unsigned int i = 0; i < run.length; i++)
+					section(run.x + i, run.y) = partner.first;
+			}
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_ERROR_LOCATIONS_H__
+#define SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_ERROR_LOCATIONS_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <imageprocessing/ImageStack.h>
+#include "TolerantEditDistanceErrors.h"
+
+/**
+ * Renders the cells of TED errors into one image stack per error type. Cells 
+ * are drawn with the label of their error partner, all other locations are 
+ * gray. Only needed for visualization -- the error counts are available from 
+ * the TolerantEditDistanceErrors directly.
+ */
+class TolerantEditDistanceErrorLocations : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	TolerantEditDistanceErrorLocations();
+
+private:
+
+	typedef TolerantEditDistanceErrors::cell_t                  cell_t;
+	typedef TolerantEditDistanceErrors::cell_map_t::mapped_type partner_map_t;
+
+	void updateOutputs();
+
+	// create an empty error stack of the size of the reference
+	void initialize(ImageStack& stack);
+
+	// draw all cells of the given partners with the label of the partner, 
+	// optionally skipping the background partner
+	void drawCells(
+			const partner_map_t& partners,
+			ImageStack&          stack,
+			bool                 skipBackground = false,
+			float                backgroundLabel = 0);
+
+	pipeline::Input<TolerantEditDistanceErrors> _errors;
+	pipeline::Input<ImageStack>                 _reference;
+
+	pipeline::Output<ImageStack> _splitLocations;
+	pipeline::Output<ImageStack> _mergeLocations;
+	pipeline::Output<ImageStack> _fpLocations;
+	pipeline::Output<ImageStack> _fnLocations;
+};
+
+#endif // SOPNET_EVALUATION_TOLERANT_EDIT_DISTANCE_ERROR_LOCATIONS_H__
+
@@ -40,6 +40,11 @@ TolerantEditDistanceErrors::clear() {
 	_cellsByGtToRecLabel.clear();
 	_cellsByRecToGtLabel.clear();
 
+	_numSplits         = 0;
+	_numMerges         = 0;
+	_numFalsePositives = 0;
+	_numFalseNegatives = 0;
+
 	_dirty = true;
 }
 
@@ -51,9 +56,31 @@ TolerantEditDistanceErrors::addMapping(unsigned int cellIndex, float recLabel) {
 
 	float gtLabel = (*_cells)[cellIndex].getGroundTruthLabel();
 
+	countErrors(gtLabel, recLabel, false);
+
 	addEntry(_cellsByRecToGtLabel, recLabel, gtLabel, cellIndex);
 	addEntry(_cellsByGtToRecLabel, gtLabel, recLabel, cellIndex);
 
+	countErrors(gtLabel, recLabel, true);
+
+	_dirty = true;
+}
+
+void
+TolerantEditDistanceErrors::removeMapping(unsigned int cellIndex, float recLabel) {
+
+	if (!_cells)
+		BOOST_THROW_EXCEPTION(UsageError() << error_message("cells need to be set before using removeMapping()") << STACK_TRACE);
+
+	float gtLabel = (*_cells)[cellIndex].getGroundTruthLabel();
+
+	countErrors(gtLabel, recLabel, false);
+
+	removeEntry(_cellsByRecToGtLabel, recLabel, gtLabel, cellIndex);
+	removeEntry(_cellsByGtToRecLabel, gtLabel, recLabel, cellIndex);
+
+	countErrors(gtLabel, recLabel, true);
+
 	_dirty = true;
 }
 
@@ -98,35 +125,31 @@ TolerantEditDistanceErrors::getOverlap(float gtLabel, float recLabel) {
 unsigned int
 TolerantEditDistanceErrors::getNumSplits() {
 
-	updateErrorCounts();
 	return _numSplits;
 }
 
 unsigned int
 TolerantEditDistanceErrors::getNumMerges() {
 
-	updateErrorCounts();
 	return _numMerges;
 }
 
 unsigned int
 TolerantEditDistanceErrors::getNumFalsePositives() {
 
-	updateErrorCounts();
 	return _numFalsePositives;
 }
 
 unsigned int
 TolerantEditDistanceErrors::getNumFalseNegatives() {
 
-	updateErrorCounts();
 	return _numFalseNegatives;
 }
 
 std::set<float>
 TolerantEditDistanceErrors::getMergeLabels() {
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 
 	std::set<float> mergeLabels;
 	foreach (float k, _merges | boost::adaptors::map_keys)
@@ -138,7 +161,7 @@ TolerantEditDistanceErrors::getMergeLabels() {
 std::set<float>
 TolerantEditDistanceErrors::getSplitLabels() {
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 
 	std::set<float> splitLabels;
 	foreach (float k, _splits | boost::adaptors::map_keys)
@@ -174,14 +197,14 @@ TolerantEditDistanceErrors::getMerges(float recLabel) {
 const TolerantEditDistanceErrors::cell_map_t::mapped_type&
 TolerantEditDistanceErrors::getSplitCells(float gtLabel) {
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 	return _splits[gtLabel];
 }
 
 const TolerantEditDistanceErrors::cell_map_t::mapped_type&
 TolerantEditDistanceErrors::getMergeCells(float recLabel) {
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 	return _merges[recLabel];
 }
 
@@ -191,7 +214,7 @@ TolerantEditDistanceErrors::getFalsePositiveCells() {
 	if (!_haveBackgroundLabel)
 		BOOST_THROW_EXCEPTION(UsageError() << error_message("we don't hav a background label -- cannot give false positives"));
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 	return _splits[_gtBackgroundLabel];
 }
 
@@ -201,57 +224,121 @@ TolerantEditDistanceErrors::getFalseNegativeCells() {
 	if (!_haveBackgroundLabel)
 		BOOST_THROW_EXCEPTION(UsageError() << error_message("we don't hav a background label -- cannot give false negatives"));
 
-	updateErrorCounts();
+	updateSplitsAndMerges();
 	return _merges[_recBackgroundLabel];
 }
 
+std::vector<TolerantEditDistanceErrors::ErrorPair>
+TolerantEditDistanceErrors::getErrorPairs() {
+
+	updateSplitsAndMerges();
+
+	std::vector<ErrorPair> pairs;
+
+	addErrorPairs(_splits, true,  Split, FalsePositive, _gtBackgroundLabel,  _recBackgroundLabel, pairs);
+	addErrorPairs(_merges, false, Merge, FalseNegative, _recBackgroundLabel, _gtBackgroundLabel,  pairs);
+
+	return pairs;
+}
+
+void
+TolerantEditDistanceErrors::addErrorPairs(
+		const cell_map_t&       splits,
+		bool                    gtFirst,
+		ErrorType               type,
+		ErrorType               backgroundType,
+		float                   backgroundLabel,
+		float                   partnerBackgroundLabel,
+		std::vector<ErrorPair>& pairs) {
+
+	typedef cell_map_t::value_type                mapping_t;
+	typedef cell_map_t::mapped_type::value_type   partner_t;
+
+	foreach (const mapping_t& i, splits) {
+
+		bool isBackground = (_haveBackgroundLabel && i.first == backgroundLabel);
+
+		foreach (const partner_t& partner, i.second) {
+
+			// the background mapping to the background is not an error
+			if (isBackground && partner.first == partnerBackgroundLabel)
+				continue;
+
+			ErrorPair pair;
+			pair.type         = (isBackground ? backgroundType : type);
+			pair.gtLabel      = (gtFirst ? i.first : partner.first);
+			pair.recLabel     = (gtFirst ? partner.first : i.first);
+			pair.numCells     = partner.second.size();
+			pair.numLocations = 0;
+
+			foreach (unsigned int cellIndex, partner.second)
+				pair.numLocations += (*_cells)[cellIndex].size();
+
+			pairs.push_back(pair);
+		}
+	}
+}
+
+void
+TolerantEditDistanceErrors::countErrors(float gtLabel, float recLabel, bool add) {
+
+	// each label mapped to n > 1 partners contributes n - 1 errors
+
+	cell_map_t::const_iterator gt = _cellsByGtToRecLabel.find(gtLabel);
+
+	if (gt != _cellsByGtToRecLabel.end() && gt->second.size() > 1) {
+
+		unsigned int& count = (_haveBackgroundLabel && gtLabel == _gtBackgroundLabel ? _numFalsePositives : _numSplits);
+
+		if (add)
+			count += gt->second.size() - 1;
+		else
+			count -= gt->second.size() - 1;
+	}
+
+	cell_map_t::const_iterator rec = _cellsByRecToGtLabel.find(recLabel);
+
+	if (rec != _cellsByRecToGtLabel.end() && rec->second.size() > 1) {
+
+		unsigned int& count = (_haveBackgroundLabel && recLabel == _recBackgroundLabel ? _numFalseNegatives : _numMerges);
+
+		if (add)
+			count += rec->second.size() - 1;
+		else
+			count -= rec->second.size() - 1;
+	}
+}
+
 void
-TolerantEditDistanceErrors::updateErrorCounts() {
+TolerantEditDistanceErrors::updateSplitsAndMerges() {
 
 	if (!_dirty)
 		return;
 
-	boost::timer::auto_cpu_timer timer("\tTolerantEditDistanceErrors::updateErrorCounts():\t\t%w\n");
+	boost::timer::auto_cpu_timer timer("\tTolerantEditDistanceErrors::updateSplitsAndMerges():\t\t%w\n");
 
 	_dirty = false;
 
-	_numSplits = 0;
-	_numMerges = 0;
-	_numFalsePositives = 0;
-	_numFalseNegatives = 0;
 	_splits.clear();
 	_merges.clear();
 
-	findSplits(_cellsByGtToRecLabel, _splits, _numSplits, _numFalsePositives, _gtBackgroundLabel);
-	findSplits(_cellsByRecToGtLabel, _merges, _numMerges, _numFalseNegatives, _recBackgroundLabel);
+	findSplits(_cellsByGtToRecLabel, _splits);
+	findSplits(_cellsByRecToGtLabel, _merges);
 }
 
 void
-TolerantEditDistanceErrors::findSplits(
-		const cell_map_t& cellMap,
-		cell_map_t&       splits,
-		unsigned int&     numSplits,
-		unsigned int&     numFalsePositives,
-		float             backgroundLabel) {
+TolerantEditDistanceErrors::findSplits(const cell_map_t& cellMap, cell_map_t& splits) {
 
 	typedef cell_map_t::value_type mapping_t;
 
 	foreach (const mapping_t& i, cellMap) {
 
-		unsigned int partners = i.second.size();
-
 		// one-to-one mapping is okay
-		if (partners == 1)
+		if (i.second.size() <= 1)
 			continue;
 
 		// remeber the split
 		splits[i.first] = i.second;
-
-		// increase count
-		if (_haveBackgroundLabel && i.first == backgroundLabel)
-			numFalsePositives += partners - 1;
-		else
-			numSplits += partners - 1;
 	}
 }
 
@@ -260,3 +347,26 @@ TolerantEditDistanceErrors::addEntry(cell_map_t& map, float a, float b, unsigned
 
 	map[a][b].insert(cellIndex);
 }
+
+void
+TolerantEditDistanceErrors::removeEntry(cell_map_t& map, float a, float b, unsigned int cellIndex) {
+
+	cell_map_t::iterator i = map.find(a);
+
+	if (i == map.end())
+		return;
+
+	cell_map_t::mapped_type::iterator j = i->second.find(b);
+
+	if (j == i->second.end())
+		return;
+
+	j->second.erase(cellIndex);
+
+	// don't keep empty entries, they would count as partners
+	if (j->second.empty())
+		i->second.erase(j);
+
+	if (i->second.empty())
+		map.erase(i);
+}
@@ -19,6 +19,27 @@ public:
 	typedef boost::shared_ptr<std::vector<cell_t> >                    cells_t;
 	typedef std::map<float, std::map<float, std::set<unsigned int> > > cell_map_t;
 
+	enum ErrorType {
+
+		Split,
+		Merge,
+		FalsePositive,
+		FalseNegative
+	};
+
+	/**
+	 * A pair of ground truth and reconstruction label that contributes to an 
+	 * error, together with the number of cells and locations they share.
+	 */
+	struct ErrorPair {
+
+		ErrorType    type;
+		float        gtLabel;
+		float        recLabel;
+		unsigned int numCells;
+		unsigned int numLocations;
+	};
+
 	/**
 	 * Create an empty errors data structure without using a background label, 
 	 * i.e., without false positives and false negatives.
@@ -28,10 +49,10 @@ public:
 	/**
 	 * Create an empty errors data structure for the given background labels.
 	 *
-	 * @param gtBackgroundLabel
+	 * @param gtBackgroundLabel 
 	 *             The background label in the ground truth.
 	 *
-	 * @param recBackgroundLabel
+	 * @param recBackgroundLabel 
 	 *             The background label in the reconstruction.
 	 */
 	TolerantEditDistanceErrors(float gtBackgroundLabel, float recBackgroundLabel);
@@ -40,7 +61,7 @@ public:
 	 * Set the list of cells this errors data structure is working on. This has 
 	 * to be done before calling addMapping() or getOverlap().
 	 *
-	 * @param cells
+	 * @param cells 
 	 *             A list of cells (sets of image locations) that partitions the 
 	 *             ground truth and reconstruction volumes. Each cell has a 
 	 *             ground truth label and can be mapped via addMapping() to an 
@@ -48,6 +69,21 @@ public:
 	 */
 	void setCells(cells_t cells);
 
+	/**
+	 * Get the list of cells this errors data structure is working on.
+	 */
+	cells_t getCells() const { return _cells; }
+
+	/**
+	 * Indicate whether a background label is used, i.e., whether there are 
+	 * false positives and false negatives.
+	 */
+	bool haveBackgroundLabel() const { return _haveBackgroundLabel; }
+
+	float getGroundTruthBackgroundLabel() const { return _gtBackgroundLabel; }
+
+	float getReconstructionBackgroundLabel() const { return _recBackgroundLabel; }
+
 	/**
 	 * Clear the label mappings and error counts.
 	 */
@@ -56,14 +92,28 @@ public:
 	/**
 	 * Register a mapping from a cell to a reconstruction label.
 	 * 
-	 * @param cellIndex
+	 * @param cellIndex 
 	 *             The index of the cell in the cell list.
 	 *
-	 * @param recLabel
+	 * @param recLabel 
 	 *             The reconstruction label of the cell.
 	 */
 	void addMapping(unsigned int cellIndex, float recLabel);
 
+	/**
+	 * Remove a mapping that was registered with addMapping(). The error counts 
+	 * are updated for the affected labels only, such that a sequence of small 
+	 * changes to the mappings is cheap. The cell must still have the ground 
+	 * truth label it had when the mapping was added.
+	 *
+	 * @param cellIndex 
+	 *             The index of the cell in the cell list.
+	 *
+	 * @param recLabel 
+	 *             The reconstruction label the cell was mapped to.
+	 */
+	void removeMapping(unsigned int cellIndex, float recLabel);
+
 	/**
 	 * Get all reconstruction labels that map to the given ground truth label.
 	 */
@@ -133,6 +183,19 @@ public:
 	 */
 	const cell_map_t::mapped_type& getFalseNegativeCells();
 
+	/**
+	 * Get all cells, grouped by the reconstruction label they are mapped to 
+	 * and their ground truth label.
+	 */
+	const cell_map_t& getCellsByReconstructionLabel() const { return _cellsByRecToGtLabel; }
+
+	/**
+	 * Get a sparse list of all errors, i.e., all pairs of ground truth and 
+	 * reconstruction labels that are part of a split, merge, false positive, 
+	 * or false negative, with the number of cells and locations of each pair.
+	 */
+	std::vector<ErrorPair> getErrorPairs();
+
 	std::string errorHeader() { return "TED_FP\tTED_FN\tTED_FS\tTED_FM\tTED_SUM"; }
 
 	std::string errorString() {
@@ -165,14 +228,24 @@ private:
 
 	void addEntry(cell_map_t& map, float a, float b, unsigned int v);
 
-	void updateErrorCounts();
+	void removeEntry(cell_map_t& map, float a, float b, unsigned int v);
+
+	// add or subtract the errors of the given ground truth and reconstruction 
+	// label to or from the error counts
+	void countErrors(float gtLabel, float recLabel, bool add);
+
+	void updateSplitsAndMerges();
+
+	void addErrorPairs(
+			const cell_map_t&       splits,
+			bool                    gtFirst,
+			ErrorType               type,
+			ErrorType               backgroundType,
+			float                   backgroundLabel,
+			float                   partnerBackgroundLabel,
+			std::vector<ErrorPair>& pairs);
 
-	void findSplits(
-			const cell_map_t& cellMap,
-			cell_map_t&       splits,
-			unsigned int&     numSplits,
-			unsigned int&     numFalsePositives,
-			float             backgroundLabel);
+	void findSplits(const cell_map_t& cellMap, cell_map_t& splits);
 
 	// a list of cells partitioning the image
 	cells_t _cells;
@@ -181,10 +254,12 @@ private:
 	cell_map_t _cellsByRecToGtLabel;
 	cell_map_t _cellsByGtToRecLabel;
 
-	// subset of the confusion matrix without one-to-one mappings
+	// subset of the confusion matrix without one-to-one mappings, found on 
+	// demand
 	cell_map_t _splits;
 	cell_map_t _merges;
 
+	// the error counts, kept up-to-date with each added or removed mapping
 	unsigned int _numSplits;
 	unsigned int _numMerges;
 	unsigned int _numFalsePositives;
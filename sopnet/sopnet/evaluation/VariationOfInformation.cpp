@@ -21,52 +21,21 @@ VariationOfInformation::VariationOfInformation() :
 void
 VariationOfInformation::updateOutputs() {
 
-	if (_stack1->size() != _stack2->size())
-		BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("image stacks have different size") << STACK_TRACE);
-
 	// count label occurences
 
-	_p1.clear();
-	_p2.clear();
-	_p12.clear();
-
-	ImageStack::const_iterator i1  = _stack1->begin();
-	ImageStack::const_iterator i2  = _stack2->begin();
-
-	unsigned int n = 0;
-
-	for (; i1 != _stack1->end(); i1++, i2++) {
-
-		if ((*i1)->size() != (*i2)->size())
-			BOOST_THROW_EXCEPTION(SizeMismatchError() << error_message("images have different size") << STACK_TRACE);
-
-		n += (*i1)->size();
-
-		Image::iterator j1 = (*i1)->begin();
-		Image::iterator j2 = (*i2)->begin();
-
-		for (; j1 != (*i1)->end(); j1++, j2++) {
-
-			if (_ignoreBackground && (*j1 == 0 || *j2 == 0)) {
+	ContingencyTable table;
+	table.count(*_stack1, *_stack2, _ignoreBackground);
 
-				n--;
-				continue;
-			}
+	// set output
+	_errors = new VariationOfInformationErrors();
 
-			_p1[*j1]++;
-			_p2[*j2]++;
-			_p12[std::make_pair(*j1, *j2)]++;
-		}
-	}
+	computeErrors(table, *_errors);
+}
 
-	// normalize
+void
+VariationOfInformation::computeErrors(const ContingencyTable& table, VariationOfInformationErrors& errors) {
 
-	for (typename LabelProb::iterator i = _p1.begin(); i != _p1.end(); i++)
-		i->second /= n;
-	for (typename LabelProb::iterator i = _p2.begin(); i != _p2.end(); i++)
-		i->second /= n;
-	for (typename JointLabelProb::iterator i = _p12.begin(); i != _p12.end(); i++)
-		i->second /= n;
+	double n = table.getNumLocations();
 
 	// compute information
 
@@ -74,42 +43,34 @@ VariationOfInformation::updateOutputs() {
 	double H1 = 0.0;
 	// H(stack 2)
 	double H2 = 0.0;
-	double I  = 0.0;
-
-	for(typename LabelProb::const_iterator i = _p1.begin(); i != _p1.end(); i++)
-		H1 -= i->second * std::log(i->second);
+	// H(stack 1, stack 2)
+	double H12 = 0.0;
 
-	for(typename LabelProb::const_iterator i = _p2.begin(); i != _p2.end(); i++)
-		H2 -= i->second * std::log(i->second);
+	ContingencyTable::LabelPair labelPair;
+	ContingencyTable::Label     label;
+	size_t                      count;
 
-	for(typename JointLabelProb::const_iterator i = _p12.begin(); i != _p12.end(); i++) {
+	foreach (boost::tie(label, count), table.getCounts1())
+		H1 -= (count/n)*std::log(count/n);
 
-		const float j = i->first.first;
-		const float k = i->first.second;
+	foreach (boost::tie(label, count), table.getCounts2())
+		H2 -= (count/n)*std::log(count/n);
 
-		const double pjk = i->second;
-		const double pj  = _p1[j];
-		const double pk  = _p2[k];
+	foreach (boost::tie(labelPair, count), table.getPairCounts())
+		H12 -= (count/n)*std::log(count/n);
 
-		I += pjk * std::log( pjk / (pj*pk) );
-	}
-
-	// H(stack 1, stack2)
-	double H12 = H1 + H2 - I;
-
-	// set output
-	_errors = new VariationOfInformationErrors();
+	double I = H1 + H2 - H12;
 
 	// We compare stack1 to stack2. Thus, the split entropy represents the 
 	// number of splits from stack1 to stack2, and the merge entropy the number 
 	// of merges from stack1 to stack2.
 	//
 	// H(stack 2|stack 1) = H(stack 1, stack 2) - H(stack 1)
-	_errors->setSplitEntropy(H12 - H1);
+	errors.setSplitEntropy(H12 - H1);
 	// H(stack 1|stack 2) = H(stack 1, stack 2) - H(stack 2)
-	_errors->setMergeEntropy(H12 - H2);
+	errors.setMergeEntropy(H12 - H2);
 
 	LOG_DEBUG(variationofinformationlog)
-			<< "sum of conditional entropies is " << _errors->getEntropy()
+			<< "sum of conditional entropies is " << errors.getEntropy()
 			<< ", which should be equal to " << (H1 + H2 - 2.0*I) << std::endl;
 }
@@ -3,17 +3,21 @@
 
 #include <pipeline/all.h>
 #include <imageprocessing/ImageStack.h>
+#include "ContingencyTable.h"
 #include "VariationOfInformationErrors.h"
 
 class VariationOfInformation : public pipeline::SimpleProcessNode<> {
 
-	typedef std::map<float, double>                   LabelProb;
-	typedef std::map<std::pair<float, float>, double> JointLabelProb;
-
 public:
 
 	VariationOfInformation();
 
+	/**
+	 * Compute the variation of information from the label co-occurrences of 
+	 * two stacks.
+	 */
+	static void computeErrors(const ContingencyTable& table, VariationOfInformationErrors& errors);
+
 private:
 
 	void updateOutputs();
@@ -24,11 +28,6 @@ private:
 
 	pipeline::Output<VariationOfInformationErrors> _errors;
 
-	// label probabilities
-	LabelProb      _p1;
-	LabelProb      _p2;
-	JointLabelProb _p12;
-
 	// do not count statistics for pixels that belong to the background
 	bool _ignoreBackground;
 };
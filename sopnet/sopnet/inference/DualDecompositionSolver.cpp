@@ -0,0 +1,373 @@
+#include <cmath>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <pipeline/Value.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include <sopnet/parallel.h>
+#include "DualDecompositionSolver.h"
+
+util::ProgramOption optionDualDecompositionMaxIterations(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "dualDecompositionMaxIterations",
+		util::_description_text = "The maximal number of subgradient iterations of the dual decomposition.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionDualDecompositionGap(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "dualDecompositionGap",
+		util::_description_text = "Stop the dual decomposition if the relative gap between the best feasible solution and the dual bound falls below this value.",
+		util::_default_value    = 0.0001);
+
+util::ProgramOption optionDualDecompositionStepSize(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "dualDecompositionStepSize",
+		util::_description_text = "The scale of the subgradient steps of the dual decomposition.",
+		util::_default_value    = 1.0);
+
+extern util::ProgramOption optionSubproblemsThreads;
+
+static logger::LogChannel dualdecompositionlog("dualdecompositionlog", "[DualDecompositionSolver] ");
+
+DualDecompositionSolver::DualDecompositionSolver() :
+	_solution(new Solution()) {
+
+	registerInput(_subproblems, "subproblems");
+	registerOutput(_solution, "solution");
+}
+
+void
+DualDecompositionSolver::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer("\tDualDecompositionSolver::updateOutputs()\t%ws\n");
+
+	initialize();
+
+	unsigned int maxIterations = optionDualDecompositionMaxIterations;
+	double       maxGap        = optionDualDecompositionGap;
+
+	Solution merged;
+	Solution best;
+
+	bool   havePrimalBound = false;
+	double primalBound     = 0;
+	double dualBound       = -_sign*std::numeric_limits<double>::infinity();
+
+	for (unsigned int i = 0; i < maxIterations; i++) {
+
+		solveSubproblems();
+
+		double dualValue = getDualValue();
+
+		// the dual value is a bound for every choice of multipliers, keep the
+		// tightest one
+		if (_sign*dualValue > _sign*dualBound)
+			dualBound = dualValue;
+
+		if (mergeSolutions(merged)) {
+
+			double primalValue = getPrimalValue(merged);
+
+			if (!havePrimalBound || _sign*primalValue < _sign*primalBound) {
+
+				primalBound     = primalValue;
+				havePrimalBound = true;
+				best            = merged;
+			}
+		}
+
+		unsigned int numDisagreements = updateMultipliers(primalBound, dualBound, havePrimalBound, i);
+
+		double lowerBound = (_sign > 0 ? dualBound : primalBound);
+		double upperBound = (_sign > 0 ? primalBound : dualBound);
+
+		LOG_USER(dualdecompositionlog)
+				<< "iteration " << i
+				<< ": lower bound " << lowerBound
+				<< ", upper bound " << (havePrimalBound ? boost::lexical_cast<std::string>(upperBound) : std::string("none"))
+				<< ", " << numDisagreements << " disagreeing variables" << std::endl;
+
+		if (numDisagreements == 0) {
+
+			LOG_USER(dualdecompositionlog) << "subproblems reached consensus" << std::endl;
+			break;
+		}
+
+		if (havePrimalBound) {
+
+			double gap = _sign*(primalBound - dualBound)/std::max(1.0, std::abs(primalBound));
+
+			if (gap <= maxGap) {
+
+				LOG_USER(dualdecompositionlog) << "gap " << gap << " below threshold" << std::endl;
+				break;
+			}
+		}
+	}
+
+	if (havePrimalBound) {
+
+		*_solution = best;
+
+	} else {
+
+		LOG_ERROR(dualdecompositionlog)
+				<< "no feasible solution found, the result is inconsistent "
+				<< "between subproblems" << std::endl;
+
+		*_solution = merged;
+	}
+
+	_problems.clear();
+	_solvers.clear();
+}
+
+void
+DualDecompositionSolver::initialize() {
+
+	boost::shared_ptr<Problem> problem = _subproblems->getProblem();
+
+	const LinearObjective& objective = *problem->getObjective();
+
+	_sign = (objective.getSense() == Minimize ? 1.0 : -1.0);
+
+	unsigned int numSubproblems = _subproblems->getNumSubproblems();
+
+	LOG_DEBUG(dualdecompositionlog) << "extracting " << numSubproblems << " subproblems" << std::endl;
+
+	_problems.resize(numSubproblems);
+	_solvers.resize(numSubproblems);
+	_costs.resize(numSubproblems);
+	_multipliers.resize(numSubproblems);
+	_subproblemSolutions.clear();
+	_subproblemSolutions.resize(numSubproblems);
+	_sharedVariables.clear();
+	_sharedVariables.resize(objective.size());
+
+	_numThreads = getNumWorkerThreads(optionSubproblemsThreads, numSubproblems);
+
+	// share the CPUs between the solvers of the workers
+	boost::shared_ptr<LinearSolverParameters> parameters = boost::make_shared<LinearSolverParameters>(Binary);
+	parameters->setNumThreads(getThreadsPerWorker(_numThreads));
+
+	for (unsigned int s = 0; s < numSubproblems; s++) {
+
+		_problems[s] = _subproblems->extractProblem(s);
+
+		const std::vector<unsigned int>& variables = _subproblems->getSubproblemVariables(s);
+
+		_costs[s].resize(variables.size());
+		_multipliers[s].assign(variables.size(), 0);
+
+		// split the costs of each variable evenly between its copies
+		for (unsigned int j = 0; j < variables.size(); j++) {
+
+			unsigned int numCopies = _subproblems->getVariableSubproblems(variables[j]).size();
+
+			_costs[s][j] = objective.getCoefficients()[variables[j]]/numCopies;
+			_problems[s]->getObjective()->setCoefficient(j, _costs[s][j]);
+
+			if (numCopies > 1)
+				_sharedVariables[variables[j]].push_back(std::make_pair(s, j));
+		}
+
+		_solvers[s] = boost::make_shared<LinearSolver>();
+		_solvers[s]->setInput("objective", _problems[s]->getObjective());
+		_solvers[s]->setInput("linear constraints", _problems[s]->getLinearConstraints());
+		_solvers[s]->setInput("parameters", parameters);
+	}
+}
+
+void
+DualDecompositionSolver::solveSubproblems() {
+
+	parallelFor(
+			_numThreads,
+			_solvers.size(),
+			boost::bind(&DualDecompositionSolver::solveSubproblem, this, _1));
+}
+
+void
+DualDecompositionSolver::solveSubproblem(unsigned int s) {
+
+	try {
+
+		for (unsigned int j = 0; j < _costs[s].size(); j++)
+			_solvers[s]->setObjectiveCoefficient(j, _costs[s][j] + _multipliers[s][j]);
+
+		pipeline::Value<Solution> solution = _solvers[s]->getOutput("solution");
+
+		_subproblemSolutions[s] = solution->getVector();
+
+	} catch (boost::exception& e) {
+
+		LOG_ERROR(dualdecompositionlog) << "failed to solve subproblem " << s << std::endl;
+
+		if (boost::get_error_info<error_message>(e))
+			LOG_ERROR(dualdecompositionlog) << *boost::get_error_info<error_message>(e) << std::endl;
+
+		_subproblemSolutions[s].clear();
+	}
+}
+
+double
+DualDecompositionSolver::getDualValue() {
+
+	double value = _subproblems->getProblem()->getObjective()->getConstant();
+
+	for (unsigned int s = 0; s < _subproblemSolutions.size(); s++) {
+
+		const std::vector<double>& solution = _subproblemSolutions[s];
+
+		// without a solution for each subproblem, we don't have a bound
+		if (solution.size() < _costs[s].size())
+			return -_sign*std::numeric_limits<double>::infinity();
+
+		for (unsigned int j = 0; j < _costs[s].size(); j++)
+			value += (_costs[s][j] + _multipliers[s][j])*solution[j];
+	}
+
+	return value;
+}
+
+bool
+DualDecompositionSolver::mergeSolutions(Solution& solution) {
+
+	boost::shared_ptr<Problem> problem = _subproblems->getProblem();
+
+	solution.getVector().assign(problem->getObjective()->size(), 0);
+
+	for (unsigned int s = 0; s < _subproblemSolutions.size(); s++) {
+
+		const std::vector<unsigned int>& variables         = _subproblems->getSubproblemVariables(s);
+		const std::vector<double>&       subproblemSolution = _subproblemSolutions[s];
+
+		if (subproblemSolution.size() < variables.size())
+			return false;
+
+		for (unsigned int j = 0; j < variables.size(); j++)
+			if (_subproblems->getVariableOwner(variables[j]) == s)
+				solution[variables[j]] = subproblemSolution[j];
+	}
+
+	// check feasibility in the working problem
+	const LinearConstraints& constraints = *problem->getLinearConstraints();
+
+	foreach (const LinearConstraint& constraint, constraints) {
+
+		double value = 0;
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients())
+			value += coef*solution[varNum];
+
+		const double eps = 1e-6;
+
+		if (constraint.getRelation() == LessEqual && value > constraint.getValue() + eps)
+			return false;
+		if (constraint.getRelation() == GreaterEqual && value < constraint.getValue() - eps)
+			return false;
+		if (constraint.getRelation() == Equal && std::abs(value - constraint.getValue()) > eps)
+			return false;
+	}
+
+	return true;
+}
+
+double
+DualDecompositionSolver::getPrimalValue(const Solution& solution) {
+
+	const LinearObjective& objective = *_subproblems->getProblem()->getObjective();
+
+	double value = objective.getConstant();
+
+	for (unsigned int i = 0; i < objective.size(); i++)
+		value += objective.getCoefficients()[i]*solution[i];
+
+	return value;
+}
+
+unsigned int
+DualDecompositionSolver::updateMultipliers(double primalBound, double dualBound, bool havePrimalBound, unsigned int iteration) {
+
+	// the subgradient of the dual for each copy of a variable is its
+	// deviation from the mean over all copies
+	std::vector<std::vector<double> > subgradient(_multipliers.size());
+	for (unsigned int s = 0; s < _multipliers.size(); s++)
+		subgradient[s].assign(_multipliers[s].size(), 0);
+
+	double       norm             = 0;
+	unsigned int numDisagreements = 0;
+
+	for (unsigned int i = 0; i < _sharedVariables.size(); i++) {
+
+		const std::vector<std::pair<unsigned int, unsigned int> >& copies = _sharedVariables[i];
+
+		if (copies.empty())
+			continue;
+
+		// The subgradients of the copies sum to zero only if all of them have 
+		// a value. Leave the multipliers of variables shared with a failed 
+		// subproblem as they are, and count them as disagreeing, such that 
+		// we don't stop on a consensus we can't know about.
+		bool solved = true;
+		for (unsigned int c = 0; c < copies.size(); c++)
+			if (_subproblemSolutions[copies[c].first].size() <= copies[c].second)
+				solved = false;
+
+		if (!solved) {
+
+			numDisagreements++;
+			continue;
+		}
+
+		double mean = 0;
+		for (unsigned int c = 0; c < copies.size(); c++)
+			mean += _subproblemSolutions[copies[c].first][copies[c].second];
+
+		mean /= copies.size();
+
+		bool disagree = false;
+		for (unsigned int c = 0; c < copies.size(); c++) {
+
+			double g = _subproblemSolutions[copies[c].first][copies[c].second] - mean;
+
+			subgradient[copies[c].first][copies[c].second] = g;
+			norm += g*g;
+
+			if (std::abs(g) > 1e-6)
+				disagree = true;
+		}
+
+		if (disagree)
+			numDisagreements++;
+	}
+
+	// nothing to update if only failed subproblems disagree
+	if (numDisagreements == 0 || norm == 0)
+		return numDisagreements;
+
+	// Polyak step size, if we have a primal bound, otherwise diminishing
+	double stepSize = optionDualDecompositionStepSize;
+	double gap      = _sign*(primalBound - dualBound);
+
+	if (havePrimalBound && gap > 0)
+		stepSize *= gap/norm;
+	else
+		stepSize /= (iteration + 1);
+
+	LOG_DEBUG(dualdecompositionlog) << "subgradient step size is " << stepSize << std::endl;
+
+	// ascend the dual for minimization, descend for maximization
+	for (unsigned int s = 0; s < _multipliers.size(); s++)
+		for (unsigned int j = 0; j < _multipliers[s].size(); j++)
+			_multipliers[s][j] += _sign*stepSize*subgradient[s][j];
+
+	return numDisagreements;
+}
@@ -0,0 +1,83 @@
+#ifndef SOPNET_INFERENCE_DUAL_DECOMPOSITION_SOLVER_H__
+#define SOPNET_INFERENCE_DUAL_DECOMPOSITION_SOLVER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <inference/LinearSolver.h>
+#include <inference/Solution.h>
+#include "Subproblems.h"
+
+/**
+ * Finds a consistent solution for a working problem that was decomposed into
+ * overlapping subproblems using Lagrangian dual decomposition.
+ *
+ * The objective coefficient of each variable is split evenly between the
+ * subproblems that contain it. Agreement between the copies of a shared
+ * variable is enforced by Lagrange multipliers, which are updated with
+ * subgradient steps until all copies agree or the gap between the dual bound
+ * and the best feasible solution found so far falls below a threshold.
+ *
+ * For minimization problems, the dual value is a lower bound and the value of
+ * the best feasible solution an upper bound on the optimum (vice versa for
+ * maximization). Both are reported for each iteration.
+ */
+class DualDecompositionSolver : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	DualDecompositionSolver();
+
+private:
+
+	void updateOutputs();
+
+	// extract the subproblems and create a solver for each of them
+	void initialize();
+
+	// solve all subproblems with the current multipliers
+	void solveSubproblems();
+
+	// solve subproblem s, called concurrently by the workers
+	void solveSubproblem(unsigned int s);
+
+	// the sum of the subproblem objective values under the current multipliers
+	double getDualValue();
+
+	// combine the subproblem solutions by owner and return true, if the result
+	// is a feasible solution of the working problem
+	bool mergeSolutions(Solution& solution);
+
+	// the value of a solution under the working objective
+	double getPrimalValue(const Solution& solution);
+
+	// update the multipliers with a subgradient step of the given length,
+	// return the number of shared variables that disagree
+	unsigned int updateMultipliers(double primalBound, double dualBound, bool havePrimalBound, unsigned int iteration);
+
+	pipeline::Input<Subproblems> _subproblems;
+	pipeline::Output<Solution>   _solution;
+
+	// 1 for minimization, -1 for maximization
+	double _sign;
+
+	std::vector<boost::shared_ptr<Problem> >      _problems;
+	std::vector<boost::shared_ptr<LinearSolver> > _solvers;
+
+	// the split objective coefficients of each subproblem
+	std::vector<std::vector<double> > _costs;
+
+	// the Lagrange multipliers of each subproblem variable
+	std::vector<std::vector<double> > _multipliers;
+
+	// the most recent solution of each subproblem
+	std::vector<std::vector<double> > _subproblemSolutions;
+
+	// for each working variable that is contained in more than one
+	// subproblem, the subproblems and local variable numbers of its copies
+	std::vector<std::vector<std::pair<unsigned int, unsigned int> > > _sharedVariables;
+
+	// the number of subproblems to solve concurrently
+	unsigned int _numThreads;
+};
+
+#endif // SOPNET_INFERENCE_DUAL_DECOMPOSITION_SOLVER_H__
+
@@ -0,0 +1,97 @@
+#include <util/foreach.h>
+#include <sopnet/segments/EndSegment.h>
+#include <sopnet/segments/ContinuationSegment.h>
+#include <sopnet/segments/BranchSegment.h>
+#include "EnclosingNeuronSegments.h"
+
+EnclosingNeuronSegments::EnclosingNeuronSegments(double maxDistance, double threshold) :
+	_overlap(false, false),
+	_maxDistance(maxDistance),
+	_threshold(threshold) {}
+
+std::vector<unsigned int>
+EnclosingNeuronSegments::find(boost::shared_ptr<Segment> otherSegment, Segments& neuronSegments) {
+
+	std::vector<unsigned int> enclosing;
+
+	boost::shared_ptr<EndSegment>          end;
+	boost::shared_ptr<ContinuationSegment> continuation;
+	boost::shared_ptr<BranchSegment>       branch;
+	double distance;
+
+	foreach (boost::tie(end, distance), neuronSegments.findEnds(
+			otherSegment->getCenter(),
+			otherSegment->getInterSectionInterval(),
+			_maxDistance))
+		if (encloses(end, otherSegment))
+			enclosing.push_back(end->getId());
+
+	foreach (boost::tie(continuation, distance), neuronSegments.findContinuations(
+			otherSegment->getCenter(),
+			otherSegment->getInterSectionInterval(),
+			_maxDistance))
+		if (encloses(continuation, otherSegment))
+			enclosing.push_back(continuation->getId());
+
+	foreach (boost::tie(branch, distance), neuronSegments.findBranches(
+			otherSegment->getCenter(),
+			otherSegment->getInterSectionInterval(),
+			_maxDistance))
+		if (encloses(branch, otherSegment))
+			enclosing.push_back(branch->getId());
+
+	return enclosing;
+}
+
+bool
+EnclosingNeuronSegments::encloses(boost::shared_ptr<Segment> neuronSegment, boost::shared_ptr<Segment> otherSegment) {
+
+	/* We say that a neuron segment encloses a other segment, if the
+	 * slices' overlap is more than (threshold % of) the sum of sizes of the
+	 * other slices.
+	 */
+
+	// get the sum of sizes of the other slices
+	unsigned int otherSize = 0;
+	foreach (boost::shared_ptr<Slice> slice, otherSegment->getSourceSlices())
+		otherSize += slice->getComponent()->getSize();
+	foreach (boost::shared_ptr<Slice> slice, otherSegment->getTargetSlices())
+		otherSize += slice->getComponent()->getSize();
+
+	// get the neuron source and target slices
+	std::vector<boost::shared_ptr<Slice> > neuronSourceSlices = neuronSegment->getSourceSlices();
+	std::vector<boost::shared_ptr<Slice> > neuronTargetSlices = neuronSegment->getTargetSlices();
+
+	if (neuronSegment->getDirection() != otherSegment->getDirection())
+		std::swap(neuronSourceSlices, neuronTargetSlices);
+
+	// get the overlap
+	unsigned int sourceOverlap = getOverlap(neuronSourceSlices, otherSegment->getSourceSlices());
+	unsigned int targetOverlap = getOverlap(neuronTargetSlices, otherSegment->getTargetSlices());
+
+	return (double)(sourceOverlap + targetOverlap)/otherSize >= _threshold;
+}
+
+unsigned int
+EnclosingNeuronSegments::getOverlap(
+		const std::vector<boost::shared_ptr<Slice> >& slices1,
+		const std::vector<boost::shared_ptr<Slice> >& slices2) {
+
+	if (slices1.size() == 0 || slices2.size() == 0)
+		return 0;
+
+	if (slices1.size() == 1 && slices2.size() == 1)
+		return _overlap(*slices1[0], *slices2[0]);
+
+	if (slices1.size() == 2 && slices2.size() == 1)
+		return _overlap(*slices1[0], *slices1[1], *slices2[0]);
+
+	if (slices2.size() == 2 && slices1.size() == 1)
+		return _overlap(*slices2[0], *slices2[1], *slices1[0]);
+
+	// both have two slices
+	return std::max(
+			_overlap(*slices1[0], *slices2[0]) + _overlap(*slices1[1], *slices2[1]),
+			_overlap(*slices1[0], *slices2[1]) + _overlap(*slices1[1], *slices2[0]));
+}
+
@@ -0,0 +1,52 @@
+#ifndef SOPNET_INFERENCE_ENCLOSING_NEURON_SEGMENTS_H__
+#define SOPNET_INFERENCE_ENCLOSING_NEURON_SEGMENTS_H__
+
+#include <vector>
+
+#include <sopnet/features/Overlap.h>
+#include <sopnet/segments/Segments.h>
+
+/**
+ * Finds the neuron segments that enclose a mitochondria or synapse segment.
+ */
+class EnclosingNeuronSegments {
+
+public:
+
+	/**
+	 * @param maxDistance
+	 *              The maximal center distance between the other segment and
+	 *              an enclosing neuron segment.
+	 *
+	 * @param threshold
+	 *              The minimal ratio (<=1) of overlap with the neuron segment
+	 *              to size of the other segment.
+	 */
+	EnclosingNeuronSegments(double maxDistance, double threshold);
+
+	/**
+	 * Get the ids of all neuron segments in the inter-section interval of the
+	 * given segment that enclose it.
+	 */
+	std::vector<unsigned int> find(boost::shared_ptr<Segment> otherSegment, Segments& neuronSegments);
+
+private:
+
+	bool encloses(
+			boost::shared_ptr<Segment> neuronSegment,
+			boost::shared_ptr<Segment> otherSegment);
+
+	unsigned int getOverlap(
+			const std::vector<boost::shared_ptr<Slice> >& slices1,
+			const std::vector<boost::shared_ptr<Slice> >& slices2);
+
+	// functor to compute the overlap between slices
+	Overlap _overlap;
+
+	double _maxDistance;
+
+	double _threshold;
+};
+
+#endif // SOPNET_INFERENCE_ENCLOSING_NEURON_SEGMENTS_H__
+
@@ -22,6 +22,7 @@ LinearCostFunction::updateOutputs() {
 
 	// invalidate cache
 	_cache.clear();
+	_cacheIds.clear();
 
 	if (_features->numFeatures() != _parameters->getWeights().size()) {
 
@@ -45,7 +46,7 @@ LinearCostFunction::costs(
 
 	segmentCosts.resize(ends.size() + continuations.size() + branches.size(), 0);
 
-	if (segmentCosts.size() == _cache.size()) {
+	if (isCached(ends, continuations, branches)) {
 
 		for (unsigned int i = 0; i < segmentCosts.size(); i++)
 			segmentCosts[i] += _cache[i];
@@ -54,6 +55,8 @@ LinearCostFunction::costs(
 	}
 
 	_cache.resize(ends.size() + continuations.size() + branches.size());
+	_cacheIds.clear();
+	_cacheIds.reserve(_cache.size());
 
 	const std::vector<double> weights = _parameters->getWeights();
 
@@ -65,6 +68,7 @@ LinearCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(end->getId());
 
 		i++;
 	}
@@ -75,6 +79,7 @@ LinearCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(continuation->getId());
 
 		i++;
 	}
@@ -85,11 +90,40 @@ LinearCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(branch->getId());
 
 		i++;
 	}
 }
 
+bool
+LinearCostFunction::isCached(
+		const std::vector<boost::shared_ptr<EndSegment> >&          ends,
+		const std::vector<boost::shared_ptr<ContinuationSegment> >& continuations,
+		const std::vector<boost::shared_ptr<BranchSegment> >&       branches) {
+
+	// the cost function might be called for different sets of segments of the 
+	// same size (e.g., for each inter-section interval)
+	if (_cacheIds.size() != ends.size() + continuations.size() + branches.size())
+		return false;
+
+	unsigned int i = 0;
+
+	foreach (boost::shared_ptr<EndSegment> end, ends)
+		if (_cacheIds[i++] != end->getId())
+			return false;
+
+	foreach (boost::shared_ptr<ContinuationSegment> continuation, continuations)
+		if (_cacheIds[i++] != continuation->getId())
+			return false;
+
+	foreach (boost::shared_ptr<BranchSegment> branch, branches)
+		if (_cacheIds[i++] != branch->getId())
+			return false;
+
+	return true;
+}
+
 double
 LinearCostFunction::costs(const Segment& segment, const std::vector<double>& weights) {
 
@@ -44,7 +44,16 @@ private:
 
 	pipeline::Output<costs_function_type> _costFunction;
 
+	// checks whether the cache holds the costs of exactly these segments
+	bool isCached(
+			const std::vector<boost::shared_ptr<EndSegment> >&          ends,
+			const std::vector<boost::shared_ptr<ContinuationSegment> >& continuations,
+			const std::vector<boost::shared_ptr<BranchSegment> >&       branches);
+
 	std::vector<double> _cache;
+
+	// the ids of the segments in the cache
+	std::vector<unsigned int> _cacheIds;
 };
 
 #endif // CELLTRACKER_TRACKLET_EVALUATOR_H__
@@ -1,8 +1,10 @@
+#include <util/Logger.h>
 #include <util/foreach.h>
 #include <util/ProgramOptions.h>
 #include <sopnet/segments/EndSegment.h>
 #include <sopnet/segments/ContinuationSegment.h>
 #include <sopnet/segments/BranchSegment.h>
+#include "EnclosingNeuronSegments.h"
 #include "ProblemAssembler.h"
 
 util::ProgramOption optionMaxMitochondriaNeuronDistance(
@@ -37,8 +39,7 @@ ProblemAssembler::ProblemAssembler() :
 	_allMitochondriaSegments(new Segments()),
 	_allSynapseSegments(new Segments()),
 	_allLinearConstraints(new LinearConstraints()),
-	_problemConfiguration(new ProblemConfiguration()),
-	_overlap(false, false) {
+	_problemConfiguration(new ProblemConfiguration()) {
 
 	registerInputs(_neuronSegments, "neuron segments");
 	registerInputs(_neuronLinearConstraints, "neuron linear constraints");
@@ -155,10 +156,10 @@ ProblemAssembler::addExplanationConstraints() {
 	_consistencyConstraints = LinearConstraints(_numSlices);
 
 	// set the relation and value
-	foreach (LinearConstraint& constraint, _consistencyConstraints) {
+	for (unsigned int i = 0; i < _consistencyConstraints.size(); i++) {
 
-		constraint.setValue(0);
-		constraint.setRelation(Equal);
+		_consistencyConstraints.edit(i).setValue(0);
+		_consistencyConstraints.edit(i).setRelation(Equal);
 	}
 
 	// set the coefficients
@@ -177,6 +178,10 @@ ProblemAssembler::addExplanationConstraints() {
 		LOG_ALL(problemassemblerlog) << constraint << std::endl;
 
 	_allLinearConstraints->addAll(_consistencyConstraints);
+
+	// every segment got a variable, even if it does not appear in a 
+	// constraint
+	_allLinearConstraints->registerVariables(_numSegments);
 }
 
 void
@@ -212,23 +217,25 @@ ProblemAssembler::addMitochondriaConstraints() {
 	_mitochondriaConstraints = LinearConstraints(_numMitochondriaSegments);
 
 	// set the relation and value
-	foreach (LinearConstraint& constraint, _mitochondriaConstraints) {
+	for (unsigned int i = 0; i < _mitochondriaConstraints.size(); i++) {
 
-		constraint.setValue(0);
-		constraint.setRelation(LessEqual);
+		_mitochondriaConstraints.edit(i).setValue(0);
+		_mitochondriaConstraints.edit(i).setRelation(LessEqual);
 	}
 
-	LinearConstraints::iterator constraint = _mitochondriaConstraints.begin();
+	unsigned int i = 0;
 	foreach (boost::shared_ptr<Segment> mitochondriaSegment, _allMitochondriaSegments->getSegments()) {
 
+		LinearConstraint& constraint = _mitochondriaConstraints.edit(i);
+
 		unsigned int mitochondriaSegmentId = mitochondriaSegment->getId();
 
-		constraint->setCoefficient(_problemConfiguration->getVariable(mitochondriaSegmentId), 1);
+		constraint.setCoefficient(_problemConfiguration->getVariable(mitochondriaSegmentId), 1);
 
 		foreach (unsigned int neuronSegmentId, getMitochondriaEnclosingNeuronSegments(mitochondriaSegmentId))
-			constraint->setCoefficient(_problemConfiguration->getVariable(neuronSegmentId), -1);
+			constraint.setCoefficient(_problemConfiguration->getVariable(neuronSegmentId), -1);
 
-		constraint++;
+		i++;
 	}
 
 	LOG_DEBUG(problemassemblerlog) << "created " << _mitochondriaConstraints.size() << " linear constraints" << std::endl;
@@ -255,7 +262,7 @@ ProblemAssembler::addSynapseConstraints() {
 	// allocate a set of linear constraints
 	_synapseConstraints = LinearConstraints(_numSynapseSegments);
 
-	LinearConstraints::iterator constraint = _synapseConstraints.begin();
+	unsigned int i = 0;
 	foreach (boost::shared_ptr<Segment> synapseSegment, _allSynapseSegments->getSegments()) {
 
 		LOG_ALL(problemassemblerlog) << "processing synapse segment " << synapseSegment->getId() << std::endl;
@@ -268,24 +275,26 @@ ProblemAssembler::addSynapseConstraints() {
 		if (n == 0)
 			continue;
 
-		constraint->setValue(n);
-		constraint->setRelation(LessEqual);
+		LinearConstraint& constraint = _synapseConstraints.edit(i);
+
+		constraint.setValue(n);
+		constraint.setRelation(LessEqual);
 
 		LOG_ALL(problemassemblerlog) << "corresponding variable id is " << _problemConfiguration->getVariable(synapseSegmentId) << std::endl;
 
-		constraint->setCoefficient(_problemConfiguration->getVariable(synapseSegmentId), n);
+		constraint.setCoefficient(_problemConfiguration->getVariable(synapseSegmentId), n);
 
 		LOG_ALL(problemassemblerlog) << "setting enclosing segments coefficients" << std::endl;
 
 		foreach (unsigned int neuronSegmentId, getSynapseEnclosingNeuronSegments(synapseSegmentId)) {
 
 			LOG_ALL(problemassemblerlog) << "setting coefficient for segment " << neuronSegmentId << std::endl;
-			constraint->setCoefficient(_problemConfiguration->getVariable(neuronSegmentId), 1);
+			constraint.setCoefficient(_problemConfiguration->getVariable(neuronSegmentId), 1);
 		}
 
 		LOG_ALL(problemassemblerlog) << "finished constraint for synapse segment " << synapseSegment->getId() << std::endl;
 
-		constraint++;
+		i++;
 	}
 
 	LOG_DEBUG(problemassemblerlog) << "created " << _synapseConstraints.size() << " linear constraints" << std::endl;
@@ -303,8 +312,12 @@ ProblemAssembler::mapConstraints(boost::shared_ptr<LinearConstraints> linearCons
 		unsigned int id;
 		double value;
 
-		foreach(boost::tie(id, value), linearConstraint.getCoefficients())
-			mappedConstraint.setCoefficient(_problemConfiguration->getVariable(id), value);
+		foreach(boost::tie(id, value), linearConstraint.getCoefficients()) {
+
+			unsigned int varNum = _problemConfiguration->getVariable(id);
+
+			mappedConstraint.setCoefficient(varNum, value);
+		}
 
 		mappedConstraint.setRelation(linearConstraint.getRelation());
 
@@ -323,9 +336,9 @@ ProblemAssembler::setCoefficient(const EndSegment& end) {
 	 * the number of the slice in the problem.
 	 */
 	if (end.getDirection() == Left) // slice is on the right
-		_consistencyConstraints[getSliceNum(sliceId)].setCoefficient(_numSegments,  1.0);
+		_consistencyConstraints.edit(getSliceNum(sliceId)).setCoefficient(_numSegments,  1.0);
 	else                            // slice is on the left
-		_consistencyConstraints[getSliceNum(sliceId)].setCoefficient(_numSegments, -1.0);
+		_consistencyConstraints.edit(getSliceNum(sliceId)).setCoefficient(_numSegments, -1.0);
 
 	/* Sneakily we assigned a variable number (_numSegments) to every
 	 * segment we found. Remember this mapping -- we will need it to
@@ -348,13 +361,13 @@ ProblemAssembler::setCoefficient(const ContinuationSegment& continuation) {
 	 */
 	if (continuation.getDirection() == Left) { // target is left
 
-		_consistencyConstraints[getSliceNum(targetSliceId)].setCoefficient(_numSegments, -1.0);
-		_consistencyConstraints[getSliceNum(sourceSliceId)].setCoefficient(_numSegments,  1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSliceId)).setCoefficient(_numSegments, -1.0);
+		_consistencyConstraints.edit(getSliceNum(sourceSliceId)).setCoefficient(_numSegments,  1.0);
 
 	} else  {                                  // target is right
 
-		_consistencyConstraints[getSliceNum(targetSliceId)].setCoefficient(_numSegments,  1.0);
-		_consistencyConstraints[getSliceNum(sourceSliceId)].setCoefficient(_numSegments, -1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSliceId)).setCoefficient(_numSegments,  1.0);
+		_consistencyConstraints.edit(getSliceNum(sourceSliceId)).setCoefficient(_numSegments, -1.0);
 	}
 
 	/* Sneakily we assigned a variable number (_numSegments) to every
@@ -379,15 +392,15 @@ ProblemAssembler::setCoefficient(const BranchSegment& branch) {
 	 */
 	if (branch.getDirection() == Left) { // targets are left
 
-		_consistencyConstraints[getSliceNum(targetSlice1Id)].setCoefficient(_numSegments, -1.0);
-		_consistencyConstraints[getSliceNum(targetSlice2Id)].setCoefficient(_numSegments, -1.0);
-		_consistencyConstraints[getSliceNum(sourceSliceId)].setCoefficient(_numSegments,   1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSlice1Id)).setCoefficient(_numSegments, -1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSlice2Id)).setCoefficient(_numSegments, -1.0);
+		_consistencyConstraints.edit(getSliceNum(sourceSliceId)).setCoefficient(_numSegments,   1.0);
 
 	} else  {                                  // target is right
 
-		_consistencyConstraints[getSliceNum(targetSlice1Id)].setCoefficient(_numSegments,  1.0);
-		_consistencyConstraints[getSliceNum(targetSlice2Id)].setCoefficient(_numSegments,  1.0);
-		_consistencyConstraints[getSliceNum(sourceSliceId)].setCoefficient(_numSegments,  -1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSlice1Id)).setCoefficient(_numSegments,  1.0);
+		_consistencyConstraints.edit(getSliceNum(targetSlice2Id)).setCoefficient(_numSegments,  1.0);
+		_consistencyConstraints.edit(getSliceNum(sourceSliceId)).setCoefficient(_numSegments,  -1.0);
 	}
 
 	/* Sneakily we assigned a variable number (_numSegments) to every
@@ -463,129 +476,29 @@ ProblemAssembler::getSliceNum(unsigned int sliceId) {
 void
 ProblemAssembler::extractMitochondriaEnclosingNeuronSegments() {
 
-	unsigned int maxMitochondriaNeuronDistance = optionMaxMitochondriaNeuronDistance;
-	_enclosingMitochondriaThreshold = optionMitochondriaEnclosingThreshold;
+	EnclosingNeuronSegments enclosingNeuronSegments(
+			optionMaxMitochondriaNeuronDistance.as<unsigned int>(),
+			optionMitochondriaEnclosingThreshold.as<double>());
 
-	foreach (boost::shared_ptr<Segment> mitochondriaSegment, _allMitochondriaSegments->getSegments()) {
+	_mitochondriaEnclosingNeuronSegments.clear();
 
-		unsigned int mitochondriaSegmentId = mitochondriaSegment->getId();
-
-		boost::shared_ptr<EndSegment>          end;
-		boost::shared_ptr<ContinuationSegment> continuation;
-		boost::shared_ptr<BranchSegment>       branch;
-		double distance;
-
-		foreach (boost::tie(end, distance), _allNeuronSegments->findEnds(
-				mitochondriaSegment->getCenter(),
-				mitochondriaSegment->getInterSectionInterval(),
-				maxMitochondriaNeuronDistance))
-			if (encloses(end, mitochondriaSegment, _enclosingMitochondriaThreshold))
-				_mitochondriaEnclosingNeuronSegments[mitochondriaSegmentId].push_back(end->getId());
-
-		foreach (boost::tie(continuation, distance), _allNeuronSegments->findContinuations(
-				mitochondriaSegment->getCenter(),
-				mitochondriaSegment->getInterSectionInterval(),
-				maxMitochondriaNeuronDistance))
-			if (encloses(continuation, mitochondriaSegment, _enclosingMitochondriaThreshold))
-				_mitochondriaEnclosingNeuronSegments[mitochondriaSegmentId].push_back(continuation->getId());
-
-		foreach (boost::tie(branch, distance), _allNeuronSegments->findBranches(
-				mitochondriaSegment->getCenter(),
-				mitochondriaSegment->getInterSectionInterval(),
-				maxMitochondriaNeuronDistance))
-			if (encloses(branch, mitochondriaSegment, _enclosingMitochondriaThreshold))
-				_mitochondriaEnclosingNeuronSegments[mitochondriaSegmentId].push_back(branch->getId());
-	}
+	foreach (boost::shared_ptr<Segment> mitochondriaSegment, _allMitochondriaSegments->getSegments())
+		_mitochondriaEnclosingNeuronSegments[mitochondriaSegment->getId()] =
+				enclosingNeuronSegments.find(mitochondriaSegment, *_allNeuronSegments);
 }
 
 void
 ProblemAssembler::extractSynapseEnclosingNeuronSegments() {
 
-	unsigned int maxSynapseNeuronDistance = optionMaxSynapseNeuronDistance;
-	_enclosingSynapseThreshold = optionSynapseEnclosingThreshold;
-
-	foreach (boost::shared_ptr<Segment> synapseSegment, _allSynapseSegments->getSegments()) {
-
-		unsigned int synapseSegmentId = synapseSegment->getId();
-
-		boost::shared_ptr<EndSegment> end;
-		boost::shared_ptr<ContinuationSegment> continuation;
-		boost::shared_ptr<BranchSegment> branch;
-		double distance;
-
-		foreach (boost::tie(end, distance), _allNeuronSegments->findEnds(
-				synapseSegment->getCenter(),
-				synapseSegment->getInterSectionInterval(),
-				maxSynapseNeuronDistance))
-			if (encloses(end, synapseSegment, _enclosingSynapseThreshold))
-				_synapseEnclosingNeuronSegments[synapseSegmentId].push_back(end->getId());
-
-		foreach (boost::tie(continuation, distance), _allNeuronSegments->findContinuations(
-				synapseSegment->getCenter(),
-				synapseSegment->getInterSectionInterval(),
-				maxSynapseNeuronDistance))
-			if (encloses(continuation, synapseSegment, _enclosingSynapseThreshold))
-				_synapseEnclosingNeuronSegments[synapseSegmentId].push_back(continuation->getId());
-
-		foreach (boost::tie(branch, distance), _allNeuronSegments->findBranches(
-				synapseSegment->getCenter(),
-				synapseSegment->getInterSectionInterval(),
-				maxSynapseNeuronDistance))
-			if (encloses(branch, synapseSegment, _enclosingSynapseThreshold))
-				_synapseEnclosingNeuronSegments[synapseSegmentId].push_back(branch->getId());
-	}
-}
-
-bool
-ProblemAssembler::encloses(boost::shared_ptr<Segment> neuronSegment, boost::shared_ptr<Segment> otherSegment, double enclosingThreshold) {
-
-	/* We say that a neuron segment encloses a other segment, if the 
-	 * slices' overlap is more than (threshold % of) the sum of sizes of the 
-	 * other slices.
-	 */
-
-	// get the sum of sizes of the other slices
-	unsigned int mitoSize = 0;
-	foreach (boost::shared_ptr<Slice> slice, otherSegment->getSourceSlices())
-		mitoSize += slice->getComponent()->getSize();
-	foreach (boost::shared_ptr<Slice> slice, otherSegment->getTargetSlices())
-		mitoSize += slice->getComponent()->getSize();
-
-	// get the neuron source and target slices
-	std::vector<boost::shared_ptr<Slice> > neuronSourceSlices = neuronSegment->getSourceSlices();
-	std::vector<boost::shared_ptr<Slice> > neuronTargetSlices = neuronSegment->getTargetSlices();
-
-	if (neuronSegment->getDirection() != otherSegment->getDirection())
-		std::swap(neuronSourceSlices, neuronTargetSlices);
-
-	// get the overlap
-	unsigned int sourceOverlap = getOverlap(neuronSourceSlices, otherSegment->getSourceSlices());
-	unsigned int targetOverlap = getOverlap(neuronTargetSlices, otherSegment->getTargetSlices());
-
-	return (double)(sourceOverlap + targetOverlap)/mitoSize >= enclosingThreshold;
-}
-
-unsigned int
-ProblemAssembler::getOverlap(
-		const std::vector<boost::shared_ptr<Slice> >& slices1,
-		const std::vector<boost::shared_ptr<Slice> >& slices2) {
-
-	if (slices1.size() == 0 || slices2.size() == 0)
-		return 0;
-
-	if (slices1.size() == 1 && slices2.size() == 1)
-		return _overlap(*slices1[0], *slices2[0]);
-
-	if (slices1.size() == 2 && slices2.size() == 1)
-		return _overlap(*slices1[0], *slices1[1], *slices2[0]);
+	EnclosingNeuronSegments enclosingNeuronSegments(
+			optionMaxSynapseNeuronDistance.as<unsigned int>(),
+			optionSynapseEnclosingThreshold.as<double>());
 
-	if (slices2.size() == 2 && slices1.size() == 1)
-		return _overlap(*slices2[0], *slices2[1], *slices1[0]);
+	_synapseEnclosingNeuronSegments.clear();
 
-	// both have two slices
-	return std::max(
-			_overlap(*slices1[0], *slices2[0]) + _overlap(*slices1[1], *slices2[1]),
-			_overlap(*slices1[0], *slices2[1]) + _overlap(*slices1[1], *slices2[0]));
+	foreach (boost::shared_ptr<Segment> synapseSegment, _allSynapseSegments->getSegments())
+		_synapseEnclosingNeuronSegments[synapseSegment->getId()] =
+				enclosingNeuronSegments.find(synapseSegment, *_allNeuronSegments);
 }
 
 std::vector<unsigned int>&
@@ -3,7 +3,6 @@
 
 #include <pipeline/all.h>
 #include <inference/LinearConstraints.h>
-#include <sopnet/features/Overlap.h>
 #include <sopnet/segments/Segments.h>
 #include "ProblemConfiguration.h"
 
@@ -49,15 +48,6 @@ private:
 
 	void extractSynapseEnclosingNeuronSegments();
 
-	bool encloses(
-			boost::shared_ptr<Segment> neuronSegment,
-			boost::shared_ptr<Segment> otherSegment,
-			double enclosingThreshold);
-
-	unsigned int getOverlap(
-			const std::vector<boost::shared_ptr<Slice> >& slices1,
-			const std::vector<boost::shared_ptr<Slice> >& slices2);
-
 	std::vector<unsigned int>& getMitochondriaEnclosingNeuronSegments(unsigned int otherSegmentId);
 
 	std::vector<unsigned int>& getSynapseEnclosingNeuronSegments(unsigned int otherSegmentId);
@@ -130,17 +120,6 @@ private:
 
 	// the total number of slices
 	unsigned int _numSlices;
-
-	// functor to compute the overlap between slices
-	Overlap _overlap;
-
-	// min ratio of overlap to size to consider a mitochondria or synapse 
-	// segment to be enclosed by a neuron segment
-	double _enclosingMitochondriaThreshold;
-
-	// min ratio of overlap to size to consider a mitochondria or synapse 
-	// segment to be enclosed by a neuron segment
-	double _enclosingSynapseThreshold;
 };
 
 #endif // CELLTRACKER_PROBLEM_ASSEMBLER_H__
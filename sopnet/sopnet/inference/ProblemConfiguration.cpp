@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+
 #include <util/Logger.h>
 #include "ProblemConfiguration.h"
 
@@ -11,9 +14,21 @@ ProblemConfiguration::ProblemConfiguration() {
 void
 ProblemConfiguration::setVariable(const Segment& segment, unsigned int variable) {
 
+	util::rect<int> boundingBox(0, 0, 0, 0);
+	foreach (boost::shared_ptr<Slice> slice, segment.getSlices())
+		if (boundingBox.isZero())
+			boundingBox = slice->getComponent()->getBoundingBox();
+		else
+			boundingBox.fit(slice->getComponent()->getBoundingBox());
+
 	setVariable(segment.getId(), variable);
-	fit(segment);
+	_segmentHashes[variable] = segment.hashValue();
 	_interSectionIntervals[variable] = segment.getInterSectionInterval();
+	_boundingBoxes[variable] = boundingBox;
+
+	_indexDirty = true;
+
+	fit(segment.getInterSectionInterval(), boundingBox);
 }
 
 void
@@ -51,20 +66,136 @@ ProblemConfiguration::getSegmentId(unsigned int variable) {
 	return _segmentIds[variable];
 }
 
+SegmentHash
+ProblemConfiguration::getSegmentHash(unsigned int variable) {
+
+	if (!_segmentHashes.count(variable))
+		BOOST_THROW_EXCEPTION(
+				NoSuchSegment()
+				<< error_message(
+						std::string("segment hash map does not contain an entry for variable ") +
+						boost::lexical_cast<std::string>(variable))
+				<< STACK_TRACE);
+
+	return _segmentHashes[variable];
+}
+
 std::vector<unsigned int>
 ProblemConfiguration::getVariables(unsigned int minInterSectionInterval, unsigned int maxInterSectionInterval) {
 
+	updateIndex();
+
 	std::vector<unsigned int> variables;
-	unsigned int variableId;
+
+	std::map<unsigned int, std::vector<unsigned int> >::const_iterator i   = _intervalVariables.lower_bound(minInterSectionInterval);
+	std::map<unsigned int, std::vector<unsigned int> >::const_iterator end = _intervalVariables.lower_bound(maxInterSectionInterval);
+
+	for (; i != end; i++)
+		variables.insert(variables.end(), i->second.begin(), i->second.end());
+
+	std::sort(variables.begin(), variables.end());
+
+	return variables;
+}
+
+std::vector<unsigned int>
+ProblemConfiguration::getVariables(unsigned int minInterSectionInterval, unsigned int maxInterSectionInterval, const util::rect<int>& region) {
+
+	updateIndex();
+
+	std::vector<unsigned int> variables;
+
+	// the grid cells covered by the region
+	int minCellX = (int)std::floor((double)region.minX/GridCellSize);
+	int minCellY = (int)std::floor((double)region.minY/GridCellSize);
+	int maxCellX = (int)std::floor((double)(region.maxX - 1)/GridCellSize);
+	int maxCellY = (int)std::floor((double)(region.maxY - 1)/GridCellSize);
+
+	std::map<unsigned int, grid_type>::const_iterator i   = _intervalGrids.lower_bound(minInterSectionInterval);
+	std::map<unsigned int, grid_type>::const_iterator end = _intervalGrids.lower_bound(maxInterSectionInterval);
+
+	for (; i != end; i++) {
+
+		const grid_type& grid = i->second;
+
+		// visit only the cells of the region, unless the grid has fewer 
+		// non-empty cells than that
+		if ((std::size_t)(maxCellX - minCellX + 1)*(maxCellY - minCellY + 1) < grid.size()) {
+
+			for (int x = minCellX; x <= maxCellX; x++)
+				for (int y = minCellY; y <= maxCellY; y++) {
+
+					grid_type::const_iterator cell = grid.find(cell_type(x, y));
+
+					if (cell != grid.end())
+						variables.insert(variables.end(), cell->second.begin(), cell->second.end());
+				}
+
+		} else {
+
+			for (grid_type::const_iterator cell = grid.begin(); cell != grid.end(); cell++)
+				if (cell->first.first  >= minCellX && cell->first.first  <= maxCellX &&
+				    cell->first.second >= minCellY && cell->first.second <= maxCellY)
+					variables.insert(variables.end(), cell->second.begin(), cell->second.end());
+		}
+	}
+
+	// variables can be listed in several cells
+	std::sort(variables.begin(), variables.end());
+	variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+
+	// keep only the ones that really intersect the region
+	std::vector<unsigned int> intersecting;
+	intersecting.reserve(variables.size());
+
+	foreach (unsigned int variable, variables) {
+
+		const util::rect<int>& boundingBox = _boundingBoxes[variable];
+
+		if (boundingBox.maxX <= region.minX || boundingBox.minX >= region.maxX ||
+		    boundingBox.maxY <= region.minY || boundingBox.minY >= region.maxY)
+			continue;
+
+		intersecting.push_back(variable);
+	}
+
+	return intersecting;
+}
+
+void
+ProblemConfiguration::updateIndex() {
+
+	if (!_indexDirty)
+		return;
+
+	LOG_DEBUG(problemconfigurationlog) << "building variable index" << std::endl;
+
+	_intervalVariables.clear();
+	_intervalGrids.clear();
+
+	unsigned int variable;
 	unsigned int interSectionInterval;
 
-	foreach (boost::tie(variableId, interSectionInterval), _interSectionIntervals) {
+	foreach (boost::tie(variable, interSectionInterval), _interSectionIntervals) {
+
+		_intervalVariables[interSectionInterval].push_back(variable);
+
+		grid_type& grid = _intervalGrids[interSectionInterval];
 
-		if (interSectionInterval >= minInterSectionInterval && interSectionInterval < maxInterSectionInterval)
-			variables.push_back(variableId);
+		const util::rect<int>& boundingBox = _boundingBoxes[variable];
+
+		// the cells overlapped by the bounding box (max is exclusive)
+		int minCellX = (int)std::floor((double)boundingBox.minX/GridCellSize);
+		int minCellY = (int)std::floor((double)boundingBox.minY/GridCellSize);
+		int maxCellX = (int)std::floor((double)std::max(boundingBox.minX, boundingBox.maxX - 1)/GridCellSize);
+		int maxCellY = (int)std::floor((double)std::max(boundingBox.minY, boundingBox.maxY - 1)/GridCellSize);
+
+		for (int x = minCellX; x <= maxCellX; x++)
+			for (int y = minCellY; y <= maxCellY; y++)
+				grid[cell_type(x, y)].push_back(variable);
 	}
 
-	return variables;
+	_indexDirty = false;
 }
 
 std::set<unsigned int>
@@ -86,6 +217,12 @@ ProblemConfiguration::clear() {
 
 	_variables.clear();
 	_segmentIds.clear();
+	_segmentHashes.clear();
+	_interSectionIntervals.clear();
+	_boundingBoxes.clear();
+	_intervalVariables.clear();
+	_intervalGrids.clear();
+	_indexDirty = false;
 
 	_minInterSectionInterval = -1;
 	_maxInterSectionInterval = -1;
@@ -95,27 +232,27 @@ ProblemConfiguration::clear() {
 }
 
 void
-ProblemConfiguration::fit(const Segment& segment) {
+ProblemConfiguration::fit(unsigned int interSectionInterval, const util::rect<int>& boundingBox) {
 
-	LOG_ALL(problemconfigurationlog) << "fitting segment " << segment.getId() << " with inter-section interval " << segment.getInterSectionInterval() << std::endl;
+	LOG_ALL(problemconfigurationlog) << "fitting variable with inter-section interval " << interSectionInterval << std::endl;
 
 	if (_minInterSectionInterval < 0) {
 
-		_minInterSectionInterval = segment.getInterSectionInterval();
-		_maxInterSectionInterval = segment.getInterSectionInterval();
-		_minX = (int)segment.getCenter().x;
-		_maxX = (int)segment.getCenter().x;
-		_minY = (int)segment.getCenter().y;
-		_maxY = (int)segment.getCenter().y;
+		_minInterSectionInterval = interSectionInterval;
+		_maxInterSectionInterval = interSectionInterval;
+		_minX = boundingBox.minX;
+		_maxX = boundingBox.maxX;
+		_minY = boundingBox.minY;
+		_maxY = boundingBox.maxY;
 
 	} else {
 
-		_minInterSectionInterval = std::min(_minInterSectionInterval, (int)segment.getInterSectionInterval());
-		_maxInterSectionInterval = std::max(_maxInterSectionInterval, (int)segment.getInterSectionInterval());
-		_minX = std::min(_minX, (int)segment.getCenter().x);
-		_maxX = std::max(_maxX, (int)segment.getCenter().x);
-		_minY = std::min(_minY, (int)segment.getCenter().y);
-		_maxY = std::max(_maxY, (int)segment.getCenter().y);
+		_minInterSectionInterval = std::min(_minInterSectionInterval, (int)interSectionInterval);
+		_maxInterSectionInterval = std::max(_maxInterSectionInterval, (int)interSectionInterval);
+		_minX = std::min(_minX, boundingBox.minX);
+		_maxX = std::max(_maxX, boundingBox.maxX);
+		_minY = std::min(_minY, boundingBox.minY);
+		_maxY = std::max(_maxY, boundingBox.maxY);
 	}
 
 	LOG_ALL(problemconfigurationlog) << "extents are now " << _minInterSectionInterval << "-" << _maxInterSectionInterval << std::endl;
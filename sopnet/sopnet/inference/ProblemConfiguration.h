@@ -4,6 +4,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include <pipeline/all.h>
+#include <util/rect.hpp>
 #include <sopnet/exceptions.h>
 #include <sopnet/segments/Segments.h>
 
@@ -14,8 +15,8 @@ public:
 	ProblemConfiguration();
 
 	/**
-	 * Assign a segment to a variable id. Remembers the inter-section interval 
-	 * and the extends of the problem.
+	 * Assign a segment to a variable id. Remembers the inter-section interval, 
+	 * the bounding box of the segment's slices, and the extends of the problem.
 	 */
 	void setVariable(const Segment& segment, unsigned int variable);
 
@@ -34,11 +35,32 @@ public:
 	 */
 	unsigned int getSegmentId(unsigned int variable);
 
+	/**
+	 * Set the hash of the segment that corresponds to a variable.
+	 */
+	void setSegmentHash(unsigned int variable, SegmentHash hash) { _segmentHashes[variable] = hash; }
+
+	/**
+	 * Check whether the hash of the segment of a variable is known.
+	 */
+	bool hasSegmentHash(unsigned int variable) { return _segmentHashes.count(variable); }
+
+	/**
+	 * Get the hash of the segment that corresponds to a variable.
+	 */
+	SegmentHash getSegmentHash(unsigned int variable);
+
 	/**
 	 * Get the inter-section interval that corresponds to a variable.
 	 */
 	unsigned int getInterSectionInterval(unsigned int variable) { return _interSectionIntervals[variable]; }
 
+	/**
+	 * Get the bounding box in x and y of the slices of the segment that 
+	 * corresponds to a variable.
+	 */
+	const util::rect<int>& getBoundingBox(unsigned int variable) { return _boundingBoxes[variable]; }
+
 	unsigned int getMinInterSectionInterval() { return _minInterSectionInterval; }
 	unsigned int getMaxInterSectionInterval() { return _maxInterSectionInterval; }
 	unsigned int getMinX() { return _minX; }
@@ -53,6 +75,14 @@ public:
 	 */
 	std::vector<unsigned int> getVariables(unsigned int minInterSectionInterval, unsigned int maxInterSectionInterval);
 
+	/**
+	 * Get all the variables that are assigned to the intersection intervals 
+	 * between (including) minInterSectionInterval and (excluding) 
+	 * maxInterSectionInterval and whose bounding box intersects the given 
+	 * region.
+	 */
+	std::vector<unsigned int> getVariables(unsigned int minInterSectionInterval, unsigned int maxInterSectionInterval, const util::rect<int>& region);
+
 	/**
 	 * Get all variables that have been assigned to segments.
 	 */
@@ -65,7 +95,19 @@ public:
 
 private:
 
-	void fit(const Segment& segment);
+	void fit(unsigned int interSectionInterval, const util::rect<int>& boundingBox);
+
+	// (re)build the index of variables by inter-section interval and grid cell
+	void updateIndex();
+
+	// the size of the cells of the grid index in pixels
+	static const int GridCellSize = 256;
+
+	// a cell of the grid index
+	typedef std::pair<int, int> cell_type;
+
+	// the variables whose bounding box overlaps a cell
+	typedef std::map<cell_type, std::vector<unsigned int> > grid_type;
 
 	// mapping of segment ids to variable numbers
 	std::map<unsigned int, unsigned int> _variables;
@@ -73,9 +115,23 @@ private:
 	// reverse mapping
 	std::map<unsigned int, unsigned int> _segmentIds;
 
+	// mapping from variable ids to segment hashes
+	std::map<unsigned int, SegmentHash> _segmentHashes;
+
 	// mapping from variable ids to inter-section intervals
 	std::map<unsigned int, unsigned int> _interSectionIntervals;
 
+	// mapping from variable ids to the bounding boxes of their slices
+	std::map<unsigned int, util::rect<int> > _boundingBoxes;
+
+	// index from inter-section intervals to the variables assigned to them
+	std::map<unsigned int, std::vector<unsigned int> > _intervalVariables;
+
+	// index from inter-section intervals to a grid of their variables
+	std::map<unsigned int, grid_type> _intervalGrids;
+
+	bool _indexDirty;
+
 	// the boundary of the problem in volume space
 	int _minInterSectionInterval;
 	int _maxInterSectionInterval;
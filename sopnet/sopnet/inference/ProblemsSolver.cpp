@@ -1,52 +1,197 @@
+#include <boost/bind.hpp>
+#include <boost/timer/timer.hpp>
+
 #include <pipeline/Value.h>
-#include <inference/LinearSolver.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include <sopnet/parallel.h>
 #include "ProblemsSolver.h"
 
+util::ProgramOption optionProblemsThreads(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "problemsThreads",
+		util::_description_text = "The number of problems to solve concurrently. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionProblemsTimeLimit(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "problemsTimeLimit",
+		util::_description_text = "The maximal time in seconds to spend on each problem. The default (0) means no limit.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionProblemsGap(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "problemsGap",
+		util::_description_text = "The relative optimality gap at which to stop solving each problem. The default (-1) uses the gap of the solver backend.",
+		util::_default_value    = -1);
+
+static logger::LogChannel problemssolverlog("problemssolverlog", "[ProblemsSolver] ");
+
 ProblemsSolver::ProblemsSolver() :
-	_solutions(new Solutions()) {
+	_solutions(new Solutions()),
+	_threadsPerWorker(1),
+	_numSolved(0),
+	_cancelled(false) {
 
 	registerInput(_problems, "problems");
 	registerOutput(_solutions, "solutions");
 }
 
 void
-ProblemsSolver::updateOutputs() {
+ProblemsSolver::cancel() {
 
-	// create internal pipeline
+	boost::mutex::scoped_lock lock(_mutex);
 
-	_solutionAssembler->clearInputs("solutions");
+	LOG_USER(problemssolverlog) << "cancelling" << std::endl;
 
-	foreach (boost::shared_ptr<Problem> problem, *_problems) {
+	_cancelled = true;
 
-		pipeline::Process<LinearSolver> solver;
+	unsigned int problem;
+	boost::shared_ptr<LinearSolver> solver;
+	foreach (boost::tie(problem, solver), _runningSolvers)
+		solver->interrupt();
+}
 
-		solver->setInput("objective", problem->getObjective());
-		solver->setInput("linear constraints", problem->getLinearConstraints());
-		solver->setInput("parameters", boost::make_shared<LinearSolverParameters>(Binary));
+unsigned int
+ProblemsSolver::getNumSolved() {
 
-		_solutionAssembler->addInput("solutions", solver->getOutput("solution"));
-	}
+	boost::mutex::scoped_lock lock(_mutex);
+
+	return _numSolved;
+}
 
-	pipeline::Value<Solutions> solutions = _solutionAssembler->getOutput("solutions");
+unsigned int
+ProblemsSolver::getNumRemaining() {
 
-	// copy internal pipeline output to output structure (this is not too bad, 
-	// since Solutions is a lightweight data structure)
-	*_solutions = *solutions;
+	boost::mutex::scoped_lock lock(_mutex);
+
+	return _problemSolutions.size() - _numSolved;
 }
 
-ProblemsSolver::SolutionsAssembler::SolutionsAssembler() {
+std::vector<double>
+ProblemsSolver::getDurations() {
 
-	registerInputs(_singleSolutions, "solutions");
-	registerOutput(_solutions, "solutions");
+	boost::mutex::scoped_lock lock(_mutex);
+
+	return _durations;
 }
 
 void
-ProblemsSolver::SolutionsAssembler::updateOutputs() {
+ProblemsSolver::updateOutputs() {
+
+	boost::timer::auto_cpu_timer timer("\tProblemsSolver::updateOutputs()\t%ws\n");
+
+	unsigned int numProblems = _problems->size();
+
+	unsigned int numThreads = getNumWorkerThreads(optionProblemsThreads, numProblems);
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		_problemSolutions.clear();
+		_problemSolutions.resize(numProblems);
+		_durations.assign(numProblems, 0);
+		_runningSolvers.clear();
+		_numSolved   = 0;
+		_cancelled   = false;
+	}
+
+	// share the CPUs between the solvers of the workers
+	_threadsPerWorker = getThreadsPerWorker(numThreads);
+
+	LOG_USER(problemssolverlog)
+			<< "solving " << numProblems << " problems with " << numThreads << " threads, "
+			<< _threadsPerWorker << " solver threads each" << std::endl;
+
+	parallelFor(
+			numThreads,
+			numProblems,
+			boost::bind(&ProblemsSolver::solveProblem, this, _1));
 
 	_solutions->clear();
 
-	foreach (boost::shared_ptr<Solution> solution, _singleSolutions) {
+	for (unsigned int i = 0; i < numProblems; i++) {
+
+		// problems that have not been solved get an all-zero solution
+		if (!_problemSolutions[i])
+			_problemSolutions[i] = boost::make_shared<Solution>(_problems->getProblem(i)->getObjective()->size());
+
+		_solutions->addSolution(_problemSolutions[i]);
+	}
+
+	LOG_USER(problemssolverlog) << "solved " << _numSolved << " of " << numProblems << " problems" << std::endl;
+}
+
+void
+ProblemsSolver::solveProblem(unsigned int i) {
+
+	// don't set up a solver for problems that will not be solved
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		if (_cancelled)
+			return;
+	}
+
+	boost::shared_ptr<Problem> problem = _problems->getProblem(i);
+
+	boost::shared_ptr<LinearSolverParameters> parameters = boost::make_shared<LinearSolverParameters>(Binary);
+	parameters->setTimeLimit(optionProblemsTimeLimit.as<double>());
+	parameters->setOptimalityGap(optionProblemsGap.as<double>());
+	parameters->setNumThreads(_threadsPerWorker);
+
+	boost::shared_ptr<LinearSolver> solver = boost::make_shared<LinearSolver>();
+
+	solver->setInput("objective", problem->getObjective());
+	solver->setInput("linear constraints", problem->getLinearConstraints());
+	solver->setInput("parameters", parameters);
+
+	// cancel() might have been called while the solver was set up -- check 
+	// again and register the solver under the same lock, such that cancel() 
+	// either prevents the solve or interrupts it (interrupts that come in 
+	// before the backend started optimizing stop it right away)
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		if (_cancelled)
+			return;
 
-		_solutions->addSolution(solution);
+		_runningSolvers[i] = solver;
 	}
+
+	boost::timer::cpu_timer solveTimer;
+
+	boost::shared_ptr<Solution> solution;
+
+	try {
+
+		pipeline::Value<Solution> result = solver->getOutput("solution");
+
+		// solves that were interrupted before they found a solution get an 
+		// all-zero solution, like the ones that did not start
+		if (result->size() > 0)
+			solution = boost::make_shared<Solution>(*result);
+
+	} catch (boost::exception& e) {
+
+		LOG_ERROR(problemssolverlog) << "failed to solve problem " << i << std::endl;
+
+		if (boost::get_error_info<error_message>(e))
+			LOG_ERROR(problemssolverlog) << *boost::get_error_info<error_message>(e) << std::endl;
+	}
+
+	double duration = solveTimer.elapsed().wall/1e9;
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	_runningSolvers.erase(i);
+	_problemSolutions[i] = solution;
+	_durations[i] = duration;
+	_numSolved++;
+
+	LOG_USER(problemssolverlog)
+			<< "solved problem " << i << " in " << duration << "s ("
+			<< _numSolved << " solved, "
+			<< (_problemSolutions.size() - _numSolved) << " remaining)" << std::endl;
 }
@@ -1,40 +1,81 @@
 #ifndef SOPNET_INFERENCE_PROBLEMS_SOLVER_H__
 #define SOPNET_INFERENCE_PROBLEMS_SOLVER_H__
 
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+
 #include <pipeline/all.h>
-#include <pipeline/Process.h>
+#include <inference/LinearSolver.h>
 #include <inference/Solution.h>
 #include "Problems.h"
 #include "Solutions.h"
 
+/**
+ * Solves each problem of a set of problems. Problems are distributed over a 
+ * pool of worker threads (see option sopnet.inference.problemsThreads), each 
+ * solve can be limited in time and optimality gap.
+ *
+ * The progress can be queried from another thread while the solutions are 
+ * computed, and the remaining solves can be cancelled.
+ */
 class ProblemsSolver : public pipeline::SimpleProcessNode<> {
 
 public:
 
 	ProblemsSolver();
 
+	/**
+	 * Stop solving: Running solves are interrupted and provide the best 
+	 * solution they found so far, problems that have not been started yet get 
+	 * an all-zero solution. Can be called from another thread.
+	 */
+	void cancel();
+
+	/**
+	 * Get the number of problems that have been solved so far in the current 
+	 * or last update.
+	 */
+	unsigned int getNumSolved();
+
+	/**
+	 * Get the number of problems that still need to be solved in the current 
+	 * update.
+	 */
+	unsigned int getNumRemaining();
+
+	/**
+	 * Get the wall-clock duration in seconds for each problem solved so far 
+	 * (0 for problems that have not been solved).
+	 */
+	std::vector<double> getDurations();
+
 private:
 
-	class SolutionsAssembler : public pipeline::SimpleProcessNode<> {
+	void updateOutputs();
 
-	public:
+	// solve problem i, called concurrently by the workers
+	void solveProblem(unsigned int i);
 
-		SolutionsAssembler();
+	pipeline::Input<Problems>   _problems;
+	pipeline::Output<Solutions> _solutions;
 
-	private:
+	// the solutions of the current update
+	std::vector<boost::shared_ptr<Solution> > _problemSolutions;
 
-		void updateOutputs();
+	// the solvers that are currently running by the problem they solve
+	std::map<unsigned int, boost::shared_ptr<LinearSolver> > _runningSolvers;
 
-		pipeline::Inputs<Solution>  _singleSolutions;
-		pipeline::Output<Solutions> _solutions;
-	};
+	// the time it took to solve each problem
+	std::vector<double> _durations;
 
-	void updateOutputs();
+	// the number of threads the solver of each worker can use
+	unsigned int _threadsPerWorker;
 
-	pipeline::Input<Problems>   _problems;
-	pipeline::Output<Solutions> _solutions;
+	unsigned int _numSolved;
+	bool         _cancelled;
 
-	pipeline::Process<SolutionsAssembler> _solutionAssembler;
+	boost::mutex _mutex;
 };
 
 #endif // SOPNET_INFERENCE_PROBLEMS_SOLVER_H__
@@ -37,6 +37,7 @@ RandomForestCostFunction::updateOutputs() {
 
 	// invalidate cache
 	_cache.clear();
+	_cacheIds.clear();
 }
 
 void
@@ -62,7 +63,7 @@ RandomForestCostFunction::costs(
 
 	segmentCosts.resize(ends.size() + continuations.size() + branches.size(), 0);
 
-	if (segmentCosts.size() == _cache.size()) {
+	if (isCached(ends, continuations, branches)) {
 
 		for (unsigned int i = 0; i < segmentCosts.size(); i++)
 			segmentCosts[i] += _cache[i];
@@ -71,6 +72,8 @@ RandomForestCostFunction::costs(
 	}
 
 	_cache.resize(ends.size() + continuations.size() + branches.size());
+	_cacheIds.clear();
+	_cacheIds.reserve(_cache.size());
 
 	unsigned int i = 0;
 
@@ -80,6 +83,7 @@ RandomForestCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(end->getId());
 
 		i++;
 	}
@@ -93,6 +97,7 @@ RandomForestCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(continuation->getId());
 
 		i++;
 	}
@@ -106,11 +111,40 @@ RandomForestCostFunction::costs(
 
 		segmentCosts[i] += c;
 		_cache[i] = c;
+		_cacheIds.push_back(branch->getId());
 
 		i++;
 	}
 }
 
+bool
+RandomForestCostFunction::isCached(
+		const std::vector<boost::shared_ptr<EndSegment> >&          ends,
+		const std::vector<boost::shared_ptr<ContinuationSegment> >& continuations,
+		const std::vector<boost::shared_ptr<BranchSegment> >&       branches) {
+
+	// the cost function might be called for different sets of segments of the 
+	// same size (e.g., for each inter-section interval)
+	if (_cacheIds.size() != ends.size() + continuations.size() + branches.size())
+		return false;
+
+	unsigned int i = 0;
+
+	foreach (boost::shared_ptr<EndSegment> end, ends)
+		if (_cacheIds[i++] != end->getId())
+			return false;
+
+	foreach (boost::shared_ptr<ContinuationSegment> continuation, continuations)
+		if (_cacheIds[i++] != continuation->getId())
+			return false;
+
+	foreach (boost::shared_ptr<BranchSegment> branch, branches)
+		if (_cacheIds[i++] != branch->getId())
+			return false;
+
+	return true;
+}
+
 double
 RandomForestCostFunction::costs(const Segment& segment) {
 
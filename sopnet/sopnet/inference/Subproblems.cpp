@@ -0,0 +1,63 @@
+#include <util/foreach.h>
+#include "Subproblems.h"
+
+unsigned int
+Subproblems::getVariableOwner(unsigned int variable) {
+
+	std::map<unsigned int, unsigned int>::const_iterator i = _variableOwners.find(variable);
+
+	if (i != _variableOwners.end())
+		return i->second;
+
+	return *getVariableSubproblems(variable).begin();
+}
+
+boost::shared_ptr<Problem>
+Subproblems::extractProblem(unsigned int subproblem) {
+
+	const std::vector<unsigned int>& variables   = getSubproblemVariables(subproblem);
+	const std::vector<unsigned int>& constraints = getSubproblemConstraints(subproblem);
+
+	const LinearObjective&   workingObjective   = *_problem->getObjective();
+	const LinearConstraints& workingConstraints = *_problem->getLinearConstraints();
+	ProblemConfiguration&    workingConfiguration = *_problem->getConfiguration();
+
+	boost::shared_ptr<Problem> problem = boost::make_shared<Problem>(variables.size());
+
+	// map working problem variables to subproblem variables
+	std::map<unsigned int, unsigned int> subproblemVariables;
+
+	for (unsigned int i = 0; i < variables.size(); i++) {
+
+		subproblemVariables[variables[i]] = i;
+
+		problem->getObjective()->setCoefficient(i, workingObjective.getCoefficients()[variables[i]]);
+		problem->getConfiguration()->setVariable(workingConfiguration.getSegmentId(variables[i]), i);
+
+		if (workingConfiguration.hasSegmentHash(variables[i]))
+			problem->getConfiguration()->setSegmentHash(i, workingConfiguration.getSegmentHash(variables[i]));
+	}
+
+	problem->getObjective()->setSense(workingObjective.getSense());
+
+	foreach (unsigned int i, constraints) {
+
+		const LinearConstraint& workingConstraint = workingConstraints[i];
+
+		LinearConstraint constraint;
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), workingConstraint.getCoefficients())
+			constraint.setCoefficient(subproblemVariables[varNum], coef);
+
+		constraint.setRelation(workingConstraint.getRelation());
+		constraint.setValue(workingConstraint.getValue());
+
+		problem->getLinearConstraints()->add(constraint);
+	}
+
+	problem->getLinearConstraints()->registerVariables(variables.size());
+
+	return problem;
+}
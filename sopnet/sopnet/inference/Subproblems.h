@@ -2,8 +2,35 @@
 #define SOPNET_INFERENCE_SUBPROBLEMS_H__
 
 #include <pipeline/Data.h>
+#include <util/rect.hpp>
 #include "Problem.h"
 
+/**
+ * The part of the volume covered by a subproblem.
+ */
+struct SubproblemBlock {
+
+	SubproblemBlock() :
+		x(0), y(0), z(0),
+		minInterSectionInterval(0),
+		maxInterSectionInterval(0),
+		region(0, 0, 0, 0),
+		core(0, 0, 0, 0) {}
+
+	// the coordinates of the block in the grid of blocks
+	unsigned int x, y, z;
+
+	// the first and the first not contained inter-section interval
+	unsigned int minInterSectionInterval;
+	unsigned int maxInterSectionInterval;
+
+	// the region in x and y, including the halo
+	util::rect<int> region;
+
+	// the region in x and y without the halo
+	util::rect<int> core;
+};
+
 /**
  * Describes a set of subproblem as part of a larger working problem.
  */
@@ -11,6 +38,9 @@ class Subproblems : public pipeline::Data {
 
 public:
 
+	Subproblems() :
+		_numSubproblems(0) {}
+
 	/**
 	 * Set the working problem that is decomposed by this set of subproblems.
 	 */
@@ -31,7 +61,8 @@ public:
 	 */
 	void assignVariable(unsigned int variable, unsigned int subproblem) {
 
-		_variablesToSubproblems[variable].insert(subproblem);
+		if (_variablesToSubproblems[variable].insert(subproblem).second)
+			getSubproblemVariables(subproblem).push_back(variable);
 	}
 
 	/**
@@ -39,7 +70,8 @@ public:
 	 */
 	void assignConstraint(unsigned int constraint, unsigned int subproblem) {
 
-		_constraintsToSubproblems[constraint].insert(subproblem);
+		if (_constraintsToSubproblems[constraint].insert(subproblem).second)
+			getSubproblemConstraints(subproblem).push_back(constraint);
 	}
 
 	/**
@@ -52,6 +84,74 @@ public:
 	 */
 	std::set<unsigned int>& getConstraintSubproblems(unsigned int constraint) { return _constraintsToSubproblems[constraint]; }
 
+	/**
+	 * Get all working problem variables of a subproblem, in the order they 
+	 * have been assigned. The position of a variable in this list is its 
+	 * variable number in the problem returned by extractProblem().
+	 */
+	std::vector<unsigned int>& getSubproblemVariables(unsigned int subproblem) {
+
+		fitSubproblem(subproblem);
+		return _subproblemsToVariables[subproblem];
+	}
+
+	/**
+	 * Get all working problem constraints of a subproblem.
+	 */
+	std::vector<unsigned int>& getSubproblemConstraints(unsigned int subproblem) {
+
+		fitSubproblem(subproblem);
+		return _subproblemsToConstraints[subproblem];
+	}
+
+	/**
+	 * Set the subproblem that is responsible for the value of a variable in 
+	 * the solution of the working problem. This should be the subproblem in 
+	 * which the variable is farthest away from the boundary.
+	 */
+	void setVariableOwner(unsigned int variable, unsigned int subproblem) {
+
+		_variableOwners[variable] = subproblem;
+	}
+
+	/**
+	 * Get the subproblem that is responsible for the value of a variable. If 
+	 * no owner was set, this is the first subproblem the variable was assigned 
+	 * to.
+	 */
+	unsigned int getVariableOwner(unsigned int variable);
+
+	/**
+	 * Set the part of the volume that a subproblem covers.
+	 */
+	void setBlock(unsigned int subproblem, const SubproblemBlock& block) {
+
+		fitSubproblem(subproblem);
+		_blocks[subproblem] = block;
+	}
+
+	/**
+	 * Get the part of the volume that a subproblem covers.
+	 */
+	const SubproblemBlock& getBlock(unsigned int subproblem) {
+
+		fitSubproblem(subproblem);
+		return _blocks[subproblem];
+	}
+
+	/**
+	 * Get the number of subproblems.
+	 */
+	unsigned int getNumSubproblems() const { return _numSubproblems; }
+
+	/**
+	 * Create a stand-alone problem for a subproblem. Variables are numbered 
+	 * in the order given by getSubproblemVariables(), the problem 
+	 * configuration maps the segment ids of the working problem to these 
+	 * numbers.
+	 */
+	boost::shared_ptr<Problem> extractProblem(unsigned int subproblem);
+
 	/**
 	 * Reset the decomposition.
 	 */
@@ -60,14 +160,40 @@ public:
 		_problem.reset();
 		_variablesToSubproblems.clear();
 		_constraintsToSubproblems.clear();
+		_subproblemsToVariables.clear();
+		_subproblemsToConstraints.clear();
+		_variableOwners.clear();
+		_blocks.clear();
+		_numSubproblems = 0;
 	}
 
 private:
 
+	void fitSubproblem(unsigned int subproblem) {
+
+		if (subproblem < _numSubproblems)
+			return;
+
+		_numSubproblems = subproblem + 1;
+		_subproblemsToVariables.resize(_numSubproblems);
+		_subproblemsToConstraints.resize(_numSubproblems);
+		_blocks.resize(_numSubproblems);
+	}
+
 	std::map<unsigned int, std::set<unsigned int> > _variablesToSubproblems;
 
 	std::map<unsigned int, std::set<unsigned int> > _constraintsToSubproblems;
 
+	std::vector<std::vector<unsigned int> > _subproblemsToVariables;
+
+	std::vector<std::vector<unsigned int> > _subproblemsToConstraints;
+
+	std::map<unsigned int, unsigned int> _variableOwners;
+
+	std::vector<SubproblemBlock> _blocks;
+
+	unsigned int _numSubproblems;
+
 	// the problem that is decomposed into these subproblems
 	boost::shared_ptr<Problem> _problem;
 };
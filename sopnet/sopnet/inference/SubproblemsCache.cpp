@@ -0,0 +1,276 @@
+#include <fstream>
+
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "SubproblemsCache.h"
+
+static logger::LogChannel subproblemscachelog("subproblemscachelog", "[SubproblemsCache] ");
+
+// the version of the cache file format, increase on changes (including 
+// changes of the hashes)
+static const unsigned int CacheFileVersion = 3;
+
+namespace {
+
+// 64 bit FNV parameters
+const boost::uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+const boost::uint64_t FnvPrime       = 1099511628211ULL;
+
+// seed of the collision check hash
+const boost::uint64_t CheckSeed = 0x5bd1e9955bd1e995ULL;
+
+// Add the bytes of a value to the hash (FNV-1a) and the check (FNV-1). The 
+// hashes don't depend on the boost version or the platform's hash functions, 
+// such that cache files stay valid across builds. FNV-1 mixes differently 
+// than FNV-1a, such that a collision of the hash is unlikely to be a 
+// collision of the check as well.
+template <typename T>
+void
+hashCombine(boost::uint64_t& hash, boost::uint64_t& check, const T& value) {
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+
+	for (std::size_t i = 0; i < sizeof(T); i++) {
+
+		hash ^= bytes[i];
+		hash *= FnvPrime;
+
+		check *= FnvPrime;
+		check ^= bytes[i];
+	}
+}
+
+} // anonymous namespace
+
+bool
+SubproblemsCache::hashProblem(Problem& problem, boost::uint64_t& hash, boost::uint64_t& check) {
+
+	ProblemConfiguration&    configuration = *problem.getConfiguration();
+	const LinearObjective&   objective     = *problem.getObjective();
+	const LinearConstraints& constraints   = *problem.getLinearConstraints();
+
+	// the segment hashes of all variables
+	std::vector<SegmentHash> segmentHashes(objective.size());
+
+	for (unsigned int i = 0; i < objective.size(); i++) {
+
+		if (!configuration.hasSegmentHash(i))
+			return false;
+
+		segmentHashes[i] = configuration.getSegmentHash(i);
+	}
+
+	hash  = FnvOffsetBasis;
+	check = CheckSeed;
+
+	hashCombine(hash, check, static_cast<boost::uint64_t>(objective.size()));
+	hashCombine(hash, check, static_cast<boost::uint64_t>(constraints.size()));
+
+	hashCombine(hash, check, static_cast<boost::int32_t>(objective.getSense()));
+	hashCombine(hash, check, objective.getConstant());
+
+	for (unsigned int i = 0; i < objective.size(); i++) {
+
+		hashCombine(hash, check, static_cast<boost::uint64_t>(segmentHashes[i]));
+		hashCombine(hash, check, objective.getCoefficients()[i]);
+	}
+
+	foreach (const LinearConstraint& constraint, constraints) {
+
+		hashCombine(hash, check, static_cast<boost::int32_t>(constraint.getRelation()));
+		hashCombine(hash, check, constraint.getValue());
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients()) {
+
+			hashCombine(hash, check, static_cast<boost::uint64_t>(segmentHashes[varNum]));
+			hashCombine(hash, check, coef);
+		}
+	}
+
+	return true;
+}
+
+bool
+SubproblemsCache::getSolution(boost::uint64_t hash, boost::uint64_t check, unsigned int numVariables, Solution& solution) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	std::map<boost::uint64_t, CachedSolution>::const_iterator i = _solutions.find(hash);
+
+	if (i == _solutions.end())
+		return false;
+
+	if (i->second.check != check || i->second.values.size() != numVariables) {
+
+		LOG_DEBUG(subproblemscachelog) << "hash collision for subproblem " << hash << ", ignoring cached solution" << std::endl;
+		return false;
+	}
+
+	solution.getVector() = i->second.values;
+
+	return true;
+}
+
+unsigned int
+SubproblemsCache::getInitialSolution(Problem& problem, Solution& solution) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	ProblemConfiguration& configuration = *problem.getConfiguration();
+	unsigned int          numVariables  = problem.getObjective()->size();
+
+	solution.getVector().assign(numVariables, 0);
+
+	unsigned int numKnown = 0;
+
+	for (unsigned int i = 0; i < numVariables; i++) {
+
+		if (!configuration.hasSegmentHash(i))
+			continue;
+
+		std::map<SegmentHash, double>::const_iterator value = _segmentValues.find(configuration.getSegmentHash(i));
+
+		if (value == _segmentValues.end())
+			continue;
+
+		solution[i] = value->second;
+		numKnown++;
+	}
+
+	return numKnown;
+}
+
+void
+SubproblemsCache::setSolution(boost::uint64_t hash, boost::uint64_t check, Problem& problem, const Solution& solution) {
+
+	if (solution.size() != problem.getObjective()->size()) {
+
+		LOG_ERROR(subproblemscachelog)
+				<< "solution has " << solution.size() << " values for a subproblem with "
+				<< problem.getObjective()->size() << " variables, not caching it" << std::endl;
+		return;
+	}
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	CachedSolution& cached = _solutions[hash];
+	cached.check  = check;
+	cached.values = solution.getVector();
+
+	ProblemConfiguration& configuration = *problem.getConfiguration();
+
+	for (unsigned int i = 0; i < solution.size(); i++)
+		if (configuration.hasSegmentHash(i))
+			_segmentValues[configuration.getSegmentHash(i)] = solution[i];
+}
+
+void
+SubproblemsCache::load(const std::string& filename) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	std::ifstream in(filename.c_str());
+
+	if (!in.good()) {
+
+		LOG_DEBUG(subproblemscachelog) << "no cache file " << filename << " found" << std::endl;
+		return;
+	}
+
+	std::string  section;
+	unsigned int version = 0;
+
+	in >> section >> version;
+
+	if (section != "version" || version != CacheFileVersion) {
+
+		LOG_USER(subproblemscachelog)
+				<< "cache file " << filename << " was written by another version, ignoring it" << std::endl;
+		return;
+	}
+
+	unsigned int numSolutions;
+
+	in >> section >> numSolutions;
+
+	for (unsigned int i = 0; i < numSolutions && in.good(); i++) {
+
+		boost::uint64_t hash;
+		CachedSolution  solution;
+		unsigned int    size;
+
+		in >> hash >> solution.check >> size;
+
+		solution.values.resize(size);
+
+		for (unsigned int j = 0; j < size; j++)
+			in >> solution.values[j];
+
+		if (in.good())
+			_solutions[hash] = solution;
+	}
+
+	unsigned int numSegments;
+
+	in >> section >> numSegments;
+
+	for (unsigned int i = 0; i < numSegments && in.good(); i++) {
+
+		SegmentHash hash;
+		double      value;
+
+		in >> hash >> value;
+
+		_segmentValues[hash] = value;
+	}
+
+	if (in.fail())
+		LOG_ERROR(subproblemscachelog) << "cache file " << filename << " is corrupt" << std::endl;
+
+	LOG_DEBUG(subproblemscachelog)
+			<< "read " << numSolutions << " subproblem solutions and "
+			<< numSegments << " segment values from " << filename << std::endl;
+}
+
+void
+SubproblemsCache::save(const std::string& filename) {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	std::ofstream out(filename.c_str());
+
+	out.precision(17);
+
+	out << "version " << CacheFileVersion << std::endl;
+
+	out << "solutions " << _solutions.size() << std::endl;
+
+	boost::uint64_t hash;
+	CachedSolution  solution;
+	foreach (boost::tie(hash, solution), _solutions) {
+
+		out << hash << " " << solution.check << " " << solution.values.size();
+		foreach (double value, solution.values)
+			out << " " << value;
+		out << std::endl;
+	}
+
+	out << "segments " << _segmentValues.size() << std::endl;
+
+	SegmentHash segmentHash;
+	double      value;
+	foreach (boost::tie(segmentHash, value), _segmentValues)
+		out << segmentHash << " " << value << std::endl;
+
+	LOG_DEBUG(subproblemscachelog) << "wrote " << _solutions.size() << " subproblem solutions to " << filename << std::endl;
+}
+
+unsigned int
+SubproblemsCache::size() {
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	return _solutions.size();
+}
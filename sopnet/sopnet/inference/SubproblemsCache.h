@@ -0,0 +1,112 @@
+#ifndef SOPNET_INFERENCE_SUBPROBLEMS_CACHE_H__
+#define SOPNET_INFERENCE_SUBPROBLEMS_CACHE_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <inference/Solution.h>
+#include <sopnet/segments/SegmentHash.h>
+#include "Problem.h"
+
+/**
+ * A cache for the solutions of subproblems, such that subproblems that did
+ * not change since the last solve don't have to be solved again.
+ *
+ * Subproblems are identified by a hash of their objective and constraints,
+ * where variables are represented by the hashes of their segments. A second,
+ * independently seeded hash is stored with each solution to detect
+ * collisions of the first one. Both are FNV hashes over the bytes of the 
+ * problem, such that cache files can be reused by other builds on the same 
+ * platform. Only optimal solutions should be stored.
+ * Solutions of subproblems that are similar but not identical to previously
+ * solved ones can be warm-started from the last known values of their
+ * segments.
+ *
+ * All methods are thread-safe.
+ */
+class SubproblemsCache {
+
+public:
+
+	/**
+	 * Compute the hashes of a subproblem.
+	 *
+	 * @param problem
+	 *              The subproblem. Its configuration has to provide segment
+	 *              hashes for all variables.
+	 *
+	 * @param hash
+	 *              [out] The hash of the subproblem, used to look up its 
+	 *              solution.
+	 *
+	 * @param check
+	 *              [out] A second hash of the subproblem, used to detect 
+	 *              collisions of the first one.
+	 *
+	 * @return False, if not all segment hashes are known.
+	 */
+	static bool hashProblem(Problem& problem, boost::uint64_t& hash, boost::uint64_t& check);
+
+	/**
+	 * Get the cached solution of a subproblem.
+	 *
+	 * @return True, if a solution for the given hashes with the given number 
+	 *         of variables was found.
+	 */
+	bool getSolution(boost::uint64_t hash, boost::uint64_t check, unsigned int numVariables, Solution& solution);
+
+	/**
+	 * Create a start solution for a subproblem from the last known values of
+	 * its segments. Variables of unknown segments are set to zero.
+	 *
+	 * @return The number of variables for which a value was known.
+	 */
+	unsigned int getInitialSolution(Problem& problem, Solution& solution);
+
+	/**
+	 * Store the optimal solution of a subproblem. Solutions that don't assign 
+	 * a value to each variable of the subproblem are ignored.
+	 */
+	void setSolution(boost::uint64_t hash, boost::uint64_t check, Problem& problem, const Solution& solution);
+
+	/**
+	 * Read cached solutions from a file, in addition to the ones already in
+	 * the cache. Files written by another version of the cache are ignored.
+	 */
+	void load(const std::string& filename);
+
+	/**
+	 * Write all cached solutions to a file.
+	 */
+	void save(const std::string& filename);
+
+	/**
+	 * Get the number of cached subproblem solutions.
+	 */
+	unsigned int size();
+
+private:
+
+	struct CachedSolution {
+
+		// the second hash of the subproblem
+		boost::uint64_t check;
+
+		std::vector<double> values;
+	};
+
+	// subproblem hashes to the solutions of the subproblems
+	std::map<boost::uint64_t, CachedSolution> _solutions;
+
+	// the most recent value of each segment in any subproblem
+	std::map<SegmentHash, double> _segmentValues;
+
+	boost::mutex _mutex;
+};
+
+#endif // SOPNET_INFERENCE_SUBPROBLEMS_CACHE_H__
+
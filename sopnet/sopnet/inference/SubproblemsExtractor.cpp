@@ -12,6 +12,18 @@ util::ProgramOption optionSubproblemsOverlap(
 		util::_long_name        = "subproblemsOverlap",
 		util::_description_text = "The overlap between neighboring subproblems in sections.");
 
+util::ProgramOption optionSubproblemsBlockSize(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "subproblemsBlockSize",
+		util::_description_text = "The size of the subproblems in x and y in pixels. The default (0) does not decompose in x and y.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionSubproblemsBlockHalo(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "subproblemsBlockHalo",
+		util::_description_text = "The overlap of neighboring subproblems in x and y in pixels, added on each side of a block.",
+		util::_default_value    = 0);
+
 logger::LogChannel subproblemsextractorlog("subproblemsextractorlog", "[SubproblemsExtractor] ");
 
 SubproblemsExtractor::SubproblemsExtractor() :
@@ -110,79 +122,201 @@ SubproblemsExtractor::updateOutputs() {
 	_subproblems->clear();
 	_subproblems->setProblem(problem);
 
+	// without variables, the extents of the problem are not defined
+	if (_objective->size() == 0) {
+
+		LOG_DEBUG(subproblemsextractorlog) << "problem is empty, nothing to decompose" << std::endl;
+		return;
+	}
+
 	LOG_DEBUG(subproblemsextractorlog)
 			<< "decomposing problem with extents " << minInterSectionInterval
 			<< "-" << maxInterSectionInterval << " into pieces of "
 			<< subproblemsSize << " with overlap of "
 			<< subproblemsOverlap << std::endl;
 
-	// 1D decomposition of the working problem
+	// only read access to the constraints from here on, such that the 
+	// variable index of the constraints stays valid
+	const LinearConstraints& allConstraints = *_constraints;
+
+	// the blocks in x and y, each one with a core and a halo
+	std::vector<SubproblemBlock> blocks = getBlocks();
+
+	// for each variable, the distance to the boundary of its owning subproblem 
+	// (first in x and y, then between sections)
+	std::map<unsigned int, std::pair<int, int> > variableMargins;
+
+	// decomposition of the working problem into windows of sections and blocks 
+	// in x and y
 	unsigned int subproblemId = 0;
-	for (unsigned int startSubproblem = minInterSectionInterval; startSubproblem < maxInterSectionInterval; startSubproblem += subproblemsSize - subproblemsOverlap) {
+	unsigned int z = 0;
+	for (unsigned int startSubproblem = minInterSectionInterval; startSubproblem <= maxInterSectionInterval; startSubproblem += subproblemsSize - subproblemsOverlap, z++) {
 
-		// the first inter-section interval that is not part of the subproblem
-		unsigned int endSubproblem = startSubproblem + subproblemsSize;
+		foreach (SubproblemBlock block, blocks) {
 
-		LOG_DEBUG(subproblemsextractorlog) << "creating subproblem " << subproblemId << " for inter-section intervals " << startSubproblem << "-" << (endSubproblem-1) << std::endl;
+			// the first inter-section interval that is not part of the subproblem
+			unsigned int endSubproblem = startSubproblem + subproblemsSize;
 
-		// get all working problem variable ids for this subproblem
-		std::vector<unsigned int> workingVarIds = _configuration->getVariables(startSubproblem, endSubproblem);
+			block.z = z;
+			block.minInterSectionInterval = startSubproblem;
+			block.maxInterSectionInterval = endSubproblem;
 
-		LOG_DEBUG(subproblemsextractorlog) << "this subproblem contains " << workingVarIds.size() << " variables" << std::endl;
+			LOG_DEBUG(subproblemsextractorlog)
+					<< "creating subproblem " << subproblemId << " for inter-section intervals "
+					<< startSubproblem << "-" << (endSubproblem-1) << " and region "
+					<< block.region.minX << ", " << block.region.minY << " - "
+					<< block.region.maxX << ", " << block.region.maxY << std::endl;
 
-		// remember mapping of subproblem variable ids to this subproblem 
-		// (needed for unary terms)
-		foreach (unsigned int workingVarId, workingVarIds) {
+			// get all working problem variable ids for this subproblem
+			std::vector<unsigned int> workingVarIds = _configuration->getVariables(startSubproblem, endSubproblem, block.region);
 
-			LOG_ALL(subproblemsextractorlog) << "assigning variable " << workingVarId << " to subproblem " << subproblemId << std::endl;
-			_subproblems->assignVariable(workingVarId, subproblemId);
-		}
+			// skip empty blocks
+			if (workingVarIds.empty())
+				continue;
+
+			_subproblems->setBlock(subproblemId, block);
+
+			LOG_DEBUG(subproblemsextractorlog) << "this subproblem contains " << workingVarIds.size() << " variables" << std::endl;
+
+			// remember mapping of subproblem variable ids to this subproblem 
+			// (needed for unary terms)
+			foreach (unsigned int workingVarId, workingVarIds) {
+
+				LOG_ALL(subproblemsextractorlog) << "assigning variable " << workingVarId << " to subproblem " << subproblemId << std::endl;
+				_subproblems->assignVariable(workingVarId, subproblemId);
 
-		// find all working problem constraints that involve the subproblem 
-		// variable ids
-		std::vector<unsigned int> constraints = _constraints->getConstraints(workingVarIds);
-
-		// remember mapping of constraints to this subproblem
-		foreach (unsigned int i, constraints) {
-
-			LinearConstraint& constraint = (*_constraints)[i];
-
-			// There are two types of constraints: [expr]≤1 and [expr]=0.  The 
-			// first is defined within one inter-section interval and ensures 
-			// that at most one of conflicting segments is picked.  The second 
-			// is defined between two inter-section intervals and
-			// ensures continuation.
-			//
-			// Always accept the first type. Accept the second type only if 
-			// it is fully contained in our problems variables. To simplify 
-			// things (and be more general), accept constraints only if they
-			// are fully contained in our variables.
-
-			// Working variable ids have already been assigned to subproblem 
-			// ids. We can thus just ask for that.
-			unsigned int workingVarId;
-			double _;
-			bool addConstraint = true;
-			foreach (boost::tie(workingVarId, _), constraint.getCoefficients()) {
-
-				// get all subproblems that are assigned to the working variable
-				std::set<unsigned int>& assignedSubproblems = _subproblems->getVariableSubproblems(workingVarId);
-
-				// does it containt the current subproblem?
-				if (!assignedSubproblems.count(subproblemId)) {
-
-					addConstraint = false;
-					break;
+				// the subproblem in which the variable is farthest away from the 
+				// boundary determines its value in the working problem -- blocks 
+				// that contain the center of the variable in their core are 
+				// preferred over the ones that contain it only in their halo
+				const util::rect<int>& boundingBox = _configuration->getBoundingBox(workingVarId);
+				int centerX = (boundingBox.minX + boundingBox.maxX)/2;
+				int centerY = (boundingBox.minY + boundingBox.maxY)/2;
+				int coreMargin = std::min(
+						std::min(centerX - block.core.minX, block.core.maxX - 1 - centerX),
+						std::min(centerY - block.core.minY, block.core.maxY - 1 - centerY));
+
+				int interSectionInterval = _configuration->getInterSectionInterval(workingVarId);
+				int margin = std::min(
+						interSectionInterval - (int)startSubproblem,
+						(int)endSubproblem - 1 - interSectionInterval);
+
+				std::pair<int, int> margins(std::min(coreMargin, 0), margin);
+
+				if (!variableMargins.count(workingVarId) || variableMargins[workingVarId] < margins) {
+
+					variableMargins[workingVarId] = margins;
+					_subproblems->setVariableOwner(workingVarId, subproblemId);
 				}
 			}
 
-			if (addConstraint) {
+			// find all working problem constraints that involve the subproblem 
+			// variable ids
+			std::vector<unsigned int> constraints = allConstraints.getConstraints(workingVarIds);
+
+			// remember mapping of constraints to this subproblem
+			foreach (unsigned int i, constraints) {
+
+				const LinearConstraint& constraint = allConstraints[i];
+
+				// There are two types of constraints: [expr]≤1 and [expr]=0.  The 
+				// first is defined within one inter-section interval and ensures 
+				// that at most one of conflicting segments is picked.  The second 
+				// is defined between two inter-section intervals and
+				// ensures continuation.
+				//
+				// Always accept the first type. Accept the second type only if 
+				// it is fully contained in our problems variables. To simplify 
+				// things (and be more general), accept constraints only if they
+				// are fully contained in our variables.
+
+				// Working variable ids have already been assigned to subproblem 
+				// ids. We can thus just ask for that.
+				unsigned int workingVarId;
+				double _;
+				bool addConstraint = true;
+				foreach (boost::tie(workingVarId, _), constraint.getCoefficients()) {
+
+					// get all subproblems that are assigned to the working variable
+					std::set<unsigned int>& assignedSubproblems = _subproblems->getVariableSubproblems(workingVarId);
+
+					// does it containt the current subproblem?
+					if (!assignedSubproblems.count(subproblemId)) {
+
+						addConstraint = false;
+						break;
+					}
+				}
 
-				LOG_ALL(subproblemsextractorlog) << "assigning constraint " << i << " to subproblem " << subproblemId << std::endl;
-				_subproblems->assignConstraint(i, subproblemId);
+				if (addConstraint) {
+
+					LOG_ALL(subproblemsextractorlog) << "assigning constraint " << i << " to subproblem " << subproblemId << std::endl;
+					_subproblems->assignConstraint(i, subproblemId);
+				}
 			}
+
+			subproblemId++;
 		}
 
-		subproblemId++;
+		// stop as soon as the last inter-section interval is covered
+		if (startSubproblem + subproblemsSize > maxInterSectionInterval)
+			break;
 	}
+
+	LOG_DEBUG(subproblemsextractorlog) << "created " << subproblemId << " subproblems" << std::endl;
+}
+
+std::vector<SubproblemBlock>
+SubproblemsExtractor::getBlocks() {
+
+	int blockSize = optionSubproblemsBlockSize;
+	int blockHalo = optionSubproblemsBlockHalo;
+
+	// the extents of the working problem in x and y
+	int minX = _configuration->getMinX();
+	int maxX = _configuration->getMaxX();
+	int minY = _configuration->getMinY();
+	int maxY = _configuration->getMaxY();
+
+	std::vector<SubproblemBlock> blocks;
+
+	// no decomposition in x and y
+	if (blockSize <= 0) {
+
+		SubproblemBlock block;
+		block.core   = util::rect<int>(minX, minY, maxX, maxY);
+		block.region = block.core;
+
+		blocks.push_back(block);
+
+		return blocks;
+	}
+
+	unsigned int y = 0;
+	for (int startY = minY; startY < maxY; startY += blockSize, y++) {
+
+		unsigned int x = 0;
+		for (int startX = minX; startX < maxX; startX += blockSize, x++) {
+
+			SubproblemBlock block;
+			block.x = x;
+			block.y = y;
+			block.core = util::rect<int>(
+					startX,
+					startY,
+					std::min(startX + blockSize, maxX),
+					std::min(startY + blockSize, maxY));
+			block.region = util::rect<int>(
+					block.core.minX - blockHalo,
+					block.core.minY - blockHalo,
+					block.core.maxX + blockHalo,
+					block.core.maxY + blockHalo);
+
+			blocks.push_back(block);
+		}
+	}
+
+	LOG_DEBUG(subproblemsextractorlog) << "using " << blocks.size() << " blocks in x and y" << std::endl;
+
+	return blocks;
 }
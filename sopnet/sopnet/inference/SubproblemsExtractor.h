@@ -17,6 +17,9 @@ private:
 
 	void updateOutputs();
 
+	// get the blocks in x and y to decompose each window of sections into
+	std::vector<SubproblemBlock> getBlocks();
+
 	pipeline::Input<LinearObjective>      _objective;
 	pipeline::Input<LinearConstraints>    _constraints;
 	pipeline::Input<ProblemConfiguration> _configuration;
@@ -1,11 +1,30 @@
+#include <boost/bind.hpp>
+#include <boost/timer/timer.hpp>
+
 #include <pipeline/Process.h>
 #include <pipeline/Value.h>
-
-#include <sopnet/io/SolutionReader.h>
-#include <sopnet/io/SubproblemsWriter.h>
+#include <inference/LinearSolver.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <sopnet/parallel.h>
 #include "SubproblemsSolver.h"
 
-SubproblemsSolver::SubproblemsSolver() {
+util::ProgramOption optionSubproblemsThreads(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "subproblemsThreads",
+		util::_description_text = "The number of subproblems to solve concurrently. The default (0) uses one per CPU.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionSubproblemsCacheFile(
+		util::_module           = "sopnet.inference",
+		util::_long_name        = "subproblemsCacheFile",
+		util::_description_text = "A file to keep the solutions of subproblems between runs. Unchanged subproblems are not solved again.");
+
+static logger::LogChannel subproblemssolverlog("subproblemssolverlog", "[SubproblemsSolver] ");
+
+SubproblemsSolver::SubproblemsSolver() :
+	_solution(new Solution()),
+	_cacheLoaded(false) {
 
 	registerInput(_subproblems, "subproblems");
 	registerOutput(_solution, "solution");
@@ -14,17 +33,119 @@ SubproblemsSolver::SubproblemsSolver() {
 void
 SubproblemsSolver::updateOutputs() {
 
-	std::string filename("subproblems.dat");
+	boost::timer::auto_cpu_timer timer("\tSubproblemsSolver::updateOutputs()\t%ws\n");
+
+	unsigned int numSubproblems = _subproblems->getNumSubproblems();
+
+	LOG_DEBUG(subproblemssolverlog) << "extracting " << numSubproblems << " subproblems" << std::endl;
+
+	if (!_cacheLoaded && optionSubproblemsCacheFile) {
+
+		_cache.load(optionSubproblemsCacheFile.as<std::string>());
+		_cacheLoaded = true;
+	}
+
+	_problems.resize(numSubproblems);
+	_subproblemSolutions.clear();
+	_subproblemSolutions.resize(numSubproblems);
+
+	for (unsigned int i = 0; i < numSubproblems; i++)
+		_problems[i] = _subproblems->extractProblem(i);
+
+	unsigned int numThreads = getNumWorkerThreads(optionSubproblemsThreads, numSubproblems);
+
+	// share the CPUs between the solvers of the workers
+	_threadsPerWorker = getThreadsPerWorker(numThreads);
+
+	LOG_DEBUG(subproblemssolverlog)
+			<< "solving subproblems with " << numThreads << " threads, "
+			<< _threadsPerWorker << " solver threads each" << std::endl;
+
+	parallelFor(
+			numThreads,
+			numSubproblems,
+			boost::bind(&SubproblemsSolver::solveSubproblem, this, _1));
+
+	mergeSolutions();
+
+	if (optionSubproblemsCacheFile)
+		_cache.save(optionSubproblemsCacheFile.as<std::string>());
+
+	_problems.clear();
+}
+
+void
+SubproblemsSolver::solveSubproblem(unsigned int i) {
+
+	LOG_DEBUG(subproblemssolverlog) << "solving subproblem " << i << std::endl;
+
+	try {
+
+		boost::shared_ptr<Problem> problem = _problems[i];
+
+		boost::uint64_t hash, check;
+		bool cacheable = SubproblemsCache::hashProblem(*problem, hash, check);
+
+		Solution cached;
+		if (cacheable && _cache.getSolution(hash, check, problem->getObjective()->size(), cached)) {
+
+			LOG_DEBUG(subproblemssolverlog) << "subproblem " << i << " did not change, using cached solution" << std::endl;
+
+			_subproblemSolutions[i] = cached.getVector();
+			return;
+		}
+
+		pipeline::Process<LinearSolver> solver;
+
+		Solution initial;
+		if (_cache.getInitialSolution(*problem, initial) > 0)
+			solver->setInitialSolution(initial);
+
+		boost::shared_ptr<LinearSolverParameters> parameters = boost::make_shared<LinearSolverParameters>(Binary);
+		parameters->setNumThreads(_threadsPerWorker);
+
+		solver->setInput("objective", problem->getObjective());
+		solver->setInput("linear constraints", problem->getLinearConstraints());
+		solver->setInput("parameters", parameters);
+
+		pipeline::Value<Solution> solution = solver->getOutput("solution");
+
+		_subproblemSolutions[i] = solution->getVector();
+
+		// don't remember failed or time-limited solves, they would never be 
+		// retried
+		if (cacheable && solver->isOptimal())
+			_cache.setSolution(hash, check, *problem, *solution);
+
+	} catch (boost::exception& e) {
+
+		LOG_ERROR(subproblemssolverlog) << "failed to solve subproblem " << i << std::endl;
+
+		if (boost::get_error_info<error_message>(e))
+			LOG_ERROR(subproblemssolverlog) << *boost::get_error_info<error_message>(e) << std::endl;
+	}
+}
+
+void
+SubproblemsSolver::mergeSolutions() {
+
+	unsigned int numVariables = _subproblems->getProblem()->getObjective()->size();
+
+	_solution->getVector().assign(numVariables, 0);
 
-	pipeline::Process<SubproblemsWriter> writer(filename);
+	for (unsigned int i = 0; i < _subproblemSolutions.size(); i++) {
 
-	writer->setInput(_subproblems);
-	writer->write();
+		const std::vector<unsigned int>& variables = _subproblems->getSubproblemVariables(i);
+		const std::vector<double>&       solution  = _subproblemSolutions[i];
 
-	// TODO: call scalar
+		if (solution.size() < variables.size()) {
 
-	pipeline::Process<SolutionReader> reader(filename);
-	pipeline::Value<Solution> solution = reader->getOutput();
+			LOG_ERROR(subproblemssolverlog) << "no solution for subproblem " << i << std::endl;
+			continue;
+		}
 
-	_solution = solution;
+		for (unsigned int j = 0; j < variables.size(); j++)
+			if (_subproblems->getVariableOwner(variables[j]) == i)
+				(*_solution)[variables[j]] = solution[j];
+	}
 }
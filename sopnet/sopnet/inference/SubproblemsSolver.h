@@ -4,9 +4,15 @@
 #include <pipeline/SimpleProcessNode.h>
 #include <inference/Solution.h>
 #include "Subproblems.h"
+#include "SubproblemsCache.h"
 
 /**
- * Given a list of subproblems, invoces SCALAR to find a consistent solution.
+ * Given a list of subproblems, finds a solution for the working problem. 
+ * Subproblems are solved independently and concurrently, each variable gets 
+ * the value it has in the subproblem that owns it (see 
+ * Subproblems::getVariableOwner()). Solutions of subproblems are cached, such 
+ * that unchanged subproblems are not solved again and changed ones are 
+ * warm-started (see SubproblemsCache).
  */
 class SubproblemsSolver : public pipeline::SimpleProcessNode<> {
 
@@ -18,8 +24,28 @@ private:
 
 	void updateOutputs();
 
+	// solve subproblem i, called concurrently by the workers
+	void solveSubproblem(unsigned int i);
+
+	// combine the subproblem solutions into the working problem solution
+	void mergeSolutions();
+
 	pipeline::Input<Subproblems> _subproblems;
 	pipeline::Output<Solution>   _solution;
+
+	// the stand-alone problems for each subproblem
+	std::vector<boost::shared_ptr<Problem> > _problems;
+
+	// the solutions of each subproblem
+	std::vector<std::vector<double> > _subproblemSolutions;
+
+	// solutions of previously solved subproblems
+	SubproblemsCache _cache;
+
+	bool _cacheLoaded;
+
+	// the number of threads the solver of each worker can use
+	unsigned int _threadsPerWorker;
 };
 
 #endif // SOPNET_INFERENCE_SUBPROBLEMS_SOLVER_H__
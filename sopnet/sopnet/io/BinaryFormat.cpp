@@ -0,0 +1,314 @@
+#include <fstream>
+
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "BinaryFormat.h"
+
+logger::LogChannel binaryformatlog("binaryformatlog", "[BinaryFormat] ");
+
+namespace {
+
+static const char Magic[8] = { 'S', 'O', 'P', 'N', 'E', 'T', 'B', 'F' };
+
+struct Header {
+
+	char            magic[8];
+	boost::uint32_t version;
+	boost::uint32_t content;
+	boost::uint64_t payloadSize;
+	boost::uint64_t reserved;
+};
+
+// 64 bit FNV-1a hash
+boost::uint64_t checksum(const std::vector<char>& data) {
+
+	boost::uint64_t hash = 14695981039346656037ULL;
+
+	foreach (char c, data) {
+
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+} // anonymous namespace
+
+BinaryWriter::BinaryWriter(BinaryContent content) :
+	_content(content) {}
+
+void
+BinaryWriter::append(const void* data, std::size_t size) {
+
+	const char* begin = static_cast<const char*>(data);
+	_payload.insert(_payload.end(), begin, begin + size);
+}
+
+void
+BinaryWriter::pad() {
+
+	_payload.resize((_payload.size() + 7)/8*8, 0);
+}
+
+void
+BinaryWriter::writeProblem(Problem& problem) {
+
+	const LinearObjective&   objective     = *problem.getObjective();
+	const LinearConstraints& constraints   = *problem.getLinearConstraints();
+	ProblemConfiguration&    configuration = *problem.getConfiguration();
+
+	unsigned int numVariables = objective.size();
+
+	std::vector<boost::uint32_t> segmentIds(numVariables);
+	for (unsigned int i = 0; i < numVariables; i++)
+		segmentIds[i] = configuration.getSegmentId(i);
+
+	// the segment hashes identify the problem in the SubproblemsCache, they 
+	// are only written if all variables have one
+	std::vector<boost::uint64_t> segmentHashes;
+	for (unsigned int i = 0; i < numVariables; i++) {
+
+		if (!configuration.hasSegmentHash(i)) {
+
+			segmentHashes.clear();
+			break;
+		}
+
+		segmentHashes.push_back(configuration.getSegmentHash(i));
+	}
+
+	writeArray(segmentIds);
+	writeArray(segmentHashes);
+	writeArray(objective.getCoefficients());
+	writeValue<boost::uint32_t>(objective.getSense());
+	writeValue<double>(objective.getConstant());
+
+	writeConstraints(constraints);
+}
+
+void
+BinaryWriter::writeConstraints(const LinearConstraints& constraints) {
+
+	std::vector<boost::uint32_t> rowStarts;
+	std::vector<boost::uint32_t> varNums;
+	std::vector<double>          coefs;
+	std::vector<boost::uint8_t>  relations;
+	std::vector<double>          values;
+
+	rowStarts.reserve(constraints.size() + 1);
+	relations.reserve(constraints.size());
+	values.reserve(constraints.size());
+
+	foreach (const LinearConstraint& constraint, constraints) {
+
+		rowStarts.push_back(varNums.size());
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients()) {
+
+			varNums.push_back(varNum);
+			coefs.push_back(coef);
+		}
+
+		relations.push_back(constraint.getRelation());
+		values.push_back(constraint.getValue());
+	}
+
+	rowStarts.push_back(varNums.size());
+
+	writeArray(rowStarts);
+	writeArray(varNums);
+	writeArray(coefs);
+	writeArray(relations);
+	writeArray(values);
+}
+
+void
+BinaryWriter::writeSolution(const Solution& solution, ProblemConfiguration& configuration) {
+
+	std::vector<boost::uint32_t> segmentIds(solution.size());
+	for (unsigned int i = 0; i < solution.size(); i++)
+		segmentIds[i] = configuration.getSegmentId(i);
+
+	writeArray(segmentIds);
+	writeArray(solution.getVector());
+}
+
+void
+BinaryWriter::write(const std::string& filename) {
+
+	Header header;
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version     = BinaryFormatVersion;
+	header.content     = _content;
+	header.payloadSize = _payload.size();
+	header.reserved    = 0;
+
+	boost::uint64_t sum = checksum(_payload);
+
+	std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	if (!_payload.empty())
+		out.write(&_payload[0], _payload.size());
+	out.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
+
+	if (!out.good())
+		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("could not write to ") + filename) << STACK_TRACE);
+
+	LOG_DEBUG(binaryformatlog) << "wrote " << _payload.size() << " bytes to " << filename << std::endl;
+}
+
+BinaryReader::BinaryReader(const std::string& filename, BinaryContent content) :
+	_filename(filename),
+	_pos(0) {
+
+	std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("could not open ") + filename) << STACK_TRACE);
+
+	Header header;
+	in.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+	if (!in.good() || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(filename + " is not a sopnet binary file") << STACK_TRACE);
+
+	if (header.version != BinaryFormatVersion)
+		BOOST_THROW_EXCEPTION(
+				BinaryFormatError()
+				<< error_message(
+						filename + " has version " +
+						boost::lexical_cast<std::string>(header.version) + ", expected " +
+						boost::lexical_cast<std::string>(BinaryFormatVersion))
+				<< STACK_TRACE);
+
+	if (header.content != static_cast<boost::uint32_t>(content))
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(filename + " has unexpected content") << STACK_TRACE);
+
+	_payload.resize(header.payloadSize);
+	if (header.payloadSize > 0)
+		in.read(&_payload[0], header.payloadSize);
+
+	boost::uint64_t sum;
+	in.read(reinterpret_cast<char*>(&sum), sizeof(sum));
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(filename + " is truncated") << STACK_TRACE);
+
+	if (sum != checksum(_payload))
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(filename + " has a wrong checksum") << STACK_TRACE);
+
+	LOG_DEBUG(binaryformatlog) << "read " << _payload.size() << " bytes from " << filename << std::endl;
+}
+
+void
+BinaryReader::extract(void* data, std::size_t size) {
+
+	if (size > _payload.size() - _pos)
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("unexpected end of payload in ") + _filename) << STACK_TRACE);
+
+	std::memcpy(data, &_payload[_pos], size);
+	_pos += size;
+}
+
+void
+BinaryReader::skipPadding() {
+
+	_pos = std::min(_payload.size(), (_pos + 7)/8*8);
+}
+
+boost::shared_ptr<Problem>
+BinaryReader::readProblem() {
+
+	std::vector<boost::uint32_t> segmentIds;
+	std::vector<boost::uint64_t> segmentHashes;
+	std::vector<double>          costs;
+
+	readArray(segmentIds);
+	readArray(segmentHashes);
+	readArray(costs);
+
+	Sense  sense    = static_cast<Sense>(readValue<boost::uint32_t>());
+	double constant = readValue<double>();
+
+	if (costs.size() != segmentIds.size() || (!segmentHashes.empty() && segmentHashes.size() != segmentIds.size()))
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("inconsistent number of variables in ") + _filename) << STACK_TRACE);
+
+	if (segmentHashes.empty() && !costs.empty())
+		LOG_DEBUG(binaryformatlog) << "problem in " << _filename << " has no segment hashes, its solutions will not be cached" << std::endl;
+
+	boost::shared_ptr<Problem> problem = boost::make_shared<Problem>(costs.size());
+
+	for (unsigned int i = 0; i < costs.size(); i++) {
+
+		problem->getObjective()->setCoefficient(i, costs[i]);
+		problem->getConfiguration()->setVariable(segmentIds[i], i);
+
+		if (!segmentHashes.empty())
+			problem->getConfiguration()->setSegmentHash(i, segmentHashes[i]);
+	}
+
+	problem->getObjective()->setSense(sense);
+	problem->getObjective()->setConstant(constant);
+
+	readConstraints(*problem->getLinearConstraints());
+
+	problem->getLinearConstraints()->registerVariables(costs.size());
+
+	return problem;
+}
+
+void
+BinaryReader::readConstraints(LinearConstraints& constraints) {
+
+	std::vector<boost::uint32_t> rowStarts;
+	std::vector<boost::uint32_t> varNums;
+	std::vector<double>          coefs;
+	std::vector<boost::uint8_t>  relations;
+	std::vector<double>          values;
+
+	readArray(rowStarts);
+	readArray(varNums);
+	readArray(coefs);
+	readArray(relations);
+	readArray(values);
+
+	unsigned int numConstraints = relations.size();
+
+	if (rowStarts.size() != numConstraints + 1 || values.size() != numConstraints || coefs.size() != varNums.size())
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("inconsistent constraints in ") + _filename) << STACK_TRACE);
+
+	for (unsigned int i = 0; i < numConstraints; i++) {
+
+		if (rowStarts[i] > rowStarts[i+1] || rowStarts[i+1] > varNums.size())
+			BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("invalid row starts in ") + _filename) << STACK_TRACE);
+
+		LinearConstraint constraint;
+
+		for (unsigned int j = rowStarts[i]; j < rowStarts[i+1]; j++)
+			constraint.setCoefficient(varNums[j], coefs[j]);
+
+		constraint.setRelation(static_cast<Relation>(relations[i]));
+		constraint.setValue(values[i]);
+
+		constraints.add(constraint);
+	}
+}
+
+void
+BinaryReader::readSolution(Solution& solution, ProblemConfiguration& configuration) {
+
+	std::vector<boost::uint32_t> segmentIds;
+
+	readArray(segmentIds);
+	readArray(solution.getVector());
+
+	if (segmentIds.size() != solution.size())
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("inconsistent solution size in ") + _filename) << STACK_TRACE);
+
+	for (unsigned int i = 0; i < segmentIds.size(); i++)
+		configuration.setVariable(segmentIds[i], i);
+}
@@ -0,0 +1,198 @@
+#ifndef SOPNET_IO_BINARY_FORMAT_H__
+#define SOPNET_IO_BINARY_FORMAT_H__
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <util/exceptions.h>
+#include <inference/Solution.h>
+#include <sopnet/inference/Problem.h>
+
+/**
+ * Building blocks of the binary exchange format for problems, subproblems, and
+ * solutions (see BINARY_PROTOCOL).
+ *
+ * A file consists of a 32 byte header, the payload, and a 64 bit checksum of
+ * the payload. All values are stored in native byte order. Arrays are prefixed
+ * with their length as a 64 bit integer and padded to a multiple of 8 bytes,
+ * such that every array starts 8-byte aligned in the file and can be used in
+ * place if the file is memory-mapped.
+ */
+
+struct BinaryFormatError : virtual IOError {};
+
+enum BinaryContent {
+
+	BinaryProblems    = 1,
+	BinarySubproblems = 2,
+	BinarySolutions   = 3,
+	BinaryGroundTruth = 5
+};
+
+/**
+ * The version of the binary format written by BinaryWriter. Bump this
+ * whenever the layout changes.
+ */
+static const boost::uint32_t BinaryFormatVersion = 2;
+
+/**
+ * Marks variables without owning subproblem.
+ */
+static const boost::uint32_t NoOwner = 0xffffffff;
+
+/**
+ * Collects the payload of a binary file and writes it together with header
+ * and checksum.
+ */
+class BinaryWriter {
+
+public:
+
+	BinaryWriter(BinaryContent content);
+
+	/**
+	 * Append a single value, padded to 8 bytes.
+	 */
+	template <typename T>
+	void writeValue(const T& value) {
+
+		append(&value, sizeof(T));
+		pad();
+	}
+
+	/**
+	 * Append a length-prefixed, padded array.
+	 */
+	template <typename T>
+	void writeArray(const std::vector<T>& data) {
+
+		writeValue<boost::uint64_t>(data.size());
+
+		if (!data.empty())
+			append(&data[0], data.size()*sizeof(T));
+
+		pad();
+	}
+
+	/**
+	 * Append a problem: segment ids, objective, and constraints in compressed
+	 * sparse row form.
+	 */
+	void writeProblem(Problem& problem);
+
+	/**
+	 * Append linear constraints in compressed sparse row form.
+	 */
+	void writeConstraints(const LinearConstraints& constraints);
+
+	/**
+	 * Append a solution with the segment ids of its variables.
+	 */
+	void writeSolution(const Solution& solution, ProblemConfiguration& configuration);
+
+	/**
+	 * Write header, payload, and checksum to a file.
+	 */
+	void write(const std::string& filename);
+
+private:
+
+	void append(const void* data, std::size_t size);
+
+	void pad();
+
+	BinaryContent     _content;
+	std::vector<char> _payload;
+};
+
+/**
+ * Reads a binary file, verifies its header and checksum, and provides
+ * sequential access to the payload.
+ */
+class BinaryReader {
+
+public:
+
+	/**
+	 * Read and verify a file.
+	 *
+	 * @param filename
+	 *              The file to read.
+	 *
+	 * @param content
+	 *              The expected content of the file.
+	 */
+	BinaryReader(const std::string& filename, BinaryContent content);
+
+	template <typename T>
+	T readValue() {
+
+		T value;
+		extract(&value, sizeof(T));
+		skipPadding();
+
+		return value;
+	}
+
+	template <typename T>
+	void readArray(std::vector<T>& data) {
+
+		boost::uint64_t size = readValue<boost::uint64_t>();
+
+		// compare element counts, size*sizeof(T) can overflow
+		if (size > (_payload.size() - _pos)/sizeof(T))
+			BOOST_THROW_EXCEPTION(
+					BinaryFormatError()
+					<< error_message(
+							std::string("array of size ") +
+							boost::lexical_cast<std::string>(size) +
+							" exceeds payload")
+					<< STACK_TRACE);
+
+		data.resize(size);
+
+		if (size > 0)
+			extract(&data[0], size*sizeof(T));
+
+		skipPadding();
+	}
+
+	/**
+	 * Read a problem written by BinaryWriter::writeProblem().
+	 */
+	boost::shared_ptr<Problem> readProblem();
+
+	/**
+	 * Read linear constraints written by BinaryWriter::writeConstraints().
+	 */
+	void readConstraints(LinearConstraints& constraints);
+
+	/**
+	 * Read a solution written by BinaryWriter::writeSolution().
+	 *
+	 * @param solution
+	 *              [out] The solution.
+	 *
+	 * @param configuration
+	 *              [out] The mapping of the solution's variables to segment
+	 *              ids.
+	 */
+	void readSolution(Solution& solution, ProblemConfiguration& configuration);
+
+private:
+
+	void extract(void* data, std::size_t size);
+
+	void skipPadding();
+
+	std::string       _filename;
+	std::vector<char> _payload;
+	std::size_t       _pos;
+};
+
+#endif // SOPNET_IO_BINARY_FORMAT_H__
+
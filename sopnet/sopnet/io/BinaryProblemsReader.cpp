@@ -0,0 +1,27 @@
+#include <util/Logger.h>
+#include "BinaryFormat.h"
+#include "BinaryProblemsReader.h"
+
+logger::LogChannel binaryproblemsreaderlog("binaryproblemsreaderlog", "[BinaryProblemsReader] ");
+
+BinaryProblemsReader::BinaryProblemsReader(const std::string& filename) :
+	_problems(new Problems()),
+	_filename(filename) {
+
+	registerOutput(_problems, "problems");
+}
+
+void
+BinaryProblemsReader::updateOutputs() {
+
+	_problems->clear();
+
+	BinaryReader reader(_filename, BinaryProblems);
+
+	boost::uint64_t numProblems = reader.readValue<boost::uint64_t>();
+
+	LOG_DEBUG(binaryproblemsreaderlog) << "reading " << numProblems << " problems" << std::endl;
+
+	for (boost::uint64_t i = 0; i < numProblems; i++)
+		_problems->addProblem(reader.readProblem());
+}
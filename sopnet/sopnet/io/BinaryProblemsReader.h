@@ -0,0 +1,26 @@
+#ifndef SOPNET_IO_BINARY_PROBLEMS_READER_H__
+#define SOPNET_IO_BINARY_PROBLEMS_READER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+
+/**
+ * Reads problems in the binary exchange format (see BINARY_PROTOCOL).
+ */
+class BinaryProblemsReader : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinaryProblemsReader(const std::string& filename);
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Output<Problems> _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_PROBLEMS_READER_H__
+
@@ -0,0 +1,26 @@
+#include "BinaryFormat.h"
+#include "BinaryProblemsWriter.h"
+
+BinaryProblemsWriter::BinaryProblemsWriter(const std::string& filename) :
+	_filename(filename) {
+
+	registerInput(_problems, "problems");
+}
+
+void
+BinaryProblemsWriter::write(std::string filename) {
+
+	if (filename == "")
+		filename = _filename;
+
+	updateInputs();
+
+	BinaryWriter writer(BinaryProblems);
+
+	writer.writeValue<boost::uint64_t>(_problems->size());
+
+	foreach (boost::shared_ptr<Problem> problem, *_problems)
+		writer.writeProblem(*problem);
+
+	writer.write(filename);
+}
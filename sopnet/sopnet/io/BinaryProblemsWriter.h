@@ -0,0 +1,31 @@
+#ifndef SOPNET_IO_BINARY_PROBLEMS_WRITER_H__
+#define SOPNET_IO_BINARY_PROBLEMS_WRITER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+
+/**
+ * Writes problems in the binary exchange format (see BINARY_PROTOCOL).
+ */
+class BinaryProblemsWriter : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinaryProblemsWriter(const std::string& filename);
+
+	/**
+	 * Update the inputs and write the problems.
+	 */
+	void write(std::string filename = "");
+
+private:
+
+	void updateOutputs() {}
+
+	pipeline::Input<Problems> _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_PROBLEMS_WRITER_H__
+
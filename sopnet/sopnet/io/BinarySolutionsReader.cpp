@@ -0,0 +1,33 @@
+#include "BinaryFormat.h"
+#include "BinarySolutionsReader.h"
+
+BinarySolutionsReader::BinarySolutionsReader(const std::string& filename) :
+	_solutions(new Solutions()),
+	_problems(new Problems()),
+	_filename(filename) {
+
+	registerOutput(_solutions, "solutions");
+	registerOutput(_problems,  "problems");
+}
+
+void
+BinarySolutionsReader::updateOutputs() {
+
+	_solutions->clear();
+	_problems->clear();
+
+	BinaryReader reader(_filename, BinarySolutions);
+
+	boost::uint64_t numSolutions = reader.readValue<boost::uint64_t>();
+
+	for (boost::uint64_t i = 0; i < numSolutions; i++) {
+
+		boost::shared_ptr<Solution> solution = boost::make_shared<Solution>();
+		boost::shared_ptr<Problem>  problem  = boost::make_shared<Problem>();
+
+		reader.readSolution(*solution, *problem->getConfiguration());
+
+		_solutions->addSolution(solution);
+		_problems->addProblem(problem);
+	}
+}
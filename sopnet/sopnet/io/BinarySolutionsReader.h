@@ -0,0 +1,31 @@
+#ifndef SOPNET_IO_BINARY_SOLUTIONS_READER_H__
+#define SOPNET_IO_BINARY_SOLUTIONS_READER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+#include <sopnet/inference/Solutions.h>
+
+/**
+ * Reads solutions in the binary exchange format (see BINARY_PROTOCOL). Next 
+ * to the solutions, provides a problem for each solution whose configuration 
+ * maps the solution's variables to segment ids (objective and constraints are 
+ * left empty).
+ */
+class BinarySolutionsReader : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinarySolutionsReader(const std::string& filename);
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Output<Solutions> _solutions;
+	pipeline::Output<Problems>  _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_SOLUTIONS_READER_H__
+
@@ -0,0 +1,27 @@
+#include "BinaryFormat.h"
+#include "BinarySolutionsWriter.h"
+
+BinarySolutionsWriter::BinarySolutionsWriter(const std::string& filename) :
+	_filename(filename) {
+
+	registerInput(_solutions, "solutions");
+	registerInput(_problems,  "problems");
+}
+
+void
+BinarySolutionsWriter::write(std::string filename) {
+
+	if (filename == "")
+		filename = _filename;
+
+	updateInputs();
+
+	BinaryWriter writer(BinarySolutions);
+
+	writer.writeValue<boost::uint64_t>(_solutions->size());
+
+	for (unsigned int i = 0; i < _solutions->size(); i++)
+		writer.writeSolution(*_solutions->getSolution(i), *_problems->getProblem(i)->getConfiguration());
+
+	writer.write(filename);
+}
@@ -0,0 +1,34 @@
+#ifndef SOPNET_IO_BINARY_SOLUTIONS_WRITER_H__
+#define SOPNET_IO_BINARY_SOLUTIONS_WRITER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+#include <sopnet/inference/Solutions.h>
+
+/**
+ * Writes solutions in the binary exchange format (see BINARY_PROTOCOL). The 
+ * problems are needed to store the segment ids of the solutions' variables.
+ */
+class BinarySolutionsWriter : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinarySolutionsWriter(const std::string& filename);
+
+	/**
+	 * Update the inputs and write the solutions.
+	 */
+	void write(std::string filename = "");
+
+private:
+
+	void updateOutputs() {}
+
+	pipeline::Input<Solutions> _solutions;
+	pipeline::Input<Problems>  _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_SOLUTIONS_WRITER_H__
+
@@ -0,0 +1,69 @@
+#include "BinaryFormat.h"
+#include "BinarySubproblemsReader.h"
+
+BinarySubproblemsReader::BinarySubproblemsReader(const std::string& filename) :
+	_subproblems(new Subproblems()),
+	_filename(filename) {
+
+	registerOutput(_subproblems, "subproblems");
+}
+
+void
+BinarySubproblemsReader::updateOutputs() {
+
+	_subproblems->clear();
+
+	BinaryReader reader(_filename, BinarySubproblems);
+
+	boost::shared_ptr<Problem> problem = reader.readProblem();
+	_subproblems->setProblem(problem);
+
+	unsigned int numSubproblems = reader.readValue<boost::uint64_t>();
+
+	std::vector<boost::uint32_t> variableStarts;
+	std::vector<boost::uint32_t> variables;
+	std::vector<boost::uint32_t> constraintStarts;
+	std::vector<boost::uint32_t> constraints;
+	std::vector<boost::uint32_t> owners;
+	std::vector<boost::int32_t>  blocks;
+
+	reader.readArray(variableStarts);
+	reader.readArray(variables);
+	reader.readArray(constraintStarts);
+	reader.readArray(constraints);
+	reader.readArray(owners);
+	reader.readArray(blocks);
+
+	if (variableStarts.size() != numSubproblems + 1 ||
+	    constraintStarts.size() != numSubproblems + 1 ||
+	    variableStarts.back() != variables.size() ||
+	    constraintStarts.back() != constraints.size() ||
+	    blocks.size() != 13*numSubproblems)
+		BOOST_THROW_EXCEPTION(BinaryFormatError() << error_message(std::string("inconsistent subproblems in ") + _filename) << STACK_TRACE);
+
+	for (unsigned int s = 0; s < numSubproblems; s++) {
+
+		for (unsigned int i = variableStarts[s]; i < variableStarts[s+1]; i++)
+			_subproblems->assignVariable(variables[i], s);
+
+		for (unsigned int i = constraintStarts[s]; i < constraintStarts[s+1]; i++)
+			_subproblems->assignConstraint(constraints[i], s);
+
+		const boost::int32_t* values = &blocks[13*s];
+
+		SubproblemBlock block;
+		block.x = values[0];
+		block.y = values[1];
+		block.z = values[2];
+		block.minInterSectionInterval = values[3];
+		block.maxInterSectionInterval = values[4];
+		block.region = util::rect<int>(values[5], values[6], values[7], values[8]);
+		block.core   = util::rect<int>(values[9], values[10], values[11], values[12]);
+
+		_subproblems->setBlock(s, block);
+	}
+
+	for (unsigned int i = 0; i < owners.size(); i++)
+		if (owners[i] != NoOwner)
+			_subproblems->setVariableOwner(i, owners[i]);
+}
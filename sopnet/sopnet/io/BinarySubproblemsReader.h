@@ -0,0 +1,27 @@
+#ifndef SOPNET_IO_BINARY_SUBPROBLEMS_READER_H__
+#define SOPNET_IO_BINARY_SUBPROBLEMS_READER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Subproblems.h>
+
+/**
+ * Reads subproblems together with their working problem in the binary 
+ * exchange format (see BINARY_PROTOCOL).
+ */
+class BinarySubproblemsReader : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinarySubproblemsReader(const std::string& filename);
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Output<Subproblems> _subproblems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_SUBPROBLEMS_READER_H__
+
@@ -0,0 +1,83 @@
+#include "BinaryFormat.h"
+#include "BinarySubproblemsWriter.h"
+
+BinarySubproblemsWriter::BinarySubproblemsWriter(const std::string& filename) :
+	_filename(filename) {
+
+	registerInput(_subproblems, "subproblems");
+}
+
+void
+BinarySubproblemsWriter::write(std::string filename) {
+
+	if (filename == "")
+		filename = _filename;
+
+	updateInputs();
+
+	BinaryWriter writer(BinarySubproblems);
+
+	boost::shared_ptr<Problem> problem = _subproblems->getProblem();
+
+	writer.writeProblem(*problem);
+
+	unsigned int numSubproblems = _subproblems->getNumSubproblems();
+	unsigned int numVariables   = problem->getObjective()->size();
+
+	writer.writeValue<boost::uint64_t>(numSubproblems);
+
+	// variables and constraints of each subproblem in compressed sparse row 
+	// form, variables in the order of their subproblem variable numbers
+	std::vector<boost::uint32_t> variableStarts;
+	std::vector<boost::uint32_t> variables;
+	std::vector<boost::uint32_t> constraintStarts;
+	std::vector<boost::uint32_t> constraints;
+
+	// for each subproblem: grid coordinates, inter-section intervals, region, 
+	// and core
+	std::vector<boost::int32_t> blocks;
+
+	for (unsigned int s = 0; s < numSubproblems; s++) {
+
+		variableStarts.push_back(variables.size());
+		foreach (unsigned int variable, _subproblems->getSubproblemVariables(s))
+			variables.push_back(variable);
+
+		constraintStarts.push_back(constraints.size());
+		foreach (unsigned int constraint, _subproblems->getSubproblemConstraints(s))
+			constraints.push_back(constraint);
+
+		const SubproblemBlock& block = _subproblems->getBlock(s);
+		blocks.push_back(block.x);
+		blocks.push_back(block.y);
+		blocks.push_back(block.z);
+		blocks.push_back(block.minInterSectionInterval);
+		blocks.push_back(block.maxInterSectionInterval);
+		blocks.push_back(block.region.minX);
+		blocks.push_back(block.region.minY);
+		blocks.push_back(block.region.maxX);
+		blocks.push_back(block.region.maxY);
+		blocks.push_back(block.core.minX);
+		blocks.push_back(block.core.minY);
+		blocks.push_back(block.core.maxX);
+		blocks.push_back(block.core.maxY);
+	}
+
+	variableStarts.push_back(variables.size());
+	constraintStarts.push_back(constraints.size());
+
+	// the owning subproblem of each variable
+	std::vector<boost::uint32_t> owners(numVariables, NoOwner);
+	for (unsigned int i = 0; i < numVariables; i++)
+		if (!_subproblems->getVariableSubproblems(i).empty())
+			owners[i] = _subproblems->getVariableOwner(i);
+
+	writer.writeArray(variableStarts);
+	writer.writeArray(variables);
+	writer.writeArray(constraintStarts);
+	writer.writeArray(constraints);
+	writer.writeArray(owners);
+	writer.writeArray(blocks);
+
+	writer.write(filename);
+}
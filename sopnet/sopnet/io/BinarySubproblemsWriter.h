@@ -0,0 +1,32 @@
+#ifndef SOPNET_IO_BINARY_SUBPROBLEMS_WRITER_H__
+#define SOPNET_IO_BINARY_SUBPROBLEMS_WRITER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Subproblems.h>
+
+/**
+ * Writes subproblems together with their working problem in the binary 
+ * exchange format (see BINARY_PROTOCOL).
+ */
+class BinarySubproblemsWriter : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	BinarySubproblemsWriter(const std::string& filename);
+
+	/**
+	 * Update the inputs and write the subproblems.
+	 */
+	void write(std::string filename = "");
+
+private:
+
+	void updateOutputs() {}
+
+	pipeline::Input<Subproblems> _subproblems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_BINARY_SUBPROBLEMS_WRITER_H__
+
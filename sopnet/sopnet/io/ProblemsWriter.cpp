@@ -0,0 +1,80 @@
+#include <fstream>
+
+#include <util/exceptions.h>
+#include <util/foreach.h>
+#include "ProblemsWriter.h"
+
+ProblemsWriter::ProblemsWriter(const std::string& filename) :
+	_filename(filename) {
+
+	registerInput(_problems, "problems");
+}
+
+void
+ProblemsWriter::write(std::string filename) {
+
+	if (filename == "")
+		filename = _filename;
+
+	updateInputs();
+
+	std::ofstream out(filename.c_str());
+
+	out << _problems->size() << std::endl;
+
+	foreach (boost::shared_ptr<Problem> problem, *_problems)
+		writeProblem(out, *problem);
+}
+
+void
+ProblemsWriter::writeProblem(std::ostream& out, Problem& problem) {
+
+	const LinearObjective&   objective     = *problem.getObjective();
+	const LinearConstraints& constraints   = *problem.getLinearConstraints();
+	ProblemConfiguration&    configuration = *problem.getConfiguration();
+
+	out << objective.size() << std::endl;
+
+	for (unsigned int i = 0; i < objective.size(); i++)
+		out << configuration.getSegmentId(i) << " " << objective.getCoefficients()[i] << std::endl;
+
+	out << constraints.size() << std::endl;
+
+	foreach (const LinearConstraint& constraint, constraints) {
+
+		// the relation is written as value rel term
+		out << constraint.getValue();
+
+		switch (constraint.getRelation()) {
+
+			case LessEqual:
+				out << " >= ";
+				break;
+			case GreaterEqual:
+				out << " <= ";
+				break;
+			case Equal:
+				out << " == ";
+				break;
+		}
+
+		out << constraint.getCoefficients().size();
+
+		unsigned int varNum;
+		double coef;
+		foreach (boost::tie(varNum, coef), constraint.getCoefficients()) {
+
+			if (coef == 1)
+				out << " " << configuration.getSegmentId(varNum);
+			else if (coef == -1)
+				out << " -" << configuration.getSegmentId(varNum);
+			else
+				BOOST_THROW_EXCEPTION(
+						IOError()
+						<< error_message("text protocol supports only coefficients of 1 and -1")
+						<< STACK_TRACE);
+		}
+
+		out << std::endl;
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef SOPNET_IO_PROBLEMS_WRITER_H__
+#define SOPNET_IO_PROBLEMS_WRITER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+
+/**
+ * Writes problems in the text format read by ProblemsReader (see 
+ * SUBPROBLEM_PROTOCOL). Only constraints with coefficients of 1 and -1 can be 
+ * represented.
+ */
+class ProblemsWriter : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	ProblemsWriter(const std::string& filename);
+
+	/**
+	 * Update the inputs and write the problems.
+	 */
+	void write(std::string filename = "");
+
+private:
+
+	void updateOutputs() {}
+
+	void writeProblem(std::ostream& out, Problem& problem);
+
+	pipeline::Input<Problems> _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_PROBLEMS_WRITER_H__
+
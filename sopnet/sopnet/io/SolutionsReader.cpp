@@ -0,0 +1,53 @@
+#include <fstream>
+
+#include <util/exceptions.h>
+#include "SolutionsReader.h"
+
+SolutionsReader::SolutionsReader(const std::string& filename) :
+	_solutions(new Solutions()),
+	_problems(new Problems()),
+	_filename(filename) {
+
+	registerOutput(_solutions, "solutions");
+	registerOutput(_problems,  "problems");
+}
+
+void
+SolutionsReader::updateOutputs() {
+
+	_solutions->clear();
+	_problems->clear();
+
+	std::ifstream in(_filename.c_str());
+
+	if (!in.good())
+		BOOST_THROW_EXCEPTION(IOError() << error_message(std::string("could not open ") + _filename) << STACK_TRACE);
+
+	unsigned int numSolutions;
+	in >> numSolutions;
+
+	for (unsigned int i = 0; i < numSolutions && in.good(); i++) {
+
+		unsigned int numSegments;
+		in >> numSegments;
+
+		// all segments in the solution are selected
+		boost::shared_ptr<Solution> solution = boost::make_shared<Solution>(numSegments);
+		boost::shared_ptr<Problem>  problem  = boost::make_shared<Problem>();
+
+		for (unsigned int j = 0; j < numSegments; j++) {
+
+			unsigned int segmentId;
+			in >> segmentId;
+
+			(*solution)[j] = 1;
+			problem->getConfiguration()->setVariable(segmentId, j);
+		}
+
+		_solutions->addSolution(solution);
+		_problems->addProblem(problem);
+	}
+
+	if (in.fail())
+		BOOST_THROW_EXCEPTION(IOError() << error_message(_filename + " is not a valid solutions file") << STACK_TRACE);
+}
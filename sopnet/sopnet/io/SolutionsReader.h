@@ -0,0 +1,31 @@
+#ifndef SOPNET_IO_SOLUTIONS_READER_H__
+#define SOPNET_IO_SOLUTIONS_READER_H__
+
+#include <pipeline/SimpleProcessNode.h>
+#include <sopnet/inference/Problems.h>
+#include <sopnet/inference/Solutions.h>
+
+/**
+ * Reads solutions in the text format written by SolutionsWriter, i.e., the ids 
+ * of the selected segments for each solution. Next to the solutions, provides 
+ * a problem for each solution whose configuration maps the solution's 
+ * variables to segment ids.
+ */
+class SolutionsReader : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	SolutionsReader(const std::string& filename);
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Output<Solutions> _solutions;
+	pipeline::Output<Problems>  _problems;
+
+	std::string _filename;
+};
+
+#endif // SOPNET_IO_SOLUTIONS_READER_H__
+
@@ -108,4 +108,6 @@ SolutionsWriter::writeSolution(const Solution& solution, ProblemConfiguration& c
 		if (solution[i] == 1)
 			*_stream << " " << configuration.getSegmentId(i);
 	}
+
+	*_stream << std::endl;
 }
@@ -20,7 +20,9 @@ SubproblemsWriter::write(std::string filename) {
 	boost::shared_ptr<Problem> problem = _subproblems->getProblem();
 
 	unsigned int numVars = problem->getObjective()->size();
-	unsigned int numConstraints = problem->getLinearConstraints()->size();
+	const LinearConstraints& constraints = *problem->getLinearConstraints();
+
+	unsigned int numConstraints = constraints.size();
 	unsigned int numFunctions = numVars + numConstraints;
 
 	//////////////////////
@@ -42,7 +44,7 @@ SubproblemsWriter::write(std::string filename) {
 	for (unsigned int i = 0; i < numVars; i++)
 		out << "table 1 2 0 " << problem->getObjective()->getCoefficients()[i] << std::endl;
 	// constraints
-	foreach (LinearConstraint& constraint, *problem->getLinearConstraints()) {
+	foreach (const LinearConstraint& constraint, constraints) {
 
 		out << "constraint " << constraint.getCoefficients().size();
 		unsigned int var;
@@ -85,7 +87,7 @@ SubproblemsWriter::write(std::string filename) {
 	// constraints
 	for (unsigned int i = 0; i < numConstraints; i++) {
 
-		LinearConstraint& constraint = (*problem->getLinearConstraints())[i];
+		const LinearConstraint& constraint = constraints[i];
 
 		out << (i+numVars) /* function num */;
 		unsigned int var;
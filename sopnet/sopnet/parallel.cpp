@@ -0,0 +1,81 @@
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "parallel.h"
+
+namespace {
+
+void
+processJobs(
+		unsigned int numJobs,
+		const boost::function<void(unsigned int)>& job,
+		unsigned int& nextJob,
+		boost::mutex& mutex) {
+
+	while (true) {
+
+		unsigned int i;
+
+		{
+			boost::mutex::scoped_lock lock(mutex);
+
+			if (nextJob >= numJobs)
+				return;
+
+			i = nextJob;
+			nextJob++;
+		}
+
+		job(i);
+	}
+}
+
+} // anonymous namespace
+
+unsigned int
+getNumWorkerThreads(unsigned int numThreads, unsigned int numJobs) {
+
+	if (numThreads == 0)
+		numThreads = boost::thread::hardware_concurrency();
+
+	return std::max(1u, std::min(numThreads, numJobs));
+}
+
+unsigned int
+getThreadsPerWorker(unsigned int numWorkers) {
+
+	unsigned int numCpus = boost::thread::hardware_concurrency();
+
+	return std::max(1u, numCpus/std::max(1u, numWorkers));
+}
+
+void
+parallelFor(
+		unsigned int numThreads,
+		unsigned int numJobs,
+		const boost::function<void(unsigned int)>& job) {
+
+	numThreads = std::min(numThreads, numJobs);
+
+	unsigned int nextJob = 0;
+	boost::mutex mutex;
+
+	if (numThreads <= 1) {
+
+		processJobs(numJobs, job, nextJob, mutex);
+		return;
+	}
+
+	boost::thread_group workers;
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.create_thread(
+				boost::bind(
+						&processJobs,
+						numJobs,
+						boost::cref(job),
+						boost::ref(nextJob),
+						boost::ref(mutex)));
+	workers.join_all();
+}
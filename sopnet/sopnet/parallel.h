@@ -0,0 +1,40 @@
+#ifndef SOPNET_PARALLEL_H__
+#define SOPNET_PARALLEL_H__
+
+#include <boost/function.hpp>
+
+/**
+ * Get the number of worker threads to use for a number of independent jobs.
+ *
+ * @param numThreads
+ *              The requested number of threads, 0 for one per CPU.
+ *
+ * @param numJobs
+ *              The number of jobs. No more threads than jobs are used.
+ *
+ * @return The number of threads, at least 1.
+ */
+unsigned int getNumWorkerThreads(unsigned int numThreads, unsigned int numJobs);
+
+/**
+ * Get the number of threads each of the given number of concurrent workers 
+ * can use without oversubscribing the CPUs, e.g., for the linear solver 
+ * backend of each worker.
+ *
+ * @return The number of CPUs divided by the number of workers, at least 1.
+ */
+unsigned int getThreadsPerWorker(unsigned int numWorkers);
+
+/**
+ * Call job(i) for each i in [0, numJobs) with the given number of worker 
+ * threads. The jobs are handed out in order to the next idle worker. Returns 
+ * when all jobs are done. With a single thread, the jobs are run in the 
+ * calling thread.
+ */
+void parallelFor(
+		unsigned int numThreads,
+		unsigned int numJobs,
+		const boost::function<void(unsigned int)>& job);
+
+#endif // SOPNET_PARALLEL_H__
+
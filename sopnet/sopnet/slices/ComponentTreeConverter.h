@@ -56,12 +56,15 @@ public:
 
 	void leaveNode(boost::shared_ptr<ComponentTree::Node> node);
 
+	/**
+	 * Get a new, unique slice id.
+	 */
+	static unsigned int getNextSliceId();
+
 private:
 
 	void addConflictSet();
 
-	static unsigned int getNextSliceId();
-
 	static unsigned int NextSliceId;
 
 	static boost::mutex SliceIdMutex;
@@ -5,7 +5,9 @@
 
 #include <boost/timer/timer.hpp>
 
+#include <imageprocessing/ConnectedComponent.h>
 #include <imageprocessing/SubStackSelector.h>
+#include <sopnet/slices/Slice.h>
 #include <util/ProgramOptions.h>
 #include "MinimalImpactTEDWriter.h" 
 
@@ -31,6 +33,13 @@ util::ProgramOption optionUseDirectGroundTruth(
 		util::_long_name        = "useDirectGroundTruth",
 		util::_description_text = "For the computation of the TED coefficients, use the ground-truth directly instead of the gold-standard.");
 
+util::ProgramOption optionIncrementalTed(
+		util::_module           = "sopnet.training",
+		util::_long_name        = "incrementalTed",
+		util::_description_text = "Compute the TED coefficients by updating the TED of the unpinned reconstruction only where flipping a segment "
+		                          "changed it, instead of computing the TED from scratch for each segment. Option numAdjacentSections is "
+		                          "ignored in this case.");
+
 static logger::LogChannel minimalImpactTEDlog("minimalImpactTEDlog", "[minimalImapctTED] ");
 
 MinimalImpactTEDWriter::MinimalImpactTEDWriter() :
@@ -61,6 +70,9 @@ MinimalImpactTEDWriter::write(std::string filename) {
 
 	initPipeline();
 
+	if (optionIncrementalTed && !optionWriteTedConditions)
+		initIncrementalTed();
+
 	int limitToISI = -1;
 	if (optionLimitToISI)
 		limitToISI = optionLimitToISI.as<int>() - SliceHashConfiguration::sectionOffset;
@@ -135,7 +147,7 @@ MinimalImpactTEDWriter::write(std::string filename) {
 
 		// re-create the pipeline for the current segment and its inter-section 
 		// interval
-		if (!optionWriteTedConditions)
+		if (!optionWriteTedConditions && !_incrementalTed)
 			updatePipeline(interSectionInterval, optionNumAdjacentSections.as<int>());
 	
 		// Is the segment that corresponds to the variable part of the gold standard?
@@ -149,18 +161,18 @@ MinimalImpactTEDWriter::write(std::string filename) {
 
 		if (!optionWriteTedConditions) {
 
-			pipeline::Value<TolerantEditDistanceErrors> errors = _teDistance->getOutput("errors");
-			int sumErrors = errors->getNumSplits() + errors->getNumMerges() + errors->getNumFalsePositives() + errors->getNumFalseNegatives();
+			TolerantEditDistanceErrors& errors = getTedErrors();
+			int sumErrors = errors.getNumSplits() + errors.getNumMerges() + errors.getNumFalsePositives() + errors.getNumFalseNegatives();
 
 			outfile << "c" << varNum << " ";
 			outfile << (isContained ? -sumErrors : sumErrors) << " ";
 			outfile << "# ";
 			outfile << segmentHash << " ";
 			outfile << (isContained ? 1 : 0) << " ";
-			outfile << errors->getNumSplits() << " ";
-			outfile << errors->getNumMerges() << " ";
-			outfile << errors->getNumFalsePositives() << " ";
-			outfile << errors->getNumFalseNegatives() << std::endl;
+			outfile << errors.getNumSplits() << " ";
+			outfile << errors.getNumMerges() << " ";
+			outfile << errors.getNumFalsePositives() << " ";
+			outfile << errors.getNumFalseNegatives() << std::endl;
 
 			if (isContained) {
 
@@ -307,3 +319,126 @@ MinimalImpactTEDWriter::updatePipeline(int interSectionInterval, int numAdjacent
 	// -- Segments --> Reconstructor
 	_rReconstructor->setInput("segments",_segments);
 }
+
+void
+MinimalImpactTEDWriter::initIncrementalTed() {
+
+	boost::timer::auto_cpu_timer timer("\tinitIncrementalTed()\t\t\t%ws\n");
+
+	// The reconstruction part of the pipeline is created only once, it 
+	// follows the linear solver whenever a variable gets pinned.
+	_rimCreator = boost::make_shared<IdMapCreator>();
+	_rNeuronExtractor = boost::make_shared<NeuronExtractor>();
+	_rReconstructor = boost::make_shared<Reconstructor>();
+
+	// Linear Solver ----> Reconstructor
+	_rReconstructor->setInput("solution", _linearSolver->getOutput("solution"));
+	// -- Segments --> Reconstructor
+	_rReconstructor->setInput("segments",_segments);
+	// Reconstructor ----> NeuronExtractor [reconstruction]
+	_rNeuronExtractor->setInput("segments", _rReconstructor->getOutput("reconstruction"));
+	// NeuronExtractor [reconstruction] ----> IdMapCreator [reconstruction]
+	_rimCreator->setInput("neurons", _rNeuronExtractor->getOutput("neurons"));
+	// -- reference --> IdMapCreator
+	_rimCreator->setInput("reference",_reference);
+
+	pipeline::Value<ImageStack> goldStandard;
+	if (optionUseDirectGroundTruth)
+		goldStandard = _groundTruth;
+	else
+		goldStandard = _gsimCreator->getOutput("id map");
+
+	pipeline::Value<ImageStack> reconstruction = _rimCreator->getOutput("id map");
+
+	// compute the TED of the reconstruction without pinned variables, which 
+	// is the starting point for all updates
+	_incrementalTed = boost::make_shared<IncrementalTolerantEditDistance>();
+	_incrementalTed->initialize(*goldStandard, *reconstruction);
+
+	_incrementalTedNeurons = getNeurons();
+}
+
+TolerantEditDistanceErrors&
+MinimalImpactTEDWriter::getTedErrors() {
+
+	if (!_incrementalTed) {
+
+		_tedErrors = _teDistance->getOutput("errors");
+		return *_tedErrors;
+	}
+
+	// only the neurons that are different from the ones of the last update 
+	// can have changed the id map
+	neuron_map_t neurons = getNeurons();
+	std::vector<IncrementalTolerantEditDistance::BoundingBox> changedRegions = getChangedRegions(neurons);
+
+	pipeline::Value<ImageStack> reconstruction = _rimCreator->getOutput("id map");
+	_incrementalTed->update(*reconstruction, changedRegions);
+
+	_incrementalTedNeurons.swap(neurons);
+
+	LOG_DEBUG(minimalImpactTEDlog)
+			<< "updated " << _incrementalTed->getNumUpdatedChunks() << " chunks and "
+			<< _incrementalTed->getNumUpdatedCells() << " cells of the TED in "
+			<< changedRegions.size() << " changed sections" << std::endl;
+
+	return *_incrementalTed->getErrors();
+}
+
+MinimalImpactTEDWriter::neuron_map_t
+MinimalImpactTEDWriter::getNeurons() {
+
+	pipeline::Value<SegmentTrees> neurons = _rNeuronExtractor->getOutput("neurons");
+
+	neuron_map_t neuronMap;
+
+	foreach (boost::shared_ptr<SegmentTree> neuron, *neurons) {
+
+		std::vector<unsigned int> ids;
+		foreach (boost::shared_ptr<Segment> segment, neuron->getSegments())
+			ids.push_back(segment->getId());
+
+		std::sort(ids.begin(), ids.end());
+
+		neuronMap[ids] = neuron;
+	}
+
+	return neuronMap;
+}
+
+std::vector<IncrementalTolerantEditDistance::BoundingBox>
+MinimalImpactTEDWriter::getChangedRegions(const neuron_map_t& neurons) {
+
+	// the neurons that are only in one of the reconstructions
+	std::vector<boost::shared_ptr<SegmentTree> > changedNeurons;
+
+	foreach (const neuron_map_t::value_type& neuron, neurons)
+		if (!_incrementalTedNeurons.count(neuron.first))
+			changedNeurons.push_back(neuron.second);
+
+	foreach (const neuron_map_t::value_type& neuron, _incrementalTedNeurons)
+		if (!neurons.count(neuron.first))
+			changedNeurons.push_back(neuron.second);
+
+	// the bounding box of their slices in each section
+	std::map<unsigned int, IncrementalTolerantEditDistance::BoundingBox> sectionRegions;
+
+	foreach (boost::shared_ptr<SegmentTree> neuron, changedNeurons)
+		foreach (boost::shared_ptr<Segment> segment, neuron->getSegments())
+			foreach (boost::shared_ptr<Slice> slice, segment->getSlices()) {
+
+				unsigned int              section     = slice->getSection();
+				const util::rect<double>& boundingBox = slice->getComponent()->getBoundingBox();
+
+				sectionRegions[section].add(static_cast<int>(boundingBox.minX), static_cast<int>(boundingBox.minY), section);
+				sectionRegions[section].add(static_cast<int>(boundingBox.maxX), static_cast<int>(boundingBox.maxY), section);
+			}
+
+	std::vector<IncrementalTolerantEditDistance::BoundingBox> changedRegions;
+
+	typedef std::map<unsigned int, IncrementalTolerantEditDistance::BoundingBox>::value_type section_region_t;
+	foreach (const section_region_t& sectionRegion, sectionRegions)
+		changedRegions.push_back(sectionRegion.second);
+
+	return changedRegions;
+}
@@ -1,12 +1,16 @@
 #ifndef SOPNET_MINIMAL_IMPACT_TED_WRITER_H__
 #define SOPNET_MINIMAL_IMPACT_TED_WRITER_H__
 
+#include <map>
+#include <vector>
+
 #include <pipeline/all.h>
 #include <sopnet/inference/LinearConstraints.h>
 #include <sopnet/inference/ProblemConfiguration.h>
 #include <sopnet/segments/Segments.h>
 #include <sopnet/io/IdMapCreator.h>
 #include <sopnet/evaluation/TolerantEditDistance.h>
+#include <sopnet/evaluation/IncrementalTolerantEditDistance.h>
 #include <sopnet/neurons/NeuronExtractor.h>
 #include <sopnet/inference/Reconstructor.h>
 #include <sopnet/inference/LinearSolver.h>
@@ -26,6 +30,9 @@ public:
 
 private:
 
+	// neurons by the sorted ids of their segments
+	typedef std::map<std::vector<unsigned int>, boost::shared_ptr<SegmentTree> > neuron_map_t;
+
 	void updateOutputs() {}
 
 	/**
@@ -46,6 +53,34 @@ private:
 	 */
 	void updatePipeline(int interSectionInterval, int numAdjacentSections = 0);
 
+	/**
+	 * Create the reconstruction part of the pipeline once and compute the TED 
+	 * of the unpinned reconstruction, such that the TED of each flipped 
+	 * segment can be found by updating only the changed parts.
+	 */
+	void initIncrementalTed();
+
+	/**
+	 * Get the TED errors of the current reconstruction, either from the TED of 
+	 * the current pipeline or by updating the incremental TED.
+	 */
+	TolerantEditDistanceErrors& getTedErrors();
+
+	/**
+	 * Get the neurons of the current reconstruction.
+	 */
+	neuron_map_t getNeurons();
+
+	/**
+	 * Find the regions of the reconstruction that changed since the last 
+	 * update of the incremental TED, i.e., for each section the bounding box 
+	 * of the slices of all neurons that were added or removed.
+	 *
+	 * @param neurons
+	 *              The neurons of the current reconstruction.
+	 */
+	std::vector<IncrementalTolerantEditDistance::BoundingBox> getChangedRegions(const neuron_map_t& neurons);
+
 	/*********
 	* Inputs *
 	*********/
@@ -76,6 +111,18 @@ private:
 
 	// The node that calculates the tolerant edit distance	
 	boost::shared_ptr<TolerantEditDistance>		_teDistance;
+
+	// The tolerant edit distance that is updated for each flipped segment 
+	// (see optionIncrementalTed)
+	boost::shared_ptr<IncrementalTolerantEditDistance>	_incrementalTed;
+
+	// The neurons of the reconstruction the incremental TED was last updated 
+	// with
+	neuron_map_t _incrementalTedNeurons;
+
+	// The errors of the TED of the current pipeline, kept until the next call 
+	// of getTedErrors()
+	pipeline::Value<TolerantEditDistanceErrors> _tedErrors;
 	
 	// The id map creator that creates image stacks for the TED from the gold standard
 	boost::shared_ptr<IdMapCreator>			_gsimCreator;